@@ -0,0 +1,107 @@
+#include "Game/AllocationCounter.hpp"
+
+#if !defined(GAME_COUNT_ALLOCATIONS)
+#include "Engine/Memory/Mem.hpp"
+#endif
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> s_allocationCount(0);
+static std::atomic<uint64_t> s_allocatedBytes(0);
+
+
+STATIC bool AllocationCounter::CountsEveryAllocation()
+{
+#if defined(GAME_COUNT_ALLOCATIONS)
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+STATIC uint64_t AllocationCounter::GetAllocationCount()
+{
+#if defined(GAME_COUNT_ALLOCATIONS)
+	return s_allocationCount.load(std::memory_order_relaxed);
+#else
+	return static_cast<uint64_t>(MemTrackGetLiveAllocationCount());
+#endif
+}
+
+
+STATIC uint64_t AllocationCounter::GetAllocatedBytes()
+{
+#if defined(GAME_COUNT_ALLOCATIONS)
+	return s_allocatedBytes.load(std::memory_order_relaxed);
+#else
+	return static_cast<uint64_t>(MemTrackGetLiveByteCount());
+#endif
+}
+
+
+STATIC void AllocationCounter::RecordAllocation(const size_t num_bytes)
+{
+	s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+	s_allocatedBytes.fetch_add(num_bytes, std::memory_order_relaxed);
+}
+
+
+#if defined(GAME_COUNT_ALLOCATIONS)
+//-----------------------------------------------------------------------------------------------
+// Replacement global allocation functions. The standard library's array, nothrow and sized forms
+// forward to these two pairs, so they see every allocation made by new and by the containers.
+//
+
+void* operator new(const size_t num_bytes)
+{
+	AllocationCounter::RecordAllocation(num_bytes);
+	void* memory = malloc(num_bytes != 0 ? num_bytes : 1);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+
+void* operator new(const size_t num_bytes, const std::align_val_t alignment)
+{
+	AllocationCounter::RecordAllocation(num_bytes);
+
+	// aligned_alloc wants the size to be a multiple of the alignment
+	const size_t align = static_cast<size_t>(alignment);
+	const size_t rounded_bytes = (num_bytes + align - 1) / align * align;
+#if defined(_MSC_VER)
+	void* memory = _aligned_malloc(rounded_bytes != 0 ? rounded_bytes : align, align);
+#else
+	void* memory = aligned_alloc(align, rounded_bytes != 0 ? rounded_bytes : align);
+#endif
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+
+void operator delete(void* memory, const std::align_val_t alignment) noexcept
+{
+	UNUSED(alignment);
+#if defined(_MSC_VER)
+	_aligned_free(memory);
+#else
+	free(memory);
+#endif
+}
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include <cstdint>
+
+//-----------------------------------------------------------------------------------------------
+// AllocationCounter
+//
+// Process wide count of heap allocations, every thread's, not just the simulation's. With
+// GAME_COUNT_ALLOCATIONS (the headless project defines it) counting global operators new are
+// compiled in and every allocation is counted. The windowed build keeps the engine's own operators
+// and reads Engine/Memory/Mem.hpp's tracking instead, which only knows the live allocations, so
+// there a difference of two counts is net: what was allocated and not yet freed in between.
+//
+// Game::Update samples the count before and after the tick, which is what the alloc-test mode of
+// the headless runner holds to zero once warmed up.
+//
+
+class AllocationCounter
+{
+public:
+	static bool		CountsEveryAllocation();		// false when the counts are the engine's live ones
+	static uint64_t	GetAllocationCount();
+	static uint64_t	GetAllocatedBytes();
+
+	static void		RecordAllocation(size_t num_bytes);
+};
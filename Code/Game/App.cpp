@@ -1,5 +1,10 @@
 #include "Game/App.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/TraceRecorder.hpp"
+#include "Game/GameJobs.hpp"
+#include "Game/SharedVisuals.hpp"
+#include "Game/WorldSnapshot.hpp"
+#include "Game/TrajectoryRecorder.hpp"
 #include "Engine/EngineCommon.hpp"
 #include "Engine/Renderer/RenderContext.hpp"
 #include "Engine/Renderer/DebugRender.hpp"
@@ -14,6 +19,9 @@
 #include "Engine/Tools/Reports.hpp"
 #include "Scripting/Python/python.hpp"
 
+#include <cstdlib>
+#include <random>
+
 
 STATIC bool App::QuitRequest(EventArgs& args)
 {
@@ -36,6 +44,35 @@ STATIC bool App::LogMemAlloc(EventArgs& args)
 	return true;
 }
 
+STATIC bool App::DumpTrace(EventArgs& args)
+{
+	// trace seconds=5 file=Trace.json, open the result in ui.perfetto.dev or chrome://tracing
+	const float seconds = args.GetValue("seconds", static_cast<float>(TraceRecorder::DEFAULT_DUMP_SECONDS));
+	const std::string file_path = args.GetValue("file", std::string("Trace.json"));
+	return TraceRecorder::Dump(file_path, seconds);
+}
+
+STATIC bool App::DumpFrameTimes(EventArgs& args)
+{
+	// frametimes file=FrameTimes.csv (a .csv extension writes CSV, anything else JSON)
+	const std::string file_path = args.GetValue("file", std::string("FrameTimes.json"));
+	return g_theApp->m_theGame->DumpFrameTimes(file_path);
+}
+
+STATIC uint64_t App::PickWorldSeed()
+{
+	// a "seed" in GameConfig.xml pins the world, e.g. to the one shown in the Game State window;
+	// otherwise every session and every F8 restart builds a new one. Headless keeps its fixed seeds
+	const std::string pinned_seed = g_gameConfigBlackboard.GetValue("seed", std::string(""));
+	if (!pinned_seed.empty())
+	{
+		return strtoull(pinned_seed.c_str(), nullptr, 0);
+	}
+
+	std::random_device device;
+	return (static_cast<uint64_t>(device()) << 32) | static_cast<uint64_t>(device());
+}
+
 App::App(): m_theGame(nullptr)
 {
 	ParseXmlFileToNamedString(g_gameConfigBlackboard, "Data/GameConfig.xml");
@@ -57,26 +94,43 @@ void App::Startup()
 	EngineStartup();
 	g_theWindow->SetMouseMode(MOUSE_MODE_ABSOLUTE);
 	
+	TraceRecorder::SetThreadName("Main");
 	m_theGame = new Game;
+	m_theGame->SetSeed(PickWorldSeed());
 	
 	m_devCamera = new Camera();
 	m_devCamera->SetColorTarget(nullptr);
 	m_devCamera->SetOrthoView( Vec2(0.0f, 0.0),	Vec2((WORLD_HEIGHT * WORLD_ASPECT), (WORLD_HEIGHT)) );
 
 	m_theGame->Startup();
+	// opt-in like the "frametimes" command, Game::Shutdown writes it on every exit and F8 restart
+	m_theGame->SetFrameTimesPath(g_gameConfigBlackboard.GetValue("frameTimesFile", std::string("")));
+
+	// opt-in, the whole session, so a slow one can be run again with "Headless replay --file <path>"
+	const std::string input_path = g_gameConfigBlackboard.GetValue("inputRecordFile", std::string(""));
+	if (!input_path.empty())
+	{
+		m_theGame->StartInputRecording(input_path);
+	}
 
 	g_theEventSystem->SubscribeEventCallbackFunction("quit", QuitRequest);
+	g_theEventSystem->SubscribeEventCallbackFunction("frametimes", DumpFrameTimes);
+	g_theEventSystem->SubscribeEventCallbackFunction("trace", DumpTrace);
 
 }
 
 void App::Shutdown()
 {
 	m_theGame->Shutdown();
+	GameJobs::Shutdown();
+	SharedVisuals::Shutdown();
 	EngineShutdown();
 }
 
 void App::RunFrame()
 {
+	GAME_TRACE_SCOPE("Frame");
+
 	BeginFrame();
 	Update();
 	Render();
@@ -85,17 +139,37 @@ void App::RunFrame()
 
 void App::BeginFrame() const
 {
-	g_theRenderer->BeginFrame();
-	g_theEventSystem->BeginFrame();
-	g_theDevConsole->BeginFrame();
-	g_theDebugRenderer->BeginFrame();
-	g_theAudio->BeginFrame();
+	GAME_TRACE_SCOPE("App::BeginFrame");
 
-	m_theGame->BeginFrame();
+	{
+		GAME_TRACE_SCOPE("RenderContext::BeginFrame");
+		g_theRenderer->BeginFrame();
+	}
+	{
+		GAME_TRACE_SCOPE("EventSystem::BeginFrame");
+		g_theEventSystem->BeginFrame();
+	}
+	{
+		GAME_TRACE_SCOPE("DevConsole::BeginFrame");
+		g_theDevConsole->BeginFrame();
+	}
+	{
+		GAME_TRACE_SCOPE("DebugRender::BeginFrame");
+		g_theDebugRenderer->BeginFrame();
+	}
+	{
+		GAME_TRACE_SCOPE("AudioSystem::BeginFrame");
+		g_theAudio->BeginFrame();
+	}
+	{
+		GAME_TRACE_SCOPE("ImGui::BeginFrame");
+		m_theGame->BeginFrame();
+	}
 }
 
 void App::Update()
 {
+	GAME_TRACE_SCOPE("App::Update");
 
 	const double current_time = GetCurrentTimeSeconds();
 	const double delta_seconds = current_time - m_timeLastFrame;
@@ -105,18 +179,28 @@ void App::Update()
 	g_theDevConsole->Update(g_theClock->m_frameTime);
 	m_theGame->Update(g_theClock->m_frameTime);
 
+	GAME_TRACE_SCOPE("Game::UpdateImGui");
 	m_theGame->UpdateImGui(delta_seconds);
 }
 
 void App::Render() const
 {
 	// Draw a line from the bottom-left corner of the screen (0,0) to the center of the screen (50,50)
+	GAME_TRACE_SCOPE("App::Render");
+
 	m_theGame->Render();
-	m_theGame->RenderImGui();
-	g_theDebugRenderer->RenderToScreen();
+	{
+		GAME_TRACE_SCOPE("RenderImGui");
+		m_theGame->RenderImGui();
+	}
+	{
+		GAME_TRACE_SCOPE("DebugRender::RenderToScreen");
+		g_theDebugRenderer->RenderToScreen();
+	}
 
 	if(DEV_CONSOLE_IN_USE)
 	{
+		GAME_TRACE_SCOPE("DevConsole::Render");
 		m_devCamera->SetColorTarget(g_theRenderer->GetFrameColorTarget());
 
 		m_devCamera->SetModelMatrix( Matrix44::IDENTITY );
@@ -131,8 +215,13 @@ void App::Render() const
 
 void App::EndFrame() const
 {
+	GAME_TRACE_SCOPE("App::EndFrame");
+
 	// "Present" the back buffer by swapping the front (visible) and back (working) screen buffers
-	g_theRenderer->EndFrame();
+	{
+		GAME_TRACE_SCOPE("RenderContext::EndFrame");
+		g_theRenderer->EndFrame();
+	}
 	g_theEventSystem->EndFrame();
 	g_theDevConsole->EndFrame();
 	g_theDebugRenderer->EndFrame();
@@ -186,11 +275,51 @@ bool App::HandleKeyPressed(const unsigned char key_code)
 			m_theGame->SetDeveloperMode(true);
 		return true;
 
+	case F2_KEY:
+		if (!DEV_CONSOLE_IN_USE)
+			TraceRecorder::Dump("Trace.json");
+		return true;
+
+	case F5_KEY:
+		if (!DEV_CONSOLE_IN_USE)
+			m_theGame->SaveSnapshot(WorldSnapshot::DEFAULT_PATH);
+		return true;
+
+	case F6_KEY:
+		if (!DEV_CONSOLE_IN_USE)
+		{
+			if (m_theGame->IsRecordingTrajectories())
+				m_theGame->StopTrajectoryRecording();
+			else
+				m_theGame->StartTrajectoryRecording(TrajectoryRecorder::DEFAULT_PATH, TrajectorySettings());
+		}
+		return true;
+
+	case F7_KEY:
+		if (!DEV_CONSOLE_IN_USE)
+		{
+			// the F5 snapshot restores in place, no teardown, no new world and no rebuilt meshes
+			m_theGame->StopTrajectoryPlayback();
+			m_theGame->LoadSnapshot(WorldSnapshot::DEFAULT_PATH);
+		}
+		return true;
+
 	case F8_KEY:
 		if (!DEV_CONSOLE_IN_USE)
 			HardRestart();
 		return true;
 
+	case F9_KEY:
+		if (!DEV_CONSOLE_IN_USE)
+		{
+			// the last F6 recording replaces the simulation until F9 again, the scrubber is in the Game State window
+			if (m_theGame->IsPlayingBack())
+				m_theGame->StopTrajectoryPlayback();
+			else
+				m_theGame->StartTrajectoryPlayback(TrajectoryRecorder::DEFAULT_PATH);
+		}
+		return true;
+
 	case TILDE_KEY:
 		DEV_CONSOLE_IN_USE = !DEV_CONSOLE_IN_USE;
 		return true;
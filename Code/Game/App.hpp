@@ -20,8 +20,12 @@ public:
 	static bool QuitRequest(EventArgs& args);
 	static bool PrintMemAlloc(EventArgs& args);
 	static bool LogMemAlloc(EventArgs& args);
+	static bool DumpFrameTimes(EventArgs& args);
+	static bool DumpTrace(EventArgs& args);
 	static bool LogThreadedTest(EventArgs& args);
 private:
+	static uint64_t PickWorldSeed();
+
 	void BeginFrame() const;
 	void Update();
 	void Render() const;
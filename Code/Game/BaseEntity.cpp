@@ -1,12 +1,11 @@
 #include "Game/BaseEntity.hpp"
 #include "Game/Game.hpp"
+#include "Game/SharedVisuals.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Math/MathUtils.hpp"
-#include "Engine/Renderer/GPUMesh.hpp"
-#include "Engine/Renderer/Material.hpp"
-#include "Engine/Renderer/Shader.hpp"
+#include "Game/RenderBackend.hpp"
 
-STATIC uint BaseEntity::NextID = 0;
+STATIC std::atomic<uint> BaseEntity::NextID{ 0 };
 
 BaseEntity::BaseEntity() : m_boundingRadius(0.0f), m_id(NextValidID()),
 	m_entityType(DEFAULT_ENTITY_TYPE), m_boolTag(false)
@@ -33,7 +32,10 @@ BaseEntity::BaseEntity(const int entity_type, const Vec2& pos, const float bound
 
 BaseEntity::~BaseEntity()
 {
-	delete m_mesh;
+	if (m_ownsMesh)
+	{
+		delete m_mesh;
+	}
 	m_mesh = nullptr;
 }
 
@@ -61,17 +63,10 @@ void BaseEntity::Init()
 
 void BaseEntity::InitVisuals()
 {
-	// Get Everything to draw the triangle
-	m_material = g_theRenderer->CreateOrGetMaterial("Magenta", false);
-	m_material->SetShader("default_lit.hlsl");
-	m_material->m_shader->SetDepth(COMPARE_LESS_EQUAL, true);
-	TextureView* white_texture(reinterpret_cast<TextureView*>(g_theRenderer->CreateOrGetTextureView2D("0xFF00FFFF")));
-	m_material->SetDiffuseMap(white_texture);
-
-	CPUMesh disc_mesh;
-	CpuMeshAddDisc(&disc_mesh, Rgba::WHITE, 1.0f);
-	m_mesh = new GPUMesh(g_theRenderer);
-	m_mesh->CreateFromCPUMesh<Vertex_Lit>(disc_mesh);
+	// every obstacle draws the same unit disc, scaled by its model matrix
+	m_material = SharedVisuals::GetMaterial(SHARED_MATERIAL_OBSTACLE);
+	m_mesh = SharedVisuals::CreateOrGetMesh(SHARED_MESH_DISC, 1.0f, Rgba::WHITE);
+	m_ownsMesh = false;
 }
 
 
@@ -159,5 +154,5 @@ void BaseEntity::UnTag()
 
 uint BaseEntity::NextValidID()
 {
-	return NextID++;
+	return NextID.fetch_add(1, std::memory_order_relaxed);
 }
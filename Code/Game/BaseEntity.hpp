@@ -1,6 +1,7 @@
 #pragma once
 #include "Game/GameCommon.hpp" 
 #include "Engine/Math/Matrix33.hpp"
+#include <atomic>
 
 class GPUMesh;
 class Material;
@@ -14,9 +15,10 @@ protected:
 	Matrix33	m_modelMatrix = Matrix33::IDENTITY;
 	Material*	m_material = nullptr;
 	GPUMesh*	m_mesh = nullptr;
+	bool		m_ownsMesh = true;		// false for SharedVisuals meshes, which outlive the entity
 	
 private:
-	static uint NextID;
+	static std::atomic<uint> NextID;	// shared by every world, worlds may be built on several threads
 
 	//Meta Data
 	uint		m_id; // unique ID
@@ -0,0 +1,104 @@
+#include "Game/ClearanceField.hpp"
+#include "Game/BaseEntity.hpp"
+#include "Game/WallEntity.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+void ClearanceField::Build(const Vec2& mins, const Vec2& maxs, const float cell_size,
+	const std::vector<BaseEntity*>& obstacles, const std::vector<WallEntity*>& walls, const WrapDomain* wrap_domain)
+{
+	m_mins = mins;
+	m_inverseCellSize = 1.0f / cell_size;
+	m_numCellsX = std::max(1, static_cast<int>(std::ceil((maxs.x - mins.x) * m_inverseCellSize)));
+	m_numCellsY = std::max(1, static_cast<int>(std::ceil((maxs.y - mins.y) * m_inverseCellSize)));
+
+	const size_t num_cells = static_cast<size_t>(m_numCellsX) * static_cast<size_t>(m_numCellsY);
+	m_obstacleClearance.assign(num_cells, INFINITY);
+	m_wallClearance.assign(num_cells, INFINITY);
+
+	// anything inside a cell is at most half a diagonal away from its center
+	const float half_diagonal = cell_size * 0.70710678f;
+
+	for (int cell_y = 0; cell_y < m_numCellsY; ++cell_y)
+	{
+		for (int cell_x = 0; cell_x < m_numCellsX; ++cell_x)
+		{
+			const Vec2 center(
+				mins.x + (static_cast<float>(cell_x) + 0.5f) * cell_size,
+				mins.y + (static_cast<float>(cell_y) + 0.5f) * cell_size);
+			const size_t cell_idx = static_cast<size_t>(cell_y) * static_cast<size_t>(m_numCellsX) + static_cast<size_t>(cell_x);
+
+			float obstacle_clearance = INFINITY;
+			for (const BaseEntity* obstacle : obstacles)
+			{
+				const Vec2 displacement = wrap_domain != nullptr ?
+					wrap_domain->GetDisplacement(center, obstacle->GetPosition()) : obstacle->GetPosition() - center;
+				const float surface_distance = displacement.GetLength() - obstacle->GetBoundingRadius();
+				obstacle_clearance = std::min(obstacle_clearance, surface_distance);
+			}
+
+			float wall_clearance = INFINITY;
+			for (const WallEntity* wall : walls)
+			{
+				wall_clearance = std::min(wall_clearance, GetDistanceToWall(center, *wall));
+			}
+
+			m_obstacleClearance[cell_idx] = obstacle_clearance - half_diagonal;
+			m_wallClearance[cell_idx] = wall_clearance - half_diagonal;
+		}
+	}
+}
+
+
+float ClearanceField::GetObstacleClearance(const Vec2& position) const
+{
+	const int cell_idx = GetCellIndex(position);
+	return cell_idx >= 0 ? m_obstacleClearance[cell_idx] : 0.0f;
+}
+
+
+float ClearanceField::GetWallClearance(const Vec2& position) const
+{
+	const int cell_idx = GetCellIndex(position);
+	return cell_idx >= 0 ? m_wallClearance[cell_idx] : 0.0f;
+}
+
+
+STATIC float ClearanceField::GetDistanceToWall(const Vec2& position, const WallEntity& wall)
+{
+	// WallAvoidance only accepts hits within the half length of the wall's center, so the wall is
+	// the segment center +- direction * half length rather than the whole plane
+	const Plane2 plane = wall.GetPlane();
+	const Vec2 center = wall.GetPosition();
+	const Vec2 direction = plane.GetDirection();
+	const float half_length = wall.GetPlanHalfLength();
+
+	const Vec2 to_position = position - center;
+	float along = to_position.x * direction.x + to_position.y * direction.y;
+	along = std::min(std::max(along, -half_length), half_length);
+
+	const Vec2 closest = center + direction * along;
+	return (position - closest).GetLength();
+}
+
+
+int ClearanceField::GetCellIndex(const Vec2& position) const
+{
+	const float local_x = (position.x - m_mins.x) * m_inverseCellSize;
+	const float local_y = (position.y - m_mins.y) * m_inverseCellSize;
+	if (!(local_x >= 0.0f && local_y >= 0.0f))
+	{
+		return -1;
+	}
+
+	const int cell_x = static_cast<int>(local_x);
+	const int cell_y = static_cast<int>(local_y);
+	if (cell_x >= m_numCellsX || cell_y >= m_numCellsY)
+	{
+		return -1;
+	}
+
+	return cell_y * m_numCellsX + cell_x;
+}
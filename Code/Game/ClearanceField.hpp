@@ -0,0 +1,47 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/WrapDomain.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+class WallEntity;
+
+//-----------------------------------------------------------------------------------------------
+// ClearanceField
+//
+// Coarse distance field over the play area for culling avoidance queries. Every cell stores a lower
+// bound, valid anywhere inside the cell, on the distance to the nearest obstacle surface and to the
+// nearest wall segment. When that bound already exceeds what a behavior can see (detection box,
+// whisker length) the behavior has nothing to find and can return straight away.
+//
+// Obstacles and walls are static, so the field is rebuilt only when either list changes. Positions
+// off the grid report zero clearance, which never culls. Given a WrapDomain, obstacle distances are
+// measured to the nearest periodic image, so an obstacle just across a seam still counts.
+//
+
+class ClearanceField
+{
+public:
+	static constexpr float DEFAULT_CELL_SIZE = 2.0f;
+
+public:
+	void	Build(const Vec2& mins, const Vec2& maxs, float cell_size,
+		const std::vector<BaseEntity*>& obstacles, const std::vector<WallEntity*>& walls,
+		const WrapDomain* wrap_domain = nullptr);
+
+	float	GetObstacleClearance(const Vec2& position) const;
+	float	GetWallClearance(const Vec2& position) const;
+
+	static float	GetDistanceToWall(const Vec2& position, const WallEntity& wall);
+
+private:
+	int		GetCellIndex(const Vec2& position) const;
+
+private:
+	Vec2				m_mins = Vec2::ZERO;
+	float				m_inverseCellSize = 0.0f;
+	int					m_numCellsX = 0;
+	int					m_numCellsY = 0;
+	std::vector<float>	m_obstacleClearance;
+	std::vector<float>	m_wallClearance;
+};
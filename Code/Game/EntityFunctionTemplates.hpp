@@ -2,6 +2,7 @@
 #include "Game/BaseEntity.hpp"
 #include "Game/MovingEntity.hpp"
 #include "Game/Vehicle.hpp"
+#include "Game/WrapDomain.hpp"
 
 // expecting to only use with Entity objects
 
@@ -12,7 +13,8 @@ void TagClosestNeighbors(T* entity_ptr, S& vec_of_others, const float radius)
 	{
 		(*s_it)->UnTag();
 
-		const Vec2 direction = (*s_it)->GetPosition() - entity_ptr->GetPosition();
+		//the world wraps, an entity just across the edge is as close as it looks from the other side
+		const Vec2 direction = WORLD_WRAP.GetDisplacement(entity_ptr->GetPosition(), (*s_it)->GetPosition());
 
 		const float other_radius = (*s_it)->GetBoundingRadius();
 		const float range = radius + other_radius;
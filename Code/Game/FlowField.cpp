@@ -0,0 +1,368 @@
+#include "Game/FlowField.hpp"
+#include "Game/BaseEntity.hpp"
+#include "Game/ClearanceField.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+#include "Game/Vehicle.hpp"
+#include "Game/WallEntity.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr float FLOW_DIAGONAL_COST = 1.41421356f;
+constexpr float FLOW_INV_SQRT_2 = 0.70710678f;
+
+// 8-connected neighbors, orthogonal first so diagonals can check the two cells they pass between
+constexpr int FLOW_NEIGHBOR_DX[8] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+constexpr int FLOW_NEIGHBOR_DY[8] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+
+
+// min-heap order for the std heap functions, a functor so the comparison inlines
+struct FlowNodeFarther
+{
+	bool operator()(const FlowFieldNode& lhs, const FlowFieldNode& rhs) const
+	{
+		return lhs.m_distance > rhs.m_distance;
+	}
+};
+
+
+void FlowFieldGrid::Build(const Vec2& mins, const Vec2& maxs, const float cell_size,
+	const std::vector<BaseEntity*>& obstacles, const std::vector<WallEntity*>& walls)
+{
+	m_mins = mins;
+	m_cellSize = cell_size;
+	m_inverseCellSize = 1.0f / cell_size;
+	m_numCellsX = std::max(1, static_cast<int>(std::ceil((maxs.x - mins.x) * m_inverseCellSize)));
+	m_numCellsY = std::max(1, static_cast<int>(std::ceil((maxs.y - mins.y) * m_inverseCellSize)));
+	m_blocked.assign(static_cast<size_t>(GetNumCells()), 0);
+
+	const float half_cell = cell_size * 0.5f;
+	for (int cell_idx = 0; cell_idx < GetNumCells(); ++cell_idx)
+	{
+		const Vec2 center = GetCellCenter(cell_idx);
+
+		bool blocked = false;
+		for (const BaseEntity* obstacle : obstacles)
+		{
+			const float blocked_radius = obstacle->GetBoundingRadius() + OBSTACLE_PADDING;
+			if ((obstacle->GetPosition() - center).GetLengthSquared() < blocked_radius * blocked_radius)
+			{
+				blocked = true;
+				break;
+			}
+		}
+
+		for (size_t wall_idx = 0; !blocked && wall_idx < walls.size(); ++wall_idx)
+		{
+			blocked = ClearanceField::GetDistanceToWall(center, *walls[wall_idx]) < half_cell;
+		}
+
+		m_blocked[cell_idx] = blocked ? 1 : 0;
+	}
+}
+
+
+int FlowFieldGrid::GetCellIndex(const Vec2& position) const
+{
+	const float local_x = (position.x - m_mins.x) * m_inverseCellSize;
+	const float local_y = (position.y - m_mins.y) * m_inverseCellSize;
+	if (local_x < 0.0f || local_y < 0.0f)
+	{
+		return -1;
+	}
+
+	const int cell_x = static_cast<int>(local_x);
+	const int cell_y = static_cast<int>(local_y);
+	if (cell_x >= m_numCellsX || cell_y >= m_numCellsY)
+	{
+		return -1;
+	}
+
+	return cell_y * m_numCellsX + cell_x;
+}
+
+
+Vec2 FlowFieldGrid::GetCellCenter(const int cell_idx) const
+{
+	const int cell_x = cell_idx % m_numCellsX;
+	const int cell_y = cell_idx / m_numCellsX;
+	return Vec2(
+		m_mins.x + (static_cast<float>(cell_x) + 0.5f) * m_cellSize,
+		m_mins.y + (static_cast<float>(cell_y) + 0.5f) * m_cellSize);
+}
+
+
+void FlowField::Build(const FlowFieldGrid& grid, const int goal_cell, std::vector<FlowFieldNode>& open_scratch)
+{
+	// unit step from each neighbor back to the cell that reached it, the opposite of the neighbor offsets
+	static const Vec2 s_backDirections[8] = {
+		Vec2(-1.0f, 0.0f), Vec2(1.0f, 0.0f), Vec2(0.0f, -1.0f), Vec2(0.0f, 1.0f),
+		Vec2(-FLOW_INV_SQRT_2, -FLOW_INV_SQRT_2), Vec2(FLOW_INV_SQRT_2, -FLOW_INV_SQRT_2),
+		Vec2(-FLOW_INV_SQRT_2, FLOW_INV_SQRT_2), Vec2(FLOW_INV_SQRT_2, FLOW_INV_SQRT_2)
+	};
+
+	const int num_cells_x = grid.GetNumCellsX();
+	const int num_cells_y = grid.GetNumCellsY();
+	const float cell_size = grid.GetCellSize();
+
+	FlowFieldCell unreachable;
+	unreachable.m_distance = INFINITY;
+	m_cells.assign(static_cast<size_t>(grid.GetNumCells()), unreachable);
+	m_goalCell = goal_cell;
+	if (goal_cell < 0)
+	{
+		return;
+	}
+
+	open_scratch.clear();
+	m_cells[goal_cell].m_distance = 0.0f;
+	open_scratch.push_back({ 0.0f, goal_cell });
+
+	while (!open_scratch.empty())
+	{
+		std::pop_heap(open_scratch.begin(), open_scratch.end(), FlowNodeFarther());
+		const FlowFieldNode node = open_scratch.back();
+		open_scratch.pop_back();
+
+		// stale heap entry, the cell was settled through a shorter path since it was pushed
+		if (node.m_distance > m_cells[node.m_cellIdx].m_distance)
+		{
+			continue;
+		}
+
+		const int cell_x = node.m_cellIdx % num_cells_x;
+		const int cell_y = node.m_cellIdx / num_cells_x;
+		bool orthogonal_open[4] = { false, false, false, false };
+
+		for (int neighbor_idx = 0; neighbor_idx < 8; ++neighbor_idx)
+		{
+			const int neighbor_x = cell_x + FLOW_NEIGHBOR_DX[neighbor_idx];
+			const int neighbor_y = cell_y + FLOW_NEIGHBOR_DY[neighbor_idx];
+			if (neighbor_x < 0 || neighbor_y < 0 || neighbor_x >= num_cells_x || neighbor_y >= num_cells_y)
+			{
+				continue;
+			}
+
+			const int neighbor_cell = neighbor_y * num_cells_x + neighbor_x;
+			if (grid.IsBlocked(neighbor_cell))
+			{
+				continue;
+			}
+
+			const bool is_diagonal = neighbor_idx >= 4;
+			if (!is_diagonal)
+			{
+				orthogonal_open[neighbor_idx] = true;
+			}
+			else if (!orthogonal_open[FLOW_NEIGHBOR_DX[neighbor_idx] > 0 ? 0 : 1] ||
+				!orthogonal_open[FLOW_NEIGHBOR_DY[neighbor_idx] > 0 ? 2 : 3])
+			{
+				continue;
+			}
+
+			const float distance = node.m_distance + (is_diagonal ? FLOW_DIAGONAL_COST : 1.0f) * cell_size;
+			FlowFieldCell& neighbor = m_cells[neighbor_cell];
+			if (distance < neighbor.m_distance)
+			{
+				// the search runs outward from the goal, so the path from the neighbor steps back here
+				neighbor.m_distance = distance;
+				neighbor.m_direction = s_backDirections[neighbor_idx];
+				open_scratch.push_back({ distance, neighbor_cell });
+				std::push_heap(open_scratch.begin(), open_scratch.end(), FlowNodeFarther());
+			}
+		}
+	}
+}
+
+
+bool FlowField::Sample(const FlowFieldGrid& grid, const Vec2& position, Vec2& out_direction, float& out_distance) const
+{
+	const int cell_idx = grid.GetCellIndex(position);
+	if (cell_idx < 0 || cell_idx == m_goalCell || m_cells.empty())
+	{
+		return false;
+	}
+
+	const FlowFieldCell& cell = m_cells[cell_idx];
+	if (cell.m_distance == INFINITY)
+	{
+		return false;
+	}
+
+	out_direction = cell.m_direction;
+	out_distance = cell.m_distance;
+	return true;
+}
+
+
+void FlowFieldCache::BuildGrid(const Vec2& mins, const Vec2& maxs, const float cell_size,
+	const std::vector<BaseEntity*>& obstacles, const std::vector<WallEntity*>& walls)
+{
+	m_grid.Build(mins, maxs, cell_size, obstacles, walls);
+	m_openScratch.reserve(static_cast<size_t>(m_grid.GetNumCells()) * 2);
+
+	for (FlowFieldEntry& entry : m_entries)
+	{
+		entry.m_goalCell = entry.m_refCount > 0 ? m_grid.GetCellIndex(entry.m_goal) : -1;
+		entry.m_dirty = true;
+	}
+}
+
+
+int FlowFieldCache::Retain(const Vec2& goal)
+{
+	// fixed goals in one cell share a field, inside the goal cell agents steer straight anyway
+	const int goal_cell = m_grid.IsBuilt() ? m_grid.GetCellIndex(goal) : -1;
+	for (size_t entry_idx = 0; entry_idx < m_entries.size(); ++entry_idx)
+	{
+		FlowFieldEntry& entry = m_entries[entry_idx];
+		if (entry.m_refCount > 0 && entry.m_movingGoal == nullptr && m_grid.IsBuilt() &&
+			entry.m_goalCell == goal_cell && goal_cell >= 0)
+		{
+			++entry.m_refCount;
+			return static_cast<int>(entry_idx);
+		}
+	}
+
+	const int flow_field_handle = AcquireEntry();
+	FlowFieldEntry& entry = m_entries[flow_field_handle];
+	entry.m_goal = goal;
+	entry.m_goalCell = goal_cell;
+	return flow_field_handle;
+}
+
+
+int FlowFieldCache::Retain(const Vehicle* moving_goal)
+{
+	if (moving_goal == nullptr)
+	{
+		return INVALID_FLOW_FIELD;
+	}
+
+	for (size_t entry_idx = 0; entry_idx < m_entries.size(); ++entry_idx)
+	{
+		FlowFieldEntry& entry = m_entries[entry_idx];
+		if (entry.m_refCount > 0 && entry.m_movingGoal == moving_goal)
+		{
+			++entry.m_refCount;
+			return static_cast<int>(entry_idx);
+		}
+	}
+
+	const int flow_field_handle = AcquireEntry();
+	FlowFieldEntry& entry = m_entries[flow_field_handle];
+	entry.m_movingGoal = moving_goal;
+	entry.m_goal = moving_goal->GetPosition();
+	entry.m_goalCell = m_grid.IsBuilt() ? m_grid.GetCellIndex(entry.m_goal) : -1;
+	return flow_field_handle;
+}
+
+
+void FlowFieldCache::Release(const int flow_field_handle)
+{
+	if (flow_field_handle == INVALID_FLOW_FIELD)
+	{
+		return;
+	}
+
+	FlowFieldEntry& entry = m_entries[flow_field_handle];
+	if (--entry.m_refCount > 0)
+	{
+		return;
+	}
+
+	// keeps its cells, a later goal landing in this slot reuses the storage
+	entry.m_movingGoal = nullptr;
+	m_freeSlots.push_back(flow_field_handle);
+}
+
+
+void FlowFieldCache::Update()
+{
+	m_numBuildsLastUpdate = 0;
+	if (!m_grid.IsBuilt())
+	{
+		return;
+	}
+
+	const double build_begin = FrameTimeStats::GetTimeSeconds();
+	for (FlowFieldEntry& entry : m_entries)
+	{
+		if (entry.m_refCount == 0)
+		{
+			continue;
+		}
+
+		if (entry.m_movingGoal != nullptr)
+		{
+			entry.m_goal = entry.m_movingGoal->GetPosition();
+			const int goal_cell = m_grid.GetCellIndex(entry.m_goal);
+			if (goal_cell != entry.m_goalCell)
+			{
+				entry.m_goalCell = goal_cell;
+				entry.m_dirty = true;
+			}
+		}
+
+		if (entry.m_dirty)
+		{
+			entry.m_field.Build(m_grid, entry.m_goalCell, m_openScratch);
+			entry.m_dirty = false;
+			++m_numBuildsLastUpdate;
+		}
+	}
+
+	if (m_numBuildsLastUpdate > 0)
+	{
+		m_lastBuildSeconds = (FrameTimeStats::GetTimeSeconds() - build_begin) / static_cast<double>(m_numBuildsLastUpdate);
+	}
+}
+
+
+void FlowFieldCache::GetGoal(const int flow_field_handle, Vec2& out_goal, const Vehicle*& out_moving_goal) const
+{
+	const FlowFieldEntry& entry = m_entries[flow_field_handle];
+	out_goal = entry.m_goal;
+	out_moving_goal = entry.m_movingGoal;
+}
+
+
+bool FlowFieldCache::Sample(const int flow_field_handle, const Vec2& position, Vec2& out_direction,
+	float& out_distance) const
+{
+	const FlowFieldEntry& entry = m_entries[flow_field_handle];
+	if (entry.m_dirty)
+	{
+		return false;
+	}
+
+	return entry.m_field.Sample(m_grid, position, out_direction, out_distance);
+}
+
+
+uint FlowFieldCache::GetNumFields() const
+{
+	return static_cast<uint>(m_entries.size() - m_freeSlots.size());
+}
+
+
+int FlowFieldCache::AcquireEntry()
+{
+	int flow_field_handle;
+	if (!m_freeSlots.empty())
+	{
+		flow_field_handle = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		flow_field_handle = static_cast<int>(m_entries.size());
+		m_entries.emplace_back();
+	}
+
+	FlowFieldEntry& entry = m_entries[flow_field_handle];
+	entry.m_movingGoal = nullptr;
+	entry.m_refCount = 1;
+	entry.m_dirty = true;
+	return flow_field_handle;
+}
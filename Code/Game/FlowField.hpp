@@ -0,0 +1,141 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+#include <vector>
+
+class Vehicle;
+class WallEntity;
+
+//-----------------------------------------------------------------------------------------------
+// FlowFieldGrid
+//
+// Cell layout shared by every flow field plus which cells an agent can not pass: centers inside an
+// obstacle (padded by OBSTACLE_PADDING) or within half a cell of a wall segment. Obstacles and walls
+// are static, so the grid is rebuilt only when either list changes, like the ClearanceField.
+//
+
+class FlowFieldGrid
+{
+public:
+	static constexpr float DEFAULT_CELL_SIZE = 2.0f;
+	static constexpr float OBSTACLE_PADDING = 2.0f;
+
+public:
+	void	Build(const Vec2& mins, const Vec2& maxs, float cell_size,
+		const std::vector<BaseEntity*>& obstacles, const std::vector<WallEntity*>& walls);
+
+	int		GetCellIndex(const Vec2& position) const;	// -1 off the grid
+	Vec2	GetCellCenter(int cell_idx) const;
+	bool	IsBlocked(int cell_idx) const	{ return m_blocked[cell_idx] != 0; }
+	bool	IsBuilt() const					{ return !m_blocked.empty(); }
+	int		GetNumCellsX() const			{ return m_numCellsX; }
+	int		GetNumCellsY() const			{ return m_numCellsY; }
+	int		GetNumCells() const				{ return m_numCellsX * m_numCellsY; }
+	float	GetCellSize() const				{ return m_cellSize; }
+
+private:
+	Vec2					m_mins = Vec2::ZERO;
+	float					m_cellSize = DEFAULT_CELL_SIZE;
+	float					m_inverseCellSize = 1.0f / DEFAULT_CELL_SIZE;
+	int						m_numCellsX = 0;
+	int						m_numCellsY = 0;
+	std::vector<uint8_t>	m_blocked;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// FlowField
+//
+// Shortest paths from every cell of a FlowFieldGrid to one goal cell, integrated with Dijkstra over
+// the 8-connected grid (octile step costs, no cutting past blocked corners). Each cell keeps the unit
+// direction to its next cell on the path and its path length to the goal, side by side so a sample
+// is one index computation and one cache line.
+//
+
+struct FlowFieldCell
+{
+	Vec2	m_direction = Vec2::ZERO;	// zero in the goal cell and where the goal can not be reached
+	float	m_distance = 0.0f;
+};
+
+
+struct FlowFieldNode
+{
+	float	m_distance = 0.0f;
+	int		m_cellIdx = 0;
+};
+
+
+class FlowField
+{
+public:
+	void	Build(const FlowFieldGrid& grid, int goal_cell, std::vector<FlowFieldNode>& open_scratch);
+
+	// false in the goal cell, in blocked or unreachable cells and off the grid: steer straight there
+	bool	Sample(const FlowFieldGrid& grid, const Vec2& position, Vec2& out_direction, float& out_distance) const;
+
+	int		GetGoalCell() const { return m_goalCell; }
+
+private:
+	std::vector<FlowFieldCell>	m_cells;
+	int							m_goalCell = -1;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// FlowFieldCache
+//
+// One flow field per goal, shared by every agent seeking or arriving at it. Fixed goals are matched
+// by grid cell, moving goals (a vehicle) by pointer; both are reference counted by the steering
+// behaviors using them. Update() follows moving goals and re-integrates a field only when its goal
+// crossed into another cell, every other tick just reuses the field.
+//
+
+struct FlowFieldEntry
+{
+	FlowField		m_field;
+	Vec2			m_goal = Vec2::ZERO;
+	const Vehicle*	m_movingGoal = nullptr;
+	int				m_goalCell = -1;
+	uint			m_refCount = 0;
+	bool			m_dirty = true;
+};
+
+
+class FlowFieldCache
+{
+public:
+	static constexpr int INVALID_FLOW_FIELD = -1;
+
+public:
+	void	BuildGrid(const Vec2& mins, const Vec2& maxs, float cell_size,
+		const std::vector<BaseEntity*>& obstacles, const std::vector<WallEntity*>& walls);
+
+	int		Retain(const Vec2& goal);
+	int		Retain(const Vehicle* moving_goal);
+	void	Release(int flow_field_handle);
+	void	Update();
+
+	bool	Sample(int flow_field_handle, const Vec2& position, Vec2& out_direction, float& out_distance) const;
+
+	// the goal a handle was retained for, out_moving_goal is null for a fixed goal
+	void	GetGoal(int flow_field_handle, Vec2& out_goal, const Vehicle*& out_moving_goal) const;
+
+	const FlowFieldGrid&	GetGrid() const { return m_grid; }
+	uint					GetNumFields() const;
+	uint					GetNumBuildsLastUpdate() const { return m_numBuildsLastUpdate; }
+	double					GetLastBuildSeconds() const { return m_lastBuildSeconds; }
+
+private:
+	int		AcquireEntry();
+
+private:
+	FlowFieldGrid				m_grid;
+	std::vector<FlowFieldEntry>	m_entries;
+	std::vector<int>			m_freeSlots;
+	std::vector<FlowFieldNode>	m_openScratch;	// Dijkstra heap, kept so rebuilds do not allocate
+
+	uint	m_numBuildsLastUpdate = 0;
+	double	m_lastBuildSeconds = 0.0;
+};
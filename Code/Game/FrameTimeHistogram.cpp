@@ -0,0 +1,318 @@
+#include "Game/FrameTimeHistogram.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+
+void FrameTimeHistogram::Record(const uint64_t value_us)
+{
+	const uint64_t clamped = std::min(value_us, MAX_TRACKABLE_VALUE);
+	++m_counts[GetCountIndex(clamped)];
+	++m_totalCount;
+	m_max = std::max(m_max, clamped);
+}
+
+
+void FrameTimeHistogram::Add(const FrameTimeHistogram& other)
+{
+	for (int count_idx = 0; count_idx < NUM_COUNTS; ++count_idx)
+	{
+		m_counts[count_idx] += other.m_counts[count_idx];
+	}
+
+	m_totalCount += other.m_totalCount;
+	m_max = std::max(m_max, other.m_max);
+}
+
+
+void FrameTimeHistogram::Subtract(const FrameTimeHistogram& other)
+{
+	// the max can not be un-merged, the owner restores it with SetMax()
+	for (int count_idx = 0; count_idx < NUM_COUNTS; ++count_idx)
+	{
+		m_counts[count_idx] -= other.m_counts[count_idx];
+	}
+
+	m_totalCount -= other.m_totalCount;
+}
+
+
+void FrameTimeHistogram::Reset()
+{
+	std::fill(m_counts, m_counts + NUM_COUNTS, 0u);
+	m_totalCount = 0;
+	m_max = 0;
+}
+
+
+uint64_t FrameTimeHistogram::GetValueAtPercentile(const double percentile) const
+{
+	if (m_totalCount == 0)
+	{
+		return 0;
+	}
+
+	const double clamped = std::min(std::max(percentile, 0.0), 100.0);
+	uint64_t target = static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(m_totalCount)));
+	target = std::max<uint64_t>(target, 1);
+
+	uint64_t cumulative = 0;
+	for (int count_idx = 0; count_idx < NUM_COUNTS; ++count_idx)
+	{
+		cumulative += m_counts[count_idx];
+		if (cumulative >= target)
+		{
+			// report the top of the bucket, but never more than what was actually seen
+			return std::min(GetHighestEquivalentValue(count_idx), m_max);
+		}
+	}
+
+	return m_max;
+}
+
+
+STATIC int FrameTimeHistogram::GetCountIndex(const uint64_t value_us)
+{
+	int highest_bit = 0;
+	for (uint64_t remaining = value_us >> 1; remaining != 0; remaining >>= 1)
+	{
+		++highest_bit;
+	}
+
+	// bucket 0 covers [0, SUB_BUCKET_COUNT) one to one, bucket n its upper half at 2^n resolution
+	const int bucket = std::max(0, highest_bit - (SUB_BUCKET_BITS - 1));
+	const int sub_bucket = static_cast<int>(value_us >> bucket);
+	return bucket * SUB_BUCKET_HALF + sub_bucket;
+}
+
+
+STATIC uint64_t FrameTimeHistogram::GetHighestEquivalentValue(const int count_idx)
+{
+	if (count_idx < SUB_BUCKET_COUNT)
+	{
+		return static_cast<uint64_t>(count_idx);
+	}
+
+	const int bucket = count_idx / SUB_BUCKET_HALF - 1;
+	const uint64_t sub_bucket = static_cast<uint64_t>(count_idx - bucket * SUB_BUCKET_HALF);
+	return ((sub_bucket + 1) << bucket) - 1;
+}
+
+
+FrameTimeWindow::FrameTimeWindow(const double window_seconds, const int num_slices)
+	: m_slices(static_cast<size_t>(num_slices)),
+	m_windowSeconds(window_seconds),
+	m_sliceSeconds(window_seconds / static_cast<double>(num_slices))
+{
+}
+
+
+void FrameTimeWindow::Record(const uint64_t value_us, const double now_seconds)
+{
+	Advance(now_seconds);
+	m_slices[m_currentSlice].Record(value_us);
+	m_window.Record(value_us);
+}
+
+
+void FrameTimeWindow::Advance(const double now_seconds)
+{
+	if (m_sliceStartSeconds < 0.0)
+	{
+		m_sliceStartSeconds = now_seconds;
+		return;
+	}
+
+	const int num_slices = static_cast<int>(m_slices.size());
+	int num_expired = 0;
+	while (now_seconds - m_sliceStartSeconds >= m_sliceSeconds && num_expired < num_slices)
+	{
+		m_currentSlice = (m_currentSlice + 1) % num_slices;
+		m_window.Subtract(m_slices[m_currentSlice]);
+		m_slices[m_currentSlice].Reset();
+		m_sliceStartSeconds += m_sliceSeconds;
+		++num_expired;
+	}
+
+	if (num_expired == 0)
+	{
+		return;
+	}
+
+	if (num_expired == num_slices)
+	{
+		// idle for longer than the whole window, restart the slice grid at now
+		m_sliceStartSeconds = now_seconds;
+	}
+
+	uint64_t window_max = 0;
+	for (int slice_idx = 0; slice_idx < num_slices; ++slice_idx)
+	{
+		window_max = std::max(window_max, m_slices[slice_idx].GetMax());
+	}
+	m_window.SetMax(window_max);
+}
+
+
+void FrameTimeWindow::Reset()
+{
+	for (size_t slice_idx = 0; slice_idx < m_slices.size(); ++slice_idx)
+	{
+		m_slices[slice_idx].Reset();
+	}
+
+	m_window.Reset();
+	m_sliceStartSeconds = -1.0;
+	m_currentSlice = 0;
+}
+
+
+FrameTimeStats::FrameTimeStats(const char* name)
+	: m_name(name),
+	m_shortWindow(1.0, 10),
+	m_longWindow(10.0, 10)
+{
+}
+
+
+void FrameTimeStats::Record(const double value_seconds, const double now_seconds)
+{
+	const uint64_t value_us = value_seconds > 0.0 ? static_cast<uint64_t>(value_seconds * 1.0e6 + 0.5) : 0;
+	m_shortWindow.Record(value_us, now_seconds);
+	m_longWindow.Record(value_us, now_seconds);
+	m_allTime.Record(value_us);
+}
+
+
+void FrameTimeStats::Reset()
+{
+	m_shortWindow.Reset();
+	m_longWindow.Reset();
+	m_allTime.Reset();
+}
+
+
+const FrameTimeHistogram& FrameTimeStats::GetHistogram(const FrameTimeSpan span) const
+{
+	switch (span)
+	{
+		case FRAME_TIME_SPAN_1S:	return m_shortWindow.GetHistogram();
+		case FRAME_TIME_SPAN_10S:	return m_longWindow.GetHistogram();
+		default:					return m_allTime;
+	}
+}
+
+
+STATIC const char* FrameTimeStats::GetSpanName(const FrameTimeSpan span)
+{
+	static const char* s_spanNames[NUM_FRAME_TIME_SPANS] = { "1s", "10s", "all" };
+	return s_spanNames[span];
+}
+
+
+STATIC double FrameTimeStats::GetTimeSeconds()
+{
+	const std::chrono::steady_clock::duration now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration<double>(now).count();
+}
+
+
+STATIC bool FrameTimeStats::WriteCsv(const std::string& file_path, const std::vector<const FrameTimeStats*>& stats)
+{
+	FILE* file = fopen(file_path.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(file, "metric,window,count,p50_ms,p90_ms,p99_ms,p99.9_ms,max_ms\n");
+	for (size_t stat_idx = 0; stat_idx < stats.size(); ++stat_idx)
+	{
+		for (int span_idx = 0; span_idx < NUM_FRAME_TIME_SPANS; ++span_idx)
+		{
+			const FrameTimeSpan span = static_cast<FrameTimeSpan>(span_idx);
+			const FrameTimeHistogram& histogram = stats[stat_idx]->GetHistogram(span);
+			fprintf(file, "%s,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+				stats[stat_idx]->GetName(),
+				GetSpanName(span),
+				static_cast<unsigned long long>(histogram.GetTotalCount()),
+				static_cast<double>(histogram.GetValueAtPercentile(50.0)) * 1.0e-3,
+				static_cast<double>(histogram.GetValueAtPercentile(90.0)) * 1.0e-3,
+				static_cast<double>(histogram.GetValueAtPercentile(99.0)) * 1.0e-3,
+				static_cast<double>(histogram.GetValueAtPercentile(99.9)) * 1.0e-3,
+				static_cast<double>(histogram.GetMax()) * 1.0e-3);
+		}
+	}
+
+	fclose(file);
+	return true;
+}
+
+
+STATIC bool FrameTimeStats::WriteJson(const std::string& file_path, const std::vector<const FrameTimeStats*>& stats)
+{
+	FILE* file = fopen(file_path.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(file, "{\n");
+	for (size_t stat_idx = 0; stat_idx < stats.size(); ++stat_idx)
+	{
+		fprintf(file, "  \"%s\": {\n", stats[stat_idx]->GetName());
+		for (int span_idx = 0; span_idx < NUM_FRAME_TIME_SPANS; ++span_idx)
+		{
+			const FrameTimeSpan span = static_cast<FrameTimeSpan>(span_idx);
+			const FrameTimeHistogram& histogram = stats[stat_idx]->GetHistogram(span);
+			fprintf(file,
+				"    \"%s\": {\"count\": %llu, \"p50_ms\": %.3f, \"p90_ms\": %.3f, \"p99_ms\": %.3f, \"p99.9_ms\": %.3f, \"max_ms\": %.3f}",
+				GetSpanName(span),
+				static_cast<unsigned long long>(histogram.GetTotalCount()),
+				static_cast<double>(histogram.GetValueAtPercentile(50.0)) * 1.0e-3,
+				static_cast<double>(histogram.GetValueAtPercentile(90.0)) * 1.0e-3,
+				static_cast<double>(histogram.GetValueAtPercentile(99.0)) * 1.0e-3,
+				static_cast<double>(histogram.GetValueAtPercentile(99.9)) * 1.0e-3,
+				static_cast<double>(histogram.GetMax()) * 1.0e-3);
+			fprintf(file, ",\n");
+		}
+
+		// whole-run distribution as [bucket upper bound in us, count] pairs, empty buckets skipped
+		const FrameTimeHistogram& all_time = stats[stat_idx]->GetHistogram(FRAME_TIME_SPAN_ALL);
+		fprintf(file, "    \"buckets_us\": [");
+		bool first_bucket = true;
+		for (int count_idx = 0; count_idx < FrameTimeHistogram::NUM_COUNTS; ++count_idx)
+		{
+			const uint32_t count = all_time.GetCountAtIndex(count_idx);
+			if (count == 0)
+			{
+				continue;
+			}
+
+			fprintf(file, "%s[%llu, %u]",
+				first_bucket ? "" : ", ",
+				static_cast<unsigned long long>(FrameTimeHistogram::GetHighestEquivalentValue(count_idx)),
+				count);
+			first_bucket = false;
+		}
+		fprintf(file, "]\n  }%s\n", stat_idx + 1 < stats.size() ? "," : "");
+	}
+	fprintf(file, "}\n");
+
+	fclose(file);
+	return true;
+}
+
+
+STATIC bool FrameTimeStats::Write(const std::string& file_path, const std::vector<const FrameTimeStats*>& stats)
+{
+	const size_t dot = file_path.find_last_of('.');
+	if (dot != std::string::npos && file_path.compare(dot, std::string::npos, ".csv") == 0)
+	{
+		return WriteCsv(file_path, stats);
+	}
+
+	return WriteJson(file_path, stats);
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// FrameTimeHistogram
+//
+// HDR style log-bucketed histogram of durations in microseconds. Every power of two range is split
+// into SUB_BUCKET_HALF linear sub buckets, so any recorded value is reported within 0.8% no matter
+// whether it is a 50us tick or a 2s hitch. Memory is fixed, recording is an index computation and an
+// increment, and percentiles are exact up to that bucket resolution.
+//
+
+class FrameTimeHistogram
+{
+public:
+	static constexpr int		SUB_BUCKET_BITS = 8;
+	static constexpr int		SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+	static constexpr int		SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+	static constexpr int		MAX_BUCKET = 19;	// tracks up to 2^27 us (~134 s), longer values are clamped
+	static constexpr int		NUM_COUNTS = (MAX_BUCKET + 2) * SUB_BUCKET_HALF;
+	static constexpr uint64_t	MAX_TRACKABLE_VALUE = (uint64_t(1) << (MAX_BUCKET + SUB_BUCKET_BITS)) - 1;
+
+public:
+	void		Record(uint64_t value_us);
+	void		Add(const FrameTimeHistogram& other);
+	void		Subtract(const FrameTimeHistogram& other);
+	void		Reset();
+
+	void		SetMax(uint64_t max_us) { m_max = max_us; }
+
+	uint64_t	GetTotalCount() const	{ return m_totalCount; }
+	uint64_t	GetMax() const			{ return m_max; }
+	uint64_t	GetValueAtPercentile(double percentile) const;
+	uint32_t	GetCountAtIndex(int count_idx) const { return m_counts[count_idx]; }
+
+	static int		GetCountIndex(uint64_t value_us);
+	static uint64_t	GetHighestEquivalentValue(int count_idx);
+
+private:
+	uint32_t	m_counts[NUM_COUNTS] = { 0 };
+	uint64_t	m_totalCount = 0;
+	uint64_t	m_max = 0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// FrameTimeWindow
+//
+// Sliding window over the last m_windowSeconds, kept as a ring of slice histograms plus their running
+// sum. When a slice expires its counts are subtracted from the sum, so queries never touch the ring.
+//
+
+class FrameTimeWindow
+{
+public:
+	FrameTimeWindow(double window_seconds, int num_slices);
+
+	void	Record(uint64_t value_us, double now_seconds);
+	void	Advance(double now_seconds);
+	void	Reset();
+
+	const FrameTimeHistogram&	GetHistogram() const	{ return m_window; }
+	double						GetWindowSeconds() const { return m_windowSeconds; }
+
+private:
+	std::vector<FrameTimeHistogram>	m_slices;
+	FrameTimeHistogram				m_window;
+	double	m_windowSeconds = 0.0;
+	double	m_sliceSeconds = 0.0;
+	double	m_sliceStartSeconds = -1.0;
+	int		m_currentSlice = 0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// FrameTimeStats
+//
+// One measured duration (frame time, tick time) tracked over a 1s window, a 10s window and the whole
+// run. Several stats can be written out together as CSV (percentile summary) or JSON (summary plus the
+// non-empty buckets of the whole-run histogram).
+//
+
+enum FrameTimeSpan
+{
+	FRAME_TIME_SPAN_1S = 0,
+	FRAME_TIME_SPAN_10S,
+	FRAME_TIME_SPAN_ALL,
+
+	NUM_FRAME_TIME_SPANS
+};
+
+
+class FrameTimeStats
+{
+public:
+	explicit FrameTimeStats(const char* name);
+
+	void	Record(double value_seconds, double now_seconds);
+	void	Reset();
+
+	const char*					GetName() const { return m_name; }
+	const FrameTimeHistogram&	GetHistogram(FrameTimeSpan span) const;
+
+	static const char*	GetSpanName(FrameTimeSpan span);
+	static double		GetTimeSeconds();
+
+	static bool	WriteCsv(const std::string& file_path, const std::vector<const FrameTimeStats*>& stats);
+	static bool	WriteJson(const std::string& file_path, const std::vector<const FrameTimeStats*>& stats);
+	static bool	Write(const std::string& file_path, const std::vector<const FrameTimeStats*>& stats);
+
+private:
+	const char*			m_name = nullptr;
+	FrameTimeWindow		m_shortWindow;
+	FrameTimeWindow		m_longWindow;
+	FrameTimeHistogram	m_allTime;
+};
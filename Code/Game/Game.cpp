@@ -3,24 +3,42 @@
 #include "Game/Vehicle.hpp"
 #include "Game/WallEntity.hpp"
 #include "Game/EntityFunctionTemplates.hpp"
+#include "Game/GameProfiler.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+#include "Game/TraceRecorder.hpp"
+#include "Game/AllocationCounter.hpp"
+#include "Game/WrapDomain.hpp"
+#include "Game/WorldSnapshot.hpp"
+#include "Game/TrajectoryRecorder.hpp"
+#include "Game/TrajectoryPlayback.hpp"
+#include "Game/InputRecording.hpp"
+#include "Game/GameJobs.hpp"
+
+#include "Game/RenderBackend.hpp"
 
 #include "Engine/Core/Vertex_PCU.hpp"
-#include "Engine/Core/WindowContext.hpp"
 #include "Engine/Math/Matrix44.hpp"
+#include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/CPUMesh.hpp"
-#include "Engine/Renderer/GPUMesh.hpp"
-#include "Engine/Renderer/Material.hpp"
-#include "Engine/Renderer/Shader.hpp"
-#include "Engine/Renderer/DebugRender.hpp"
-#include "Engine/Core/Vertex_PCU.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <new>
+
+#if !defined(GAME_HEADLESS)
+#include "Engine/Core/WindowContext.hpp"
 #include "Engine/Renderer/ImGUISystem.hpp"
 #include "Engine/Core/Clock.hpp"
+#endif
 
 
 Game::Game()
 {
 	m_inDevMode = false;
 	m_time = 0.0f;
+
+	m_agentAvoidance.SetWrapDomain(&WORLD_WRAP);
 }
 
 Game::~Game()
@@ -29,11 +47,16 @@ Game::~Game()
 
 void Game::Startup()
 {	
+	m_random.Seed(m_seed);
+
 	//Setup Camera
-	m_gameCamera = new Camera();
-	m_gameCamera->SetColorTarget(nullptr); // when binding, if nullptr, use the backbuffer
-	m_gameCamera->SetOrthoView(Vec2(-WORLD_HEIGHT * WORLD_ASPECT, -WORLD_HEIGHT), Vec2(WORLD_HEIGHT * WORLD_ASPECT, WORLD_HEIGHT));
-	m_defaultShader = g_theRenderer->CreateOrGetShader("default_unlit.hlsl");
+	if (m_visualsEnabled)
+	{
+		m_gameCamera = new Camera();
+		m_gameCamera->SetColorTarget(nullptr); // when binding, if nullptr, use the backbuffer
+		m_gameCamera->SetOrthoView(Vec2(-WORLD_HEIGHT * WORLD_ASPECT, -WORLD_HEIGHT), Vec2(WORLD_HEIGHT * WORLD_ASPECT, WORLD_HEIGHT));
+		m_defaultShader = g_theRenderer->CreateOrGetShader("default_unlit.hlsl");
+	}
 
 	//Setup Game entities
 	m_obstacles = std::vector<BaseEntity*>();
@@ -42,7 +65,7 @@ void Game::Startup()
 		Vec2::ZERO,
 		32.0f)
 	);
-	m_obstacles[0]->Init();
+	InitEntityVisuals(m_obstacles[0]);
 
 
 	m_worldBounds = std::vector<WallEntity*>();
@@ -54,7 +77,7 @@ void Game::Startup()
 		Vec2(-1.0f, 0.0f),
 		-WORLD_HEIGHT * WORLD_ASPECT
 	));
-	m_worldBounds[0]->Init();
+	InitEntityVisuals(m_worldBounds[0]);
 
 	// North
 	m_worldBounds.push_back(new WallEntity(
@@ -63,7 +86,7 @@ void Game::Startup()
 		Vec2(0.0f, -1.0f),
 		-WORLD_HEIGHT_ADJUST
 	));
-	m_worldBounds[1]->Init();
+	InitEntityVisuals(m_worldBounds[1]);
 
 	// West
 	m_worldBounds.push_back(new WallEntity(
@@ -72,7 +95,7 @@ void Game::Startup()
 		Vec2(1.0f, 0.0f),
 		-WORLD_HEIGHT * WORLD_ASPECT
 	));
-	m_worldBounds[2]->Init();
+	InitEntityVisuals(m_worldBounds[2]);
 
 	// South
 	m_worldBounds.push_back(new WallEntity(
@@ -81,12 +104,12 @@ void Game::Startup()
 		Vec2(0.0f, 1.0f),
 		-WORLD_HEIGHT
 	));
-	m_worldBounds[3]->Init();
+	InitEntityVisuals(m_worldBounds[3]);
 
 	
 	
 	m_vehicles = std::vector<Vehicle*>();
-	m_vehicles.reserve(MAX_NUM_ENEMIES);
+	ReservePopulation(VEHICLE_BATCH_SIZE);	// the leader's batch, per-vehicle arrays exist even for a population of 1
 	m_vehicles.push_back(new Vehicle(
 		this, 
 		Vec2(-100.0f, 0.0f), 
@@ -102,35 +125,18 @@ void Game::Startup()
 	m_vehicles[0]->WanderAround(7.0f, 20.0f, 1.32f);
 	m_vehicles[0]->AvoidObstacles(30.0f, 3.0f, 0.25f);
 	m_vehicles[0]->AvoidWalls(3, 30.0f, 3.0f, 45.0f);
-	m_vehicles[0]->Init();
-	
-	for(uint veh_idx = 1; veh_idx < MAX_NUM_ENEMIES; ++veh_idx)
-	{
-		const float x = g_randomNumberGenerator.GetRandomFloatInRange(
-			-WORLD_HEIGHT * WORLD_ASPECT,
-			WORLD_HEIGHT * WORLD_ASPECT
-		);
-
-		const float y = g_randomNumberGenerator.GetRandomFloatInRange(
-			-WORLD_HEIGHT,
-			WORLD_HEIGHT
-		);
+	InitEntityVisuals(m_vehicles[0]);
+	m_vehicles[0]->SetPopulationIndex(0);
+	m_vehicles[0]->GetRandom().Seed(SimRandom::CombineSeeds(m_seed, 0));
 
-		m_vehicles.push_back(new Vehicle(
-			this,
-			Vec2(x, y),
-			0.0f,
-			Vec2::ZERO,
-			1.0f,
-			4.0f,
-			75.0f,
-			1.0f,
-			5.0f,
-			Rgba::GRAY));
+	// the rest are created on demand, startup only pays for the initial population
+	CreateVehicles(num_enemies);
 
-		m_vehicles[veh_idx]->Init();
-		m_vehicles[veh_idx]->TurnOffSteering();
-		++vehicle_head_idx;
+	m_activeVehicles.clear();
+	m_wokenVehicles.clear();
+	for (uint veh_idx = 0; veh_idx < num_enemies; ++veh_idx)
+	{
+		m_activeVehicles.push_back(veh_idx);
 	}
 
 	
@@ -139,6 +145,11 @@ void Game::Startup()
 
 void Game::Shutdown()
 {
+	// the final checkpoint hashes the world, before it goes
+	StopInputRecording();
+	delete m_inputRecorder;
+	m_inputRecorder = nullptr;
+
 	const uint num_vehicles = static_cast<uint>(m_vehicles.size());
 	for (uint vehicles_idx = 0; vehicles_idx < num_vehicles; ++vehicles_idx)
 	{
@@ -164,29 +175,174 @@ void Game::Shutdown()
 
 	delete m_gameCamera;
 	m_gameCamera = nullptr;
+
+	// finishes the file, whatever is still in the ring included
+	delete m_trajectoryRecorder;
+	m_trajectoryRecorder = nullptr;
+
+	delete m_trajectoryPlayback;
+	m_trajectoryPlayback = nullptr;
+
+	if (!m_frameTimesPath.empty())
+	{
+		DumpFrameTimes(m_frameTimesPath);
+	}
 }
 
 void Game::BeginFrame()
 {
+#if !defined(GAME_HEADLESS)
 	g_imGUI->BeginFrame();
 	ImGui::NewFrame();
+#endif
 }
 
 
 void Game::Update(const double delta_seconds)
 {
+	GAME_TRACE_SCOPE("Game::Update");
+	GAME_PROFILE_SCOPE(PROFILE_GAME_UPDATE);
+
+	// a recording replaces the simulation, one recorded frame per tick until it ends
+	if (m_trajectoryPlayback != nullptr)
+	{
+		if (!m_playbackPaused && m_trajectoryPlayback->Step())
+		{
+			ApplyPlaybackFrame();
+		}
+		else
+		{
+			m_playbackPaused = true;
+		}
+		return;
+	}
+	if (m_inputRecorder != nullptr && m_inputRecorder->IsRecording())
+	{
+		RecordInputSettings();
+		m_inputRecorder->RecordFrame(delta_seconds);
+	}
+	const double tick_begin = FrameTimeStats::GetTimeSeconds();
+	const uint64_t allocations_begin = AllocationCounter::GetAllocationCount();
+
+	if (m_clearanceDirty)
+	{
+		RebuildEnvironmentFields();
+	}
+
 	m_time += static_cast<float>(delta_seconds);
 	m_currentFrame++;
 
-	for (uint vehicles_idx = 0; vehicles_idx < num_enemies; ++vehicles_idx)
+	if (!m_wokenVehicles.empty())
+	{
+		MergeWokenVehicles();
+	}
+
+	if (m_useTargetSnapshots)
+	{
+		m_targetSnapshots.Capture();
+	}
+
+	if (m_useFlowFields)
+	{
+		m_flowFields.Update();
+	}
+
+	const bool use_lod = m_lodScheduler.IsEnabled();
+	const uint tick = static_cast<uint>(m_currentFrame);
+	if (use_lod && m_lodScheduler.IsRebalanceDue(tick))
+	{
+		m_lodScheduler.Rebalance(m_vehicles, m_activeVehicles, m_vehicles[0]->GetPosition());
+	}
+
+	SolveAgentAvoidance(delta_seconds, use_lod, tick);
+
+	// only awake vehicles cost anything, still in ascending index order
+	const uint num_active = static_cast<uint>(m_activeVehicles.size());
+	uint num_updated = 0;
+	bool any_asleep = false;
+	for (uint active_idx = 0; active_idx < num_active; ++active_idx)
+	{
+		const uint veh_idx = m_activeVehicles[active_idx];
+		Vehicle* vehicle = m_vehicles[veh_idx];
+
+		// another shard steps it, this one only mirrors it
+		if (m_vehicleOwnership[veh_idx] != VEHICLE_OWNED)
+		{
+			continue;
+		}
+
+		if (use_lod)
+		{
+			// off-tick vehicles bank the dt and integrate it all on their next due tick
+			vehicle->AccumulateLodSeconds(delta_seconds);
+			if (!LodScheduler::IsDue(vehicle->GetLodTier(), veh_idx, tick))
+			{
+				continue;
+			}
+
+			const double lod_seconds = vehicle->ConsumeLodSeconds();
+			vehicle->Update(lod_seconds);
+			if (m_collectMetrics)
+			{
+				RecordMetrics(veh_idx, lod_seconds);
+			}
+		}
+		else
+		{
+			vehicle->Update(delta_seconds);
+			if (m_collectMetrics)
+			{
+				RecordMetrics(veh_idx, delta_seconds);
+			}
+		}
+		++num_updated;
+
+		if (vehicle->CanSleep())
+		{
+			vehicle->Sleep();
+			any_asleep = true;
+		}
+	}
+
+	if (any_asleep)
+	{
+		RemoveSleepingVehicles();
+	}
+
+	m_numUpdatedLastTick = num_updated;
+	if (m_collectMetrics)
+	{
+		++m_metrics.m_numTicks;
+		m_metrics.m_agentUpdates += num_updated;
+	}
+	if (use_lod)
 	{
-		m_vehicles[vehicles_idx]->Update(delta_seconds);
+		m_lodScheduler.RecordTick(num_updated, delta_seconds);
+	}
+	if (m_trajectoryRecorder != nullptr && m_trajectoryRecorder->IsRecording())
+	{
+		m_trajectoryRecorder->Capture(m_vehicles, num_enemies, tick, m_time);
+	}
+	// the engine's live count can drop over a tick that frees more than it allocates
+	const uint64_t allocations_end = AllocationCounter::GetAllocationCount();
+	m_allocationsLastTick = allocations_end > allocations_begin ? allocations_end - allocations_begin : 0;
+
+	const double tick_end = FrameTimeStats::GetTimeSeconds();
+	m_tickTimes.Record(tick_end - tick_begin, tick_end);
+
+	// outside the tick's time, a replay does not hash unless it verifies
+	if (m_inputRecorder != nullptr && m_inputRecorder->IsRecording() && m_inputRecorder->IsCheckpointDue())
+	{
+		m_inputRecorder->RecordCheckpoint(ComputeStateHash());
 	}
 }
 
 
 void Game::UpdateImGui(double delta_seconds)
 {
+	m_frameTimes.Record(delta_seconds, FrameTimeStats::GetTimeSeconds());
+
+#if !defined(GAME_HEADLESS)
 	m_imguiError = ImGui::Begin(
 		"Game State",
 		&m_show,
@@ -196,8 +352,31 @@ void Game::UpdateImGui(double delta_seconds)
 		ImGuiWindowFlags_NoSavedSettings
 	);
 
+	const float line_height = ImGui::GetTextLineHeightWithSpacing();
+	float window_height = 150.0f + 5.0f * line_height;
+	if (m_lodScheduler.IsEnabled())
+	{
+		window_height += line_height;
+	}
+	if (m_useFlowFields)
+	{
+		window_height += line_height;
+	}
+	if (m_agentAvoidance.GetNumSolvedLastTick() > 0)
+	{
+		window_height += line_height;
+	}
+	if (m_trajectoryPlayback != nullptr)
+	{
+		window_height += line_height;
+	}
+	if (m_showProfile)
+	{
+		window_height += static_cast<float>(NUM_PROFILE_ZONES + 1) * line_height;
+	}
+
 	ImGui::SetWindowSize(
-		ImVec2(1725.0f, 120.0f),
+		ImVec2(1725.0f, window_height),
 		ImGuiCond_Always
 	);
 
@@ -208,57 +387,253 @@ void Game::UpdateImGui(double delta_seconds)
 
 	ImGui::TextColored(
 		ImVec4(0.5529f, 1.0f, 1.0f, 1.0f),
-		"Num Agents = %u",
-		num_enemies);
+		"Num Agents = %u (%u awake, %u created)",
+		num_enemies,
+		static_cast<uint>(m_activeVehicles.size()),
+		static_cast<uint>(m_vehicles.size()));
 
-	if(!g_theClock->IsPaused())
+	m_tickList[m_tickHead] = static_cast<float>(delta_seconds * 1000.0);
+	if (++m_tickHead == g_maxTickPlot)    /* inc buffer index */
 	{
-		const float fps = 1.0f / static_cast<float>(delta_seconds);
-		m_avgFPS = CalcAverageTick(fps);
-
-		m_tickList[m_tickHead] = fps;
-		if (++m_tickHead == g_maxTickPlot)    /* inc buffer index */
-		{
-			m_tickHead = 0;
-		}
+		m_tickHead = 0;
 	}
-	
-	char overlay[32];
-	sprintf(overlay, "avg %f", m_avgFPS);
+
+	// scale the plot to the recent worst case so hitches stay visible instead of clipping
+	const FrameTimeHistogram& recent_frames = m_frameTimes.GetHistogram(FRAME_TIME_SPAN_10S);
+	const float plot_max_ms = std::max(1000.0f / 30.0f, static_cast<float>(recent_frames.GetMax()) * 1.0e-3f);
+
+	char overlay[64];
+	sprintf(overlay, "p99 %.2f ms  max %.2f ms",
+		static_cast<double>(recent_frames.GetValueAtPercentile(99.0)) * 1.0e-3,
+		static_cast<double>(recent_frames.GetMax()) * 1.0e-3);
 	ImGui::PlotLines(
-		"FPS",
+		"Frame ms",
 		m_tickList,
 		g_maxTickPlot,
 		m_tickHead,
 		overlay,
 		0.0f,
-		400.0f,
+		plot_max_ms,
 		ImVec2(1600, 65)
 	);
 
+	UpdateFrameTimesImGui();
+
+	if (ImGui::Button("Dump CSV"))
+	{
+		DumpFrameTimes("FrameTimes.csv");
+	}
 	ImGui::SameLine();
-	
-	ImGui::PlotHistogram(
-		"avg", 
-		&m_avgFPS, 
-		1, 
-		0, 
-		nullptr, 
-		0.0f, 
-		400.0f, 
-		ImVec2(20, 65));
+	if (ImGui::Button("Dump JSON"))
+	{
+		DumpFrameTimes("FrameTimes.json");
+	}
+	ImGui::SameLine();
+	ImGui::Checkbox("Cull avoidance", &m_cullAvoidance);
+	ImGui::SameLine();
+	ImGui::Checkbox("Flow fields", &m_useFlowFields);
+	ImGui::SameLine();
+	bool use_target_snapshots = m_useTargetSnapshots;
+	if (ImGui::Checkbox("Target snapshots", &use_target_snapshots))
+	{
+		SetTargetSnapshots(use_target_snapshots);
+	}
+	ImGui::SameLine();
+	bool prioritized = m_steeringCombine == STEER_COMBINE_PRIORITIZED;
+	if (ImGui::Checkbox("Prioritized steering", &prioritized))
+	{
+		SetSteeringCombine(prioritized ? STEER_COMBINE_PRIORITIZED : STEER_COMBINE_AVERAGE);
+	}
+	ImGui::SameLine();
+	ImGui::Checkbox("Steering profile", &m_showProfile);
+	ImGui::SameLine();
+	UpdateLodImGui();
+	if (m_trajectoryPlayback != nullptr)
+	{
+		UpdatePlaybackImGui();
+	}
+	if (m_useFlowFields)
+	{
+		ImGui::Text("flow fields: %u  rebuilt last tick: %u  %.3f ms per rebuild",
+			m_flowFields.GetNumFields(),
+			m_flowFields.GetNumBuildsLastUpdate(),
+			m_flowFields.GetLastBuildSeconds() * 1000.0);
+	}
+	ImGui::Text("world seed: 0x%016llx", static_cast<unsigned long long>(m_seed));	// "seed" in GameConfig.xml pins it
+	ImGui::Text(AllocationCounter::CountsEveryAllocation() ?
+		"process-wide allocations during the last tick: %llu" :
+		"process-wide live allocations gained during the last tick: %llu",
+		static_cast<unsigned long long>(m_allocationsLastTick));
+	if (m_agentAvoidance.GetNumSolvedLastTick() > 0)
+	{
+		ImGui::Text("agent avoidance: %u solved  %.2f LP iterations per agent  %.3f ms",
+			m_agentAvoidance.GetNumSolvedLastTick(),
+			static_cast<double>(m_agentAvoidance.GetIterationsLastTick()) /
+				static_cast<double>(m_agentAvoidance.GetNumSolvedLastTick()),
+			m_agentAvoidance.GetLastSolveSeconds() * 1000.0);
+	}
+	if (m_showProfile)
+	{
+		UpdateProfileImGui();
+	}
 
 	ImGui::End();
+#endif
+}
+
+void Game::UpdateLodImGui()
+{
+#if !defined(GAME_HEADLESS)
+	bool lod_enabled = m_lodScheduler.IsEnabled();
+	if (ImGui::Checkbox("LOD tiers", &lod_enabled))
+	{
+		SetLodEnabled(lod_enabled);
+	}
+
+	if (!lod_enabled)
+	{
+		return;
+	}
+
+	ImGui::Text("every 1st: %u  every 2nd: %u  every 4th: %u  effective updates/s: %.0f",
+		m_lodScheduler.GetTierPopulation(LOD_TIER_FULL),
+		m_lodScheduler.GetTierPopulation(LOD_TIER_HALF),
+		m_lodScheduler.GetTierPopulation(LOD_TIER_QUARTER),
+		m_lodScheduler.GetUpdatesPerSecond());
+#endif
+}
+
+
+void Game::UpdatePlaybackImGui()
+{
+#if !defined(GAME_HEADLESS)
+	int tick = static_cast<int>(m_trajectoryPlayback->GetTick());
+	ImGui::PushItemWidth(900.0f);
+	if (ImGui::SliderInt("Playback tick", &tick, static_cast<int>(m_trajectoryPlayback->GetFirstTick()),
+		static_cast<int>(m_trajectoryPlayback->GetLastTick())))
+	{
+		SeekTrajectoryPlayback(static_cast<uint>(tick));
+	}
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	if (ImGui::Button(m_playbackPaused ? "Play" : "Pause"))
+	{
+		m_playbackPaused = !m_playbackPaused;
+	}
+	ImGui::SameLine();
+	ImGui::Text("%u agents  %.2f s  %u frames in %u blocks  %llu dropped",
+		m_trajectoryPlayback->GetNumAgents(),
+		m_trajectoryPlayback->GetTime(),
+		m_trajectoryPlayback->GetNumFrames(),
+		m_trajectoryPlayback->GetNumBlocks(),
+		static_cast<unsigned long long>(m_trajectoryPlayback->GetDroppedFrames()));
+#endif
+}
+
+
+void Game::UpdateFrameTimesImGui() const
+{
+#if !defined(GAME_HEADLESS)
+	const FrameTimeStats* stats[] = { &m_frameTimes, &m_tickTimes };
+
+	ImGui::Columns(7, "frame_times");
+	ImGui::Text("ms");		ImGui::NextColumn();
+	ImGui::Text("count");	ImGui::NextColumn();
+	ImGui::Text("p50");		ImGui::NextColumn();
+	ImGui::Text("p90");		ImGui::NextColumn();
+	ImGui::Text("p99");		ImGui::NextColumn();
+	ImGui::Text("p99.9");	ImGui::NextColumn();
+	ImGui::Text("max");		ImGui::NextColumn();
+
+	for (const FrameTimeStats* stat : stats)
+	{
+		for (int span_idx = FRAME_TIME_SPAN_1S; span_idx <= FRAME_TIME_SPAN_10S; ++span_idx)
+		{
+			const FrameTimeSpan span = static_cast<FrameTimeSpan>(span_idx);
+			const FrameTimeHistogram& histogram = stat->GetHistogram(span);
+
+			ImGui::Text("%s (%s)", stat->GetName(), FrameTimeStats::GetSpanName(span));
+			ImGui::NextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(histogram.GetTotalCount()));
+			ImGui::NextColumn();
+			ImGui::Text("%.3f", static_cast<double>(histogram.GetValueAtPercentile(50.0)) * 1.0e-3);
+			ImGui::NextColumn();
+			ImGui::Text("%.3f", static_cast<double>(histogram.GetValueAtPercentile(90.0)) * 1.0e-3);
+			ImGui::NextColumn();
+			ImGui::Text("%.3f", static_cast<double>(histogram.GetValueAtPercentile(99.0)) * 1.0e-3);
+			ImGui::NextColumn();
+			ImGui::Text("%.3f", static_cast<double>(histogram.GetValueAtPercentile(99.9)) * 1.0e-3);
+			ImGui::NextColumn();
+			ImGui::Text("%.3f", static_cast<double>(histogram.GetMax()) * 1.0e-3);
+			ImGui::NextColumn();
+		}
+	}
+
+	ImGui::Columns(1);
+#endif
+}
+
+void Game::UpdateProfileImGui() const
+{
+#if defined(GAME_HEADLESS)
+#elif defined(GAME_PROFILE_ZONES_ENABLED)
+	const double update_ms = GameProfiler::GetZoneFrame(PROFILE_GAME_UPDATE).m_smoothedMilliseconds;
+
+	ImGui::Columns(6, "steering_profile");
+	ImGui::Text("Zone");			ImGui::NextColumn();
+	ImGui::Text("ms (frame)");		ImGui::NextColumn();
+	ImGui::Text("ms (smoothed)");	ImGui::NextColumn();
+	ImGui::Text("calls");			ImGui::NextColumn();
+	ImGui::Text("ns / call");		ImGui::NextColumn();
+	ImGui::Text("%% of update");	ImGui::NextColumn();
+
+	for (int zone_idx = 0; zone_idx < NUM_PROFILE_ZONES; ++zone_idx)
+	{
+		const ProfileZone zone = static_cast<ProfileZone>(zone_idx);
+		const ProfileZoneFrame& frame = GameProfiler::GetZoneFrame(zone);
+		const double ns_per_call = frame.m_calls > 0 ?
+			frame.m_milliseconds * 1.0e6 / static_cast<double>(frame.m_calls) : 0.0;
+		const double share = update_ms > 0.0 ? frame.m_smoothedMilliseconds / update_ms * 100.0 : 0.0;
+
+		ImGui::Text("%*s%s", GameProfiler::GetZoneDepth(zone) * 2, "", GameProfiler::GetZoneName(zone));
+		ImGui::NextColumn();
+		ImGui::Text("%.3f", frame.m_milliseconds);
+		ImGui::NextColumn();
+		ImGui::Text("%.3f", frame.m_smoothedMilliseconds);
+		ImGui::NextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(frame.m_calls));
+		ImGui::NextColumn();
+		ImGui::Text("%.1f", ns_per_call);
+		ImGui::NextColumn();
+		ImGui::Text("%.1f", share);
+		ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+#else
+	ImGui::Text("Profile zones are compiled out (GAME_DISABLE_PROFILE_ZONES).");
+#endif
 }
 
+
 void Game::RenderImGui() const
 {
+#if !defined(GAME_HEADLESS)
 	g_imGUI->Render();
+#endif
 }
 
 
 void Game::Render() const
 {
+	if (!m_visualsEnabled)
+	{
+		return;
+	}
+
+	GAME_TRACE_SCOPE("Game::Render");
+	GAME_PROFILE_SCOPE(PROFILE_GAME_RENDER);
+
 	ColorTargetView* rtv = g_theRenderer->GetFrameColorTarget();
 	m_gameCamera->SetColorTarget(rtv);
 
@@ -271,43 +646,64 @@ void Game::Render() const
 	g_theRenderer->ClearScreen(Rgba::CYAN);
 	g_theRenderer->ClearDepthStencilTarget(1.0f);
 
-	const int num_obstacles = static_cast<int>(m_obstacles.size());
-	for (int obstacle_idx = 0; obstacle_idx < num_obstacles; ++obstacle_idx)
 	{
-		m_obstacles[obstacle_idx]->Render();
+		GAME_PROFILE_SCOPE(PROFILE_RENDER_OBSTACLES);
+		const int num_obstacles = static_cast<int>(m_obstacles.size());
+		for (int obstacle_idx = 0; obstacle_idx < num_obstacles; ++obstacle_idx)
+		{
+			m_obstacles[obstacle_idx]->Render();
+		}
 	}
 
-	const int num_walls = static_cast<int>(m_worldBounds.size());
-	for (int wall_idx = 0; wall_idx < num_walls; ++wall_idx)
 	{
-		m_worldBounds[wall_idx]->Render();
+		GAME_PROFILE_SCOPE(PROFILE_RENDER_WALLS);
+		const int num_walls = static_cast<int>(m_worldBounds.size());
+		for (int wall_idx = 0; wall_idx < num_walls; ++wall_idx)
+		{
+			m_worldBounds[wall_idx]->Render();
+		}
 	}
-	
-	for (uint vehicles_idx = 0; vehicles_idx < num_enemies; ++vehicles_idx)
+
 	{
-		m_vehicles[vehicles_idx]->Render();
+		GAME_PROFILE_SCOPE(PROFILE_RENDER_VEHICLES);
+		for (uint vehicles_idx = 0; vehicles_idx < num_enemies; ++vehicles_idx)
+		{
+			m_vehicles[vehicles_idx]->Render();
+		}
 	}
  
 	g_theRenderer->EndCamera(m_gameCamera);
+
+	GAME_PROFILE_SCOPE(PROFILE_RENDER_DEBUG);
 	g_theDebugRenderer->RenderToCamera(m_gameCamera);
 }
 
 
 void Game::EndFrame()
 {
+	GameProfiler::CollectFrame();
+
+#if !defined(GAME_HEADLESS)
 	g_imGUI->EndFrame();
+#endif
 }
 
 
 bool Game::HandleKeyPressed(const unsigned char key_code)
 {
+	if (m_inputRecorder != nullptr && m_inputRecorder->IsRecording())
+	{
+		RecordInputSettings();
+		m_inputRecorder->RecordKey(key_code, true);
+	}
+
 	switch (key_code)
 	{
 		case NUM_1_KEY: // Reset steering
 		{
 			for (uint veh_idx = 1; veh_idx < num_enemies; ++veh_idx)
 			{
-				m_vehicles[veh_idx]->TurnOffSteering();
+				SetVehicleBehavior(veh_idx, CONSTANT_DIR);
 			}
 			return true;
 		}
@@ -315,8 +711,7 @@ bool Game::HandleKeyPressed(const unsigned char key_code)
 		{
 			for (uint veh_idx = 1; veh_idx < num_enemies; ++veh_idx)
 			{
-				m_vehicles[veh_idx]->TurnOffSteering();
-				m_vehicles[veh_idx]->SeekTarget(Vec2::ZERO);
+				SetVehicleBehavior(veh_idx, STEER_SEEK);
 			}
 			return true;
 		}
@@ -324,23 +719,15 @@ bool Game::HandleKeyPressed(const unsigned char key_code)
 		{
 			for (uint veh_idx = 1; veh_idx < num_enemies; ++veh_idx)
 			{
-				m_vehicles[veh_idx]->TurnOffSteering();
-				m_vehicles[veh_idx]->FleeTarget(Vec2::ZERO);
+				SetVehicleBehavior(veh_idx, STEER_FLEE);
 			}
 			return true;
 		}
-		case NUM_4_KEY:  // Pursuit steering
+		case NUM_4_KEY:  // Arrive steering
 		{
 			for (uint veh_idx = 1; veh_idx < num_enemies; ++veh_idx)
 			{
-				const float arrive_at = g_randomNumberGenerator.GetRandomFloatInRange(
-					0.1f,
-					20.0f
-				);
-
-				
-				m_vehicles[veh_idx]->TurnOffSteering();
-				m_vehicles[veh_idx]->ArriveAt(m_vehicles[0]->GetPosition(), arrive_at);
+				SetVehicleBehavior(veh_idx, STEER_ARRIVE);
 			}
 			return true;
 		}
@@ -348,9 +735,7 @@ bool Game::HandleKeyPressed(const unsigned char key_code)
 		{
 			for (uint veh_idx = 1; veh_idx < num_enemies; ++veh_idx)
 			{
-			
-				m_vehicles[veh_idx]->TurnOffSteering();
-				m_vehicles[veh_idx]->PursuitOn(m_vehicles[0]);
+				SetVehicleBehavior(veh_idx, STEER_PURSUIT);
 			}
 			return true;
 		}
@@ -358,8 +743,7 @@ bool Game::HandleKeyPressed(const unsigned char key_code)
 		{
 			for (uint veh_idx = 1; veh_idx < num_enemies; ++veh_idx)
 			{
-				m_vehicles[veh_idx]->TurnOffSteering();
-				m_vehicles[veh_idx]->EvadeFrom(m_vehicles[0]);
+				SetVehicleBehavior(veh_idx, STEER_EVADE);
 			}
 			return true;
 		}
@@ -367,42 +751,18 @@ bool Game::HandleKeyPressed(const unsigned char key_code)
 		{
 			for (uint veh_idx = 1; veh_idx < num_enemies; ++veh_idx)
 			{
-				const float radius = g_randomNumberGenerator.GetRandomFloatInRange(
-					1.0f,
-					100.0f
-				);
-
-				const float distance = g_randomNumberGenerator.GetRandomFloatInRange(
-					70.0f,
-					100.0f
-				);
-
-				const float jitter = g_randomNumberGenerator.GetRandomFloatInRange(
-					1.0f,
-					50.0f
-				);
-
-				m_vehicles[veh_idx]->TurnOffSteering();
-				m_vehicles[veh_idx]->WanderAround(radius, distance, jitter);
+				SetVehicleBehavior(veh_idx, STEER_WANDER);
 			}
 			return true;
 		}
 		case Q_KEY:
 		{
-			num_enemies *= 0.5f;
-			if(num_enemies < MIN_NUM_ENEMIES)
-			{
-				num_enemies = MIN_NUM_ENEMIES;
-			}
+			SetNumVehicles(num_enemies / 2);
 			return true;
 		}
 		case W_KEY:
 		{
-			num_enemies *= 2.0f;
-			if (num_enemies > MAX_NUM_ENEMIES)
-			{
-				num_enemies = MAX_NUM_ENEMIES;
-			}
+			SetNumVehicles(num_enemies * 2);
 			return true;
 		}
 			
@@ -413,7 +773,11 @@ bool Game::HandleKeyPressed(const unsigned char key_code)
 
 bool Game::HandleKeyReleased(const unsigned char key_code)
 {
-	UNUSED(key_code);
+	if (m_inputRecorder != nullptr && m_inputRecorder->IsRecording())
+	{
+		RecordInputSettings();
+		m_inputRecorder->RecordKey(key_code, false);
+	}
 	return true;
 }
 
@@ -429,19 +793,1169 @@ void Game::GarbageCollection() const
 }
 
 
-void Game::TagObstaclesWithinDisc(BaseEntity* vehicle, const float range)
+void Game::SetNumVehicles(const uint num_vehicles)
 {
-	TagClosestNeighbors(vehicle, m_obstacles, range);
-}
+	const uint old_num_enemies = num_enemies;
+	num_enemies = num_vehicles;
+	if (num_enemies < MIN_NUM_ENEMIES)
+	{
+		num_enemies = MIN_NUM_ENEMIES;
+	}
+
+	if (num_enemies > MAX_NUM_ENEMIES)
+	{
+		num_enemies = MAX_NUM_ENEMIES;
+	}
 
+	if (m_vehicles.empty())
+	{
+		return;
+	}
 
-const std::vector<BaseEntity*>& Game::GetObstacles() const
-{
-	return m_obstacles;
+	CreateVehicles(num_enemies);
+
+	if (num_enemies < old_num_enemies)
+	{
+		// the active set is sorted, everything past the new population is one tail
+		const std::vector<uint>::iterator first_removed = std::lower_bound(
+			m_activeVehicles.begin(), m_activeVehicles.end(), num_enemies);
+		if (m_lodScheduler.IsEnabled())
+		{
+			for (std::vector<uint>::iterator removed = first_removed; removed != m_activeVehicles.end(); ++removed)
+			{
+				m_lodScheduler.Dismiss(m_vehicles[*removed]);
+			}
+		}
+		m_activeVehicles.erase(first_removed, m_activeVehicles.end());
+
+		// a banked LOD span belongs to ticks it sat out, rejoining later must not integrate it in one step
+		for (uint veh_idx = num_enemies; veh_idx < old_num_enemies; ++veh_idx)
+		{
+			m_vehicles[veh_idx]->ConsumeLodSeconds();
+		}
+		return;
+	}
+
+	// vehicles rejoining the population keep whatever state they had, awake ones resume updating
+	for (uint veh_idx = old_num_enemies; veh_idx < num_enemies; ++veh_idx)
+	{
+		if (m_vehicles[veh_idx]->IsAwake())
+		{
+			m_wokenVehicles.push_back(veh_idx);
+		}
+	}
 }
 
 
-const std::vector<WallEntity*>& Game::GetWalls() const
+void Game::CreateVehicles(const uint num_vehicles)
 {
-	return m_worldBounds;
+	uint num_created = static_cast<uint>(m_vehicles.size());
+	if (num_vehicles <= num_created)
+	{
+		return;
+	}
+
+	// whole batches, so growing one at a time does not create (and reallocate) one at a time
+	const uint num_batches = (num_vehicles + VEHICLE_BATCH_SIZE - 1) / VEHICLE_BATCH_SIZE;
+	const uint new_num_created = std::min(num_batches * VEHICLE_BATCH_SIZE, MAX_NUM_ENEMIES);
+
+	// at least double, so growing batch by batch copies every per-vehicle array a logarithmic number of times
+	const uint capacity = static_cast<uint>(m_vehicles.capacity());
+	if (new_num_created > capacity)
+	{
+		ReservePopulation(std::max(new_num_created, std::min(capacity * 2, MAX_NUM_ENEMIES)));
+	}
+
+	for (; num_created < new_num_created; ++num_created)
+	{
+		const float x = m_random.GetRandomFloatInRange(
+			-WORLD_HEIGHT * WORLD_ASPECT,
+			WORLD_HEIGHT * WORLD_ASPECT
+		);
+
+		const float y = m_random.GetRandomFloatInRange(
+			-WORLD_HEIGHT,
+			WORLD_HEIGHT
+		);
+
+		Vehicle* vehicle = new Vehicle(
+			this,
+			Vec2(x, y),
+			0.0f,
+			Vec2::ZERO,
+			1.0f,
+			4.0f,
+			75.0f,
+			1.0f,
+			5.0f,
+			Rgba::GRAY);
+
+		// created awake, idle vehicles drop out at the end of their first tick in the population
+		InitEntityVisuals(vehicle);
+		vehicle->SetPopulationIndex(num_created);
+		vehicle->GetRandom().Seed(SimRandom::CombineSeeds(m_seed, num_created));
+		vehicle->TurnOffSteering();
+		m_vehicles.push_back(vehicle);
+		++vehicle_head_idx;
+	}
+}
+
+
+void Game::ReservePopulation(const uint capacity)
+{
+	// the per-tick vectors only ever grow here, steady state ticks stay allocation free
+	m_vehicles.reserve(capacity);
+	m_activeVehicles.reserve(capacity);
+	m_wokenVehicles.reserve(capacity);
+	m_mergedVehicles.reserve(capacity);
+	m_orcaAgents.reserve(capacity);
+	m_orcaSolveIndices.reserve(capacity);
+	m_orcaSlots.reserve(capacity);
+	m_orcaPreferredVelocities.reserve(capacity);
+	m_vehicleOwnership.resize(capacity, VEHICLE_OWNED);
+	m_obstacleContacts.resize(capacity, 0);
+}
+
+
+void Game::InitEntityVisuals(BaseEntity* entity) const
+{
+	// Init only builds meshes and materials, worlds without visuals never touch the renderer
+	if (m_visualsEnabled)
+	{
+		entity->Init();
+	}
+}
+
+
+void Game::WakeVehicle(const uint veh_idx)
+{
+	// outside the population it is picked up by SetNumVehicles once the population grows over it
+	if (veh_idx < num_enemies)
+	{
+		m_wokenVehicles.push_back(veh_idx);
+	}
+}
+
+
+void Game::MergeWokenVehicles()
+{
+	std::sort(m_wokenVehicles.begin(), m_wokenVehicles.end());
+
+	// a vehicle that slept and woke within one tick never left the active set, unique drops the copy
+	m_mergedVehicles.clear();
+	std::merge(m_activeVehicles.begin(), m_activeVehicles.end(),
+		m_wokenVehicles.begin(), m_wokenVehicles.end(),
+		std::back_inserter(m_mergedVehicles));
+	m_mergedVehicles.erase(std::unique(m_mergedVehicles.begin(), m_mergedVehicles.end()), m_mergedVehicles.end());
+
+	// the population may have shrunk since the wake was queued
+	const std::vector<uint>::iterator first_removed = std::lower_bound(
+		m_mergedVehicles.begin(), m_mergedVehicles.end(), num_enemies);
+	m_mergedVehicles.erase(first_removed, m_mergedVehicles.end());
+
+	// joining between rebalances, give them a tier now rather than running on whatever they last had
+	if (m_lodScheduler.IsEnabled())
+	{
+		const Vec2 focus_position = m_vehicles[0]->GetPosition();
+		const uint num_woken = static_cast<uint>(m_wokenVehicles.size());
+		for (uint woken_idx = 0; woken_idx < num_woken; ++woken_idx)
+		{
+			const uint veh_idx = m_wokenVehicles[woken_idx];
+			const bool duplicate = woken_idx > 0 && m_wokenVehicles[woken_idx - 1] == veh_idx;
+			if (!duplicate && veh_idx < num_enemies &&
+				!std::binary_search(m_activeVehicles.begin(), m_activeVehicles.end(), veh_idx))
+			{
+				m_lodScheduler.Admit(m_vehicles[veh_idx], focus_position);
+			}
+		}
+	}
+
+	m_activeVehicles.swap(m_mergedVehicles);
+	m_wokenVehicles.clear();
+}
+
+
+void Game::RemoveSleepingVehicles()
+{
+	// stable compaction, swap-removal would reorder the updates
+	const std::vector<Vehicle*>& vehicles = m_vehicles;
+	LodScheduler* lod_scheduler = m_lodScheduler.IsEnabled() ? &m_lodScheduler : nullptr;
+	m_activeVehicles.erase(std::remove_if(m_activeVehicles.begin(), m_activeVehicles.end(),
+		[&vehicles, lod_scheduler](const uint veh_idx)
+		{
+			const Vehicle* vehicle = vehicles[veh_idx];
+			if (vehicle->IsAwake())
+			{
+				return false;
+			}
+
+			if (lod_scheduler != nullptr)
+			{
+				lod_scheduler->Dismiss(vehicle);
+			}
+			return true;
+		}),
+		m_activeVehicles.end());
+}
+
+
+bool Game::DumpFrameTimes(const std::string& file_path) const
+{
+	const std::vector<const FrameTimeStats*> stats = { &m_frameTimes, &m_tickTimes };
+	return FrameTimeStats::Write(file_path, stats);
+}
+
+
+void Game::SetFrameTimesPath(const std::string& file_path)
+{
+	m_frameTimesPath = file_path;
+}
+
+
+const FrameTimeStats& Game::GetFrameTimes() const
+{
+	return m_frameTimes;
+}
+
+
+const FrameTimeStats& Game::GetTickTimes() const
+{
+	return m_tickTimes;
+}
+
+
+uint Game::GetNumVehicles() const
+{
+	return num_enemies;
+}
+
+
+uint Game::GetNumCreatedVehicles() const
+{
+	return static_cast<uint>(m_vehicles.size());
+}
+
+
+uint Game::GetNumUpdatedLastTick() const
+{
+	return m_numUpdatedLastTick;
+}
+
+
+uint Game::GetNumActiveVehicles() const
+{
+	return static_cast<uint>(m_activeVehicles.size());
+}
+
+
+uint64_t Game::GetAllocationsLastTick() const
+{
+	return m_allocationsLastTick;
+}
+
+
+Vehicle* Game::GetVehicle(const uint veh_idx) const
+{
+	return m_vehicles[veh_idx];
+}
+
+
+void Game::SetVehicleBehavior(const uint veh_idx, const int behavior)
+{
+	m_vehicles[veh_idx]->TurnOffSteering();
+	AddVehicleBehavior(veh_idx, behavior);
+}
+
+
+void Game::AddVehicleBehavior(const uint veh_idx, const int behavior)
+{
+	Vehicle* vehicle = m_vehicles[veh_idx];
+
+	switch (behavior)
+	{
+		case STEER_SEEK:
+		{
+			vehicle->SeekTarget(Vec2::ZERO);
+			break;
+		}
+		case STEER_FLEE:
+		{
+			vehicle->FleeTarget(Vec2::ZERO);
+			break;
+		}
+		case STEER_ARRIVE:
+		{
+			const float arrive_at = m_random.GetRandomFloatInRange(
+				0.1f,
+				20.0f
+			);
+
+			vehicle->ArriveAt(m_vehicles[0]->GetPosition(), arrive_at);
+			break;
+		}
+		case STEER_PURSUIT:
+		{
+			vehicle->PursuitOn(m_vehicles[0]);
+			break;
+		}
+		case STEER_EVADE:
+		{
+			vehicle->EvadeFrom(m_vehicles[0]);
+			break;
+		}
+		case STEER_WANDER:
+		{
+			const float radius = m_random.GetRandomFloatInRange(
+				m_steeringTuning.m_wanderRadiusMin,
+				m_steeringTuning.m_wanderRadiusMax
+			);
+
+			const float distance = m_random.GetRandomFloatInRange(
+				m_steeringTuning.m_wanderDistanceMin,
+				m_steeringTuning.m_wanderDistanceMax
+			);
+
+			const float jitter = m_random.GetRandomFloatInRange(
+				m_steeringTuning.m_wanderJitterMin,
+				m_steeringTuning.m_wanderJitterMax
+			);
+
+			vehicle->WanderAround(radius, distance, jitter);
+			break;
+		}
+		case STEER_OBSTACLE_AVOIDANCE:
+		{
+			vehicle->AvoidObstacles(m_steeringTuning.m_obstacleLookAhead, m_steeringTuning.m_obstacleAvoidanceMul,
+				m_steeringTuning.m_obstacleBreakingWeight);
+			break;
+		}
+		case STEER_WALL_AVOIDANCE:
+		{
+			vehicle->AvoidWalls(m_steeringTuning.m_numWhiskers, m_steeringTuning.m_whiskerLength,
+				m_steeringTuning.m_wallAvoidanceMul, m_steeringTuning.m_whiskerFieldOfView);
+			break;
+		}
+		case STEER_AGENT_AVOIDANCE:
+		{
+			vehicle->AvoidAgents();
+			break;
+		}
+		default: // CONSTANT_DIR, steering stays off
+		{
+			break;
+		}
+	}
+}
+
+
+void Game::SetVehicleOwnership(const uint veh_idx, const VehicleOwnership ownership)
+{
+	m_vehicleOwnership[veh_idx] = static_cast<uint8_t>(ownership);
+}
+
+
+VehicleOwnership Game::GetVehicleOwnership(const uint veh_idx) const
+{
+	return static_cast<VehicleOwnership>(m_vehicleOwnership[veh_idx]);
+}
+
+
+void Game::WriteVehicleState(const uint veh_idx, VehicleState& out_state) const
+{
+	m_vehicles[veh_idx]->WriteState(out_state);
+	out_state.m_obstacleContact = m_obstacleContacts[veh_idx];
+}
+
+
+void Game::ReadVehicleState(const VehicleState& state)
+{
+	m_vehicles[state.m_index]->ReadState(state);
+	m_obstacleContacts[state.m_index] = static_cast<uint8_t>(state.m_obstacleContact);
+}
+
+
+bool Game::SaveSnapshot(const std::string& file_path) const
+{
+	WorldSnapshotHeader header;
+	header.m_numVehicles = static_cast<uint32_t>(m_vehicles.size());
+	header.m_populationSize = num_enemies;
+	header.m_numObstacles = static_cast<uint32_t>(m_obstacles.size());
+	header.m_numWalls = static_cast<uint32_t>(m_worldBounds.size());
+	header.m_steeringCombine = static_cast<uint32_t>(m_steeringCombine);
+	header.m_worldFlags =
+		(m_cullAvoidance ? WORLD_SNAPSHOT_CULL_AVOIDANCE : 0u) |
+		(m_useTargetSnapshots ? WORLD_SNAPSHOT_TARGET_SNAPSHOTS : 0u) |
+		(m_useFlowFields ? WORLD_SNAPSHOT_FLOW_FIELDS : 0u) |
+		(m_lodScheduler.IsEnabled() ? WORLD_SNAPSHOT_LOD : 0u) |
+		(m_collectMetrics ? WORLD_SNAPSHOT_METRICS : 0u);
+	header.m_currentFrame = m_currentFrame;
+	header.m_time = m_time;
+	header.m_seed = m_seed;
+	header.m_randomState = m_random.GetState();
+	header.m_metricTicks = m_metrics.m_numTicks;
+	header.m_metricAgentUpdates = m_metrics.m_agentUpdates;
+	header.m_metricObstacleCollisions = m_metrics.m_obstacleCollisions;
+	header.m_metricDistanceTraveled = m_metrics.m_distanceTraveled;
+	header.m_steeringTuning = m_steeringTuning;
+	WorldSnapshot::LayOut(header);
+
+	// the whole file in one buffer, one write
+	std::vector<uint8_t> buffer(static_cast<size_t>(header.m_fileSize), 0);
+	memcpy(buffer.data(), &header, sizeof(header));
+
+	// vehicles only read here, they fill their records in place from every thread
+	VehicleSnapshot* vehicles = reinterpret_cast<VehicleSnapshot*>(buffer.data() + header.m_vehiclesOffset);
+	auto write_vehicles = [this, vehicles](const uint begin, const uint end)
+	{
+		for (uint veh_idx = begin; veh_idx < end; ++veh_idx)
+		{
+			VehicleSnapshot* record = new (&vehicles[veh_idx]) VehicleSnapshot;
+			m_vehicles[veh_idx]->WriteSnapshot(*record);
+			record->m_flags |= m_obstacleContacts[veh_idx] != 0 ? VEHICLE_SNAPSHOT_OBSTACLE_CONTACT : 0u;
+		}
+	};
+	GameJobs::ParallelFor(header.m_numVehicles, SNAPSHOT_GRAIN, write_vehicles);
+
+	ObstacleSnapshot* obstacles = reinterpret_cast<ObstacleSnapshot*>(buffer.data() + header.m_obstaclesOffset);
+	for (uint obstacle_idx = 0; obstacle_idx < header.m_numObstacles; ++obstacle_idx)
+	{
+		ObstacleSnapshot* record = new (&obstacles[obstacle_idx]) ObstacleSnapshot;
+		record->m_position = m_obstacles[obstacle_idx]->GetPosition();
+		record->m_radius = m_obstacles[obstacle_idx]->GetBoundingRadius();
+	}
+
+	WallSnapshot* walls = reinterpret_cast<WallSnapshot*>(buffer.data() + header.m_wallsOffset);
+	for (uint wall_idx = 0; wall_idx < header.m_numWalls; ++wall_idx)
+	{
+		const Plane2 plane = m_worldBounds[wall_idx]->GetPlane();
+		WallSnapshot* record = new (&walls[wall_idx]) WallSnapshot;
+		record->m_normal = plane.m_normal;
+		record->m_signedDistance = plane.m_signedDistance;
+		record->m_length = m_worldBounds[wall_idx]->GetPlanHalfLength() * 2.0f;
+	}
+
+	return WorldSnapshot::WriteFile(file_path, buffer);
+}
+
+
+bool Game::LoadSnapshot(const std::string& file_path)
+{
+	WorldSnapshot snapshot;
+	return snapshot.Map(file_path) && RestoreSnapshot(snapshot);
+}
+
+
+bool Game::RestoreSnapshot(const WorldSnapshot& snapshot)
+{
+	GAME_TRACE_SCOPE("Game::RestoreSnapshot");
+	if (!snapshot.IsMapped() || m_vehicles.empty() || snapshot.GetHeader().m_numVehicles > MAX_NUM_ENEMIES)
+	{
+		return false;
+	}
+
+	// the world is no longer the one the input recording started from
+	StopInputRecording();
+
+	const WorldSnapshotHeader& header = snapshot.GetHeader();
+	RestoreEnvironment(snapshot);
+
+	// back to full rate first if the saved world was, that drops the banked spans the records restore
+	if (m_lodScheduler.IsEnabled() != ((header.m_worldFlags & WORLD_SNAPSHOT_LOD) != 0))
+	{
+		SetLodEnabled((header.m_worldFlags & WORLD_SNAPSHOT_LOD) != 0);
+	}
+
+	// exactly the vehicles the saved world had created, so growing the population later creates the
+	// same ones it would have; existing vehicles are reused as they are, meshes included
+	const uint num_vehicles = header.m_numVehicles;
+	CreateVehicles(num_vehicles);
+	while (m_vehicles.size() > num_vehicles)
+	{
+		delete m_vehicles.back();
+		m_vehicles.pop_back();
+	}
+	vehicle_head_idx = num_vehicles;
+
+	// one thread, targets and flow goals retain entries in the shared caches
+	const VehicleSnapshot* vehicles = snapshot.GetVehicles();
+	for (uint veh_idx = 0; veh_idx < num_vehicles; ++veh_idx)
+	{
+		Vehicle* vehicle = m_vehicles[veh_idx];
+		const float old_radius = vehicle->GetBoundingRadius();
+		vehicle->ReadSnapshot(vehicles[veh_idx]);
+		if (vehicle->GetBoundingRadius() != old_radius)
+		{
+			InitEntityVisuals(vehicle);
+		}
+
+		m_obstacleContacts[veh_idx] = (vehicles[veh_idx].m_flags & VEHICLE_SNAPSHOT_OBSTACLE_CONTACT) != 0 ? 1 : 0;
+		m_vehicleOwnership[veh_idx] = VEHICLE_OWNED;
+	}
+
+	// between ticks the active set is exactly the awake vehicles of the population
+	num_enemies = std::max(header.m_populationSize, MIN_NUM_ENEMIES);
+	m_activeVehicles.clear();
+	m_wokenVehicles.clear();
+	for (uint veh_idx = 0; veh_idx < num_enemies; ++veh_idx)
+	{
+		if (m_vehicles[veh_idx]->IsAwake())
+		{
+			m_activeVehicles.push_back(veh_idx);
+		}
+	}
+
+	m_seed = header.m_seed;
+	m_random.SetState(header.m_randomState);
+	m_time = header.m_time;
+	m_currentFrame = header.m_currentFrame;
+	m_steeringCombine = static_cast<SteeringCombine>(header.m_steeringCombine);
+	m_steeringTuning = header.m_steeringTuning;
+	m_cullAvoidance = (header.m_worldFlags & WORLD_SNAPSHOT_CULL_AVOIDANCE) != 0;
+	m_useFlowFields = (header.m_worldFlags & WORLD_SNAPSHOT_FLOW_FIELDS) != 0;
+	m_collectMetrics = (header.m_worldFlags & WORLD_SNAPSHOT_METRICS) != 0;
+	SetTargetSnapshots((header.m_worldFlags & WORLD_SNAPSHOT_TARGET_SNAPSHOTS) != 0);
+
+	m_metrics.m_numTicks = header.m_metricTicks;
+	m_metrics.m_agentUpdates = header.m_metricAgentUpdates;
+	m_metrics.m_obstacleCollisions = header.m_metricObstacleCollisions;
+	m_metrics.m_distanceTraveled = header.m_metricDistanceTraveled;
+	return true;
+}
+
+
+void Game::RestoreEnvironment(const WorldSnapshot& snapshot)
+{
+	// kept when it matches, so the fields built from it stay valid
+	const WorldSnapshotHeader& header = snapshot.GetHeader();
+	const ObstacleSnapshot* obstacles = snapshot.GetObstacles();
+	const WallSnapshot* walls = snapshot.GetWalls();
+	bool matches = m_obstacles.size() == header.m_numObstacles && m_worldBounds.size() == header.m_numWalls;
+	for (uint obstacle_idx = 0; matches && obstacle_idx < header.m_numObstacles; ++obstacle_idx)
+	{
+		const Vec2 position = m_obstacles[obstacle_idx]->GetPosition();
+		matches = position.x == obstacles[obstacle_idx].m_position.x && position.y == obstacles[obstacle_idx].m_position.y &&
+			m_obstacles[obstacle_idx]->GetBoundingRadius() == obstacles[obstacle_idx].m_radius;
+	}
+	for (uint wall_idx = 0; matches && wall_idx < header.m_numWalls; ++wall_idx)
+	{
+		const Plane2 plane = m_worldBounds[wall_idx]->GetPlane();
+		matches = plane.m_normal.x == walls[wall_idx].m_normal.x && plane.m_normal.y == walls[wall_idx].m_normal.y &&
+			plane.m_signedDistance == walls[wall_idx].m_signedDistance &&
+			m_worldBounds[wall_idx]->GetPlanHalfLength() * 2.0f == walls[wall_idx].m_length;
+	}
+
+	if (matches)
+	{
+		return;
+	}
+
+	for (BaseEntity* obstacle : m_obstacles)
+	{
+		delete obstacle;
+	}
+	for (WallEntity* wall : m_worldBounds)
+	{
+		delete wall;
+	}
+	m_obstacles.clear();
+	m_worldBounds.clear();
+
+	for (uint obstacle_idx = 0; obstacle_idx < header.m_numObstacles; ++obstacle_idx)
+	{
+		BaseEntity* obstacle = new BaseEntity(DEFAULT_ENTITY_TYPE, obstacles[obstacle_idx].m_position,
+			obstacles[obstacle_idx].m_radius);
+		InitEntityVisuals(obstacle);
+		m_obstacles.push_back(obstacle);
+	}
+
+	for (uint wall_idx = 0; wall_idx < header.m_numWalls; ++wall_idx)
+	{
+		WallEntity* wall = new WallEntity(this, walls[wall_idx].m_length, walls[wall_idx].m_normal,
+			walls[wall_idx].m_signedDistance);
+		InitEntityVisuals(wall);
+		m_worldBounds.push_back(wall);
+	}
+
+	m_clearanceDirty = true;
+}
+
+
+bool Game::StartTrajectoryRecording(const std::string& file_path, const TrajectorySettings& settings)
+{
+	if (m_trajectoryRecorder == nullptr)
+	{
+		m_trajectoryRecorder = new TrajectoryRecorder();
+	}
+	return m_trajectoryRecorder->Start(file_path, settings, num_enemies, m_seed);
+}
+
+
+bool Game::StopTrajectoryRecording()
+{
+	return m_trajectoryRecorder != nullptr && m_trajectoryRecorder->Stop();
+}
+
+
+bool Game::IsRecordingTrajectories() const
+{
+	return m_trajectoryRecorder != nullptr && m_trajectoryRecorder->IsRecording();
+}
+
+
+const TrajectoryRecorder* Game::GetTrajectoryRecorder() const
+{
+	return m_trajectoryRecorder;
+}
+
+
+bool Game::StartTrajectoryPlayback(const std::string& file_path)
+{
+	TrajectoryPlayback* playback = new TrajectoryPlayback();
+	if (m_vehicles.empty() || !playback->Open(file_path))
+	{
+		delete playback;
+		return false;
+	}
+
+	StopInputRecording();
+	delete m_trajectoryPlayback;
+	m_trajectoryPlayback = playback;
+	m_playbackPaused = false;
+	ApplyPlaybackFrame();
+	return true;
+}
+
+
+void Game::StopTrajectoryPlayback()
+{
+	delete m_trajectoryPlayback;
+	m_trajectoryPlayback = nullptr;
+}
+
+
+bool Game::IsPlayingBack() const
+{
+	return m_trajectoryPlayback != nullptr;
+}
+
+
+bool Game::SeekTrajectoryPlayback(const uint tick)
+{
+	if (m_trajectoryPlayback == nullptr || !m_trajectoryPlayback->Seek(tick))
+	{
+		return false;
+	}
+
+	ApplyPlaybackFrame();
+	return true;
+}
+
+
+void Game::SetPlaybackPaused(const bool paused)
+{
+	m_playbackPaused = paused;
+}
+
+
+bool Game::IsPlaybackPaused() const
+{
+	return m_playbackPaused;
+}
+
+
+const TrajectoryPlayback* Game::GetTrajectoryPlayback() const
+{
+	return m_trajectoryPlayback;
+}
+
+
+bool Game::StartInputRecording(const std::string& file_path)
+{
+	// a replay starts from Startup, so does the recording
+	if (m_vehicles.empty() || m_currentFrame != 0 || IsRecordingInput())
+	{
+		return false;
+	}
+
+	if (m_inputRecorder == nullptr)
+	{
+		m_inputRecorder = new InputRecorder();
+	}
+
+	InputFileHeader header;
+	header.m_numVehicles = num_enemies;
+	header.m_seed = m_seed;
+	header.m_checkpointFrames = InputRecorder::DEFAULT_CHECKPOINT_FRAMES;
+	header.m_settings = GetInputSettings();
+	header.m_steeringCombine = static_cast<uint8_t>(m_steeringCombine);
+	return m_inputRecorder->Start(file_path, header);
+}
+
+
+bool Game::StopInputRecording()
+{
+	return IsRecordingInput() && m_inputRecorder->Stop(ComputeStateHash());
+}
+
+
+bool Game::IsRecordingInput() const
+{
+	return m_inputRecorder != nullptr && m_inputRecorder->IsRecording();
+}
+
+
+uint8_t Game::GetInputSettings() const
+{
+	return (m_cullAvoidance ? INPUT_SETTING_CULL_AVOIDANCE : 0u) |
+		(m_useTargetSnapshots ? INPUT_SETTING_TARGET_SNAPSHOTS : 0u) |
+		(m_useFlowFields ? INPUT_SETTING_FLOW_FIELDS : 0u) |
+		(m_lodScheduler.IsEnabled() ? INPUT_SETTING_LOD : 0u);
+}
+
+
+void Game::ApplyInputSettings(const uint8_t settings)
+{
+	SetAvoidanceCulling((settings & INPUT_SETTING_CULL_AVOIDANCE) != 0);
+	SetTargetSnapshots((settings & INPUT_SETTING_TARGET_SNAPSHOTS) != 0);
+	SetFlowFields((settings & INPUT_SETTING_FLOW_FIELDS) != 0);
+	SetLodEnabled((settings & INPUT_SETTING_LOD) != 0);
+}
+
+
+uint64_t Game::ComputeStateHash() const
+{
+	GAME_TRACE_SCOPE("Game::ComputeStateHash");
+	static_assert(sizeof(VehicleState) % sizeof(uint32_t) == 0, "VehicleState is hashed as whole words");
+
+	// FNV-1a over 32-bit words, states are plain data without padding
+	auto hash_words = [](uint64_t hash, const void* data, const size_t num_bytes)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t byte_idx = 0; byte_idx < num_bytes; byte_idx += sizeof(uint32_t))
+		{
+			uint32_t word;
+			memcpy(&word, bytes + byte_idx, sizeof(uint32_t));
+			hash = (hash ^ word) * 0x100000001B3ull;
+		}
+		return hash;
+	};
+
+	const uint num_vehicles = static_cast<uint>(m_vehicles.size());
+	const uint num_chunks = (num_vehicles + STATE_HASH_CHUNK - 1) / STATE_HASH_CHUNK;
+	std::vector<uint64_t> chunk_hashes(num_chunks);
+	auto hash_chunks = [this, &chunk_hashes, &hash_words, num_vehicles](const uint begin, const uint end)
+	{
+		for (uint chunk_idx = begin; chunk_idx < end; ++chunk_idx)
+		{
+			uint64_t hash = 0xCBF29CE484222325ull;
+			const uint chunk_end = std::min(num_vehicles, (chunk_idx + 1) * STATE_HASH_CHUNK);
+			for (uint veh_idx = chunk_idx * STATE_HASH_CHUNK; veh_idx < chunk_end; ++veh_idx)
+			{
+				VehicleState state;
+				WriteVehicleState(veh_idx, state);
+				hash = hash_words(hash, &state, sizeof(state));
+			}
+			chunk_hashes[chunk_idx] = hash;
+		}
+	};
+	GameJobs::ParallelFor(num_chunks, 1, hash_chunks);
+
+	const uint64_t random_state = m_random.GetState();
+	uint64_t hash = 0xCBF29CE484222325ull;
+	hash = hash_words(hash, &num_enemies, sizeof(num_enemies));
+	hash = hash_words(hash, &num_vehicles, sizeof(num_vehicles));
+	hash = hash_words(hash, &m_currentFrame, sizeof(m_currentFrame));
+	hash = hash_words(hash, &m_time, sizeof(m_time));
+	hash = hash_words(hash, &random_state, sizeof(random_state));
+	return hash_words(hash, chunk_hashes.data(), chunk_hashes.size() * sizeof(uint64_t));
+}
+
+
+void Game::RecordInputSettings()
+{
+	m_inputRecorder->RecordSettings(GetInputSettings(), static_cast<uint8_t>(m_steeringCombine));
+}
+
+
+void Game::ApplyPlaybackFrame()
+{
+	GAME_TRACE_SCOPE("Game::ApplyPlaybackFrame");
+
+	// the population follows the recording, vehicles are created and shown as it grows
+	const uint num_agents = m_trajectoryPlayback->GetNumAgents();
+	if (num_agents != num_enemies)
+	{
+		SetNumVehicles(num_agents);
+	}
+
+	const std::vector<Vec2>& positions = m_trajectoryPlayback->GetPositions();
+	const std::vector<Vec2>& forwards = m_trajectoryPlayback->GetForwards();
+	auto apply_range = [this, &positions, &forwards](const uint begin, const uint end)
+	{
+		for (uint veh_idx = begin; veh_idx < end; ++veh_idx)
+		{
+			m_vehicles[veh_idx]->SetPos(positions[veh_idx]);
+			m_vehicles[veh_idx]->SetForward(forwards[veh_idx]);
+		}
+	};
+	GameJobs::ParallelFor(std::min(num_agents, num_enemies), PLAYBACK_GRAIN, apply_range);
+}
+
+
+void Game::SpawnObstacles(const uint num_obstacles)
+{
+	for (uint obstacle_idx = 0; obstacle_idx < num_obstacles; ++obstacle_idx)
+	{
+		const float x = m_random.GetRandomFloatInRange(
+			-WORLD_HEIGHT * WORLD_ASPECT,
+			WORLD_HEIGHT * WORLD_ASPECT
+		);
+
+		const float y = m_random.GetRandomFloatInRange(
+			-WORLD_HEIGHT,
+			WORLD_HEIGHT_ADJUST
+		);
+
+		const float radius = m_random.GetRandomFloatInRange(2.0f, 10.0f);
+
+		BaseEntity* obstacle = new BaseEntity(DEFAULT_ENTITY_TYPE, Vec2(x, y), radius);
+		InitEntityVisuals(obstacle);
+		m_obstacles.push_back(obstacle);
+	}
+
+	m_clearanceDirty = true;
+}
+
+
+void Game::SpawnWalls(const uint num_walls)
+{
+	for (uint wall_idx = 0; wall_idx < num_walls; ++wall_idx)
+	{
+		// walls sit where their plane passes closest to the origin, so pick the normal and distance
+		const float angle_degrees = m_random.GetRandomFloatInRange(0.0f, 360.0f);
+		const float distance = m_random.GetRandomFloatInRange(10.0f, 70.0f);
+		const float length = m_random.GetRandomFloatInRange(20.0f, 60.0f);
+
+		WallEntity* wall = new WallEntity(
+			this,
+			length,
+			Vec2(CosDegrees(angle_degrees), SinDegrees(angle_degrees)),
+			distance
+		);
+		InitEntityVisuals(wall);
+		m_worldBounds.push_back(wall);
+	}
+
+	m_clearanceDirty = true;
+}
+
+
+void Game::TagObstaclesWithinDisc(BaseEntity* vehicle, const float range)
+{
+	TagClosestNeighbors(vehicle, m_obstacles, range);
+}
+
+
+const std::vector<BaseEntity*>& Game::GetObstacles() const
+{
+	return m_obstacles;
+}
+
+
+const std::vector<WallEntity*>& Game::GetWalls() const
+{
+	return m_worldBounds;
+}
+
+
+const ClearanceField& Game::GetClearanceField() const
+{
+	return m_clearanceField;
+}
+
+
+void Game::SetAvoidanceCulling(const bool cull_avoidance)
+{
+	m_cullAvoidance = cull_avoidance;
+}
+
+
+bool Game::IsAvoidanceCullingEnabled() const
+{
+	return m_cullAvoidance;
+}
+
+
+TargetSnapshotCache& Game::GetTargetSnapshots()
+{
+	return m_targetSnapshots;
+}
+
+
+const TargetSnapshotCache& Game::GetTargetSnapshots() const
+{
+	return m_targetSnapshots;
+}
+
+
+void Game::SetTargetSnapshots(const bool use_target_snapshots)
+{
+	if (use_target_snapshots && !m_useTargetSnapshots)
+	{
+		// the copies went stale while nobody refreshed them
+		m_targetSnapshots.Capture();
+	}
+
+	m_useTargetSnapshots = use_target_snapshots;
+}
+
+
+bool Game::AreTargetSnapshotsEnabled() const
+{
+	return m_useTargetSnapshots;
+}
+
+
+FlowFieldCache& Game::GetFlowFields()
+{
+	return m_flowFields;
+}
+
+
+const FlowFieldCache& Game::GetFlowFields() const
+{
+	return m_flowFields;
+}
+
+
+void Game::SetFlowFields(const bool use_flow_fields)
+{
+	m_useFlowFields = use_flow_fields;
+}
+
+
+bool Game::AreFlowFieldsEnabled() const
+{
+	return m_useFlowFields;
+}
+
+
+const OrcaSolver& Game::GetAgentAvoidance() const
+{
+	return m_agentAvoidance;
+}
+
+
+bool Game::GetAgentAvoidanceVelocity(const uint veh_idx, Vec2& out_velocity) const
+{
+	if (m_agentAvoidance.GetNumSolvedLastTick() == 0 || veh_idx >= m_orcaSlots.size() ||
+		m_orcaSlots[veh_idx] == INVALID_ORCA_SLOT)
+	{
+		return false;
+	}
+
+	out_velocity = m_agentAvoidance.GetVelocity(m_orcaSlots[veh_idx]);
+	return true;
+}
+
+
+void Game::SetSteeringCombine(const SteeringCombine steering_combine)
+{
+	m_steeringCombine = steering_combine;
+}
+
+
+SteeringCombine Game::GetSteeringCombine() const
+{
+	return m_steeringCombine;
+}
+
+
+void Game::SetLodEnabled(const bool lod_enabled)
+{
+	if (!lod_enabled && m_lodScheduler.IsEnabled())
+	{
+		// back to full rate, drop the partial spans so nobody integrates a stale dt later
+		const uint num_vehicles = static_cast<uint>(m_vehicles.size());
+		for (uint veh_idx = 0; veh_idx < num_vehicles; ++veh_idx)
+		{
+			m_vehicles[veh_idx]->ConsumeLodSeconds();
+			m_vehicles[veh_idx]->SetLodTier(LOD_TIER_FULL);
+		}
+	}
+
+	m_lodScheduler.SetEnabled(lod_enabled);
+}
+
+
+void Game::SetSeed(const uint64_t seed)
+{
+	m_seed = seed;
+}
+
+
+uint64_t Game::GetSeed() const
+{
+	return m_seed;
+}
+
+
+SimRandom& Game::GetRandom()
+{
+	return m_random;
+}
+
+
+void Game::SetVisualsEnabled(const bool visuals_enabled)
+{
+	m_visualsEnabled = visuals_enabled;
+}
+
+
+void Game::SetSteeringTuning(const SteeringTuning& steering_tuning)
+{
+	m_steeringTuning = steering_tuning;
+}
+
+
+const SteeringTuning& Game::GetSteeringTuning() const
+{
+	return m_steeringTuning;
+}
+
+
+void Game::SetMetricsEnabled(const bool collect_metrics)
+{
+	m_collectMetrics = collect_metrics;
+}
+
+
+const WorldMetrics& Game::GetMetrics() const
+{
+	return m_metrics;
+}
+
+
+const LodScheduler& Game::GetLodScheduler() const
+{
+	return m_lodScheduler;
+}
+
+
+void Game::RebuildEnvironmentFields()
+{
+	m_clearanceField.Build(
+		Vec2(-WORLD_HEIGHT * WORLD_ASPECT, -WORLD_HEIGHT),
+		Vec2(WORLD_HEIGHT * WORLD_ASPECT, WORLD_HEIGHT),
+		ClearanceField::DEFAULT_CELL_SIZE,
+		m_obstacles,
+		m_worldBounds,
+		&WORLD_WRAP
+	);
+
+	m_flowFields.BuildGrid(
+		Vec2(-WORLD_HEIGHT * WORLD_ASPECT, -WORLD_HEIGHT),
+		Vec2(WORLD_HEIGHT * WORLD_ASPECT, WORLD_HEIGHT),
+		FlowFieldGrid::DEFAULT_CELL_SIZE,
+		m_obstacles,
+		m_worldBounds
+	);
+
+	m_clearanceDirty = false;
+}
+
+
+void Game::RecordMetrics(const uint veh_idx, const double delta_seconds)
+{
+	const Vehicle* vehicle = m_vehicles[veh_idx];
+	m_metrics.m_distanceTraveled += static_cast<double>(vehicle->GetVelocity().GetLength()) * delta_seconds;
+
+	// the clearance field rules out almost everyone without looking at a single obstacle
+	const Vec2 position = vehicle->GetPosition();
+	const float vehicle_radius = vehicle->GetBoundingRadius();
+	bool touching = false;
+	if (m_clearanceField.GetObstacleClearance(position) <= vehicle_radius)
+	{
+		for (const BaseEntity* obstacle : m_obstacles)
+		{
+			const float contact_distance = vehicle_radius + obstacle->GetBoundingRadius();
+			if (WORLD_WRAP.GetDistanceSquared(position, obstacle->GetPosition()) < contact_distance * contact_distance)
+			{
+				touching = true;
+				break;
+			}
+		}
+	}
+
+	// count the start of each contact, not every tick spent inside
+	if (touching && m_obstacleContacts[veh_idx] == 0)
+	{
+		++m_metrics.m_obstacleCollisions;
+	}
+	m_obstacleContacts[veh_idx] = touching ? 1 : 0;
+}
+
+
+void Game::SolveAgentAvoidance(const double delta_seconds, const bool use_lod, const uint tick)
+{
+	// only vehicles that update this tick, off-tick ones would have nothing to use the result on
+	m_orcaSolveIndices.clear();
+	for (const uint veh_idx : m_activeVehicles)
+	{
+		const Vehicle* vehicle = m_vehicles[veh_idx];
+		if (vehicle->HasBehavior(STEER_AGENT_AVOIDANCE) && m_vehicleOwnership[veh_idx] == VEHICLE_OWNED &&
+			(!use_lod || LodScheduler::IsDue(vehicle->GetLodTier(), veh_idx, tick)))
+		{
+			m_orcaSolveIndices.push_back(veh_idx);
+		}
+	}
+
+	if (m_orcaSolveIndices.empty() || delta_seconds <= 0.0)
+	{
+		m_agentAvoidance.Clear();
+		return;
+	}
+
+	// The preferred velocity is where this tick's other behaviors take the vehicle. They are worked out
+	// here, before anyone moves, and Update integrates that same force instead of calculating it again
+	m_orcaPreferredVelocities.resize(m_orcaSolveIndices.size());
+	for (size_t solve_idx = 0; solve_idx < m_orcaSolveIndices.size(); ++solve_idx)
+	{
+		Vehicle* vehicle = m_vehicles[m_orcaSolveIndices[solve_idx]];
+		const double vehicle_seconds = use_lod ? vehicle->PeekLodSeconds() + delta_seconds : delta_seconds;
+		m_orcaPreferredVelocities[solve_idx] = vehicle->PresolveSteering(vehicle_seconds);
+	}
+
+	GAME_PROFILE_SCOPE(PROFILE_AGENT_AVOIDANCE_SOLVE);
+
+	// everyone in the population is a neighbor, sleepers included, they just never get solved. Remote
+	// vehicles are left out, their positions are stale; ascending order keeps neighbor ties as they were
+	m_orcaAgents.clear();
+	m_orcaSlots.assign(num_enemies, INVALID_ORCA_SLOT);
+	for (uint veh_idx = 0; veh_idx < num_enemies; ++veh_idx)
+	{
+		if (m_vehicleOwnership[veh_idx] == VEHICLE_REMOTE)
+		{
+			continue;
+		}
+
+		const Vehicle* vehicle = m_vehicles[veh_idx];
+		m_orcaSlots[veh_idx] = static_cast<uint>(m_orcaAgents.size());
+		m_orcaAgents.emplace_back();
+		OrcaAgent& agent = m_orcaAgents.back();
+		agent.m_position = vehicle->GetPosition();
+		agent.m_velocity = vehicle->GetVelocity();
+		agent.m_preferredVelocity = agent.m_velocity;	// neighbors not solved this tick keep going as they are
+		agent.m_radius = vehicle->GetBoundingRadius();
+		agent.m_maxSpeed = vehicle->GetMaxSpeed();
+	}
+
+	for (size_t solve_idx = 0; solve_idx < m_orcaSolveIndices.size(); ++solve_idx)
+	{
+		const uint orca_slot = m_orcaSlots[m_orcaSolveIndices[solve_idx]];
+		m_orcaAgents[orca_slot].m_preferredVelocity = m_orcaPreferredVelocities[solve_idx];
+		m_orcaSolveIndices[solve_idx] = orca_slot;
+	}
+
+	m_agentAvoidance.Solve(m_orcaAgents, m_orcaSolveIndices, static_cast<float>(delta_seconds));
 }
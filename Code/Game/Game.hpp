@@ -2,9 +2,17 @@
 #include "Engine/Math/Vec3.hpp"
 #include "Engine/Math/Matrix44.hpp"
 #include "Engine/Core/NamedStrings.hpp"
-#include "Engine/Renderer/RenderContext.hpp"
+#include "Game/RenderBackend.hpp"
 #include "Engine/Math/Plane2.hpp"
 #include "GameCommon.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+#include "Game/ClearanceField.hpp"
+#include "Game/LodScheduler.hpp"
+#include "Game/TargetSnapshotCache.hpp"
+#include "Game/FlowField.hpp"
+#include "Game/OrcaSolver.hpp"
+#include "Game/SimRandom.hpp"
+#include "Game/VehicleState.hpp"
 
 class Camera;
 class Shader;
@@ -13,6 +21,52 @@ class Material;
 class BaseEntity;
 class Vehicle;
 class WallEntity;
+class WorldSnapshot;
+class TrajectoryRecorder;
+class TrajectoryPlayback;
+class InputRecorder;
+struct TrajectorySettings;
+
+
+//Parameters AddVehicleBehavior hands to each behavior, what a parameter sweep varies per world
+struct SteeringTuning
+{
+	float	m_wanderRadiusMin = 1.0f;
+	float	m_wanderRadiusMax = 100.0f;
+	float	m_wanderDistanceMin = 70.0f;
+	float	m_wanderDistanceMax = 100.0f;
+	float	m_wanderJitterMin = 1.0f;
+	float	m_wanderJitterMax = 50.0f;
+	float	m_obstacleLookAhead = 30.0f;
+	float	m_obstacleAvoidanceMul = 3.0f;
+	float	m_obstacleBreakingWeight = 0.25f;
+	uint	m_numWhiskers = 3;
+	float	m_whiskerLength = 30.0f;
+	float	m_wallAvoidanceMul = 3.0f;
+	float	m_whiskerFieldOfView = 45.0f;
+};
+
+
+//What a world measured about itself while metrics were enabled
+struct WorldMetrics
+{
+	uint		m_numTicks = 0;
+	uint64_t	m_agentUpdates = 0;
+	uint64_t	m_obstacleCollisions = 0;	// times a vehicle started overlapping an obstacle
+	double		m_distanceTraveled = 0.0;	// summed over vehicles, wrap-around jumps excluded
+};
+
+
+//Which vehicles a world steps itself when the population is split across processes, see SimShard
+enum VehicleOwnership
+{
+	VEHICLE_OWNED = 0,		// updated here, the default
+	VEHICLE_GHOST,			// read-only copy of a nearby vehicle owned elsewhere, a neighbor and a target
+	VEHICLE_REMOTE,			// owned elsewhere and out of reach, left out of the tick entirely
+
+	NUM_VEHICLE_OWNERSHIPS
+};
+
 
 class Game
 {
@@ -23,12 +77,78 @@ private:
 	//Game objects
 	uint num_enemies = 4;
 	const uint MIN_NUM_ENEMIES = 1;
-	const uint MAX_NUM_ENEMIES = 4'096;
+	const uint MAX_NUM_ENEMIES = 1'048'576;	// only keeps repeated doubling from overflowing
+	const uint VEHICLE_BATCH_SIZE = 256;	// vehicles are created this many at a time, as the population grows
+	static constexpr uint SNAPSHOT_GRAIN = 4'096;	// vehicles per job when writing a snapshot
+	static constexpr uint PLAYBACK_GRAIN = 4'096;	// vehicles per job when applying a recorded frame
+	static constexpr uint STATE_HASH_CHUNK = 4'096;	// vehicles hashed together, fixed so any thread count agrees
+	static constexpr uint INVALID_ORCA_SLOT = 0xFFFFFFFFu;
 	uint vehicle_head_idx = 0;
+	uint m_numUpdatedLastTick = 0;
+	uint64_t m_allocationsLastTick = 0;	// process-wide, any thread allocating during the tick counts
 	
 	std::vector<Vehicle*>		m_vehicles;
 	std::vector<BaseEntity*>	m_obstacles;
 	std::vector<WallEntity*>	m_worldBounds;
+
+	//Active set, ascending indices of the vehicles that are awake and inside the population.
+	//Sleepers are dropped after each tick, wakes are queued and merged in before the next one, so
+	//update order (and with it the random sequence wander consumes) never changes.
+	std::vector<uint>	m_activeVehicles;
+	std::vector<uint>	m_wokenVehicles;
+	std::vector<uint>	m_mergedVehicles;	// scratch for the merge, reserved up front
+
+	//Avoidance culling, rebuilt whenever obstacles or walls change
+	ClearanceField	m_clearanceField;
+	bool			m_clearanceDirty = true;
+	bool			m_cullAvoidance = true;
+
+	//Moving-target state shared by pursuers, refreshed at the start of every tick
+	TargetSnapshotCache	m_targetSnapshots;
+	bool				m_useTargetSnapshots = true;
+
+	//Shared seek/arrive goals, off by default
+	FlowFieldCache	m_flowFields;
+	bool			m_useFlowFields = false;
+
+	//Agent-agent avoidance, solved for every STEER_AGENT_AVOIDANCE vehicle before the update loop
+	OrcaSolver				m_agentAvoidance;
+	std::vector<OrcaAgent>	m_orcaAgents;
+	std::vector<uint>		m_orcaSolveIndices;
+	std::vector<Vec2>		m_orcaPreferredVelocities;	// per solved vehicle, parallel to m_orcaSolveIndices
+	std::vector<uint>		m_orcaSlots;		// per vehicle, its index in m_orcaAgents or INVALID_ORCA_SLOT
+
+	//Per vehicle VehicleOwnership, everyone owned unless the world is one shard of several
+	std::vector<uint8_t>	m_vehicleOwnership;
+
+	//World identity, every random draw of the simulation comes from m_random or a vehicle's own stream
+	uint64_t	m_seed = SimRandom::DEFAULT_SEED;
+	SimRandom	m_random;
+	bool		m_visualsEnabled = true;	// false for batch worlds, which never touch the renderer
+
+	//Read by AddVehicleBehavior
+	SteeringTuning	m_steeringTuning;
+
+	//Per-world metrics, off by default
+	WorldMetrics			m_metrics;
+	std::vector<uint8_t>	m_obstacleContacts;		// per vehicle, set while it overlaps an obstacle
+	bool					m_collectMetrics = false;
+
+	//How each vehicle folds its behaviors into one force
+	SteeringCombine	m_steeringCombine = STEER_COMBINE_AVERAGE;
+
+	//Multi-rate ticking, off by default
+	LodScheduler	m_lodScheduler;
+
+	//Trajectory recording, created by the first StartTrajectoryRecording and kept for its stats
+	TrajectoryRecorder*	m_trajectoryRecorder = nullptr;
+
+	//Trajectory playback, shown in place of the simulation while open
+	TrajectoryPlayback*	m_trajectoryPlayback = nullptr;
+	bool				m_playbackPaused = false;
+
+	//Input recording, keys, toggles and dt of a session started from Startup
+	InputRecorder*	m_inputRecorder = nullptr;
 	
 	//Camera
 	Camera* m_gameCamera = nullptr;
@@ -42,9 +162,13 @@ private:
 	int m_currentFrame = 0;
 
 	float m_tickList[g_maxTickPlot] = { 0 };
-	float m_avgFPS = 0.0f;
 	int m_tickHead = 0;
 
+	//Frame and tick time distributions
+	FrameTimeStats	m_frameTimes = FrameTimeStats("frame");
+	FrameTimeStats	m_tickTimes = FrameTimeStats("tick");
+	std::string		m_frameTimesPath;
+
 public:
 	Game();
 	~Game();
@@ -57,6 +181,10 @@ public:
 
 	void BeginFrame();
 	void UpdateImGui(double delta_seconds);
+	void UpdateFrameTimesImGui() const;
+	void UpdateProfileImGui() const;
+	void UpdateLodImGui();
+	void UpdatePlaybackImGui();
 	void RenderImGui() const;
 	void EndFrame();
 	//input
@@ -69,9 +197,102 @@ public:
 	void TagObstaclesWithinDisc(BaseEntity* vehicle, float range);
 	const std::vector<BaseEntity*>& GetObstacles() const;
 	const std::vector<WallEntity*>& GetWalls() const;
+	const ClearanceField& GetClearanceField() const;
+	void SetAvoidanceCulling(bool cull_avoidance);
+	bool IsAvoidanceCullingEnabled() const;
+	TargetSnapshotCache& GetTargetSnapshots();
+	const TargetSnapshotCache& GetTargetSnapshots() const;
+	void SetTargetSnapshots(bool use_target_snapshots);
+	bool AreTargetSnapshotsEnabled() const;
+	FlowFieldCache& GetFlowFields();
+	const FlowFieldCache& GetFlowFields() const;
+	void SetFlowFields(bool use_flow_fields);
+	bool AreFlowFieldsEnabled() const;
+	const OrcaSolver& GetAgentAvoidance() const;
+	bool GetAgentAvoidanceVelocity(uint veh_idx, Vec2& out_velocity) const;
+	void SetSteeringCombine(SteeringCombine steering_combine);
+	SteeringCombine GetSteeringCombine() const;
+	void SetLodEnabled(bool lod_enabled);
+	void SetSeed(uint64_t seed);					// before Startup
+	uint64_t GetSeed() const;
+	SimRandom& GetRandom();
+	void SetVisualsEnabled(bool visuals_enabled);	// before Startup
+	void SetSteeringTuning(const SteeringTuning& steering_tuning);
+	const SteeringTuning& GetSteeringTuning() const;
+	void SetMetricsEnabled(bool collect_metrics);
+	const WorldMetrics& GetMetrics() const;
+	const LodScheduler& GetLodScheduler() const;
+
+	//population
+	void		SetNumVehicles(uint num_vehicles);
+	uint		GetNumVehicles() const;
+	uint		GetNumCreatedVehicles() const;		// the population and the spares created past it
+	uint		GetNumUpdatedLastTick() const;
+	uint		GetNumActiveVehicles() const;
+	void		WakeVehicle(uint veh_idx);
+	uint64_t	GetAllocationsLastTick() const;	// process-wide, see AllocationCounter
+	Vehicle*	GetVehicle(uint veh_idx) const;
+	void		SetVehicleBehavior(uint veh_idx, int behavior);
+	void		AddVehicleBehavior(uint veh_idx, int behavior);
+
+	//sharding, moving vehicles between worlds with the same setup
+	void				SetVehicleOwnership(uint veh_idx, VehicleOwnership ownership);
+	VehicleOwnership	GetVehicleOwnership(uint veh_idx) const;
+	void				WriteVehicleState(uint veh_idx, VehicleState& out_state) const;
+	void				ReadVehicleState(const VehicleState& state);
+
+	//snapshots, the whole world to a file and back in place, see WorldSnapshot
+	bool	SaveSnapshot(const std::string& file_path) const;
+	bool	LoadSnapshot(const std::string& file_path);			// false, world untouched, without a valid file
+	bool	RestoreSnapshot(const WorldSnapshot& snapshot);		// into a started world
+
+	//trajectories, every tick's positions and headings written behind the simulation, see TrajectoryRecorder
+	bool						StartTrajectoryRecording(const std::string& file_path, const TrajectorySettings& settings);
+	bool						StopTrajectoryRecording();		// false if not recording or a write failed
+	bool						IsRecordingTrajectories() const;
+	const TrajectoryRecorder*	GetTrajectoryRecorder() const;	// nullptr until the first recording
+
+	//playback, a recording drives the vehicles Render draws instead of the simulation, see TrajectoryPlayback
+	bool						StartTrajectoryPlayback(const std::string& file_path);
+	void						StopTrajectoryPlayback();		// simulation resumes from the frame shown
+	bool						IsPlayingBack() const;
+	bool						SeekTrajectoryPlayback(uint tick);
+	void						SetPlaybackPaused(bool paused);
+	bool						IsPlaybackPaused() const;		// also once the recording has ended
+	const TrajectoryPlayback*	GetTrajectoryPlayback() const;	// nullptr unless playing back
+
+	//input recording, replayed by "Headless replay", see InputRecording.hpp
+	bool		StartInputRecording(const std::string& file_path);		// a world fresh from Startup only
+	bool		StopInputRecording();		// false if not recording or a write failed
+	bool		IsRecordingInput() const;
+	uint8_t		GetInputSettings() const;	// INPUT_SETTING_* flags
+	void		ApplyInputSettings(uint8_t settings);
+	uint64_t	ComputeStateHash() const;	// every vehicle's state, the population, time and world random
+
+	//frame time stats
+	bool					DumpFrameTimes(const std::string& file_path) const;
+	void					SetFrameTimesPath(const std::string& file_path);
+	const FrameTimeStats&	GetFrameTimes() const;
+	const FrameTimeStats&	GetTickTimes() const;
+
+	//environment
+	void		SpawnObstacles(uint num_obstacles);
+	void		SpawnWalls(uint num_walls);
 	
 private:
+	void	RebuildEnvironmentFields();
+	void	RestoreEnvironment(const WorldSnapshot& snapshot);
+	void	ApplyPlaybackFrame();
+	void	RecordInputSettings();
+	void	CreateVehicles(uint num_vehicles);
+	void	ReservePopulation(uint capacity);
+	void	InitEntityVisuals(BaseEntity* entity) const;
+	void	RecordMetrics(uint veh_idx, double delta_seconds);
+	void	SolveAgentAvoidance(double delta_seconds, bool use_lod, uint tick);
+	void	MergeWokenVehicles();
+	void	RemoveSleepingVehicles();
 	
 	bool	m_show = true;
+	bool	m_showProfile = false;
 	bool	m_imguiError = false;
 };
\ No newline at end of file
@@ -5,6 +5,9 @@ struct Rgba;
 struct Vec2;
 
 //GameCommon is holding mainly global values that will be used thought the game
+
+//#define GAME_DISABLE_PROFILE_ZONES	// (If uncommented) Compiles the GameProfiler timing zones out.
+//#define GAME_DISABLE_TRACE_EVENTS	// (If uncommented) Compiles the TraceRecorder timeline scopes out.
 //constexpr float CLIENT_ASPECT = 2.0f; // We are requesting a 1:1 aspect (square) window area
 
 class App;
@@ -79,21 +82,19 @@ constexpr int Y_KEY = 89;
 constexpr int Z_KEY = 90;
 constexpr int F1_KEY = 112;
 constexpr int F2_KEY = 113;
+constexpr int F5_KEY = 116;
+constexpr int F6_KEY = 117;
+constexpr int F7_KEY = 118;
 constexpr int F8_KEY = 119;
+constexpr int F9_KEY = 120;
 constexpr int TILDE_KEY = 192;
 
 // camera global variables
 constexpr float MAX_SCREEN_SHAKE = 2.0f;
 constexpr float SCREEN_SHAKE_REDUCTION = 1.0f;
 
-//FPS values
+//Frame time plot
 constexpr int g_maxTickPlot = 4'096;
-constexpr int g_maxTickSample = 256;
-inline int g_tickIndex = 0;
-inline float g_tickSum = 0;
-inline float g_tickList[g_maxTickSample] = {0};
-
-float CalcAverageTick(float new_tick);
 
 //One-off drawing functions
 void DrawLine(const Vec2& start, const Vec2& end, float thickness, const Rgba& tint);
@@ -122,6 +123,16 @@ enum Behavior
 	STEER_WANDER,
 	STEER_OBSTACLE_AVOIDANCE,
 	STEER_WALL_AVOIDANCE,
+	STEER_AGENT_AVOIDANCE,
 
 	NUM_STEER_BEHAVIORS
+};
+
+
+enum SteeringCombine
+{
+	STEER_COMBINE_AVERAGE = 0,		// mean of the goal behaviors, an avoidance hit overrides them
+	STEER_COMBINE_PRIORITIZED,		// truncated sum in priority order, capped at m_maxForce (uncapped in average)
+
+	NUM_STEER_COMBINES
 };
\ No newline at end of file
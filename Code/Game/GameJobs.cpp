@@ -0,0 +1,192 @@
+#include "Game/GameJobs.hpp"
+#include "Game/TraceRecorder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+struct GameJobPool
+{
+	std::vector<std::thread>	m_workers;
+	std::mutex					m_mutex;
+	std::condition_variable		m_wakeWorkers;
+	std::condition_variable		m_jobDone;
+	uint64_t					m_generation = 0;
+	uint						m_activeWorkers = 0;
+	bool						m_quit = false;
+
+	// current job, written under m_mutex while no worker is active
+	GameJobs::RangeFunction		m_rangeFunction = nullptr;
+	void*						m_context = nullptr;
+	uint						m_count = 0;
+	uint						m_grain = 1;
+	std::atomic<uint>			m_nextBegin{ 0 };
+	std::atomic<uint>			m_remainingChunks{ 0 };
+};
+
+static GameJobPool	s_pool;
+static bool			s_started = false;
+static thread_local uint	s_jobDepth = 0;	// > 0 while this thread runs a chunk, nested jobs run inline
+static uint			s_numWorkers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+// joinable threads must not reach the pool's destructor, in case nobody called Shutdown()
+static struct GameJobPoolGuard
+{
+	~GameJobPoolGuard() { GameJobs::Shutdown(); }
+} s_poolGuard;
+
+
+static void RunChunks(GameJobPool& pool)
+{
+	for (;;)
+	{
+		const uint begin = pool.m_nextBegin.fetch_add(pool.m_grain, std::memory_order_relaxed);
+		if (begin >= pool.m_count)
+		{
+			return;
+		}
+
+		const uint end = std::min(begin + pool.m_grain, pool.m_count);
+		{
+			GAME_TRACE_SCOPE("GameJobs::Chunk");
+			++s_jobDepth;
+			pool.m_rangeFunction(pool.m_context, begin, end);
+			--s_jobDepth;
+		}
+
+		if (pool.m_remainingChunks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			std::lock_guard<std::mutex> lock(pool.m_mutex);
+			pool.m_jobDone.notify_all();
+		}
+	}
+}
+
+
+static void WorkerMain(GameJobPool* pool)
+{
+	TraceRecorder::SetThreadName("Job Worker");
+
+	uint64_t seen_generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(pool->m_mutex);
+			pool->m_wakeWorkers.wait(lock, [pool, seen_generation]() {
+				return pool->m_quit || pool->m_generation != seen_generation;
+			});
+
+			if (pool->m_quit)
+			{
+				return;
+			}
+
+			seen_generation = pool->m_generation;
+			++pool->m_activeWorkers;
+		}
+
+		RunChunks(*pool);
+
+		std::lock_guard<std::mutex> lock(pool->m_mutex);
+		--pool->m_activeWorkers;
+		pool->m_jobDone.notify_all();
+	}
+}
+
+
+static void StartPool()
+{
+	s_started = true;
+	s_pool.m_workers.reserve(s_numWorkers);
+	for (uint worker_idx = 0; worker_idx < s_numWorkers; ++worker_idx)
+	{
+		s_pool.m_workers.emplace_back(WorkerMain, &s_pool);
+	}
+}
+
+
+STATIC void GameJobs::ParallelFor(const uint count, const uint grain, const RangeFunction range_function,
+	void* context)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	const uint chunk_size = std::max(1u, grain);
+	if (!s_started)
+	{
+		StartPool();
+	}
+
+	if (s_numWorkers == 0 || count <= chunk_size || s_jobDepth > 0)
+	{
+		range_function(context, 0, count);
+		return;
+	}
+
+	{
+		// a worker still leaving the previous job must not pick up chunks under this one's parameters
+		std::unique_lock<std::mutex> lock(s_pool.m_mutex);
+		s_pool.m_jobDone.wait(lock, []() { return s_pool.m_activeWorkers == 0; });
+
+		s_pool.m_rangeFunction = range_function;
+		s_pool.m_context = context;
+		s_pool.m_count = count;
+		s_pool.m_grain = chunk_size;
+		s_pool.m_nextBegin.store(0, std::memory_order_relaxed);
+		s_pool.m_remainingChunks.store((count + chunk_size - 1) / chunk_size, std::memory_order_relaxed);
+		++s_pool.m_generation;
+	}
+	s_pool.m_wakeWorkers.notify_all();
+
+	RunChunks(s_pool);
+
+	std::unique_lock<std::mutex> lock(s_pool.m_mutex);
+	s_pool.m_jobDone.wait(lock, []() {
+		return s_pool.m_remainingChunks.load(std::memory_order_acquire) == 0 && s_pool.m_activeWorkers == 0;
+	});
+}
+
+
+STATIC void GameJobs::SetNumWorkers(const uint num_workers)
+{
+	if (!s_started)
+	{
+		s_numWorkers = num_workers;
+	}
+}
+
+
+STATIC uint GameJobs::GetNumThreads()
+{
+	return s_numWorkers + 1;
+}
+
+
+STATIC void GameJobs::Shutdown()
+{
+	if (!s_started)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_pool.m_mutex);
+		s_pool.m_quit = true;
+	}
+	s_pool.m_wakeWorkers.notify_all();
+
+	for (std::thread& worker : s_pool.m_workers)
+	{
+		worker.join();
+	}
+
+	s_pool.m_workers.clear();
+	s_pool.m_quit = false;
+	s_started = false;
+}
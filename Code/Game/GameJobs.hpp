@@ -0,0 +1,43 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+
+//-----------------------------------------------------------------------------------------------
+// GameJobs
+//
+// Persistent worker pool for data-parallel simulation passes. Workers start on first use and sleep
+// between jobs. ParallelFor splits [0, count) into chunks of `grain` that the workers and the calling
+// thread pull from a shared counter, and returns once every chunk has run. Jobs are issued from one
+// thread at a time (the main thread); a ParallelFor issued from inside a chunk runs inline on the
+// thread that issued it, so a parallel batch of worlds can still call code that uses jobs itself.
+//
+// The body is passed through a plain function pointer and context, so issuing a job never allocates.
+//
+
+class GameJobs
+{
+public:
+	using RangeFunction = void(*)(void* context, uint begin, uint end);
+
+public:
+	static void	ParallelFor(uint count, uint grain, RangeFunction range_function, void* context);
+
+	// body(begin, end) for each chunk
+	template<typename RangeBody>
+	static void	ParallelFor(uint count, uint grain, RangeBody& body)
+	{
+		ParallelFor(count, grain, &InvokeRange<RangeBody>, &body);
+	}
+
+	// before the first job (or after Shutdown), 0 runs every job on the calling thread; default is one per
+	// core minus one
+	static void	SetNumWorkers(uint num_workers);
+	static uint	GetNumThreads();
+	static void	Shutdown();
+
+private:
+	template<typename RangeBody>
+	static void	InvokeRange(void* context, const uint begin, const uint end)
+	{
+		(*static_cast<RangeBody*>(context))(begin, end);
+	}
+};
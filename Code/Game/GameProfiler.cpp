@@ -0,0 +1,135 @@
+#include "Game/GameProfiler.hpp"
+#include <chrono>
+
+static ProfileThreadSlot	s_threadSlots[GameProfiler::MAX_PROFILE_THREADS];
+static std::atomic<int>		s_numThreadSlots(0);
+static ProfileThreadSlot	s_overflowSlot;
+static thread_local ProfileThreadSlot* t_threadSlot = nullptr;
+
+static uint64_t			s_lastTotalTicks[NUM_PROFILE_ZONES] = { 0 };
+static uint64_t			s_lastTotalCalls[NUM_PROFILE_ZONES] = { 0 };
+static ProfileZoneFrame	s_zoneFrames[NUM_PROFILE_ZONES];
+
+// tick to nanosecond conversion, calibrated against the steady clock between collections
+static uint64_t	s_lastCollectTicks = 0;
+static double	s_lastCollectSeconds = 0.0;
+static double	s_nanosecondsPerTick = 0.0;
+
+constexpr double PROFILE_SMOOTHING = 0.1;
+
+static const char* s_zoneNames[NUM_PROFILE_ZONES] = {
+	"Game::Update",
+	"AgentAvoidanceSolve",
+	"Vehicle::Update",
+	"Calculate",
+	"Seek",
+	"Flee",
+	"Arrive",
+	"Pursuit",
+	"Evade",
+	"Wander",
+	"ObstacleAvoidance",
+	"WallAvoidance",
+	"Integration",
+	"Game::Render",
+	"Obstacles",
+	"Walls",
+	"Vehicles",
+	"DebugRender",
+};
+
+// indentation in the breakdown, mirrors which zone is nested in which
+static const int s_zoneDepths[NUM_PROFILE_ZONES] = {
+	0, 1, 1, 2, 3, 3, 3, 3, 3, 3, 3, 3, 2,
+	0, 1, 1, 1, 1,
+};
+
+
+STATIC void GameProfiler::CollectFrame()
+{
+	const uint64_t now_ticks = GetTicks();
+	const double now_seconds = std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	if (s_lastCollectTicks != 0 && now_ticks > s_lastCollectTicks)
+	{
+		const double measured = (now_seconds - s_lastCollectSeconds) * 1.0e9 /
+			static_cast<double>(now_ticks - s_lastCollectTicks);
+		s_nanosecondsPerTick = s_nanosecondsPerTick == 0.0 ? measured :
+			s_nanosecondsPerTick + (measured - s_nanosecondsPerTick) * PROFILE_SMOOTHING;
+	}
+	s_lastCollectTicks = now_ticks;
+	s_lastCollectSeconds = now_seconds;
+
+	const int num_slots = s_numThreadSlots.load(std::memory_order_acquire);
+	for (int zone_idx = 0; zone_idx < NUM_PROFILE_ZONES; ++zone_idx)
+	{
+		uint64_t total_ticks = 0;
+		uint64_t total_calls = 0;
+		for (int slot_idx = 0; slot_idx < num_slots && slot_idx < MAX_PROFILE_THREADS; ++slot_idx)
+		{
+			total_ticks += s_threadSlots[slot_idx].m_ticks[zone_idx].load(std::memory_order_relaxed);
+			total_calls += s_threadSlots[slot_idx].m_calls[zone_idx].load(std::memory_order_relaxed);
+		}
+
+		ProfileZoneFrame& frame = s_zoneFrames[zone_idx];
+		frame.m_milliseconds = static_cast<double>(total_ticks - s_lastTotalTicks[zone_idx]) *
+			s_nanosecondsPerTick * 1.0e-6;
+		frame.m_calls = total_calls - s_lastTotalCalls[zone_idx];
+		frame.m_smoothedMilliseconds += (frame.m_milliseconds - frame.m_smoothedMilliseconds) * PROFILE_SMOOTHING;
+
+		s_lastTotalTicks[zone_idx] = total_ticks;
+		s_lastTotalCalls[zone_idx] = total_calls;
+	}
+}
+
+
+STATIC void GameProfiler::Record(const ProfileZone zone, const uint64_t elapsed_ticks)
+{
+	ProfileThreadSlot* slot = t_threadSlot;
+	if (slot == nullptr)
+	{
+		slot = AcquireThreadSlot();
+	}
+
+	// each slot has one writer, so a plain load and store is enough and skips the locked add a
+	// fetch_add costs on x86; they are atomics only so CollectFrame can read them mid-frame
+	std::atomic<uint64_t>& ticks = slot->m_ticks[zone];
+	std::atomic<uint64_t>& calls = slot->m_calls[zone];
+	ticks.store(ticks.load(std::memory_order_relaxed) + elapsed_ticks, std::memory_order_relaxed);
+	calls.store(calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+STATIC const ProfileZoneFrame& GameProfiler::GetZoneFrame(const ProfileZone zone)
+{
+	return s_zoneFrames[zone];
+}
+
+
+STATIC const char* GameProfiler::GetZoneName(const ProfileZone zone)
+{
+	return s_zoneNames[zone];
+}
+
+
+STATIC int GameProfiler::GetZoneDepth(const ProfileZone zone)
+{
+	return s_zoneDepths[zone];
+}
+
+
+STATIC double GameProfiler::GetNanosecondsPerTick()
+{
+	return s_nanosecondsPerTick;
+}
+
+
+STATIC ProfileThreadSlot* GameProfiler::AcquireThreadSlot()
+{
+	const int slot_idx = s_numThreadSlots.fetch_add(1, std::memory_order_acq_rel);
+
+	// past the limit a slot would have two writers, those threads record into one nobody collects
+	t_threadSlot = slot_idx < MAX_PROFILE_THREADS ? &s_threadSlots[slot_idx] : &s_overflowSlot;
+	return t_threadSlot;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include <atomic>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+//-----------------------------------------------------------------------------------------------
+// GameProfiler
+//
+// Fixed set of scoped timing zones for the steering simulation. Each thread writes into its own
+// slot (no locks, no shared cache lines), and GameProfiler::CollectFrame() folds every slot into a
+// per-frame breakdown that Game::UpdateImGui shows in the "Game State" window.
+//
+// Define GAME_DISABLE_PROFILE_ZONES (see GameCommon.hpp) to compile every zone out.
+//
+
+#if !defined(GAME_DISABLE_PROFILE_ZONES)
+#define GAME_PROFILE_ZONES_ENABLED
+#endif
+
+enum ProfileZone
+{
+	PROFILE_GAME_UPDATE = 0,
+	PROFILE_AGENT_AVOIDANCE_SOLVE,
+	PROFILE_VEHICLE_UPDATE,
+	PROFILE_STEER_CALCULATE,
+	PROFILE_STEER_SEEK,
+	PROFILE_STEER_FLEE,
+	PROFILE_STEER_ARRIVE,
+	PROFILE_STEER_PURSUIT,
+	PROFILE_STEER_EVADE,
+	PROFILE_STEER_WANDER,
+	PROFILE_STEER_OBSTACLE_AVOIDANCE,
+	PROFILE_STEER_WALL_AVOIDANCE,
+	PROFILE_INTEGRATION,
+	PROFILE_GAME_RENDER,
+	PROFILE_RENDER_OBSTACLES,
+	PROFILE_RENDER_WALLS,
+	PROFILE_RENDER_VEHICLES,
+	PROFILE_RENDER_DEBUG,
+
+	NUM_PROFILE_ZONES
+};
+
+
+struct ProfileZoneFrame
+{
+	double		m_milliseconds = 0.0;
+	double		m_smoothedMilliseconds = 0.0;
+	uint64_t	m_calls = 0;
+};
+
+
+struct alignas(64) ProfileThreadSlot
+{
+	std::atomic<uint64_t>	m_ticks[NUM_PROFILE_ZONES];
+	std::atomic<uint64_t>	m_calls[NUM_PROFILE_ZONES];
+};
+
+
+class GameProfiler
+{
+public:
+	static constexpr int MAX_PROFILE_THREADS = 64;
+
+public:
+	static void		CollectFrame();
+	static void		Record(ProfileZone zone, uint64_t elapsed_ticks);
+
+	static const ProfileZoneFrame&	GetZoneFrame(ProfileZone zone);
+	static const char*				GetZoneName(ProfileZone zone);
+	static int						GetZoneDepth(ProfileZone zone);
+	static double					GetNanosecondsPerTick();
+
+	static inline uint64_t GetTicks()
+	{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+private:
+	static ProfileThreadSlot*	AcquireThreadSlot();
+};
+
+
+class GameProfileScope
+{
+private:
+	ProfileZone	m_zone;
+	uint64_t	m_startTicks;
+
+public:
+	explicit GameProfileScope(const ProfileZone zone) : m_zone(zone), m_startTicks(GameProfiler::GetTicks())
+	{
+	}
+
+	~GameProfileScope()
+	{
+		GameProfiler::Record(m_zone, GameProfiler::GetTicks() - m_startTicks);
+	}
+};
+
+
+#define GAME_PROFILE_COMBINE_INNER(a, b) a##b
+#define GAME_PROFILE_COMBINE(a, b) GAME_PROFILE_COMBINE_INNER(a, b)
+
+#if defined(GAME_PROFILE_ZONES_ENABLED)
+#define GAME_PROFILE_SCOPE(zone) GameProfileScope GAME_PROFILE_COMBINE(profile_scope_, __LINE__)(zone)
+#else
+#define GAME_PROFILE_SCOPE(zone)
+#endif
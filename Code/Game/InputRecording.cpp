@@ -0,0 +1,231 @@
+#include "Game/InputRecording.hpp"
+
+#include <cstring>
+
+// the on-disk layout, a change to either is a new INPUT_VERSION
+static_assert(sizeof(InputFileHeader) == 32, "InputFileHeader layout changed");
+static_assert(sizeof(double) == 8, "frame events hold an 8 byte dt");
+
+// largest payload of any event, a checkpoint
+constexpr size_t INPUT_MAX_PAYLOAD_BYTES = sizeof(uint32_t) + sizeof(uint64_t);
+
+
+//-----------------------------------------------------------------------------------------------
+InputRecorder::~InputRecorder()
+{
+	if (IsRecording())
+	{
+		fclose(m_file);
+	}
+}
+
+
+bool InputRecorder::Start(const std::string& file_path, const InputFileHeader& header)
+{
+	if (IsRecording() || header.m_checkpointFrames == 0)
+	{
+		return false;
+	}
+
+	m_file = fopen(file_path.c_str(), "wb");
+	if (m_file == nullptr)
+	{
+		return false;
+	}
+
+	m_header = header;
+	m_numFrames = 0;
+	m_lastDeltaSeconds = 0.0;
+	m_settings = header.m_settings;
+	m_steeringCombine = header.m_steeringCombine;
+	m_writeFailed = fwrite(&m_header, sizeof(m_header), 1, m_file) != 1;
+	return true;
+}
+
+
+void InputRecorder::RecordSettings(const uint8_t settings, const uint8_t steering_combine)
+{
+	if (!IsRecording() || (settings == m_settings && steering_combine == m_steeringCombine))
+	{
+		return;
+	}
+
+	const uint8_t payload[2] = { settings, steering_combine };
+	WriteEvent(INPUT_EVENT_SETTINGS, payload, sizeof(payload));
+	m_settings = settings;
+	m_steeringCombine = steering_combine;
+}
+
+
+void InputRecorder::RecordKey(const uint8_t key_code, const bool pressed)
+{
+	if (IsRecording())
+	{
+		WriteEvent(pressed ? INPUT_EVENT_KEY_PRESSED : INPUT_EVENT_KEY_RELEASED, &key_code, sizeof(key_code));
+	}
+}
+
+
+void InputRecorder::RecordFrame(const double delta_seconds)
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	// bitwise, a dt that only compares equal (0.0 and -0.0) would not replay the same
+	if (m_numFrames > 0 && memcmp(&delta_seconds, &m_lastDeltaSeconds, sizeof(double)) == 0)
+	{
+		WriteEvent(INPUT_EVENT_FRAME_SAME_DT, nullptr, 0);
+	}
+	else
+	{
+		WriteEvent(INPUT_EVENT_FRAME, &delta_seconds, sizeof(double));
+	}
+	m_lastDeltaSeconds = delta_seconds;
+	++m_numFrames;
+}
+
+
+void InputRecorder::RecordCheckpoint(const uint64_t state_hash)
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	uint8_t payload[INPUT_MAX_PAYLOAD_BYTES];
+	memcpy(payload, &m_numFrames, sizeof(uint32_t));
+	memcpy(payload + sizeof(uint32_t), &state_hash, sizeof(uint64_t));
+	WriteEvent(INPUT_EVENT_CHECKPOINT, payload, sizeof(payload));
+}
+
+
+bool InputRecorder::Stop(const uint64_t state_hash)
+{
+	if (!IsRecording())
+	{
+		return false;
+	}
+
+	uint8_t payload[INPUT_MAX_PAYLOAD_BYTES];
+	memcpy(payload, &m_numFrames, sizeof(uint32_t));
+	memcpy(payload + sizeof(uint32_t), &state_hash, sizeof(uint64_t));
+	WriteEvent(INPUT_EVENT_END, payload, sizeof(payload));
+
+	const bool closed = fclose(m_file) == 0;
+	m_file = nullptr;
+	return closed && !m_writeFailed;
+}
+
+
+void InputRecorder::WriteEvent(const InputEventType type, const void* payload, const size_t payload_size)
+{
+	// one fwrite per event, so a file cut short ends on a whole event more often than not
+	uint8_t bytes[1 + INPUT_MAX_PAYLOAD_BYTES];
+	bytes[0] = static_cast<uint8_t>(type);
+	if (payload_size > 0)
+	{
+		memcpy(bytes + 1, payload, payload_size);
+	}
+
+	if (!m_writeFailed && fwrite(bytes, 1, 1 + payload_size, m_file) != 1 + payload_size)
+	{
+		m_writeFailed = true;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool InputReplay::Open(const std::string& file_path)
+{
+	Close();
+	if (!m_file.Map(file_path) || m_file.GetSize() < sizeof(InputFileHeader))
+	{
+		Close();
+		return false;
+	}
+
+	memcpy(&m_header, m_file.GetData(), sizeof(InputFileHeader));
+	if (m_header.m_magic != INPUT_MAGIC || m_header.m_version != INPUT_VERSION ||
+		m_header.m_headerSize != sizeof(InputFileHeader) || m_header.m_checkpointFrames == 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_offset = sizeof(InputFileHeader);
+	return true;
+}
+
+
+void InputReplay::Close()
+{
+	m_file.Unmap();
+	m_header = InputFileHeader();
+	m_offset = 0;
+	m_lastDeltaSeconds = 0.0;
+	m_complete = false;
+}
+
+
+bool InputReplay::Next(InputEvent& out_event)
+{
+	uint8_t type = 0;
+	if (!IsOpen() || m_complete || !Read(&type, sizeof(type)))
+	{
+		return false;
+	}
+
+	out_event = InputEvent();
+	out_event.m_type = static_cast<InputEventType>(type);
+	switch (out_event.m_type)
+	{
+	case INPUT_EVENT_FRAME:
+		if (!Read(&m_lastDeltaSeconds, sizeof(double)))
+		{
+			return false;
+		}
+		out_event.m_deltaSeconds = m_lastDeltaSeconds;
+		return true;
+
+	case INPUT_EVENT_FRAME_SAME_DT:
+		out_event.m_deltaSeconds = m_lastDeltaSeconds;
+		return true;
+
+	case INPUT_EVENT_KEY_PRESSED:
+	case INPUT_EVENT_KEY_RELEASED:
+		return Read(&out_event.m_keyCode, sizeof(uint8_t));
+
+	case INPUT_EVENT_SETTINGS:
+		return Read(&out_event.m_settings, sizeof(uint8_t)) && Read(&out_event.m_steeringCombine, sizeof(uint8_t));
+
+	case INPUT_EVENT_CHECKPOINT:
+	case INPUT_EVENT_END:
+		if (!Read(&out_event.m_frame, sizeof(uint32_t)) || !Read(&out_event.m_stateHash, sizeof(uint64_t)))
+		{
+			return false;
+		}
+		m_complete = out_event.m_type == INPUT_EVENT_END;
+		return true;
+
+	default:
+		// not something this version writes, nothing past it can be trusted
+		m_offset = m_file.GetSize();
+		return false;
+	}
+}
+
+
+bool InputReplay::Read(void* out_data, const size_t size)
+{
+	if (m_file.GetSize() - m_offset < size)
+	{
+		m_offset = m_file.GetSize();
+		return false;
+	}
+
+	memcpy(out_data, m_file.GetData() + m_offset, size);
+	m_offset += size;
+	return true;
+}
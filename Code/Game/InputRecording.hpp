@@ -0,0 +1,153 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/MappedFile.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+//-----------------------------------------------------------------------------------------------
+// Input recordings
+//
+// Everything that steers a world after Startup, so a session can be run again exactly: the seed and
+// population it started from, then in order every key that reached Game, every change to the
+// simulation toggles of the Game State window, and the dt of every Game::Update. The dt is the one
+// the clock handed to the game, so slow motion and pause are in it. Written by InputRecorder while
+// the game runs, read back by InputReplay.
+//
+//		header		InputFileHeader
+//		events		a type byte each, then its payload (see InputEventType)
+//
+// Every m_checkpointFrames frames, and once more at the end, a checkpoint holds a hash of the world
+// state (Game::ComputeStateHash), so a replay knows whether it is still the same run and from where
+// it is not. A file that was cut short, by a crash say, replays up to its last whole event.
+//
+
+constexpr uint32_t INPUT_MAGIC = 0x524E5049;		// "IPNR"
+constexpr uint32_t INPUT_VERSION = 1;
+
+// InputFileHeader::m_settings and INPUT_EVENT_SETTINGS
+constexpr uint8_t INPUT_SETTING_CULL_AVOIDANCE = 1u << 0;
+constexpr uint8_t INPUT_SETTING_TARGET_SNAPSHOTS = 1u << 1;
+constexpr uint8_t INPUT_SETTING_FLOW_FIELDS = 1u << 2;
+constexpr uint8_t INPUT_SETTING_LOD = 1u << 3;
+
+
+enum InputEventType : uint8_t
+{
+	INPUT_EVENT_FRAME = 1,			// double dt, then one Game::Update with it
+	INPUT_EVENT_FRAME_SAME_DT,		// one Game::Update with the previous frame's dt
+	INPUT_EVENT_KEY_PRESSED,		// key code byte
+	INPUT_EVENT_KEY_RELEASED,		// key code byte
+	INPUT_EVENT_SETTINGS,			// INPUT_SETTING_* byte, steering combine byte
+	INPUT_EVENT_CHECKPOINT,			// uint32 frames so far, uint64 state hash after the last of them
+	INPUT_EVENT_END,				// a final checkpoint, nothing follows
+
+	NUM_INPUT_EVENTS
+};
+
+
+struct InputFileHeader
+{
+	uint32_t	m_magic = INPUT_MAGIC;
+	uint32_t	m_version = INPUT_VERSION;
+	uint32_t	m_headerSize = sizeof(InputFileHeader);
+	uint32_t	m_numVehicles = 0;			// population after Startup
+	uint64_t	m_seed = 0;
+	uint32_t	m_checkpointFrames = 0;
+	uint8_t		m_settings = 0;				// INPUT_SETTING_* after Startup
+	uint8_t		m_steeringCombine = 0;
+	uint16_t	m_reserved = 0;
+};
+
+
+struct InputEvent
+{
+	InputEventType	m_type = INPUT_EVENT_END;
+	uint8_t			m_keyCode = 0;
+	uint8_t			m_settings = 0;
+	uint8_t			m_steeringCombine = 0;
+	double			m_deltaSeconds = 0.0;		// frames, repeated for INPUT_EVENT_FRAME_SAME_DT
+	uint32_t		m_frame = 0;				// checkpoints
+	uint64_t		m_stateHash = 0;			// checkpoints
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// InputRecorder
+//
+// Appends events to the file as they happen, on the calling thread. They are a few bytes each (a
+// frame with an unchanged dt is one), so buffered stdio is all the writing costs; an hour at 60 Hz
+// is around a megabyte.
+//
+
+class InputRecorder
+{
+public:
+	static constexpr const char*	DEFAULT_PATH = "Session.input";
+	static constexpr uint			DEFAULT_CHECKPOINT_FRAMES = 600;
+
+public:
+	InputRecorder() = default;
+	~InputRecorder();
+
+	InputRecorder(const InputRecorder&) = delete;
+	InputRecorder& operator=(const InputRecorder&) = delete;
+
+	bool	Start(const std::string& file_path, const InputFileHeader& header);
+	void	RecordSettings(uint8_t settings, uint8_t steering_combine);		// only written when they changed
+	void	RecordKey(uint8_t key_code, bool pressed);
+	void	RecordFrame(double delta_seconds);
+	void	RecordCheckpoint(uint64_t state_hash);
+	bool	Stop(uint64_t state_hash);		// writes the final checkpoint; false if any write failed
+	bool	IsRecording() const { return m_file != nullptr; }
+
+	bool	IsCheckpointDue() const { return m_numFrames % m_header.m_checkpointFrames == 0; }
+	uint	GetNumFrames() const { return m_numFrames; }
+
+private:
+	void	WriteEvent(InputEventType type, const void* payload, size_t payload_size);
+
+private:
+	FILE*			m_file = nullptr;
+	InputFileHeader	m_header;
+	uint			m_numFrames = 0;
+	double			m_lastDeltaSeconds = 0.0;
+	uint8_t			m_settings = 0;
+	uint8_t			m_steeringCombine = 0;
+	bool			m_writeFailed = false;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// InputReplay
+//
+// Reads an input recording in place from a read-only mapping, one event at a time.
+//
+
+class InputReplay
+{
+public:
+	InputReplay() = default;
+
+	InputReplay(const InputReplay&) = delete;
+	InputReplay& operator=(const InputReplay&) = delete;
+
+	bool	Open(const std::string& file_path);		// false if missing or not an input recording
+	void	Close();
+	bool	IsOpen() const { return m_file.IsMapped(); }
+
+	bool	Next(InputEvent& out_event);		// false past INPUT_EVENT_END or the last whole event
+	bool	IsComplete() const { return m_complete; }		// INPUT_EVENT_END was read, the file was finished
+
+	const InputFileHeader&	GetHeader() const { return m_header; }
+
+private:
+	bool	Read(void* out_data, size_t size);
+
+private:
+	MappedFile		m_file;
+	InputFileHeader	m_header;
+	size_t			m_offset = 0;
+	double			m_lastDeltaSeconds = 0.0;
+	bool			m_complete = false;
+};
@@ -0,0 +1,118 @@
+#include "Game/LodScheduler.hpp"
+#include "Game/Vehicle.hpp"
+
+
+void LodScheduler::SetEnabled(const bool enabled)
+{
+	if (enabled && !m_enabled)
+	{
+		// tiers are stale from whenever the scheduler last ran
+		m_rebalancePending = true;
+	}
+
+	m_enabled = enabled;
+	m_windowUpdates = 0;
+	m_windowSeconds = 0.0;
+}
+
+
+void LodScheduler::SetTierDistances(const float near_distance, const float far_distance)
+{
+	m_nearDistanceSq = near_distance * near_distance;
+	m_farDistanceSq = far_distance * far_distance;
+	m_rebalancePending = true;
+}
+
+
+void LodScheduler::SetRebalanceTicks(const uint rebalance_ticks)
+{
+	m_rebalanceTicks = rebalance_ticks > 0 ? rebalance_ticks : 1;
+}
+
+
+bool LodScheduler::IsRebalanceDue(const uint tick) const
+{
+	return m_rebalancePending || tick % m_rebalanceTicks == 0;
+}
+
+
+void LodScheduler::Rebalance(const std::vector<Vehicle*>& vehicles, const std::vector<uint>& active_vehicles,
+	const Vec2& focus_position)
+{
+	for (int tier_idx = 0; tier_idx < NUM_LOD_TIERS; ++tier_idx)
+	{
+		m_tierPopulations[tier_idx] = 0;
+	}
+
+	const uint num_active = static_cast<uint>(active_vehicles.size());
+	for (uint active_idx = 0; active_idx < num_active; ++active_idx)
+	{
+		Vehicle* vehicle = vehicles[active_vehicles[active_idx]];
+		const int tier = PickTier(vehicle, focus_position);
+
+		// a vehicle changing tier keeps its banked dt, it is spent on the next due tick of the new tier
+		vehicle->SetLodTier(tier);
+		++m_tierPopulations[tier];
+	}
+
+	m_rebalancePending = false;
+}
+
+
+void LodScheduler::Admit(Vehicle* vehicle, const Vec2& focus_position)
+{
+	const int tier = PickTier(vehicle, focus_position);
+	vehicle->SetLodTier(tier);
+	++m_tierPopulations[tier];
+}
+
+
+void LodScheduler::Dismiss(const Vehicle* vehicle)
+{
+	// a rebalance still pending has not counted it yet
+	uint& tier_population = m_tierPopulations[vehicle->GetLodTier()];
+	if (tier_population > 0)
+	{
+		--tier_population;
+	}
+}
+
+
+void LodScheduler::RecordTick(const uint num_updates, const double delta_seconds)
+{
+	m_windowUpdates += num_updates;
+	m_windowSeconds += delta_seconds;
+	if (m_windowSeconds >= 1.0)
+	{
+		m_updatesPerSecond = static_cast<double>(m_windowUpdates) / m_windowSeconds;
+		m_windowUpdates = 0;
+		m_windowSeconds = 0.0;
+	}
+}
+
+
+int LodScheduler::PickTier(const Vehicle* vehicle, const Vec2& focus_position) const
+{
+	const int tier = vehicle->GetLodPriority();
+	if (tier == LOD_PRIORITY_BY_DISTANCE)
+	{
+		const float distance_sq = (vehicle->GetPosition() - focus_position).GetLengthSquared();
+		return distance_sq < m_nearDistanceSq ? LOD_TIER_FULL :
+			distance_sq < m_farDistanceSq ? LOD_TIER_HALF : LOD_TIER_QUARTER;
+	}
+
+	return tier < NUM_LOD_TIERS ? tier : NUM_LOD_TIERS - 1;
+}
+
+
+STATIC uint LodScheduler::GetTierPeriod(const int tier)
+{
+	return 1u << tier;
+}
+
+
+STATIC bool LodScheduler::IsDue(const int tier, const uint veh_idx, const uint tick)
+{
+	// offset by index so a tier's vehicles are split evenly over the ticks of its period
+	return ((tick + veh_idx) & (GetTierPeriod(tier) - 1)) == 0;
+}
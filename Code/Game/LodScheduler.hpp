@@ -0,0 +1,78 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+#include <vector>
+
+class Vehicle;
+
+//-----------------------------------------------------------------------------------------------
+// LodScheduler
+//
+// Multi-rate ticking for agents that do not need full rate. Every awake vehicle sits in a tier that
+// updates every 1st, 2nd or 4th tick; in between it only banks the tick's dt and integrates the whole
+// banked span when its turn comes. Tiers are picked by distance to a focus point (the leader) unless a
+// vehicle pins one through its LOD priority, and are reassigned every few ticks rather than every tick.
+//
+// Vehicles joining the active set between rebalances get their tier right away and leaving ones are
+// taken out of the tier counts, so the counts always match the active set.
+//
+// Due ticks are staggered by vehicle index so each tier spreads its work evenly across its period.
+// Off by default, a disabled scheduler leaves Game::Update exactly as it was.
+//
+
+enum LodTier
+{
+	LOD_TIER_FULL = 0,		// every tick
+	LOD_TIER_HALF,			// every 2nd tick
+	LOD_TIER_QUARTER,		// every 4th tick
+
+	NUM_LOD_TIERS
+};
+
+constexpr int LOD_PRIORITY_BY_DISTANCE = -1;
+
+
+class LodScheduler
+{
+public:
+	static constexpr uint	DEFAULT_REBALANCE_TICKS = 8;
+	static constexpr float	DEFAULT_NEAR_DISTANCE = 60.0f;		// closer than this runs every tick
+	static constexpr float	DEFAULT_FAR_DISTANCE = 120.0f;		// farther than this runs every 4th
+
+public:
+	void	SetEnabled(bool enabled);
+	bool	IsEnabled() const { return m_enabled; }
+	void	SetTierDistances(float near_distance, float far_distance);
+	void	SetRebalanceTicks(uint rebalance_ticks);
+
+	bool	IsRebalanceDue(uint tick) const;
+	void	Rebalance(const std::vector<Vehicle*>& vehicles, const std::vector<uint>& active_vehicles,
+		const Vec2& focus_position);
+	void	Admit(Vehicle* vehicle, const Vec2& focus_position);	// woken or added between rebalances
+	void	Dismiss(const Vehicle* vehicle);						// gone to sleep or out of the population
+	void	RecordTick(uint num_updates, double delta_seconds);
+
+	uint	GetTierPopulation(int tier) const { return m_tierPopulations[tier]; }
+	double	GetUpdatesPerSecond() const { return m_updatesPerSecond; }
+
+	static uint	GetTierPeriod(int tier);
+	static bool	IsDue(int tier, uint veh_idx, uint tick);
+
+private:
+	int		PickTier(const Vehicle* vehicle, const Vec2& focus_position) const;
+
+private:
+	bool	m_enabled = false;
+	bool	m_rebalancePending = true;
+	uint	m_rebalanceTicks = DEFAULT_REBALANCE_TICKS;
+	float	m_nearDistanceSq = DEFAULT_NEAR_DISTANCE * DEFAULT_NEAR_DISTANCE;
+	float	m_farDistanceSq = DEFAULT_FAR_DISTANCE * DEFAULT_FAR_DISTANCE;
+
+	uint	m_tierPopulations[NUM_LOD_TIERS] = { 0 };
+
+	//effective rate, published once per simulated second
+	uint64_t	m_windowUpdates = 0;
+	double		m_windowSeconds = 0.0;
+	double		m_updatesPerSecond = 0.0;
+};
@@ -0,0 +1,217 @@
+#include "Game/GameCommon.hpp"
+#include "Game/SimScenario.hpp"
+#include "Game/SimBenchmark.hpp"
+#include "Game/SimAllocationTest.hpp"
+#include "Game/SimFlowFieldBench.hpp"
+#include "Game/SimOrcaBench.hpp"
+#include "Game/SimBatch.hpp"
+#include "Game/SimShard.hpp"
+#include "Game/SimSnapshot.hpp"
+#include "Game/SimPlayback.hpp"
+#include "Game/SimReplay.hpp"
+#include "Game/SimGolden.hpp"
+#include "Game/GameJobs.hpp"
+#include "Game/SharedVisuals.hpp"
+#include "Game/RenderBackend.hpp"
+#include "Game/TraceRecorder.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+// Console entry point for the headless simulation (GAME_HEADLESS builds). No window, audio,
+// dev console or ImGui: the game runs against the null renderer and reports its own throughput.
+//
+//		Headless [run] [options]	one scenario (SimScenario)
+//		Headless bench [options]	scaling benchmark suite (SimBenchmark)
+//		Headless alloc-test [options]	zero-allocation steady state check (SimAllocationTest)
+//		Headless flow-bench [options]	flow field build and sample cost (SimFlowFieldBench)
+//		Headless orca-bench [options]	agent-agent avoidance solve cost (SimOrcaBench)
+//		Headless batch [options]	parameter sweep over independent worlds (SimBatch)
+//		Headless shard [options]	one world split across processes by region (SimShard)
+//		Headless snapshot [options]	world snapshot save and restore cost (SimSnapshot)
+//		Headless playback [options]	trajectory file open, playback and seek cost (SimPlayback)
+//		Headless replay [options]	recorded interactive session, timed and verified (SimReplay)
+//		Headless golden [options]	reference vs optimized paths, per-agent tolerances (SimGolden)
+//
+App* g_theApp = nullptr;
+AudioSystem* g_theAudio = nullptr;
+
+
+static int RunMode(const char* mode, const int argc, char** argv)
+{
+	if (strcmp(mode, "run") == 0)
+	{
+		SimScenario scenario;
+		if (!scenario.ParseCommandLine(argc, argv))
+		{
+			SimScenario::PrintUsage();
+			return 1;
+		}
+
+		return scenario.Run();
+	}
+
+	if (strcmp(mode, "bench") == 0)
+	{
+		SimBenchmark benchmark;
+		if (!benchmark.ParseCommandLine(argc, argv))
+		{
+			SimBenchmark::PrintUsage();
+			return 1;
+		}
+
+		return benchmark.Run();
+	}
+
+	if (strcmp(mode, "alloc-test") == 0)
+	{
+		SimAllocationTest allocation_test;
+		if (!allocation_test.ParseCommandLine(argc, argv))
+		{
+			SimAllocationTest::PrintUsage();
+			return 1;
+		}
+
+		return allocation_test.Run();
+	}
+
+	if (strcmp(mode, "flow-bench") == 0)
+	{
+		SimFlowFieldBench flow_field_bench;
+		if (!flow_field_bench.ParseCommandLine(argc, argv))
+		{
+			SimFlowFieldBench::PrintUsage();
+			return 1;
+		}
+
+		return flow_field_bench.Run();
+	}
+
+	if (strcmp(mode, "orca-bench") == 0)
+	{
+		SimOrcaBench orca_bench;
+		if (!orca_bench.ParseCommandLine(argc, argv))
+		{
+			SimOrcaBench::PrintUsage();
+			return 1;
+		}
+
+		return orca_bench.Run();
+	}
+
+	if (strcmp(mode, "batch") == 0)
+	{
+		SimBatch batch;
+		if (!batch.ParseCommandLine(argc, argv))
+		{
+			SimBatch::PrintUsage();
+			return 1;
+		}
+
+		return batch.Run();
+	}
+
+	if (strcmp(mode, "shard") == 0)
+	{
+		SimShard shard;
+		if (!shard.ParseCommandLine(argc, argv))
+		{
+			SimShard::PrintUsage();
+			return 1;
+		}
+
+		return shard.Run();
+	}
+
+	if (strcmp(mode, "snapshot") == 0)
+	{
+		SimSnapshot snapshot;
+		if (!snapshot.ParseCommandLine(argc, argv))
+		{
+			SimSnapshot::PrintUsage();
+			return 1;
+		}
+
+		return snapshot.Run();
+	}
+
+	if (strcmp(mode, "playback") == 0)
+	{
+		SimPlayback playback;
+		if (!playback.ParseCommandLine(argc, argv))
+		{
+			SimPlayback::PrintUsage();
+			return 1;
+		}
+
+		return playback.Run();
+	}
+
+	if (strcmp(mode, "replay") == 0)
+	{
+		SimReplay replay;
+		if (!replay.ParseCommandLine(argc, argv))
+		{
+			SimReplay::PrintUsage();
+			return 1;
+		}
+
+		return replay.Run();
+	}
+
+	if (strcmp(mode, "golden") == 0)
+	{
+		SimGolden golden;
+		if (!golden.ParseCommandLine(argc, argv))
+		{
+			SimGolden::PrintUsage();
+			return 1;
+		}
+
+		return golden.Run();
+	}
+
+	printf("Unknown mode '%s'\n", mode);
+	SimScenario::PrintUsage();
+	SimBenchmark::PrintUsage();
+	SimAllocationTest::PrintUsage();
+	SimFlowFieldBench::PrintUsage();
+	SimOrcaBench::PrintUsage();
+	SimBatch::PrintUsage();
+	SimShard::PrintUsage();
+	SimSnapshot::PrintUsage();
+	SimPlayback::PrintUsage();
+	SimReplay::PrintUsage();
+	SimGolden::PrintUsage();
+	return 1;
+}
+
+
+int main(int argc, char** argv)
+{
+	// an optional leading mode name, the rest are that mode's options
+	const char* mode = "run";
+	if (argc > 1 && argv[1][0] != '-')
+	{
+		mode = argv[1];
+		--argc;
+		++argv;
+	}
+
+	TraceRecorder::SetThreadName("Main");
+	g_theRenderer = new RenderContext();
+	g_theDebugRenderer = new DebugRender();
+
+	const int result = RunMode(mode, argc, argv);
+	GameJobs::Shutdown();
+	SharedVisuals::Shutdown();
+
+	delete g_theDebugRenderer;
+	g_theDebugRenderer = nullptr;
+
+	delete g_theRenderer;
+	g_theRenderer = nullptr;
+
+	return result;
+}
@@ -0,0 +1,88 @@
+#include "Game/MappedFile.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+MappedFile::~MappedFile()
+{
+	Unmap();
+}
+
+
+bool MappedFile::Map(const std::string& file_path)
+{
+	Unmap();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	HANDLE mapping = nullptr;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+
+	// the view keeps the file and the mapping alive on its own
+	if (mapping != nullptr)
+	{
+		m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		m_size = m_data != nullptr ? static_cast<size_t>(file_size.QuadPart) : 0;
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+#else
+	const int file = open(file_path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat file_stat;
+	if (fstat(file, &file_stat) == 0 && file_stat.st_size > 0)
+	{
+		void* data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		if (data != MAP_FAILED)
+		{
+			m_data = static_cast<const uint8_t*>(data);
+			m_size = static_cast<size_t>(file_stat.st_size);
+		}
+	}
+
+	// the mapping keeps the file alive on its own
+	close(file);
+#endif
+
+	return m_data != nullptr;
+}
+
+
+void MappedFile::Unmap()
+{
+	if (m_data == nullptr)
+	{
+		return;
+	}
+
+#if defined(_WIN32)
+	UnmapViewOfFile(m_data);
+#else
+	munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+}
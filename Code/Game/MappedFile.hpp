@@ -0,0 +1,33 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//-----------------------------------------------------------------------------------------------
+// MappedFile
+//
+// A whole file mapped read-only into memory, for formats that are used in place instead of parsed:
+// WorldSnapshot and trajectory playback. Pages are only read from disk when first touched.
+//
+
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool	Map(const std::string& file_path);		// false if missing, empty or not mappable
+	void	Unmap();
+	bool	IsMapped() const { return m_data != nullptr; }
+
+	const uint8_t*	GetData() const { return m_data; }
+	size_t			GetSize() const { return m_size; }
+
+private:
+	const uint8_t*	m_data = nullptr;
+	size_t			m_size = 0;
+};
@@ -34,7 +34,7 @@ public:
 	float	GetRotationDegrees() const;
 	
 	// Mutators
-	void SetVelocity(const Vec2& new_vel);
+	virtual void SetVelocity(const Vec2& new_vel);
 	void SetMaxSpeed(float new_max_speed);
 	void SetMaxForce(float new_max_force);
 	void SetForward(const Vec2& new_forward_normal);
@@ -0,0 +1,350 @@
+#include "Game/NullRenderContext.hpp"
+#if defined(GAME_HEADLESS)
+#include <cstring>
+
+RenderContext*	g_theRenderer = nullptr;
+DebugRender*	g_theDebugRenderer = nullptr;
+
+
+//-----------------------------------------------------------------------------------------------
+void RenderStats::Accumulate(const RenderStats& other)
+{
+	m_drawCalls += other.m_drawCalls;
+	m_verticesDrawn += other.m_verticesDrawn;
+	m_indicesDrawn += other.m_indicesDrawn;
+	m_bytesDrawn += other.m_bytesDrawn;
+	m_bytesUploaded += other.m_bytesUploaded;
+	m_meshesCreated += other.m_meshesCreated;
+	m_meshesDestroyed += other.m_meshesDestroyed;
+	m_materialBinds += other.m_materialBinds;
+	m_modelMatrixBinds += other.m_modelMatrixBinds;
+	m_stateChanges += other.m_stateChanges;
+	m_cameraPasses += other.m_cameraPasses;
+	m_clears += other.m_clears;
+	m_resourceLookups += other.m_resourceLookups;
+	m_resourcesCreated += other.m_resourcesCreated;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Shader::SetDepth(const eCompareOp compare_op, const bool write)
+{
+	m_depthCompare = compare_op;
+	m_writeDepth = write;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Material::Material(RenderContext* owner) : m_owner(owner)
+{
+}
+
+
+void Material::SetShader(const char* shader_name)
+{
+	m_shader = m_owner->CreateOrGetShader(shader_name);
+}
+
+
+void Material::SetDiffuseMap(TextureView* view)
+{
+	m_diffuseMap = view;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+GPUMesh::GPUMesh(RenderContext* owner) : m_owner(owner)
+{
+}
+
+
+GPUMesh::~GPUMesh()
+{
+	m_owner->RecordMeshRelease(m_residentBytes);
+}
+
+
+void GPUMesh::RecordUpload(const uint vertex_count, const uint index_count, const size_t vertex_stride)
+{
+	const size_t new_bytes = vertex_count * vertex_stride + index_count * sizeof(uint);
+	m_owner->RecordMeshUpload(m_residentBytes, new_bytes);
+
+	m_vertexCount = vertex_count;
+	m_indexCount = index_count;
+	m_residentBytes = new_bytes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Camera::SetColorTarget(ColorTargetView* color_target)
+{
+	m_colorTarget = color_target;
+}
+
+
+void Camera::SetOrthoView(const Vec2& bottom_left, const Vec2& top_right)
+{
+	m_orthoMin = bottom_left;
+	m_orthoMax = top_right;
+}
+
+
+void Camera::SetModelMatrix(const Matrix44& model)
+{
+	m_modelMatrix = model;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DebugRender::BeginFrame()
+{
+}
+
+
+void DebugRender::EndFrame()
+{
+}
+
+
+void DebugRender::RenderToCamera(Camera* camera)
+{
+	UNUSED(camera);
+}
+
+
+void DebugRender::RenderToScreen()
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+RenderContext::RenderContext()
+{
+}
+
+
+RenderContext::~RenderContext()
+{
+	for (std::map<std::string, Material*>::iterator it = m_materials.begin(); it != m_materials.end(); ++it)
+	{
+		delete it->second;
+	}
+
+	for (std::map<std::string, Shader*>::iterator it = m_shaders.begin(); it != m_shaders.end(); ++it)
+	{
+		delete it->second;
+	}
+
+	for (std::map<std::string, TextureView2D*>::iterator it = m_textures.begin(); it != m_textures.end(); ++it)
+	{
+		delete it->second;
+	}
+}
+
+
+void RenderContext::BeginFrame()
+{
+	// anything recorded since the last frame (startup, mesh uploads) still counts towards the totals
+	m_totalStats.Accumulate(m_frameStats);
+	m_frameStats = RenderStats();
+	m_boundMaterial = nullptr;
+	m_boundShader = nullptr;
+	m_boundDiffuse = nullptr;
+}
+
+
+void RenderContext::EndFrame()
+{
+	++m_frameCount;
+}
+
+
+ColorTargetView* RenderContext::GetFrameColorTarget()
+{
+	return &m_frameColorTarget;
+}
+
+
+void RenderContext::BeginCamera(Camera* camera)
+{
+	m_activeCamera = camera;
+	++m_frameStats.m_cameraPasses;
+}
+
+
+void RenderContext::EndCamera(Camera* camera)
+{
+	UNUSED(camera);
+	m_activeCamera = nullptr;
+}
+
+
+void RenderContext::ClearScreen(const Rgba& clear_color)
+{
+	UNUSED(clear_color);
+	++m_frameStats.m_clears;
+}
+
+
+void RenderContext::ClearDepthStencilTarget(const float depth)
+{
+	UNUSED(depth);
+	++m_frameStats.m_clears;
+}
+
+
+void RenderContext::BindModelMatrix(const Matrix44& model)
+{
+	++m_frameStats.m_modelMatrixBinds;
+	if (memcmp(&m_boundModel, &model, sizeof(Matrix44)) != 0)
+	{
+		m_boundModel = model;
+		++m_frameStats.m_stateChanges;
+	}
+}
+
+
+void RenderContext::BindMaterial(const Material& material)
+{
+	++m_frameStats.m_materialBinds;
+	if (m_boundMaterial == &material)
+	{
+		return;
+	}
+
+	// a new material only costs what it actually changes in the pipeline
+	m_boundMaterial = &material;
+	if (m_boundShader != material.m_shader)
+	{
+		m_boundShader = material.m_shader;
+		++m_frameStats.m_stateChanges;
+	}
+
+	if (m_boundDiffuse != material.m_diffuseMap)
+	{
+		m_boundDiffuse = material.m_diffuseMap;
+		++m_frameStats.m_stateChanges;
+	}
+}
+
+
+void RenderContext::DrawMesh(const GPUMesh& mesh)
+{
+	++m_frameStats.m_drawCalls;
+	m_frameStats.m_verticesDrawn += mesh.GetVertexCount();
+	m_frameStats.m_indicesDrawn += mesh.GetIndexCount();
+}
+
+
+void RenderContext::DrawVertexArray(const std::vector<Vertex_PCU>& vertices)
+{
+	++m_frameStats.m_drawCalls;
+	m_frameStats.m_verticesDrawn += vertices.size();
+	m_frameStats.m_bytesDrawn += vertices.size() * sizeof(Vertex_PCU);
+}
+
+
+Shader* RenderContext::CreateOrGetShader(const std::string& file_name)
+{
+	++m_frameStats.m_resourceLookups;
+	std::map<std::string, Shader*>::iterator found = m_shaders.find(file_name);
+	if (found != m_shaders.end())
+	{
+		return found->second;
+	}
+
+	++m_frameStats.m_resourcesCreated;
+	Shader* shader = new Shader();
+	shader->m_name = file_name;
+	m_shaders[file_name] = shader;
+	return shader;
+}
+
+
+Material* RenderContext::CreateOrGetMaterial(const std::string& name, const bool from_file)
+{
+	UNUSED(from_file);
+	++m_frameStats.m_resourceLookups;
+	std::map<std::string, Material*>::iterator found = m_materials.find(name);
+	if (found != m_materials.end())
+	{
+		return found->second;
+	}
+
+	++m_frameStats.m_resourcesCreated;
+	Material* material = new Material(this);
+	m_materials[name] = material;
+	return material;
+}
+
+
+TextureView2D* RenderContext::CreateOrGetTextureView2D(const std::string& name)
+{
+	++m_frameStats.m_resourceLookups;
+	std::map<std::string, TextureView2D*>::iterator found = m_textures.find(name);
+	if (found != m_textures.end())
+	{
+		return found->second;
+	}
+
+	++m_frameStats.m_resourcesCreated;
+	TextureView2D* texture = new TextureView2D();
+	texture->m_name = name;
+	m_textures[name] = texture;
+	return texture;
+}
+
+
+const RenderStats& RenderContext::GetFrameStats() const
+{
+	return m_frameStats;
+}
+
+
+RenderStats RenderContext::GetTotalStats() const
+{
+	RenderStats total = m_totalStats;
+	total.Accumulate(m_frameStats);
+	return total;
+}
+
+
+uint64_t RenderContext::GetFrameCount() const
+{
+	return m_frameCount;
+}
+
+
+size_t RenderContext::GetResidentMeshBytes() const
+{
+	return m_residentMeshBytes;
+}
+
+
+void RenderContext::ResetStats()
+{
+	m_frameStats = RenderStats();
+	m_totalStats = RenderStats();
+	m_frameCount = 0;
+}
+
+
+void RenderContext::RecordMeshUpload(const size_t old_bytes, const size_t new_bytes)
+{
+	if (old_bytes == 0)
+	{
+		++m_frameStats.m_meshesCreated;
+	}
+
+	m_frameStats.m_bytesUploaded += new_bytes;
+	m_residentMeshBytes = m_residentMeshBytes - old_bytes + new_bytes;
+}
+
+
+void RenderContext::RecordMeshRelease(const size_t bytes)
+{
+	++m_frameStats.m_meshesDestroyed;
+	m_residentMeshBytes -= bytes;
+}
+
+#endif
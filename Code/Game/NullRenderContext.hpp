@@ -0,0 +1,215 @@
+#pragma once
+#if defined(GAME_HEADLESS)
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Matrix44.hpp"
+#include "Engine/Core/Rgba.hpp"
+#include "Engine/Core/CPUMesh.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// NullRenderContext.hpp
+//
+// Recording stand-in for the DX11 renderer, used when the game is built with GAME_HEADLESS.
+// It mirrors the subset of RenderContext / GPUMesh / Material / Shader / Camera / DebugRender
+// the game calls, never touches a GPU, and tallies calls, bytes and state changes instead.
+//
+
+class RenderContext;
+
+enum eCompareOp
+{
+	COMPARE_NEVER,
+	COMPARE_LESS,
+	COMPARE_EQUAL,
+	COMPARE_LESS_EQUAL,
+	COMPARE_GREATER,
+	COMPARE_GREATER_EQUAL,
+	COMPARE_NOT_EQUAL,
+	COMPARE_ALWAYS
+};
+
+
+struct RenderStats
+{
+	uint64_t m_drawCalls = 0;
+	uint64_t m_verticesDrawn = 0;
+	uint64_t m_indicesDrawn = 0;
+	uint64_t m_bytesDrawn = 0;			// vertex bytes pushed through immediate draws
+	uint64_t m_bytesUploaded = 0;		// vertex + index bytes copied into GPU meshes
+	uint64_t m_meshesCreated = 0;
+	uint64_t m_meshesDestroyed = 0;
+	uint64_t m_materialBinds = 0;
+	uint64_t m_modelMatrixBinds = 0;
+	uint64_t m_stateChanges = 0;		// binds that actually changed material, shader, texture or model
+	uint64_t m_cameraPasses = 0;
+	uint64_t m_clears = 0;
+	uint64_t m_resourceLookups = 0;		// CreateOrGet* calls
+	uint64_t m_resourcesCreated = 0;	// CreateOrGet* calls that missed the cache
+
+	void Accumulate(const RenderStats& other);
+};
+
+
+class TextureView
+{
+public:
+	std::string m_name;
+};
+
+
+class TextureView2D : public TextureView
+{
+};
+
+
+class ColorTargetView
+{
+};
+
+
+class Shader
+{
+public:
+	std::string	m_name;
+	eCompareOp	m_depthCompare = COMPARE_LESS_EQUAL;
+	bool		m_writeDepth = true;
+
+public:
+	void SetDepth(eCompareOp compare_op, bool write);
+};
+
+
+class Material
+{
+public:
+	RenderContext*	m_owner = nullptr;
+	Shader*			m_shader = nullptr;
+	TextureView*	m_diffuseMap = nullptr;
+
+public:
+	explicit Material(RenderContext* owner);
+	void SetShader(const char* shader_name);
+	void SetDiffuseMap(TextureView* view);
+};
+
+
+class GPUMesh
+{
+private:
+	RenderContext*	m_owner = nullptr;
+	uint			m_vertexCount = 0;
+	uint			m_indexCount = 0;
+	size_t			m_residentBytes = 0;
+
+public:
+	explicit GPUMesh(RenderContext* owner);
+	~GPUMesh();
+
+	template <typename VERTEX_TYPE>
+	void CreateFromCPUMesh(const CPUMesh& mesh);
+
+	uint	GetVertexCount() const	{ return m_vertexCount; }
+	uint	GetIndexCount() const	{ return m_indexCount; }
+	size_t	GetResidentBytes() const	{ return m_residentBytes; }
+
+private:
+	void RecordUpload(uint vertex_count, uint index_count, size_t vertex_stride);
+};
+
+
+class Camera
+{
+public:
+	ColorTargetView*	m_colorTarget = nullptr;
+	Matrix44			m_modelMatrix;
+	Vec2				m_orthoMin = Vec2::ZERO;
+	Vec2				m_orthoMax = Vec2::ZERO;
+
+public:
+	void SetColorTarget(ColorTargetView* color_target);
+	void SetOrthoView(const Vec2& bottom_left, const Vec2& top_right);
+	void SetModelMatrix(const Matrix44& model);
+};
+
+
+class DebugRender
+{
+public:
+	void BeginFrame();
+	void EndFrame();
+	void RenderToCamera(Camera* camera);
+	void RenderToScreen();
+};
+
+
+class RenderContext
+{
+private:
+	std::map<std::string, Shader*>			m_shaders;
+	std::map<std::string, Material*>		m_materials;
+	std::map<std::string, TextureView2D*>	m_textures;
+	ColorTargetView							m_frameColorTarget;
+
+	// Currently bound state, used to tell real state changes from redundant binds
+	const Material*		m_boundMaterial = nullptr;
+	const Shader*		m_boundShader = nullptr;
+	const TextureView*	m_boundDiffuse = nullptr;
+	Matrix44			m_boundModel;
+	Camera*				m_activeCamera = nullptr;
+
+	RenderStats	m_frameStats;
+	RenderStats	m_totalStats;
+	uint64_t	m_frameCount = 0;
+	size_t		m_residentMeshBytes = 0;
+
+public:
+	RenderContext();
+	~RenderContext();
+
+	void BeginFrame();
+	void EndFrame();
+
+	ColorTargetView*	GetFrameColorTarget();
+	void	BeginCamera(Camera* camera);
+	void	EndCamera(Camera* camera);
+	void	ClearScreen(const Rgba& clear_color);
+	void	ClearDepthStencilTarget(float depth = 1.0f);
+
+	void	BindModelMatrix(const Matrix44& model);
+	void	BindMaterial(const Material& material);
+	void	DrawMesh(const GPUMesh& mesh);
+	void	DrawVertexArray(const std::vector<Vertex_PCU>& vertices);
+
+	Shader*			CreateOrGetShader(const std::string& file_name);
+	Material*		CreateOrGetMaterial(const std::string& name, bool from_file = true);
+	TextureView2D*	CreateOrGetTextureView2D(const std::string& name);
+
+	// Recording
+	const RenderStats&	GetFrameStats() const;
+	RenderStats			GetTotalStats() const;
+	uint64_t			GetFrameCount() const;
+	size_t				GetResidentMeshBytes() const;
+	void				ResetStats();
+
+	void	RecordMeshUpload(size_t old_bytes, size_t new_bytes);
+	void	RecordMeshRelease(size_t bytes);
+};
+
+
+extern RenderContext*	g_theRenderer;
+extern DebugRender*		g_theDebugRenderer;
+
+
+//-----------------------------------------------------------------------------------------------
+template <typename VERTEX_TYPE>
+void GPUMesh::CreateFromCPUMesh(const CPUMesh& mesh)
+{
+	RecordUpload(mesh.GetVertexCount(), mesh.GetIndexCount(), sizeof(VERTEX_TYPE));
+}
+
+#endif
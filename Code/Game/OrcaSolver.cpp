@@ -0,0 +1,358 @@
+#include "Game/OrcaSolver.hpp"
+#include "Game/GameJobs.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+#include "Game/TraceRecorder.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// below this the solver treats directions as parallel and lengths as zero
+constexpr float ORCA_EPSILON = 0.00001f;
+
+
+static float Det(const Vec2& a, const Vec2& b)
+{
+	return a.x * b.y - a.y * b.x;
+}
+
+
+static float Dot(const Vec2& a, const Vec2& b)
+{
+	return a.x * b.x + a.y * b.y;
+}
+
+
+void OrcaSolver::Solve(const std::vector<OrcaAgent>& agents, const std::vector<uint>& solve_indices,
+	const float time_step)
+{
+	GAME_TRACE_SCOPE("OrcaSolver::Solve");
+	const double solve_begin = FrameTimeStats::GetTimeSeconds();
+
+	const uint num_agents = static_cast<uint>(agents.size());
+	const uint num_solved = static_cast<uint>(solve_indices.size());
+	m_agents = agents.data();
+	m_solveIndices = solve_indices.data();
+
+	m_positions.resize(num_agents);
+	m_velocities.resize(num_agents);
+	for (uint agent_idx = 0; agent_idx < num_agents; ++agent_idx)
+	{
+		m_positions[agent_idx] = agents[agent_idx].m_position;
+		m_velocities[agent_idx] = agents[agent_idx].m_preferredVelocity;
+	}
+
+	// cells of one neighbor distance keep every query within a 3x3 block
+	if (m_wrapDomain != nullptr)
+	{
+		m_neighborHash.Build(m_positions.data(), num_agents, m_neighborDistance, *m_wrapDomain);
+	}
+	else
+	{
+		m_neighborHash.Build(m_positions.data(), num_agents, m_neighborDistance);
+	}
+	m_iterations.store(0, std::memory_order_relaxed);
+
+	auto solve_range = [this, time_step](const uint begin, const uint end)
+	{
+		uint iterations = 0;
+		for (uint solve_idx = begin; solve_idx < end; ++solve_idx)
+		{
+			const uint agent_idx = m_solveIndices[solve_idx];
+			iterations += SolveAgent(agent_idx, time_step, m_velocities[agent_idx]);
+		}
+		m_iterations.fetch_add(iterations, std::memory_order_relaxed);
+	};
+	GameJobs::ParallelFor(num_solved, PARALLEL_GRAIN, solve_range);
+
+	m_agents = nullptr;
+	m_solveIndices = nullptr;
+	m_numSolvedLastTick = num_solved;
+	m_iterationsLastTick = m_iterations.load(std::memory_order_relaxed);
+	m_lastSolveSeconds = FrameTimeStats::GetTimeSeconds() - solve_begin;
+}
+
+
+uint OrcaSolver::SolveAgent(const uint agent_idx, const float time_step, Vec2& out_velocity) const
+{
+	const OrcaAgent& agent = m_agents[agent_idx];
+
+	SpatialNeighbor neighbors[MAX_NEIGHBORS];
+	const uint num_neighbors = m_neighborHash.QueryNearest(agent.m_position, m_neighborDistance, agent_idx,
+		m_maxNeighbors, neighbors);
+
+	const float inverse_time_horizon = 1.0f / m_timeHorizon;
+	const float inverse_time_step = 1.0f / time_step;
+
+	OrcaLine lines[MAX_NEIGHBORS];
+	for (uint neighbor_idx = 0; neighbor_idx < num_neighbors; ++neighbor_idx)
+	{
+		const uint other_idx = neighbors[neighbor_idx].m_index;
+		const OrcaAgent& other = m_agents[other_idx];
+
+		const Vec2& relative_position = neighbors[neighbor_idx].m_displacement;	// across the seam on a torus
+		const Vec2 relative_velocity = agent.m_velocity - other.m_velocity;
+		const float distance_sq = Dot(relative_position, relative_position);
+		const float combined_radius = agent.m_radius + other.m_radius;
+		const float combined_radius_sq = combined_radius * combined_radius;
+
+		OrcaLine& line = lines[neighbor_idx];
+		Vec2 u;
+
+		if (distance_sq > combined_radius_sq)
+		{
+			// no collision yet, vector from the cutoff center to the relative velocity
+			const Vec2 w = relative_velocity - relative_position * inverse_time_horizon;
+			const float w_length_sq = Dot(w, w);
+			const float dot_product = Dot(w, relative_position);
+
+			if (dot_product < 0.0f && dot_product * dot_product > combined_radius_sq * w_length_sq)
+			{
+				// closest to the cutoff circle
+				const float w_length = std::sqrt(w_length_sq);
+				const Vec2 unit_w = w / w_length;
+				line.m_direction = Vec2(unit_w.y, -unit_w.x);
+				u = unit_w * (combined_radius * inverse_time_horizon - w_length);
+			}
+			else
+			{
+				// closest to one of the legs of the cone
+				const float leg = std::sqrt(distance_sq - combined_radius_sq);
+				if (Det(relative_position, w) > 0.0f)
+				{
+					line.m_direction = Vec2(
+						relative_position.x * leg - relative_position.y * combined_radius,
+						relative_position.x * combined_radius + relative_position.y * leg) / distance_sq;
+				}
+				else
+				{
+					line.m_direction = Vec2(
+						-relative_position.x * leg - relative_position.y * combined_radius,
+						relative_position.x * combined_radius - relative_position.y * leg) / distance_sq;
+				}
+
+				u = line.m_direction * Dot(relative_velocity, line.m_direction) - relative_velocity;
+			}
+		}
+		else
+		{
+			// already overlapping, separate within one time step
+			const Vec2 w = relative_velocity - relative_position * inverse_time_step;
+			const float w_length = std::sqrt(Dot(w, w));
+
+			// exactly coincident and co-moving, push apart along x in index order so both agree
+			Vec2 unit_w = Vec2(agent_idx < other_idx ? 1.0f : -1.0f, 0.0f);
+			if (w_length > ORCA_EPSILON)
+			{
+				unit_w = w / w_length;
+			}
+
+			line.m_direction = Vec2(unit_w.y, -unit_w.x);
+			u = unit_w * (combined_radius * inverse_time_step - w_length);
+		}
+
+		// reciprocal, each side takes half of the correction
+		line.m_point = agent.m_velocity + u * 0.5f;
+	}
+
+	uint iterations = 0;
+	Vec2 new_velocity = Vec2::ZERO;
+	const uint line_fail = LinearProgram2(lines, num_neighbors, agent.m_maxSpeed, agent.m_preferredVelocity,
+		false, new_velocity, iterations);
+	if (line_fail < num_neighbors)
+	{
+		LinearProgram3(lines, num_neighbors, line_fail, agent.m_maxSpeed, new_velocity, iterations);
+	}
+
+	out_velocity = new_velocity;
+	return iterations;
+}
+
+
+void OrcaSolver::Clear()
+{
+	m_velocities.clear();
+	m_numSolvedLastTick = 0;
+	m_iterationsLastTick = 0;
+	m_lastSolveSeconds = 0.0;
+}
+
+
+void OrcaSolver::SetTimeHorizon(const float time_horizon)
+{
+	m_timeHorizon = time_horizon;
+}
+
+
+void OrcaSolver::SetNeighborDistance(const float neighbor_distance)
+{
+	m_neighborDistance = neighbor_distance;
+}
+
+
+void OrcaSolver::SetMaxNeighbors(const uint max_neighbors)
+{
+	m_maxNeighbors = std::min(max_neighbors, MAX_NEIGHBORS);
+}
+
+
+void OrcaSolver::SetWrapDomain(const WrapDomain* wrap_domain)
+{
+	m_wrapDomain = wrap_domain;
+}
+
+
+STATIC bool OrcaSolver::LinearProgram1(const OrcaLine* lines, const uint line_no, const float radius,
+	const Vec2& opt_velocity, const bool direction_opt, Vec2& result)
+{
+	const OrcaLine& line = lines[line_no];
+	const float dot_product = Dot(line.m_point, line.m_direction);
+	const float discriminant = dot_product * dot_product + radius * radius - Dot(line.m_point, line.m_point);
+
+	if (discriminant < 0.0f)
+	{
+		// the max speed circle misses the line entirely
+		return false;
+	}
+
+	const float sqrt_discriminant = std::sqrt(discriminant);
+	float t_left = -dot_product - sqrt_discriminant;
+	float t_right = -dot_product + sqrt_discriminant;
+
+	for (uint other_no = 0; other_no < line_no; ++other_no)
+	{
+		const OrcaLine& other = lines[other_no];
+		const float denominator = Det(line.m_direction, other.m_direction);
+		const float numerator = Det(other.m_direction, line.m_point - other.m_point);
+
+		if (std::fabs(denominator) <= ORCA_EPSILON)
+		{
+			// parallel, either entirely permitted or entirely not
+			if (numerator < 0.0f)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const float t = numerator / denominator;
+		if (denominator >= 0.0f)
+		{
+			t_right = std::min(t_right, t);
+		}
+		else
+		{
+			t_left = std::max(t_left, t);
+		}
+
+		if (t_left > t_right)
+		{
+			return false;
+		}
+	}
+
+	if (direction_opt)
+	{
+		const float t = Dot(opt_velocity, line.m_direction) > 0.0f ? t_right : t_left;
+		result = line.m_point + line.m_direction * t;
+	}
+	else
+	{
+		const float t = Dot(line.m_direction, opt_velocity - line.m_point);
+		result = line.m_point + line.m_direction * std::min(std::max(t, t_left), t_right);
+	}
+
+	return true;
+}
+
+
+STATIC uint OrcaSolver::LinearProgram2(const OrcaLine* lines, const uint num_lines, const float radius,
+	const Vec2& opt_velocity, const bool direction_opt, Vec2& result, uint& iterations)
+{
+	const float opt_length_sq = Dot(opt_velocity, opt_velocity);
+	if (direction_opt)
+	{
+		// opt_velocity is a unit direction here
+		result = opt_velocity * radius;
+	}
+	else if (opt_length_sq > radius * radius)
+	{
+		result = opt_velocity * (radius / std::sqrt(opt_length_sq));
+	}
+	else
+	{
+		result = opt_velocity;
+	}
+
+	for (uint line_no = 0; line_no < num_lines; ++line_no)
+	{
+		if (Det(lines[line_no].m_direction, lines[line_no].m_point - result) <= 0.0f)
+		{
+			continue;
+		}
+
+		// the current result violates this line, the new optimum lies on it
+		++iterations;
+		const Vec2 previous_result = result;
+		if (!LinearProgram1(lines, line_no, radius, opt_velocity, direction_opt, result))
+		{
+			result = previous_result;
+			return line_no;
+		}
+	}
+
+	return num_lines;
+}
+
+
+STATIC void OrcaSolver::LinearProgram3(const OrcaLine* lines, const uint num_lines, const uint begin_line,
+	const float radius, Vec2& result, uint& iterations)
+{
+	float distance = 0.0f;
+
+	for (uint line_no = begin_line; line_no < num_lines; ++line_no)
+	{
+		const OrcaLine& line = lines[line_no];
+		if (Det(line.m_direction, line.m_point - result) <= distance)
+		{
+			continue;
+		}
+
+		// minimize the largest violation: solve on the bisectors of this line with the earlier ones
+		OrcaLine projected_lines[MAX_NEIGHBORS];
+		uint num_projected = 0;
+		for (uint other_no = 0; other_no < line_no; ++other_no)
+		{
+			const OrcaLine& other = lines[other_no];
+			OrcaLine& projected = projected_lines[num_projected];
+
+			const float determinant = Det(line.m_direction, other.m_direction);
+			if (std::fabs(determinant) <= ORCA_EPSILON)
+			{
+				if (Dot(line.m_direction, other.m_direction) > 0.0f)
+				{
+					// same direction, the other line adds nothing
+					continue;
+				}
+				projected.m_point = (line.m_point + other.m_point) * 0.5f;
+			}
+			else
+			{
+				projected.m_point = line.m_point + line.m_direction *
+					(Det(other.m_direction, line.m_point - other.m_point) / determinant);
+			}
+
+			projected.m_direction = (other.m_direction - line.m_direction).GetNormalized();
+			++num_projected;
+		}
+
+		const Vec2 previous_result = result;
+		const Vec2 inward = Vec2(-line.m_direction.y, line.m_direction.x);
+		if (LinearProgram2(projected_lines, num_projected, radius, inward, true, result, iterations) < num_projected)
+		{
+			// can only fail through float error, keep what we had
+			result = previous_result;
+		}
+
+		distance = Det(line.m_direction, line.m_point - result);
+	}
+}
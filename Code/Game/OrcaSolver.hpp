@@ -0,0 +1,94 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/SpatialHash.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <atomic>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// OrcaSolver
+//
+// Reciprocal agent-agent avoidance (optimal reciprocal collision avoidance, as in RVO2). Every agent
+// that asks for it turns each of its k nearest neighbors into a half-plane of velocities that stay
+// collision free for the time horizon, taking half of the avoidance effort itself, and picks the
+// velocity closest to its preferred one inside all of them with a 2D linear program. When the
+// half-planes leave nothing, the velocity that violates them least is used instead.
+//
+// Neighbors come from a SpatialHash rebuilt every Solve. Agents only read the shared snapshot and
+// write their own output slot, so the per-agent solves run on GameJobs without locks. Given a
+// WrapDomain, agents on opposite sides of a seam see each other at their minimum image distance.
+//
+
+struct OrcaAgent
+{
+	Vec2	m_position = Vec2::ZERO;
+	Vec2	m_velocity = Vec2::ZERO;
+	Vec2	m_preferredVelocity = Vec2::ZERO;
+	float	m_radius = 1.0f;
+	float	m_maxSpeed = 1.0f;
+};
+
+
+struct OrcaLine
+{
+	Vec2	m_point = Vec2::ZERO;
+	Vec2	m_direction = Vec2::ZERO;	// unit length, permitted velocities lie to its left
+};
+
+
+class OrcaSolver
+{
+public:
+	static constexpr uint	MAX_NEIGHBORS = 10;
+	static constexpr float	DEFAULT_TIME_HORIZON = 2.0f;
+	static constexpr float	DEFAULT_NEIGHBOR_DISTANCE = 15.0f;
+	static constexpr uint	PARALLEL_GRAIN = 256;
+
+public:
+	// solves every agent listed in solve_indices against all of agents, results via GetVelocity
+	void	Solve(const std::vector<OrcaAgent>& agents, const std::vector<uint>& solve_indices,
+		float time_step);
+
+	// returns the number of 1D programs run, the solver's unit of work
+	uint	SolveAgent(uint agent_idx, float time_step, Vec2& out_velocity) const;
+
+	// forgets last tick's results, once nobody avoids agents any more
+	void	Clear();
+
+	const Vec2&	GetVelocity(uint agent_idx) const { return m_velocities[agent_idx]; }
+	uint		GetNumAgents() const { return static_cast<uint>(m_velocities.size()); }
+
+	void	SetTimeHorizon(float time_horizon);
+	void	SetNeighborDistance(float neighbor_distance);
+	void	SetMaxNeighbors(uint max_neighbors);	// clamped to MAX_NEIGHBORS
+	void	SetWrapDomain(const WrapDomain* wrap_domain);	// nullptr for an open plane, the default
+
+	uint	GetNumSolvedLastTick() const { return m_numSolvedLastTick; }
+	uint64_t	GetIterationsLastTick() const { return m_iterationsLastTick; }
+	double	GetLastSolveSeconds() const { return m_lastSolveSeconds; }
+
+private:
+	static bool	LinearProgram1(const OrcaLine* lines, uint line_no, float radius, const Vec2& opt_velocity,
+		bool direction_opt, Vec2& result);
+	static uint	LinearProgram2(const OrcaLine* lines, uint num_lines, float radius, const Vec2& opt_velocity,
+		bool direction_opt, Vec2& result, uint& iterations);
+	static void	LinearProgram3(const OrcaLine* lines, uint num_lines, uint begin_line, float radius,
+		Vec2& result, uint& iterations);
+
+private:
+	float	m_timeHorizon = DEFAULT_TIME_HORIZON;
+	float	m_neighborDistance = DEFAULT_NEIGHBOR_DISTANCE;
+	uint	m_maxNeighbors = MAX_NEIGHBORS;
+	const WrapDomain*	m_wrapDomain = nullptr;
+
+	const OrcaAgent*		m_agents = nullptr;		// borrowed for the duration of Solve
+	const uint*				m_solveIndices = nullptr;
+	std::vector<Vec2>		m_positions;			// packed for the hash
+	std::vector<Vec2>		m_velocities;			// indexed like the agents
+	SpatialHash				m_neighborHash;
+	std::atomic<uint64_t>	m_iterations{ 0 };
+
+	uint		m_numSolvedLastTick = 0;
+	uint64_t	m_iterationsLastTick = 0;
+	double		m_lastSolveSeconds = 0.0;
+};
@@ -0,0 +1,18 @@
+#pragma once
+//-----------------------------------------------------------------------------------------------
+// RenderBackend.hpp
+//
+// Single include for everything the game draws through. The regular build uses the DX11
+// RenderContext from the Engine; headless builds (GAME_HEADLESS) swap in NullRenderContext, which
+// exposes the same calls but only counts them, so Game::Startup/Update/Render compile unchanged.
+//
+
+#if defined(GAME_HEADLESS)
+#include "Game/NullRenderContext.hpp"
+#else
+#include "Engine/Renderer/RenderContext.hpp"
+#include "Engine/Renderer/GPUMesh.hpp"
+#include "Engine/Renderer/Material.hpp"
+#include "Engine/Renderer/Shader.hpp"
+#include "Engine/Renderer/DebugRender.hpp"
+#endif
@@ -0,0 +1,119 @@
+#include "Game/SharedVisuals.hpp"
+#include "Game/RenderBackend.hpp"
+#include "Engine/Core/VertexUtils.hpp"
+
+#include <deque>
+#include <mutex>
+
+struct SharedMaterialDesc
+{
+	const char*	m_name;
+	const char*	m_shader;
+	const char*	m_texture;
+};
+
+
+struct SharedMeshEntry
+{
+	SharedMeshShape	m_shape;
+	float			m_size;
+	Rgba			m_color;
+	GPUMesh*		m_mesh;
+};
+
+
+// what each entity used to set up for itself in InitVisuals, indexed by SharedMaterial
+static const SharedMaterialDesc s_materialDescs[NUM_SHARED_MATERIALS] = {
+	{ "white",		"default_unlit.hlsl",	"0xFFFFFFFF" },
+	{ "black",		"default_lit.hlsl",		"0x000000FF" },
+	{ "red",		"default_lit.hlsl",		"0xFF0000FF" },
+	{ "Magenta",	"default_lit.hlsl",		"0xFF00FFFF" },
+};
+
+static Material*					s_materials[NUM_SHARED_MATERIALS] = { nullptr };
+static std::deque<SharedMeshEntry>	s_meshes;
+static std::mutex					s_sharedVisualsLock;
+
+
+STATIC Material* SharedVisuals::GetMaterial(const SharedMaterial material)
+{
+	std::lock_guard<std::mutex> lock(s_sharedVisualsLock);
+	if (s_materials[material] != nullptr)
+	{
+		return s_materials[material];
+	}
+
+	const SharedMaterialDesc& desc = s_materialDescs[material];
+	Material* resolved = g_theRenderer->CreateOrGetMaterial(desc.m_name, false);
+	resolved->SetShader(desc.m_shader);
+	resolved->m_shader->SetDepth(COMPARE_LESS_EQUAL, true);
+	TextureView* texture(reinterpret_cast<TextureView*>(g_theRenderer->CreateOrGetTextureView2D(desc.m_texture)));
+	resolved->SetDiffuseMap(texture);
+
+	s_materials[material] = resolved;
+	return resolved;
+}
+
+
+STATIC GPUMesh* SharedVisuals::CreateOrGetMesh(const SharedMeshShape shape, const float size, const Rgba& color)
+{
+	std::lock_guard<std::mutex> lock(s_sharedVisualsLock);
+	for (const SharedMeshEntry& entry : s_meshes)
+	{
+		if (entry.m_shape == shape && entry.m_size == size && entry.m_color == color)
+		{
+			return entry.m_mesh;
+		}
+	}
+
+	CPUMesh cpu_mesh;
+	switch (shape)
+	{
+		case SHARED_MESH_TRIANGLE:
+		{
+			CpuMeshAddTriangle(&cpu_mesh, size, color);
+			break;
+		}
+		case SHARED_MESH_DISC:
+		{
+			CpuMeshAddDisc(&cpu_mesh, color, size);
+			break;
+		}
+		case SHARED_MESH_LINE:
+		default:
+		{
+			CpuMeshAddLine(&cpu_mesh, Vec2::ZERO, Vec2(size, 0.0f), 1.0f, color);
+			break;
+		}
+	}
+
+	GPUMesh* mesh = new GPUMesh(g_theRenderer);
+	mesh->CreateFromCPUMesh<Vertex_Lit>(cpu_mesh);
+	s_meshes.push_back({ shape, size, color, mesh });
+	return mesh;
+}
+
+
+STATIC uint SharedVisuals::GetNumMeshes()
+{
+	std::lock_guard<std::mutex> lock(s_sharedVisualsLock);
+	return static_cast<uint>(s_meshes.size());
+}
+
+
+STATIC void SharedVisuals::Shutdown()
+{
+	std::lock_guard<std::mutex> lock(s_sharedVisualsLock);
+	for (SharedMeshEntry& entry : s_meshes)
+	{
+		delete entry.m_mesh;
+		entry.m_mesh = nullptr;
+	}
+	s_meshes.clear();
+
+	// the renderer owns the materials themselves
+	for (Material*& material : s_materials)
+	{
+		material = nullptr;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Engine/Core/Rgba.hpp"
+
+class GPUMesh;
+class Material;
+
+//-----------------------------------------------------------------------------------------------
+// SharedVisuals
+//
+// Flyweight meshes and materials for entities that all look alike. CreateOrGetMesh() builds a mesh
+// once per (shape, size, color) and hands every later caller the same immutable GPUMesh; GetMaterial()
+// resolves a material by name, sets it up once and returns the pointer from then on, so creating an
+// entity costs no uploads and no string lookups after the first of its kind.
+//
+// Entities never delete what they get from here (see BaseEntity::m_ownsMesh). Everything lives until
+// Shutdown(), which must run while the renderer still exists.
+//
+
+enum SharedMaterial
+{
+	SHARED_MATERIAL_VEHICLE = 0,
+	SHARED_MATERIAL_FORWARD,
+	SHARED_MATERIAL_STEERING,
+	SHARED_MATERIAL_OBSTACLE,
+
+	NUM_SHARED_MATERIALS
+};
+
+
+enum SharedMeshShape
+{
+	SHARED_MESH_TRIANGLE = 0,	// CpuMeshAddTriangle, size is the radius
+	SHARED_MESH_DISC,			// CpuMeshAddDisc, size is the radius
+	SHARED_MESH_LINE,			// from the origin to (size, 0), one unit thick
+
+	NUM_SHARED_MESH_SHAPES
+};
+
+
+class SharedVisuals
+{
+public:
+	static Material*	GetMaterial(SharedMaterial material);
+	static GPUMesh*		CreateOrGetMesh(SharedMeshShape shape, float size, const Rgba& color);
+
+	static uint			GetNumMeshes();
+	static void			Shutdown();
+};
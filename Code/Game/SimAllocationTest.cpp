@@ -0,0 +1,150 @@
+#include "Game/SimAllocationTest.hpp"
+#include "Game/SimScenario.hpp"
+#include "Game/Game.hpp"
+#include "Game/AllocationCounter.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+constexpr uint MAX_REPORTED_TICKS = 10;
+
+
+bool SimAllocationTest::ParseCommandLine(const int argc, char** argv)
+{
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--agents") == 0 && has_value)
+		{
+			m_numAgents = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--obstacles") == 0 && has_value)
+		{
+			m_numObstacles = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--walls") == 0 && has_value)
+		{
+			m_numWalls = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--warmup") == 0 && has_value)
+		{
+			m_warmupTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--ticks") == 0 && has_value)
+		{
+			m_numTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--dt") == 0 && has_value)
+		{
+			m_deltaSeconds = strtod(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--mix") == 0 && has_value)
+		{
+			m_mixSpec = argv[++arg_idx];
+		}
+		else if (strcmp(arg, "--no-dev") == 0)
+		{
+			m_devMode = false;
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+int SimAllocationTest::Run() const
+{
+	if (!AllocationCounter::CountsEveryAllocation())
+	{
+		printf("alloc-test: allocation counting is not compiled in (define GAME_COUNT_ALLOCATIONS)\n");
+		return 1;
+	}
+
+	std::vector<BehaviorWeight> mix;
+	std::vector<int> modifiers;
+	if (!SimScenario::ParseBehaviorMix(m_mixSpec, mix, modifiers))
+	{
+		return 1;
+	}
+
+	Game* game = new Game();
+	game->Startup();
+	game->SpawnObstacles(m_numObstacles);
+	game->SpawnWalls(m_numWalls);
+	game->SetNumVehicles(m_numAgents);
+	game->SetDeveloperMode(m_devMode);
+	SimScenario::ApplyBehaviorMix(game, mix, modifiers);
+
+	for (uint tick_idx = 0; tick_idx < m_warmupTicks; ++tick_idx)
+	{
+		game->Update(m_deltaSeconds);
+	}
+
+	uint num_failed_ticks = 0;
+	uint64_t total_allocations = 0;
+	const uint64_t bytes_begin = AllocationCounter::GetAllocatedBytes();
+	for (uint tick_idx = 0; tick_idx < m_numTicks; ++tick_idx)
+	{
+		const uint64_t tick_bytes_begin = AllocationCounter::GetAllocatedBytes();
+		game->Update(m_deltaSeconds);
+		const uint64_t tick_bytes = AllocationCounter::GetAllocatedBytes() - tick_bytes_begin;
+
+		const uint64_t allocations = game->GetAllocationsLastTick();
+		if (allocations == 0)
+		{
+			continue;
+		}
+
+		total_allocations += allocations;
+		if (++num_failed_ticks <= MAX_REPORTED_TICKS)
+		{
+			printf("tick %u: %llu allocations (%llu bytes)\n",
+				m_warmupTicks + tick_idx,
+				static_cast<unsigned long long>(allocations),
+				static_cast<unsigned long long>(tick_bytes));
+		}
+	}
+	const uint64_t total_bytes = AllocationCounter::GetAllocatedBytes() - bytes_begin;
+
+	game->Shutdown();
+	delete game;
+
+	if (num_failed_ticks > 0)
+	{
+		printf("alloc-test FAILED: %u of %u ticks allocated, %llu allocations, %llu bytes\n",
+			num_failed_ticks,
+			m_numTicks,
+			static_cast<unsigned long long>(total_allocations),
+			static_cast<unsigned long long>(total_bytes));
+		return 1;
+	}
+
+	printf("alloc-test passed: %u ticks after %u warm-up ticks, no allocations (agents %u, mix %s)\n",
+		m_numTicks, m_warmupTicks, m_numAgents, m_mixSpec.c_str());
+	return 0;
+}
+
+
+STATIC void SimAllocationTest::PrintUsage()
+{
+	printf(
+		"usage: Headless alloc-test [options]\n"
+		"  --agents N        number of simulated vehicles (default 1024)\n"
+		"  --obstacles N     extra obstacles (default 16)\n"
+		"  --walls N         extra walls (default 16)\n"
+		"  --warmup N        ticks allowed to allocate (default 60)\n"
+		"  --ticks N         ticks that must not allocate (default 600)\n"
+		"  --dt SECONDS      tick length (default 1/60)\n"
+		"  --mix SPEC        behavior mix (default every behavior plus obstacle and wall avoidance)\n"
+		"  --no-dev          leave developer mode (debug arrows) off\n"
+	);
+}
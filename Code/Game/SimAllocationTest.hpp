@@ -0,0 +1,31 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include <cstdint>
+#include <string>
+
+//-----------------------------------------------------------------------------------------------
+// SimAllocationTest
+//
+// Allocation budget check for the headless build: sets up a scenario, runs warm-up ticks so lazily
+// grown buffers reach their steady size, then fails (exit code 1) if any later Game::Update makes a
+// heap allocation. Needs the counting operator new from GAME_COUNT_ALLOCATIONS (AllocationCounter).
+//
+
+class SimAllocationTest
+{
+public:
+	uint		m_numAgents = 1'024;
+	uint		m_numObstacles = 16;
+	uint		m_numWalls = 16;
+	uint		m_warmupTicks = 60;
+	uint		m_numTicks = 600;
+	double		m_deltaSeconds = 1.0 / 60.0;
+	bool		m_devMode = true;		// also exercise the debug arrow path
+	std::string	m_mixSpec = "seek,flee,arrive,pursuit,evade,wander,+obstacle,+wall";
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	int		Run() const;
+
+	static void	PrintUsage();
+};
@@ -0,0 +1,370 @@
+#include "Game/SimBatch.hpp"
+#include "Game/GameJobs.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// groups of replicates summarized in the console, the CSV always has every world
+constexpr uint BATCH_MAX_PRINTED_GROUPS = 16;
+
+static const char* s_sweepNames[NUM_SWEEP_PARAMETERS] = {
+	"none", "wander-radius", "wander-jitter", "lookahead", "whiskers"
+};
+
+
+bool SimBatch::ParseCommandLine(const int argc, char** argv)
+{
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--worlds") == 0 && has_value)
+		{
+			m_numWorlds = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--replicates") == 0 && has_value)
+		{
+			m_numReplicates = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--agents") == 0 && has_value)
+		{
+			m_numAgents = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--ticks") == 0 && has_value)
+		{
+			m_numTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--obstacles") == 0 && has_value)
+		{
+			m_numObstacles = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--walls") == 0 && has_value)
+		{
+			m_numWalls = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--threads") == 0 && has_value)
+		{
+			m_numThreads = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--seed") == 0 && has_value)
+		{
+			m_seed = strtoull(argv[++arg_idx], nullptr, 0);
+		}
+		else if (strcmp(arg, "--dt") == 0 && has_value)
+		{
+			m_deltaSeconds = strtod(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--mix") == 0 && has_value)
+		{
+			m_mix.clear();
+			m_modifiers.clear();
+			if (!SimScenario::ParseBehaviorMix(argv[++arg_idx], m_mix, m_modifiers))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--sweep") == 0 && has_value)
+		{
+			if (!ParseSweep(argv[++arg_idx], m_sweepParameter, m_sweepMin, m_sweepMax))
+			{
+				printf("Bad sweep '%s', expected NAME:MIN:MAX\n", argv[arg_idx]);
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--scaling") == 0)
+		{
+			m_measureScaling = true;
+		}
+		else if (strcmp(arg, "--csv") == 0 && has_value)
+		{
+			m_csvPath = argv[++arg_idx];
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	if (m_numWorlds == 0 || m_numReplicates == 0 || m_numAgents == 0 || m_deltaSeconds <= 0.0)
+	{
+		printf("--worlds, --replicates, --agents and --dt must be positive\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+int SimBatch::Run() const
+{
+	std::vector<BatchWorldResult> results;
+
+	// the same batch on one thread first, what the parallel run is measured against
+	double serial_seconds = 0.0;
+	if (m_measureScaling)
+	{
+		GameJobs::Shutdown();
+		GameJobs::SetNumWorkers(0);
+		serial_seconds = RunWorlds(results);
+		GameJobs::Shutdown();
+	}
+
+	if (m_numThreads > 0)
+	{
+		GameJobs::Shutdown();
+		GameJobs::SetNumWorkers(m_numThreads - 1);
+	}
+	else if (m_measureScaling)
+	{
+		GameJobs::SetNumWorkers(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	}
+
+	const double batch_seconds = RunWorlds(results);
+
+	uint64_t total_updates = 0;
+	for (const BatchWorldResult& result : results)
+	{
+		total_updates += result.m_metrics.m_agentUpdates;
+	}
+
+	const uint num_threads = GameJobs::GetNumThreads();
+	const double world_ticks = static_cast<double>(m_numWorlds) * static_cast<double>(m_numTicks);
+	printf("worlds            %u (%u replicates per value), %u agents, %u ticks each\n",
+		m_numWorlds, m_numReplicates, m_numAgents, m_numTicks);
+	printf("threads           %u\n", num_threads);
+	printf("batch             %.3f s\n", batch_seconds);
+	printf("world-ticks/s     %.1f\n", world_ticks / batch_seconds);
+	printf("agent-updates/s   %.1f\n", static_cast<double>(total_updates) / batch_seconds);
+	if (m_measureScaling)
+	{
+		const double speedup = serial_seconds / batch_seconds;
+		printf("1 thread          %.3f s\n", serial_seconds);
+		printf("speedup           %.2fx (%.0f%% of linear)\n", speedup,
+			100.0 * speedup / static_cast<double>(num_threads));
+	}
+
+	PrintResults(results);
+	if (!m_csvPath.empty() && !WriteCsv(results))
+	{
+		printf("Could not write '%s'\n", m_csvPath.c_str());
+		return 1;
+	}
+
+	return 0;
+}
+
+
+double SimBatch::RunWorlds(std::vector<BatchWorldResult>& out_results) const
+{
+	out_results.assign(m_numWorlds, BatchWorldResult());
+
+	// one world per chunk, they run for seconds each so the shared counter is never contended
+	auto run_worlds = [this, &out_results](const uint begin, const uint end)
+	{
+		for (uint world_idx = begin; world_idx < end; ++world_idx)
+		{
+			out_results[world_idx] = RunWorld(world_idx);
+		}
+	};
+
+	const double batch_begin = FrameTimeStats::GetTimeSeconds();
+	GameJobs::ParallelFor(m_numWorlds, 1, run_worlds);
+	return FrameTimeStats::GetTimeSeconds() - batch_begin;
+}
+
+
+BatchWorldResult SimBatch::RunWorld(const uint world_idx) const
+{
+	BatchWorldResult result;
+	result.m_seed = SimRandom::CombineSeeds(m_seed, world_idx % m_numReplicates);
+	result.m_parameterValue = GetParameterValue(world_idx);
+
+	SteeringTuning tuning;
+	ApplyParameter(m_sweepParameter, result.m_parameterValue, tuning);
+
+	Game* game = new Game();
+	game->SetSeed(result.m_seed);
+	game->SetVisualsEnabled(false);
+	game->Startup();
+	game->SetSteeringTuning(tuning);
+	game->SpawnObstacles(m_numObstacles);
+	game->SpawnWalls(m_numWalls);
+	game->SetNumVehicles(m_numAgents);
+	SimScenario::ApplyBehaviorMix(game, m_mix, m_modifiers);
+	game->SetMetricsEnabled(true);
+
+	for (uint tick_idx = 0; tick_idx < m_numTicks; ++tick_idx)
+	{
+		game->Update(m_deltaSeconds);
+	}
+
+	result.m_metrics = game->GetMetrics();
+	game->Shutdown();
+	delete game;
+	return result;
+}
+
+
+float SimBatch::GetParameterValue(const uint world_idx) const
+{
+	const uint num_groups = (m_numWorlds + m_numReplicates - 1) / m_numReplicates;
+	if (m_sweepParameter == SWEEP_NONE || num_groups < 2)
+	{
+		return m_sweepMin;
+	}
+
+	const float fraction = static_cast<float>(world_idx / m_numReplicates) / static_cast<float>(num_groups - 1);
+	return m_sweepMin + (m_sweepMax - m_sweepMin) * fraction;
+}
+
+
+void SimBatch::PrintResults(const std::vector<BatchWorldResult>& results) const
+{
+	const uint num_groups = (m_numWorlds + m_numReplicates - 1) / m_numReplicates;
+	const uint group_stride = std::max(1u, (num_groups + BATCH_MAX_PRINTED_GROUPS - 1) / BATCH_MAX_PRINTED_GROUPS);
+
+	printf("\n%-16s %14s %16s %18s\n", s_sweepNames[m_sweepParameter], "collisions", "collisions/agent",
+		"distance/agent");
+	for (uint group_idx = 0; group_idx < num_groups; group_idx += group_stride)
+	{
+		const uint first_world = group_idx * m_numReplicates;
+		const uint end_world = std::min(first_world + m_numReplicates, m_numWorlds);
+
+		double collisions = 0.0;
+		double distance = 0.0;
+		for (uint world_idx = first_world; world_idx < end_world; ++world_idx)
+		{
+			collisions += static_cast<double>(results[world_idx].m_metrics.m_obstacleCollisions);
+			distance += results[world_idx].m_metrics.m_distanceTraveled;
+		}
+
+		// means over the group's replicates
+		const double num_worlds = static_cast<double>(end_world - first_world);
+		const double num_agents = num_worlds * static_cast<double>(m_numAgents);
+		printf("%-16.3f %14.1f %16.3f %18.1f\n", static_cast<double>(results[first_world].m_parameterValue),
+			collisions / num_worlds, collisions / num_agents, distance / num_agents);
+	}
+}
+
+
+bool SimBatch::WriteCsv(const std::vector<BatchWorldResult>& results) const
+{
+	FILE* file = fopen(m_csvPath.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(file, "world,seed,%s,ticks,agent_updates,obstacle_collisions,distance\n", s_sweepNames[m_sweepParameter]);
+	for (uint world_idx = 0; world_idx < m_numWorlds; ++world_idx)
+	{
+		const BatchWorldResult& result = results[world_idx];
+		fprintf(file, "%u,%llu,%g,%u,%llu,%llu,%.3f\n",
+			world_idx,
+			static_cast<unsigned long long>(result.m_seed),
+			static_cast<double>(result.m_parameterValue),
+			result.m_metrics.m_numTicks,
+			static_cast<unsigned long long>(result.m_metrics.m_agentUpdates),
+			static_cast<unsigned long long>(result.m_metrics.m_obstacleCollisions),
+			result.m_metrics.m_distanceTraveled);
+	}
+
+	fclose(file);
+	return true;
+}
+
+
+STATIC bool SimBatch::ParseSweep(const char* sweep_text, SweepParameter& out_parameter, float& out_min,
+	float& out_max)
+{
+	const char* first_colon = strchr(sweep_text, ':');
+	if (first_colon == nullptr)
+	{
+		return false;
+	}
+
+	const std::string name(sweep_text, first_colon);
+	for (int parameter_idx = SWEEP_NONE + 1; parameter_idx < NUM_SWEEP_PARAMETERS; ++parameter_idx)
+	{
+		if (name != s_sweepNames[parameter_idx])
+		{
+			continue;
+		}
+
+		char* range_end = nullptr;
+		out_min = static_cast<float>(strtod(first_colon + 1, &range_end));
+		if (*range_end != ':')
+		{
+			return false;
+		}
+
+		out_max = static_cast<float>(strtod(range_end + 1, nullptr));
+		out_parameter = static_cast<SweepParameter>(parameter_idx);
+		return true;
+	}
+
+	return false;
+}
+
+
+STATIC void SimBatch::ApplyParameter(const SweepParameter parameter, const float value, SteeringTuning& tuning)
+{
+	switch (parameter)
+	{
+		case SWEEP_WANDER_RADIUS:
+		{
+			tuning.m_wanderRadiusMin = value;
+			tuning.m_wanderRadiusMax = value;
+			break;
+		}
+		case SWEEP_WANDER_JITTER:
+		{
+			tuning.m_wanderJitterMin = value;
+			tuning.m_wanderJitterMax = value;
+			break;
+		}
+		case SWEEP_OBSTACLE_LOOK_AHEAD:
+		{
+			tuning.m_obstacleLookAhead = value;
+			break;
+		}
+		case SWEEP_NUM_WHISKERS:
+		{
+			tuning.m_numWhiskers = static_cast<uint>(std::lround(value));
+			break;
+		}
+		default: // SWEEP_NONE, the defaults Game uses
+		{
+			break;
+		}
+	}
+}
+
+
+STATIC void SimBatch::PrintUsage()
+{
+	printf(
+		"usage: Headless batch [options]\n"
+		"  --worlds N        independent worlds to simulate (default 256)\n"
+		"  --replicates N    worlds per sweep value, replicate r shares its seed across values (default 4)\n"
+		"  --agents N        vehicles per world (default 64)\n"
+		"  --ticks N         fixed-dt ticks per world (default 600)\n"
+		"  --obstacles N     extra obstacles per world (default 8)\n"
+		"  --walls N         extra walls per world (default 4)\n"
+		"  --mix SPEC        behavior mix as for run (default wander:1,+obstacle,+wall)\n"
+		"  --sweep P:MIN:MAX vary P evenly across the worlds, P is one of\n"
+		"                    wander-radius wander-jitter lookahead whiskers\n"
+		"  --seed N          base seed (default 0x5EED5EED5EED5EED)\n"
+		"  --threads N       worker threads including the caller (default one per core)\n"
+		"  --scaling         run the batch on one thread first and report the speedup\n"
+		"  --csv PATH        write every world's metrics\n"
+		"  --dt SECONDS      tick length (default 1/60)\n"
+	);
+}
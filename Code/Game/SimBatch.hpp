@@ -0,0 +1,78 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/SimScenario.hpp"
+#include "Game/Game.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// SimBatch
+//
+// Parameter sweep over many independent worlds. Each world is its own Game with its own seed, no
+// visuals and metrics on; one GameJobs chunk builds it, steps it to the end and tears it down, so
+// worlds share nothing mutable and the batch scales with the number of workers.
+//
+// Worlds come in groups of m_numReplicates: every group gets the next value of the swept parameter,
+// and replicate r of every group uses the same seed, so groups differ only in the parameter.
+//
+
+enum SweepParameter
+{
+	SWEEP_NONE = 0,
+	SWEEP_WANDER_RADIUS,
+	SWEEP_WANDER_JITTER,
+	SWEEP_OBSTACLE_LOOK_AHEAD,
+	SWEEP_NUM_WHISKERS,
+
+	NUM_SWEEP_PARAMETERS
+};
+
+
+struct BatchWorldResult
+{
+	uint64_t		m_seed = 0;
+	float			m_parameterValue = 0.0f;
+	WorldMetrics	m_metrics;
+};
+
+
+class SimBatch
+{
+public:
+	uint		m_numWorlds = 256;
+	uint		m_numReplicates = 4;
+	uint		m_numAgents = 64;
+	uint		m_numTicks = 600;
+	uint		m_numObstacles = 8;
+	uint		m_numWalls = 4;
+	uint		m_numThreads = 0;		// 0 keeps the GameJobs default, one per core
+	uint64_t	m_seed = SimRandom::DEFAULT_SEED;
+	double		m_deltaSeconds = 1.0 / 60.0;
+	bool		m_measureScaling = false;
+	std::string	m_csvPath;
+
+	SweepParameter	m_sweepParameter = SWEEP_NONE;
+	float			m_sweepMin = 0.0f;
+	float			m_sweepMax = 0.0f;
+
+	std::vector<BehaviorWeight>	m_mix = { { STEER_WANDER, 1.0f } };
+	std::vector<int>			m_modifiers = { STEER_OBSTACLE_AVOIDANCE, STEER_WALL_AVOIDANCE };
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	int		Run() const;
+
+	static void	PrintUsage();
+
+private:
+	double				RunWorlds(std::vector<BatchWorldResult>& out_results) const;
+	BatchWorldResult	RunWorld(uint world_idx) const;
+	float				GetParameterValue(uint world_idx) const;
+	void				PrintResults(const std::vector<BatchWorldResult>& results) const;
+	bool				WriteCsv(const std::vector<BatchWorldResult>& results) const;
+
+	static bool			ParseSweep(const char* sweep_text, SweepParameter& out_parameter, float& out_min,
+		float& out_max);
+	static void			ApplyParameter(SweepParameter parameter, float value, SteeringTuning& tuning);
+};
@@ -0,0 +1,432 @@
+#include "Game/SimBenchmark.hpp"
+#include "Game/Game.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// two-sided 95% normal quantile, used for the order-statistic confidence intervals
+constexpr double CONFIDENCE_Z = 1.959964;
+
+struct BenchmarkMix
+{
+	const char* m_name;
+	const char* m_spec;
+};
+
+// every behavior on its own, then the combinations the game actually runs
+static const BenchmarkMix s_benchmarkMixes[] = {
+	{ "seek",			"seek" },
+	{ "flee",			"flee" },
+	{ "arrive",			"arrive" },
+	{ "pursuit",		"pursuit" },
+	{ "evade",			"evade" },
+	{ "wander",			"wander" },
+	{ "obstacle",		"obstacle" },
+	{ "wall",			"wall" },
+	{ "wander_avoid",	"wander,+obstacle,+wall" },
+	{ "chase",			"pursuit:3,evade:1,+obstacle,+wall" },
+	{ "crowd",			"seek:1,flee:1,arrive:1,wander:2,+wall" },
+};
+
+constexpr int ENVIRONMENT_MIX_IDX = 8;
+
+
+std::string BenchmarkConfig::GetName() const
+{
+	char name[128];
+	snprintf(name, sizeof(name), "agents=%u/mix=%s/obstacles=%u/walls=%u", m_numAgents, m_mixName.c_str(),
+		m_numObstacles, m_numWalls);
+	return name;
+}
+
+
+bool SimBenchmark::ParseCommandLine(const int argc, char** argv)
+{
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--agents") == 0 && has_value)
+		{
+			if (!ParseUintList(argv[++arg_idx], m_agentCounts))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--obstacles") == 0 && has_value)
+		{
+			if (!ParseUintList(argv[++arg_idx], m_obstacleCounts))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--walls") == 0 && has_value)
+		{
+			if (!ParseUintList(argv[++arg_idx], m_wallCounts))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--env-agents") == 0 && has_value)
+		{
+			m_sweepEnvironmentAgents = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--warmup") == 0 && has_value)
+		{
+			m_warmupTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--samples") == 0 && has_value)
+		{
+			m_sampleTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--dt") == 0 && has_value)
+		{
+			m_deltaSeconds = strtod(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--out") == 0 && has_value)
+		{
+			m_outputPath = argv[++arg_idx];
+		}
+		else if (strcmp(arg, "--baseline") == 0 && has_value)
+		{
+			m_baselinePath = argv[++arg_idx];
+		}
+		else if (strcmp(arg, "--save-baseline") == 0)
+		{
+			m_saveBaseline = true;
+		}
+		else if (strcmp(arg, "--threshold") == 0 && has_value)
+		{
+			m_regressionThreshold = strtod(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--filter") == 0 && has_value)
+		{
+			m_filter = argv[++arg_idx];
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	if (m_sampleTicks == 0 || m_deltaSeconds <= 0.0)
+	{
+		printf("--samples and --dt must be positive\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+int SimBenchmark::Run()
+{
+	const std::vector<BenchmarkConfig> configs = BuildConfigs();
+	std::vector<BenchmarkResult> results;
+	results.reserve(configs.size());
+
+	printf("%-52s %8s %12s %25s %12s %25s\n", "config", "agents", "median ns", "95% ci", "p99 ns", "95% ci");
+	for (size_t config_idx = 0; config_idx < configs.size(); ++config_idx)
+	{
+		const BenchmarkResult result = RunConfig(configs[config_idx]);
+		printf("%-52s %8u %12.2f [%10.2f, %10.2f] %12.2f [%10.2f, %10.2f]\n", result.m_name.c_str(),
+			result.m_numAgents, result.m_medianNs, result.m_medianLowNs, result.m_medianHighNs,
+			result.m_p99Ns, result.m_p99LowNs, result.m_p99HighNs);
+		results.push_back(result);
+	}
+
+	if (!WriteJson(m_outputPath, results))
+	{
+		return 1;
+	}
+
+	if (m_baselinePath.empty())
+	{
+		return 0;
+	}
+
+	if (m_saveBaseline)
+	{
+		return WriteJson(m_baselinePath, results) ? 0 : 1;
+	}
+
+	return CompareWithBaseline(results);
+}
+
+
+std::vector<BenchmarkConfig> SimBenchmark::BuildConfigs() const
+{
+	std::vector<BenchmarkConfig> configs;
+	const int num_mixes = static_cast<int>(sizeof(s_benchmarkMixes) / sizeof(s_benchmarkMixes[0]));
+
+	// scaling: every mix at every population in the default arena
+	for (int mix_idx = 0; mix_idx < num_mixes; ++mix_idx)
+	{
+		for (size_t count_idx = 0; count_idx < m_agentCounts.size(); ++count_idx)
+		{
+			BenchmarkConfig config;
+			config.m_mixName = s_benchmarkMixes[mix_idx].m_name;
+			config.m_mixSpec = s_benchmarkMixes[mix_idx].m_spec;
+			config.m_numAgents = m_agentCounts[count_idx];
+			configs.push_back(config);
+		}
+	}
+
+	// environment: avoidance cost against extra obstacles and walls at a fixed population
+	for (size_t obstacle_idx = 0; obstacle_idx < m_obstacleCounts.size(); ++obstacle_idx)
+	{
+		for (size_t wall_idx = 0; wall_idx < m_wallCounts.size(); ++wall_idx)
+		{
+			if (m_obstacleCounts[obstacle_idx] == 0 && m_wallCounts[wall_idx] == 0)
+			{
+				continue; // already covered by the scaling sweep
+			}
+
+			BenchmarkConfig config;
+			config.m_mixName = s_benchmarkMixes[ENVIRONMENT_MIX_IDX].m_name;
+			config.m_mixSpec = s_benchmarkMixes[ENVIRONMENT_MIX_IDX].m_spec;
+			config.m_numAgents = m_sweepEnvironmentAgents;
+			config.m_numObstacles = m_obstacleCounts[obstacle_idx];
+			config.m_numWalls = m_wallCounts[wall_idx];
+			configs.push_back(config);
+		}
+	}
+
+	if (!m_filter.empty())
+	{
+		configs.erase(std::remove_if(configs.begin(), configs.end(),
+			[this](const BenchmarkConfig& config) { return config.GetName().find(m_filter) == std::string::npos; }),
+			configs.end());
+	}
+
+	return configs;
+}
+
+
+BenchmarkResult SimBenchmark::RunConfig(const BenchmarkConfig& config) const
+{
+	Game* game = new Game();
+	game->Startup();
+	game->SpawnObstacles(config.m_numObstacles);
+	game->SpawnWalls(config.m_numWalls);
+	game->SetNumVehicles(config.m_numAgents);
+
+	std::vector<BehaviorWeight> mix;
+	std::vector<int> modifiers;
+	SimScenario::ParseBehaviorMix(config.m_mixSpec, mix, modifiers);
+	SimScenario::ApplyBehaviorMix(game, mix, modifiers);
+
+	for (uint tick_idx = 0; tick_idx < m_warmupTicks; ++tick_idx)
+	{
+		game->Update(m_deltaSeconds);
+	}
+
+	std::vector<double> samples;
+	samples.reserve(m_sampleTicks);
+	const double num_agents = static_cast<double>(game->GetNumVehicles());
+	for (uint tick_idx = 0; tick_idx < m_sampleTicks; ++tick_idx)
+	{
+		const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		game->Update(m_deltaSeconds);
+		const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		const double tick_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+		samples.push_back(tick_ns / num_agents);
+	}
+
+	BenchmarkResult result;
+	result.m_name = config.GetName();
+	result.m_numAgents = game->GetNumVehicles();
+	SummarizeSamples(samples, result);
+
+	game->Shutdown();
+	delete game;
+	return result;
+}
+
+
+STATIC void SimBenchmark::PrintUsage()
+{
+	printf(
+		"usage: Headless bench [options]\n"
+		"  --agents LIST       populations to sweep (default 1000,4000,16000,64000,250000,1000000)\n"
+		"  --obstacles LIST    extra obstacles for the environment sweep (default 0,16,64)\n"
+		"  --walls LIST        extra walls for the environment sweep (default 0,16)\n"
+		"  --env-agents N      population used by the environment sweep (default 4000)\n"
+		"  --warmup N          untimed ticks per configuration (default 30)\n"
+		"  --samples N         timed ticks per configuration (default 200)\n"
+		"  --dt SECONDS        tick length (default 1/60)\n"
+		"  --filter TEXT       only run configurations whose name contains TEXT\n"
+		"  --out FILE          JSON results (default BenchmarkResults.json)\n"
+		"  --baseline FILE     compare against FILE, exit code 2 on regression\n"
+		"  --save-baseline     write the results to --baseline instead of comparing\n"
+		"  --threshold FRAC    allowed median slowdown before flagging (default 0.10)\n"
+	);
+}
+
+
+bool SimBenchmark::WriteJson(const std::string& file_path, const std::vector<BenchmarkResult>& results) const
+{
+	FILE* file = fopen(file_path.c_str(), "w");
+	if (file == nullptr)
+	{
+		printf("Could not write benchmark results to '%s'\n", file_path.c_str());
+		return false;
+	}
+
+	fprintf(file, "{\n  \"version\": 1,\n  \"unit\": \"ns_per_agent_tick\",\n");
+	fprintf(file, "  \"warmup_ticks\": %u,\n  \"sample_ticks\": %u,\n  \"dt\": %.9f,\n", m_warmupTicks, m_sampleTicks,
+		m_deltaSeconds);
+	fprintf(file, "  \"results\": [\n");
+	for (size_t result_idx = 0; result_idx < results.size(); ++result_idx)
+	{
+		const BenchmarkResult& result = results[result_idx];
+		fprintf(file, "    { \"name\": \"%s\", \"agents\": %u, \"samples\": %u, "
+			"\"median_ns\": %.4f, \"median_ci\": [%.4f, %.4f], \"p99_ns\": %.4f, \"p99_ci\": [%.4f, %.4f] }%s\n",
+			result.m_name.c_str(), result.m_numAgents, result.m_numSamples,
+			result.m_medianNs, result.m_medianLowNs, result.m_medianHighNs,
+			result.m_p99Ns, result.m_p99LowNs, result.m_p99HighNs,
+			result_idx + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+	fclose(file);
+	return true;
+}
+
+
+int SimBenchmark::CompareWithBaseline(const std::vector<BenchmarkResult>& results) const
+{
+	std::vector<BenchmarkResult> baseline;
+	if (!ReadBaseline(m_baselinePath, baseline))
+	{
+		printf("Could not read baseline '%s'\n", m_baselinePath.c_str());
+		return 1;
+	}
+
+	int num_regressions = 0;
+	printf("\n%-52s %12s %12s %9s\n", "config", "baseline", "current", "change");
+	for (size_t result_idx = 0; result_idx < results.size(); ++result_idx)
+	{
+		const BenchmarkResult& result = results[result_idx];
+		for (size_t base_idx = 0; base_idx < baseline.size(); ++base_idx)
+		{
+			if (baseline[base_idx].m_name != result.m_name)
+			{
+				continue;
+			}
+
+			// only flag when the slowdown is past the threshold AND outside the current run's noise
+			const double base_median = baseline[base_idx].m_medianNs;
+			const double change = base_median > 0.0 ? result.m_medianNs / base_median - 1.0 : 0.0;
+			const bool regressed = change > m_regressionThreshold && result.m_medianLowNs > base_median;
+			printf("%-52s %12.2f %12.2f %+8.1f%%%s\n", result.m_name.c_str(), base_median, result.m_medianNs,
+				change * 100.0, regressed ? "  REGRESSION" : "");
+
+			if (regressed)
+			{
+				++num_regressions;
+			}
+			break;
+		}
+	}
+
+	printf("%d regression(s) beyond %.0f%%\n", num_regressions, m_regressionThreshold * 100.0);
+	return num_regressions > 0 ? 2 : 0;
+}
+
+
+STATIC void SimBenchmark::SummarizeSamples(std::vector<double>& samples, BenchmarkResult& out_result)
+{
+	std::sort(samples.begin(), samples.end());
+	const double num_samples = static_cast<double>(samples.size());
+	out_result.m_numSamples = static_cast<uint>(samples.size());
+
+	// the rank of a quantile q is binomial(n, q); its normal approximation gives the interval ranks
+	const double median_rank = num_samples * 0.5;
+	const double median_spread = CONFIDENCE_Z * sqrt(num_samples * 0.25);
+	out_result.m_medianNs = GetSortedSample(samples, median_rank);
+	out_result.m_medianLowNs = GetSortedSample(samples, median_rank - median_spread);
+	out_result.m_medianHighNs = GetSortedSample(samples, median_rank + median_spread);
+
+	const double p99_rank = num_samples * 0.99;
+	const double p99_spread = CONFIDENCE_Z * sqrt(num_samples * 0.99 * 0.01);
+	out_result.m_p99Ns = GetSortedSample(samples, p99_rank);
+	out_result.m_p99LowNs = GetSortedSample(samples, p99_rank - p99_spread);
+	out_result.m_p99HighNs = GetSortedSample(samples, p99_rank + p99_spread);
+}
+
+
+STATIC double SimBenchmark::GetSortedSample(const std::vector<double>& sorted_samples, const double rank)
+{
+	if (sorted_samples.empty())
+	{
+		return 0.0;
+	}
+
+	const double last_idx = static_cast<double>(sorted_samples.size() - 1);
+	const double clamped_rank = rank < 0.0 ? 0.0 : (rank > last_idx ? last_idx : rank);
+	return sorted_samples[static_cast<size_t>(clamped_rank)];
+}
+
+
+STATIC bool SimBenchmark::ReadBaseline(const std::string& file_path, std::vector<BenchmarkResult>& out_results)
+{
+	std::ifstream file(file_path);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// the baseline is a file this class wrote: one result object per line
+	std::string line;
+	while (std::getline(file, line))
+	{
+		const size_t name_key = line.find("\"name\": \"");
+		const size_t median_key = line.find("\"median_ns\": ");
+		if (name_key == std::string::npos || median_key == std::string::npos)
+		{
+			continue;
+		}
+
+		const size_t name_begin = name_key + strlen("\"name\": \"");
+		const size_t name_end = line.find('"', name_begin);
+
+		BenchmarkResult result;
+		result.m_name = line.substr(name_begin, name_end - name_begin);
+		result.m_medianNs = atof(line.c_str() + median_key + strlen("\"median_ns\": "));
+		out_results.push_back(result);
+	}
+
+	return true;
+}
+
+
+STATIC bool SimBenchmark::ParseUintList(const char* text, std::vector<uint>& out_values)
+{
+	out_values.clear();
+
+	std::istringstream list_stream(text);
+	std::string entry;
+	while (std::getline(list_stream, entry, ','))
+	{
+		char* end = nullptr;
+		const unsigned long value = strtoul(entry.c_str(), &end, 10);
+		if (entry.empty() || *end != '\0')
+		{
+			printf("Expected a comma separated list of counts, got '%s'\n", text);
+			return false;
+		}
+
+		out_values.push_back(static_cast<uint>(value));
+	}
+
+	return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/SimScenario.hpp"
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// SimBenchmark
+//
+// Agent-count scaling suite for the headless build. Each configuration (agent count, behavior mix,
+// obstacle and wall count) gets a fresh Game, a warm-up, and then every tick is timed on its own.
+// Results are reported as ns per agent per tick: median and p99 with distribution-free confidence
+// intervals from order statistics, written as JSON and optionally compared with a baseline file.
+//
+
+struct BenchmarkConfig
+{
+	std::string	m_mixName;
+	std::string	m_mixSpec;
+	uint		m_numAgents = 0;
+	uint		m_numObstacles = 0;
+	uint		m_numWalls = 0;
+
+	std::string GetName() const;
+};
+
+
+struct BenchmarkResult
+{
+	std::string	m_name;
+	uint		m_numAgents = 0;		// agents actually simulated (the population may be capped)
+	uint		m_numSamples = 0;
+	double		m_medianNs = 0.0;
+	double		m_medianLowNs = 0.0;
+	double		m_medianHighNs = 0.0;
+	double		m_p99Ns = 0.0;
+	double		m_p99LowNs = 0.0;
+	double		m_p99HighNs = 0.0;
+};
+
+
+class SimBenchmark
+{
+public:
+	std::vector<uint>		m_agentCounts = { 1'000, 4'000, 16'000, 64'000, 250'000, 1'000'000 };
+	std::vector<uint>		m_obstacleCounts = { 0, 16, 64 };
+	std::vector<uint>		m_wallCounts = { 0, 16 };
+	uint					m_sweepEnvironmentAgents = 4'000;
+	uint					m_warmupTicks = 30;
+	uint					m_sampleTicks = 200;
+	double					m_deltaSeconds = 1.0 / 60.0;
+	double					m_regressionThreshold = 0.10;
+	std::string				m_outputPath = "BenchmarkResults.json";
+	std::string				m_baselinePath;
+	bool					m_saveBaseline = false;
+	std::string				m_filter;
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	int		Run();
+
+	std::vector<BenchmarkConfig>	BuildConfigs() const;
+	BenchmarkResult					RunConfig(const BenchmarkConfig& config) const;
+
+	static void	PrintUsage();
+
+private:
+	bool	WriteJson(const std::string& file_path, const std::vector<BenchmarkResult>& results) const;
+	int		CompareWithBaseline(const std::vector<BenchmarkResult>& results) const;
+
+	static void		SummarizeSamples(std::vector<double>& samples, BenchmarkResult& out_result);
+	static double	GetSortedSample(const std::vector<double>& sorted_samples, double rank);
+	static bool		ReadBaseline(const std::string& file_path, std::vector<BenchmarkResult>& out_results);
+	static bool		ParseUintList(const char* text, std::vector<uint>& out_values);
+};
@@ -0,0 +1,200 @@
+#include "Game/SimFlowFieldBench.hpp"
+#include "Game/FlowField.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+#include "Game/Game.hpp"
+#include "Game/Vehicle.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// the leader's cruising speed, how fast a moving goal crosses cells
+constexpr float FLOW_BENCH_GOAL_SPEED = 50.0f;
+
+
+bool SimFlowFieldBench::ParseCommandLine(const int argc, char** argv)
+{
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--agents") == 0 && has_value)
+		{
+			m_numAgents = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--obstacles") == 0 && has_value)
+		{
+			m_numObstacles = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--walls") == 0 && has_value)
+		{
+			m_numWalls = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--goals") == 0 && has_value)
+		{
+			m_numGoals = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--ticks") == 0 && has_value)
+		{
+			m_numTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--cell") == 0 && has_value)
+		{
+			m_cellSize = static_cast<float>(strtod(argv[++arg_idx], nullptr));
+		}
+		else if (strcmp(arg, "--dt") == 0 && has_value)
+		{
+			m_deltaSeconds = strtod(argv[++arg_idx], nullptr);
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	if (m_cellSize <= 0.0f || m_numGoals == 0 || m_numAgents == 0)
+	{
+		printf("--cell, --goals and --agents must be positive\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+int SimFlowFieldBench::Run() const
+{
+	Game* game = new Game();
+	game->Startup();
+	game->SpawnObstacles(m_numObstacles);
+	game->SpawnWalls(m_numWalls);
+
+	const Vec2 world_mins(-WORLD_HEIGHT * WORLD_ASPECT, -WORLD_HEIGHT);
+	const Vec2 world_maxs(WORLD_HEIGHT * WORLD_ASPECT, WORLD_HEIGHT);
+	FlowFieldCache flow_fields;
+
+	const double grid_begin = FrameTimeStats::GetTimeSeconds();
+	flow_fields.BuildGrid(world_mins, world_maxs, m_cellSize, game->GetObstacles(), game->GetWalls());
+	const double grid_seconds = FrameTimeStats::GetTimeSeconds() - grid_begin;
+
+	// one integration per fixed goal, released again so every goal builds from scratch
+	double total_build_seconds = 0.0;
+	double max_build_seconds = 0.0;
+	for (uint goal_idx = 0; goal_idx < m_numGoals; ++goal_idx)
+	{
+		const Vec2 goal(
+			g_randomNumberGenerator.GetRandomFloatInRange(world_mins.x, world_maxs.x),
+			g_randomNumberGenerator.GetRandomFloatInRange(world_mins.y, world_maxs.y));
+		const int flow_field = flow_fields.Retain(goal);
+
+		const double build_begin = FrameTimeStats::GetTimeSeconds();
+		flow_fields.Update();
+		const double build_seconds = FrameTimeStats::GetTimeSeconds() - build_begin;
+		total_build_seconds += build_seconds;
+		max_build_seconds = std::max(max_build_seconds, build_seconds);
+
+		flow_fields.Release(flow_field);
+	}
+
+	std::vector<Vec2> positions(m_numAgents);
+	for (uint agent_idx = 0; agent_idx < m_numAgents; ++agent_idx)
+	{
+		positions[agent_idx] = Vec2(
+			g_randomNumberGenerator.GetRandomFloatInRange(world_mins.x, world_maxs.x),
+			g_randomNumberGenerator.GetRandomFloatInRange(world_mins.y, world_maxs.y));
+	}
+
+	// a goal moving at leader speed around the origin, rebuilding only when it changes cell
+	Vehicle* moving_goal = game->GetVehicle(1);
+	const int flow_field = flow_fields.Retain(moving_goal);
+
+	uint num_rebuilds = 0;
+	uint64_t num_fallbacks = 0;
+	double update_seconds = 0.0;
+	double sample_seconds = 0.0;
+	double straight_seconds = 0.0;
+	float checksum = 0.0f;
+	const float orbit_radius = WORLD_HEIGHT * 0.5f;
+	for (uint tick_idx = 0; tick_idx < m_numTicks; ++tick_idx)
+	{
+		const float angle_degrees = static_cast<float>(static_cast<double>(tick_idx) * m_deltaSeconds) *
+			FLOW_BENCH_GOAL_SPEED / orbit_radius * 57.2957795f;
+		const Vec2 goal(CosDegrees(angle_degrees) * orbit_radius, SinDegrees(angle_degrees) * orbit_radius);
+		moving_goal->SetPos(goal);
+
+		const double update_begin = FrameTimeStats::GetTimeSeconds();
+		flow_fields.Update();
+		const double sample_begin = FrameTimeStats::GetTimeSeconds();
+		update_seconds += sample_begin - update_begin;
+		num_rebuilds += flow_fields.GetNumBuildsLastUpdate();
+
+		for (uint agent_idx = 0; agent_idx < m_numAgents; ++agent_idx)
+		{
+			Vec2 direction;
+			float distance;
+			if (flow_fields.Sample(flow_field, positions[agent_idx], direction, distance))
+			{
+				checksum += direction.x + distance;
+			}
+			else
+			{
+				++num_fallbacks;
+			}
+		}
+		const double straight_begin = FrameTimeStats::GetTimeSeconds();
+		sample_seconds += straight_begin - sample_begin;
+
+		// what Seek does per agent without a field: direction to the goal, normalized
+		for (uint agent_idx = 0; agent_idx < m_numAgents; ++agent_idx)
+		{
+			Vec2 direction = goal - positions[agent_idx];
+			direction.Normalize();
+			checksum += direction.x;
+		}
+		straight_seconds += FrameTimeStats::GetTimeSeconds() - straight_begin;
+	}
+
+	flow_fields.Release(flow_field);
+	game->Shutdown();
+	delete game;
+
+	const double num_samples = static_cast<double>(m_numAgents) * static_cast<double>(m_numTicks);
+	const FlowFieldGrid& grid = flow_fields.GetGrid();
+	printf("grid              %d x %d cells of %.2f\n", grid.GetNumCellsX(), grid.GetNumCellsY(), m_cellSize);
+	printf("grid build        %.3f ms (%u obstacles, %u walls)\n", grid_seconds * 1000.0, m_numObstacles, m_numWalls);
+	printf("field build       %.3f ms avg, %.3f ms max over %u goals\n",
+		total_build_seconds * 1000.0 / static_cast<double>(m_numGoals), max_build_seconds * 1000.0, m_numGoals);
+	printf("moving goal       %u rebuilds in %u ticks, %.3f ms/tick\n",
+		num_rebuilds, m_numTicks, update_seconds * 1000.0 / static_cast<double>(m_numTicks));
+	printf("agents            %u\n", m_numAgents);
+	printf("sample            %.2f ns/agent (%.3f ms/tick), %.1f%% fall back to straight seek\n",
+		sample_seconds * 1.0e9 / num_samples,
+		sample_seconds * 1000.0 / static_cast<double>(m_numTicks),
+		100.0 * static_cast<double>(num_fallbacks) / num_samples);
+	printf("straight seek     %.2f ns/agent (%.3f ms/tick)\n",
+		straight_seconds * 1.0e9 / num_samples,
+		straight_seconds * 1000.0 / static_cast<double>(m_numTicks));
+	printf("checksum          %.3f\n", static_cast<double>(checksum));
+	return 0;
+}
+
+
+STATIC void SimFlowFieldBench::PrintUsage()
+{
+	printf(
+		"usage: Headless flow-bench [options]\n"
+		"  --agents N        sample positions per tick (default 100000)\n"
+		"  --obstacles N     extra obstacles (default 32)\n"
+		"  --walls N         extra walls (default 16)\n"
+		"  --goals N         fixed goals to integrate from scratch (default 16)\n"
+		"  --ticks N         ticks of the moving goal (default 600)\n"
+		"  --cell SIZE       grid cell size (default 2)\n"
+		"  --dt SECONDS      tick length (default 1/60)\n"
+	);
+}
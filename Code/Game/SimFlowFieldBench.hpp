@@ -0,0 +1,28 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+
+//-----------------------------------------------------------------------------------------------
+// SimFlowFieldBench
+//
+// Cost of the flow field subsystem on its own, at agent counts well past the Game population cap:
+// grid build, one field integration per goal, a goal moving at leader speed (rebuilds only on cell
+// changes) and the per-agent sample against the straight-line seek direction it replaces.
+//
+
+class SimFlowFieldBench
+{
+public:
+	uint	m_numAgents = 100'000;
+	uint	m_numObstacles = 32;
+	uint	m_numWalls = 16;
+	uint	m_numGoals = 16;
+	uint	m_numTicks = 600;
+	float	m_cellSize = 2.0f;
+	double	m_deltaSeconds = 1.0 / 60.0;
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	int		Run() const;
+
+	static void	PrintUsage();
+};
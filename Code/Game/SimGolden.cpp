@@ -0,0 +1,434 @@
+#include "Game/SimGolden.hpp"
+#include "Game/Game.hpp"
+#include "Game/Vehicle.hpp"
+#include "Game/GameJobs.hpp"
+#include "Game/WrapDomain.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+struct GoldenPathName
+{
+	uint		m_path;
+	const char*	m_name;
+};
+
+static const GoldenPathName s_goldenPathNames[] = {
+	{ GOLDEN_PATH_TARGET_SNAPSHOTS, "snapshots" },
+	{ GOLDEN_PATH_CULL_AVOIDANCE, "cull" },
+	{ GOLDEN_PATH_FLOW_FIELDS, "flow" },
+	{ GOLDEN_PATH_LOD, "lod" },
+	{ GOLDEN_PATH_PARALLEL, "parallel" },
+};
+
+static const char* s_lodTierNames[NUM_LOD_TIERS] = { "every tick", "every 2nd", "every 4th" };
+
+
+static float GetLength(const Vec2& vector)
+{
+	return sqrtf(vector.x * vector.x + vector.y * vector.y);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool SimGolden::ParseCommandLine(const int argc, char** argv)
+{
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--agents") == 0 && has_value)
+		{
+			m_numAgents = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--ticks") == 0 && has_value)
+		{
+			m_numTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--obstacles") == 0 && has_value)
+		{
+			m_numObstacles = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--walls") == 0 && has_value)
+		{
+			m_numWalls = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--seed") == 0 && has_value)
+		{
+			m_seed = strtoull(argv[++arg_idx], nullptr, 0);
+		}
+		else if (strcmp(arg, "--dt") == 0 && has_value)
+		{
+			m_deltaSeconds = strtod(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--mix") == 0 && has_value)
+		{
+			if (!SimScenario::ParseBehaviorMix(argv[++arg_idx], m_mix, m_modifiers))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--reference") == 0 && has_value)
+		{
+			if (!ParsePaths(argv[++arg_idx], m_referencePaths))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--optimized") == 0 && has_value)
+		{
+			if (!ParsePaths(argv[++arg_idx], m_optimizedPaths))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--pos-tol") == 0 && has_value)
+		{
+			m_tolerance.m_position = strtof(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--vel-tol") == 0 && has_value)
+		{
+			m_tolerance.m_velocity = strtof(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--keep-going") == 0)
+		{
+			m_keepGoing = true;
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	if (m_numAgents == 0 || m_deltaSeconds <= 0.0 || !(m_tolerance.m_position >= 0.0f) ||
+		!(m_tolerance.m_velocity >= 0.0f))
+	{
+		printf("--agents and --dt must be positive, tolerances non-negative\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+int SimGolden::Run() const
+{
+	Game* reference = CreateWorld(m_referencePaths);
+	Game* optimized = CreateWorld(m_optimizedPaths);
+
+	GoldenDivergence first_divergence;
+	bool diverged = false;
+	uint num_diverged_ticks = 0;
+	float max_position_error = 0.0f;
+	float max_velocity_error = 0.0f;
+	double reference_seconds = 0.0;
+	double optimized_seconds = 0.0;
+	uint num_ticks_run = 0;
+
+	// tick 0 is the setup, which has to agree before anything is stepped
+	for (uint tick = 0; tick <= m_numTicks; ++tick)
+	{
+		if (tick > 0)
+		{
+			const double reference_begin = FrameTimeStats::GetTimeSeconds();
+			Step(reference, m_referencePaths);
+			const double optimized_begin = FrameTimeStats::GetTimeSeconds();
+			Step(optimized, m_optimizedPaths);
+			const double optimized_end = FrameTimeStats::GetTimeSeconds();
+			reference_seconds += optimized_begin - reference_begin;
+			optimized_seconds += optimized_end - optimized_begin;
+			num_ticks_run = tick;
+		}
+
+		GoldenDivergence divergence;
+		if (Compare(reference, optimized, tick, divergence, max_position_error, max_velocity_error))
+		{
+			continue;
+		}
+
+		++num_diverged_ticks;
+		if (!diverged)
+		{
+			diverged = true;
+			first_divergence = divergence;
+			PrintDivergence(reference, optimized, divergence);
+		}
+		if (!m_keepGoing)
+		{
+			break;
+		}
+	}
+
+	const double num_ticks = static_cast<double>(std::max(num_ticks_run, 1u));
+	printf("agents            %u, %u ticks of dt %.6f s, seed 0x%016llX\n", m_numAgents, num_ticks_run,
+		m_deltaSeconds, static_cast<unsigned long long>(m_seed));
+	printf("reference         %-28s %.3f ms/tick\n", GetPathsText(m_referencePaths).c_str(),
+		reference_seconds * 1000.0 / num_ticks);
+	printf("optimized         %-28s %.3f ms/tick, %u thread(s)\n", GetPathsText(m_optimizedPaths).c_str(),
+		optimized_seconds * 1000.0 / num_ticks, GameJobs::GetNumThreads());
+	printf("tolerance         position %g, velocity %g per agent\n",
+		static_cast<double>(m_tolerance.m_position), static_cast<double>(m_tolerance.m_velocity));
+	printf("max error         position %g, velocity %g\n",
+		static_cast<double>(max_position_error), static_cast<double>(max_velocity_error));
+
+	reference->Shutdown();
+	delete reference;
+	optimized->Shutdown();
+	delete optimized;
+
+	if (!diverged)
+	{
+		printf("golden            PASS, every agent within tolerance on every tick\n");
+		return 0;
+	}
+	if (m_keepGoing)
+	{
+		printf("golden            FAIL from tick %u, %u of %u ticks out of tolerance\n", first_divergence.m_tick,
+			num_diverged_ticks, num_ticks_run + 1);
+	}
+	else
+	{
+		printf("golden            FAIL at tick %u\n", first_divergence.m_tick);
+	}
+	return 1;
+}
+
+
+Game* SimGolden::CreateWorld(const uint paths) const
+{
+	Game* game = new Game();
+	game->SetSeed(m_seed);
+	game->SetVisualsEnabled(false);
+	game->Startup();
+	game->SpawnObstacles(m_numObstacles);
+	game->SpawnWalls(m_numWalls);
+	game->SetNumVehicles(m_numAgents);
+	SimScenario::ApplyBehaviorMix(game, m_mix, m_modifiers);
+	game->SetTargetSnapshots((paths & GOLDEN_PATH_TARGET_SNAPSHOTS) != 0);
+	game->SetAvoidanceCulling((paths & GOLDEN_PATH_CULL_AVOIDANCE) != 0);
+	game->SetFlowFields((paths & GOLDEN_PATH_FLOW_FIELDS) != 0);
+	game->SetLodEnabled((paths & GOLDEN_PATH_LOD) != 0);
+	return game;
+}
+
+
+void SimGolden::Step(Game* game, const uint paths) const
+{
+	if ((paths & GOLDEN_PATH_PARALLEL) != 0)
+	{
+		game->Update(m_deltaSeconds);
+		return;
+	}
+
+	// a ParallelFor issued from inside a chunk runs inline, so every job of this tick stays on this thread
+	auto update_inline = [game, this](const uint begin, const uint end)
+	{
+		UNUSED(begin);
+		UNUSED(end);
+		game->Update(m_deltaSeconds);
+	};
+	GameJobs::ParallelFor(1, 1, update_inline);
+}
+
+
+bool SimGolden::Compare(const Game* reference, const Game* optimized, const uint tick,
+	GoldenDivergence& out_divergence, float& out_max_position_error, float& out_max_velocity_error) const
+{
+	out_divergence = GoldenDivergence();
+	out_divergence.m_tick = tick;
+
+	const uint num_vehicles = std::min(reference->GetNumCreatedVehicles(), optimized->GetNumCreatedVehicles());
+	float worst_position_rank = -1.0f;
+	float worst_velocity_rank = -1.0f;
+	for (uint veh_idx = 0; veh_idx < num_vehicles; ++veh_idx)
+	{
+		VehicleState reference_state;
+		VehicleState optimized_state;
+		reference->WriteVehicleState(veh_idx, reference_state);
+		optimized->WriteVehicleState(veh_idx, optimized_state);
+
+		const float position_error = GetLength(
+			WORLD_WRAP.GetDisplacement(reference_state.m_position, optimized_state.m_position));
+		const float velocity_error = GetLength(optimized_state.m_velocity - reference_state.m_velocity);
+		out_max_position_error = std::max(out_max_position_error, position_error);
+		out_max_velocity_error = std::max(out_max_velocity_error, velocity_error);
+
+		// NaN anywhere is never within tolerance
+		if (position_error <= m_tolerance.m_position && velocity_error <= m_tolerance.m_velocity)
+		{
+			continue;
+		}
+
+		if (out_divergence.m_numDiverged == 0)
+		{
+			out_divergence.m_firstVehicle = veh_idx;
+		}
+		++out_divergence.m_numDiverged;
+
+		// NaN ranks above everything, it is the worst kind of divergence
+		const float position_rank = std::isnan(position_error) ? INFINITY : position_error;
+		const float velocity_rank = std::isnan(velocity_error) ? INFINITY : velocity_error;
+		if (position_rank > worst_position_rank ||
+			(position_rank == worst_position_rank && velocity_rank > worst_velocity_rank))
+		{
+			worst_position_rank = position_rank;
+			worst_velocity_rank = velocity_rank;
+			out_divergence.m_worstVehicle = veh_idx;
+			out_divergence.m_positionError = position_error;
+			out_divergence.m_velocityError = velocity_error;
+		}
+	}
+
+	// a population that differs is a divergence of its own, counted from the first vehicle only one has
+	const bool same_population = reference->GetNumVehicles() == optimized->GetNumVehicles() &&
+		reference->GetNumCreatedVehicles() == optimized->GetNumCreatedVehicles();
+	if (!same_population && out_divergence.m_numDiverged == 0)
+	{
+		out_divergence.m_firstVehicle = num_vehicles;
+		out_divergence.m_worstVehicle = num_vehicles;
+		out_divergence.m_numDiverged = 1;
+	}
+	return out_divergence.m_numDiverged == 0;
+}
+
+
+void SimGolden::PrintDivergence(const Game* reference, const Game* optimized, const GoldenDivergence& divergence) const
+{
+	printf("first divergence  tick %u, %u agent(s) out of tolerance, lowest index %u, worst below\n",
+		divergence.m_tick, divergence.m_numDiverged, divergence.m_firstVehicle);
+
+	const uint veh_idx = divergence.m_worstVehicle;
+	if (veh_idx >= reference->GetNumCreatedVehicles() || veh_idx >= optimized->GetNumCreatedVehicles())
+	{
+		printf("population        reference %u (%u created), optimized %u (%u created)\n",
+			reference->GetNumVehicles(), reference->GetNumCreatedVehicles(),
+			optimized->GetNumVehicles(), optimized->GetNumCreatedVehicles());
+		return;
+	}
+
+	const Vehicle* reference_vehicle = reference->GetVehicle(veh_idx);
+	const Vehicle* optimized_vehicle = optimized->GetVehicle(veh_idx);
+	VehicleState reference_state;
+	VehicleState optimized_state;
+	reference->WriteVehicleState(veh_idx, reference_state);
+	optimized->WriteVehicleState(veh_idx, optimized_state);
+
+	// behaviors are setup, the same in both worlds
+	std::string behaviors;
+	for (int beh_idx = 0; beh_idx < NUM_STEER_BEHAVIORS; ++beh_idx)
+	{
+		if (reference_vehicle->HasBehavior(beh_idx))
+		{
+			behaviors += behaviors.empty() ? "" : "+";
+			behaviors += SimScenario::GetBehaviorName(beh_idx);
+		}
+	}
+	printf("agent             %u, %s\n", veh_idx, behaviors.empty() ? "no behaviors" : behaviors.c_str());
+	printf("error             position %g (tolerance %g), velocity %g (tolerance %g)\n",
+		static_cast<double>(divergence.m_positionError), static_cast<double>(m_tolerance.m_position),
+		static_cast<double>(divergence.m_velocityError), static_cast<double>(m_tolerance.m_velocity));
+	printf("%-17s %-36s %s\n", "", "reference", "optimized");
+
+	auto print_vec2 = [](const char* label, const Vec2& reference_value, const Vec2& optimized_value)
+	{
+		char reference_text[64];
+		snprintf(reference_text, sizeof(reference_text), "(%.9g, %.9g)",
+			static_cast<double>(reference_value.x), static_cast<double>(reference_value.y));
+		printf("%-17s %-36s (%.9g, %.9g)\n", label, reference_text,
+			static_cast<double>(optimized_value.x), static_cast<double>(optimized_value.y));
+	};
+	print_vec2("position", reference_state.m_position, optimized_state.m_position);
+	print_vec2("velocity", reference_state.m_velocity, optimized_state.m_velocity);
+	print_vec2("forward", reference_state.m_forward, optimized_state.m_forward);
+	print_vec2("wander target", reference_state.m_wanderTarget, optimized_state.m_wanderTarget);
+
+	char reference_text[64];
+	snprintf(reference_text, sizeof(reference_text), "0x%016llX",
+		static_cast<unsigned long long>(reference_state.m_randomState));
+	printf("%-17s %-36s 0x%016llX\n", "random state", reference_text,
+		static_cast<unsigned long long>(optimized_state.m_randomState));
+	printf("%-17s %-36s %s\n", "awake", reference_vehicle->IsAwake() ? "yes" : "no",
+		optimized_vehicle->IsAwake() ? "yes" : "no");
+	printf("%-17s %-36s %s\n", "lod tier", s_lodTierNames[reference_vehicle->GetLodTier()],
+		s_lodTierNames[optimized_vehicle->GetLodTier()]);
+	snprintf(reference_text, sizeof(reference_text), "%.9g s", reference_state.m_lodPendingSeconds);
+	printf("%-17s %-36s %.9g s\n", "lod pending", reference_text, optimized_state.m_lodPendingSeconds);
+	printf("%-17s %-36s %s\n", "obstacle contact", reference_state.m_obstacleContact != 0 ? "yes" : "no",
+		optimized_state.m_obstacleContact != 0 ? "yes" : "no");
+}
+
+
+STATIC bool SimGolden::ParsePaths(const std::string& paths_text, uint& out_paths)
+{
+	// comma separated names from s_goldenPathNames, or "none"
+	out_paths = 0;
+	size_t begin = 0;
+	while (begin <= paths_text.size())
+	{
+		const size_t end = std::min(paths_text.find(',', begin), paths_text.size());
+		const std::string name = paths_text.substr(begin, end - begin);
+		begin = end + 1;
+		if (name.empty() || name == "none")
+		{
+			continue;
+		}
+
+		bool found = false;
+		for (const GoldenPathName& path_name : s_goldenPathNames)
+		{
+			if (name == path_name.m_name)
+			{
+				out_paths |= path_name.m_path;
+				found = true;
+			}
+		}
+		if (!found)
+		{
+			printf("Unknown path '%s' in '%s'\n", name.c_str(), paths_text.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+
+STATIC std::string SimGolden::GetPathsText(const uint paths)
+{
+	std::string text;
+	for (const GoldenPathName& path_name : s_goldenPathNames)
+	{
+		if ((paths & path_name.m_path) != 0)
+		{
+			text += text.empty() ? "" : ",";
+			text += path_name.m_name;
+		}
+	}
+	return text.empty() ? "none" : text;
+}
+
+
+STATIC void SimGolden::PrintUsage()
+{
+	printf(
+		"usage: Headless golden [options]\n"
+		"  --agents N        population of both worlds (default 2000)\n"
+		"  --ticks N         fixed-dt ticks to compare (default 600)\n"
+		"  --dt S            seconds per tick (default 1/60)\n"
+		"  --seed N          seed of both worlds (default 0x5EED5EED5EED5EED)\n"
+		"  --mix SPEC        behavior mix, as for 'Headless run' (default wander:3,pursuit:1,+obstacle,+wall)\n"
+		"  --obstacles N     extra obstacles (default 8)\n"
+		"  --walls N         extra walls (default 4)\n"
+		"  --reference LIST  paths of the reference world (default none, all jobs inline)\n"
+		"  --optimized LIST  paths under test (default cull,parallel)\n"
+		"                    LIST is comma separated from snapshots, cull, flow, lod, parallel, or none\n"
+		"  --pos-tol D       per-agent position tolerance in world units (default 0.001)\n"
+		"  --vel-tol D       per-agent velocity tolerance in units/s (default 0.001)\n"
+		"  --keep-going      run every tick after the first divergence and report how far it drifts\n"
+	);
+}
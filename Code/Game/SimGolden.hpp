@@ -0,0 +1,88 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/SimScenario.hpp"
+#include "Game/SimRandom.hpp"
+#include "Game/VehicleState.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Game;
+
+//-----------------------------------------------------------------------------------------------
+// SimGolden
+//
+// Golden-trajectory check for fast paths in the vehicle update. Two worlds are built from the same
+// seed and setup: a reference, by default the plain path with every optimization off and every job
+// run inline on one thread, and an optimized one with the paths under test switched on. They are
+// stepped in lockstep and after every tick each vehicle's position and velocity are compared within
+// per-agent tolerances, position through the world wrap.
+//
+// The first tick any vehicle leaves its tolerance is reported with the vehicle's whole state in both
+// worlds and its behaviors, then the run stops (or, with --keep-going, carries on and reports how far
+// the worlds drifted apart). A new fast path gets a GOLDEN_PATH_* flag and can land once this passes.
+//
+// Only paths meant to be exact are tested by default. Target snapshots change what a pursuer sees
+// when it updates after its target, so they are checked against a reference that has them as well.
+//
+
+enum GoldenPath : uint
+{
+	GOLDEN_PATH_TARGET_SNAPSHOTS = 1u << 0,		// Game::SetTargetSnapshots, start-of-tick targets where the plain path reads them live
+	GOLDEN_PATH_CULL_AVOIDANCE = 1u << 1,		// Game::SetAvoidanceCulling
+	GOLDEN_PATH_FLOW_FIELDS = 1u << 2,			// Game::SetFlowFields, an approximation of seek and arrive
+	GOLDEN_PATH_LOD = 1u << 3,					// Game::SetLodEnabled, an approximation by design
+	GOLDEN_PATH_PARALLEL = 1u << 4,				// GameJobs workers, otherwise every job runs inline
+};
+
+
+struct GoldenTolerance
+{
+	float	m_position = 1.0e-3f;	// world units, per agent
+	float	m_velocity = 1.0e-3f;	// world units per second, per agent
+};
+
+
+struct GoldenDivergence
+{
+	uint	m_tick = 0;
+	uint	m_numDiverged = 0;		// vehicles past tolerance on that tick
+	uint	m_firstVehicle = 0;		// lowest index among them
+	uint	m_worstVehicle = 0;		// largest position error, or velocity error if no position is off
+	float	m_positionError = 0.0f;	// of the worst vehicle
+	float	m_velocityError = 0.0f;
+};
+
+
+class SimGolden
+{
+public:
+	uint		m_numAgents = 2'000;
+	uint		m_numTicks = 600;
+	uint		m_numObstacles = 8;
+	uint		m_numWalls = 4;
+	uint64_t	m_seed = SimRandom::DEFAULT_SEED;
+	double		m_deltaSeconds = 1.0 / 60.0;
+	uint		m_referencePaths = 0;
+	uint		m_optimizedPaths = GOLDEN_PATH_CULL_AVOIDANCE | GOLDEN_PATH_PARALLEL;
+	GoldenTolerance	m_tolerance;
+	bool		m_keepGoing = false;
+
+	std::vector<BehaviorWeight>	m_mix = { { STEER_WANDER, 3.0f }, { STEER_PURSUIT, 1.0f } };
+	std::vector<int>			m_modifiers = { STEER_OBSTACLE_AVOIDANCE, STEER_WALL_AVOIDANCE };
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	int		Run() const;
+
+	static void	PrintUsage();
+	static bool	ParsePaths(const std::string& paths_text, uint& out_paths);
+	static std::string	GetPathsText(uint paths);
+
+private:
+	Game*	CreateWorld(uint paths) const;
+	void	Step(Game* game, uint paths) const;
+	bool	Compare(const Game* reference, const Game* optimized, uint tick, GoldenDivergence& out_divergence,
+				float& out_max_position_error, float& out_max_velocity_error) const;
+	void	PrintDivergence(const Game* reference, const Game* optimized, const GoldenDivergence& divergence) const;
+};
@@ -0,0 +1,285 @@
+#include "Game/SimOrcaBench.hpp"
+#include "Game/OrcaSolver.hpp"
+#include "Game/SpatialHash.hpp"
+#include "Game/GameJobs.hpp"
+#include "Game/WrapDomain.hpp"
+#include "Game/Game.hpp"
+#include "Game/Vehicle.hpp"
+#include "Game/SimRandom.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// overlaps deeper than this fraction of the combined radius count as collisions in the report
+constexpr float ORCA_BENCH_OVERLAP_TOLERANCE = 0.9f;
+// --game crowd without --agents; Game vehicles have radius 5, so the solver crowd's 50000 would not fit the world
+constexpr uint ORCA_BENCH_GAME_AGENTS = 400;
+
+
+bool SimOrcaBench::ParseCommandLine(const int argc, char** argv)
+{
+	bool agents_given = false;
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--agents") == 0 && has_value)
+		{
+			m_numAgents = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+			agents_given = true;
+		}
+		else if (strcmp(arg, "--ticks") == 0 && has_value)
+		{
+			m_numTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--threads") == 0 && has_value)
+		{
+			m_numThreads = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--neighbors") == 0 && has_value)
+		{
+			m_maxNeighbors = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--spacing") == 0 && has_value)
+		{
+			m_spacing = static_cast<float>(strtod(argv[++arg_idx], nullptr));
+		}
+		else if (strcmp(arg, "--dt") == 0 && has_value)
+		{
+			m_deltaSeconds = strtod(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--wrap") == 0)
+		{
+			m_wrap = true;
+		}
+		else if (strcmp(arg, "--game") == 0)
+		{
+			m_throughGame = true;
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	if (m_throughGame && !agents_given)
+	{
+		m_numAgents = ORCA_BENCH_GAME_AGENTS;
+	}
+
+	if (m_numAgents == 0 || m_numTicks == 0 || m_spacing <= 0.0f || m_deltaSeconds <= 0.0)
+	{
+		printf("--agents, --ticks, --spacing and --dt must be positive\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+int SimOrcaBench::Run() const
+{
+	if (m_numThreads > 0)
+	{
+		GameJobs::SetNumWorkers(m_numThreads - 1);
+	}
+
+	if (m_throughGame)
+	{
+		return RunThroughGame();
+	}
+
+	const float half_side = std::sqrt(static_cast<float>(m_numAgents)) * m_spacing * 0.5f;
+	std::vector<OrcaAgent> agents(m_numAgents);
+	std::vector<Vec2> goals(m_numAgents);
+	std::vector<uint> solve_indices(m_numAgents);
+	for (uint agent_idx = 0; agent_idx < m_numAgents; ++agent_idx)
+	{
+		OrcaAgent& agent = agents[agent_idx];
+		agent.m_position = Vec2(
+			g_randomNumberGenerator.GetRandomFloatInRange(-half_side, half_side),
+			g_randomNumberGenerator.GetRandomFloatInRange(-half_side, half_side));
+		agent.m_radius = m_radius;
+		agent.m_maxSpeed = m_maxSpeed;
+
+		goals[agent_idx] = Vec2(
+			g_randomNumberGenerator.GetRandomFloatInRange(-half_side, half_side),
+			g_randomNumberGenerator.GetRandomFloatInRange(-half_side, half_side));
+		solve_indices[agent_idx] = agent_idx;
+	}
+
+	const WrapDomain domain = { Vec2(-half_side, -half_side), Vec2(half_side, half_side) };
+	OrcaSolver solver;
+	solver.SetMaxNeighbors(m_maxNeighbors);
+	solver.SetWrapDomain(m_wrap ? &domain : nullptr);
+
+	const float delta_seconds = static_cast<float>(m_deltaSeconds);
+	double total_solve_seconds = 0.0;
+	double max_solve_seconds = 0.0;
+	uint64_t total_iterations = 0;
+	for (uint tick_idx = 0; tick_idx < m_numTicks; ++tick_idx)
+	{
+		// straight at the goal, the avoidance alone keeps the crowd apart
+		for (uint agent_idx = 0; agent_idx < m_numAgents; ++agent_idx)
+		{
+			OrcaAgent& agent = agents[agent_idx];
+			const Vec2 to_goal = m_wrap ? domain.GetDisplacement(agent.m_position, goals[agent_idx]) :
+				goals[agent_idx] - agent.m_position;
+			const float distance = to_goal.GetLength();
+			agent.m_preferredVelocity = distance > m_maxSpeed * delta_seconds ?
+				to_goal * (m_maxSpeed / distance) : Vec2::ZERO;
+		}
+
+		solver.Solve(agents, solve_indices, delta_seconds);
+		total_solve_seconds += solver.GetLastSolveSeconds();
+		max_solve_seconds = std::max(max_solve_seconds, solver.GetLastSolveSeconds());
+		total_iterations += solver.GetIterationsLastTick();
+
+		for (uint agent_idx = 0; agent_idx < m_numAgents; ++agent_idx)
+		{
+			OrcaAgent& agent = agents[agent_idx];
+			agent.m_velocity = solver.GetVelocity(agent_idx);
+			agent.m_position += agent.m_velocity * delta_seconds;
+			if (m_wrap)
+			{
+				agent.m_position = domain.Wrap(agent.m_position);
+			}
+		}
+	}
+
+	std::vector<Vec2> positions(m_numAgents);
+	for (uint agent_idx = 0; agent_idx < m_numAgents; ++agent_idx)
+	{
+		positions[agent_idx] = agents[agent_idx].m_position;
+	}
+	const uint num_overlaps = CountOverlaps(positions, m_radius, m_wrap ? &domain : nullptr);
+
+	const double num_solves = static_cast<double>(m_numAgents) * static_cast<double>(m_numTicks);
+	printf("agents            %u in %.0f x %.0f%s\n", m_numAgents, half_side * 2.0f, half_side * 2.0f,
+		m_wrap ? ", wrapped" : "");
+	printf("threads           %u\n", GameJobs::GetNumThreads());
+	printf("neighbors         %u within %.1f\n", m_maxNeighbors, OrcaSolver::DEFAULT_NEIGHBOR_DISTANCE);
+	printf("solve             %.3f ms/tick avg, %.3f ms/tick max over %u ticks\n",
+		total_solve_seconds * 1000.0 / static_cast<double>(m_numTicks), max_solve_seconds * 1000.0, m_numTicks);
+	printf("per agent         %.1f ns, %.2f LP iterations\n",
+		total_solve_seconds * 1.0e9 / num_solves, static_cast<double>(total_iterations) / num_solves);
+	printf("overlapping pairs %u at the end\n", num_overlaps);
+	return 0;
+}
+
+
+int SimOrcaBench::RunThroughGame() const
+{
+	double avoiding_seconds = 0.0;
+	double plain_seconds = 0.0;
+	float radius = 0.0f;
+	const uint avoiding_overlaps = RunGameCrowd(true, avoiding_seconds, radius);
+	const uint plain_overlaps = RunGameCrowd(false, plain_seconds, radius);
+
+	const double num_ticks = static_cast<double>(m_numTicks);
+	printf("agents            %u Game vehicles of radius %.2f, arriving at random goals\n", m_numAgents, radius);
+	printf("threads           %u\n", GameJobs::GetNumThreads());
+	printf("update            %.3f ms/tick with agent avoidance, %.3f ms/tick without\n",
+		avoiding_seconds * 1000.0 / num_ticks, plain_seconds * 1000.0 / num_ticks);
+	printf("overlapping pairs %u at the end with agent avoidance, %u without\n", avoiding_overlaps, plain_overlaps);
+	return 0;
+}
+
+
+uint SimOrcaBench::RunGameCrowd(const bool avoid_agents, double& out_seconds, float& out_radius) const
+{
+	Game* game = new Game();
+	game->SetVisualsEnabled(false);
+	game->Startup();
+	game->SetNumVehicles(m_numAgents);
+
+	// the same goals both runs, vehicle 0 stays the wandering leader
+	SimRandom goal_random;
+	const uint num_vehicles = game->GetNumVehicles();
+	for (uint veh_idx = 1; veh_idx < num_vehicles; ++veh_idx)
+	{
+		const Vec2 goal(
+			goal_random.GetRandomFloatInRange(WORLD_WRAP.m_mins.x, WORLD_WRAP.m_maxs.x),
+			goal_random.GetRandomFloatInRange(WORLD_WRAP.m_mins.y, WORLD_WRAP.m_maxs.y));
+		Vehicle* vehicle = game->GetVehicle(veh_idx);
+		vehicle->TurnOffSteering();
+		vehicle->ArriveAt(goal);
+		if (avoid_agents)
+		{
+			game->AddVehicleBehavior(veh_idx, STEER_AGENT_AVOIDANCE);
+		}
+	}
+
+	const double begin_seconds = FrameTimeStats::GetTimeSeconds();
+	for (uint tick_idx = 0; tick_idx < m_numTicks; ++tick_idx)
+	{
+		game->Update(m_deltaSeconds);
+	}
+	out_seconds = FrameTimeStats::GetTimeSeconds() - begin_seconds;
+
+	std::vector<Vec2> positions(num_vehicles);
+	for (uint veh_idx = 0; veh_idx < num_vehicles; ++veh_idx)
+	{
+		positions[veh_idx] = game->GetVehicle(veh_idx)->GetPosition();
+	}
+	out_radius = game->GetVehicle(0)->GetBoundingRadius();
+	const uint num_overlaps = CountOverlaps(positions, out_radius, &WORLD_WRAP);
+
+	game->Shutdown();
+	delete game;
+	return num_overlaps;
+}
+
+
+STATIC uint SimOrcaBench::CountOverlaps(const std::vector<Vec2>& positions, const float radius,
+	const WrapDomain* wrap_domain)
+{
+	// pairs still interpenetrating, each counted once
+	const uint num_positions = static_cast<uint>(positions.size());
+	const float overlap_distance = radius * 2.0f * ORCA_BENCH_OVERLAP_TOLERANCE;
+	SpatialHash overlap_hash;
+	if (wrap_domain != nullptr)
+	{
+		overlap_hash.Build(positions.data(), num_positions, overlap_distance, *wrap_domain);
+	}
+	else
+	{
+		overlap_hash.Build(positions.data(), num_positions, overlap_distance);
+	}
+
+	uint num_overlaps = 0;
+	for (uint position_idx = 0; position_idx < num_positions; ++position_idx)
+	{
+		SpatialNeighbor neighbors[OrcaSolver::MAX_NEIGHBORS];
+		const uint num_neighbors = overlap_hash.QueryNearest(positions[position_idx], overlap_distance, position_idx,
+			OrcaSolver::MAX_NEIGHBORS, neighbors);
+		for (uint neighbor_idx = 0; neighbor_idx < num_neighbors; ++neighbor_idx)
+		{
+			num_overlaps += neighbors[neighbor_idx].m_index > position_idx ? 1 : 0;
+		}
+	}
+	return num_overlaps;
+}
+
+
+STATIC void SimOrcaBench::PrintUsage()
+{
+	printf(
+		"usage: Headless orca-bench [options]\n"
+		"  --agents N        crowd size (default 50000, 400 with --game)\n"
+		"  --ticks N         ticks to solve (default 300)\n"
+		"  --threads N       solver threads including the caller (default one per core)\n"
+		"  --neighbors K     nearest neighbors per agent, at most 10 (default 10)\n"
+		"  --spacing M       mean distance between agents at the start (default 3)\n"
+		"  --dt SECONDS      tick length (default 1/60)\n"
+		"  --wrap            opposite edges of the square meet, neighbors are found across them\n"
+		"  --game            run Game vehicles through Game::Update instead, with and without avoidance\n"
+	);
+}
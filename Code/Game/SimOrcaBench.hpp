@@ -0,0 +1,47 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/WrapDomain.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// SimOrcaBench
+//
+// Cost of agent-agent avoidance on its own, at crowd sizes well past the Game population cap: a
+// dense square of agents, each heading for a random goal across it, solved with OrcaSolver and
+// integrated every tick. Reports time and linear program iterations per agent, the worker count,
+// and how many pairs still overlap at the end. With --wrap the square is a torus, so the same crowd
+// can be timed with periodic neighbor queries against the open plane.
+//
+// The crowd above sets each velocity straight from the solver. --game runs the same kind of crowd
+// as Game vehicles instead, each arriving at a random goal, once with agent avoidance and once
+// without, through Game::Update and Vehicle::Update, and counts the overlaps of both. That is the
+// check on what the game does with the solve, not just on the solve.
+//
+
+class SimOrcaBench
+{
+public:
+	uint	m_numAgents = 50'000;
+	uint	m_numTicks = 300;
+	uint	m_numThreads = 0;			// 0 keeps the GameJobs default, one per core
+	uint	m_maxNeighbors = 10;
+	float	m_spacing = 3.0f;			// mean distance between agents at the start
+	float	m_radius = 0.5f;
+	float	m_maxSpeed = 5.0f;
+	double	m_deltaSeconds = 1.0 / 60.0;
+	bool	m_wrap = false;
+	bool	m_throughGame = false;
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	int		Run() const;
+
+	static void	PrintUsage();
+
+private:
+	int		RunThroughGame() const;
+	uint	RunGameCrowd(bool avoid_agents, double& out_seconds, float& out_radius) const;
+
+	static uint	CountOverlaps(const std::vector<Vec2>& positions, float radius, const WrapDomain* wrap_domain);
+};
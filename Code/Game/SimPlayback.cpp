@@ -0,0 +1,250 @@
+#include "Game/SimPlayback.hpp"
+#include "Game/Game.hpp"
+#include "Game/TrajectoryPlayback.hpp"
+#include "Game/RenderBackend.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+constexpr double PLAYBACK_RENDER_DELTA_SECONDS = 1.0 / 60.0;
+
+
+// FNV-1a over the current frame: its tick and every position and forward, bit for bit
+static uint64_t HashFrame(const TrajectoryPlayback& playback)
+{
+	uint64_t hash = 0xCBF29CE484222325ull ^ playback.GetTick();
+	const uint32_t* words[] = {
+		reinterpret_cast<const uint32_t*>(playback.GetPositions().data()),
+		reinterpret_cast<const uint32_t*>(playback.GetForwards().data())
+	};
+	const size_t num_words = 2 * static_cast<size_t>(playback.GetNumAgents());
+	for (const uint32_t* frame_words : words)
+	{
+		for (size_t word_idx = 0; word_idx < num_words; ++word_idx)
+		{
+			hash = (hash ^ frame_words[word_idx]) * 0x100000001B3ull;
+		}
+	}
+	return hash;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool SimPlayback::ParseCommandLine(const int argc, char** argv)
+{
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--file") == 0 && has_value)
+		{
+			m_filePath = argv[++arg_idx];
+		}
+		else if (strcmp(arg, "--seeks") == 0 && has_value)
+		{
+			m_numSeeks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--seed") == 0 && has_value)
+		{
+			m_seed = strtoull(argv[++arg_idx], nullptr, 0);
+		}
+		else if (strcmp(arg, "--verify") == 0)
+		{
+			m_verify = true;
+		}
+		else if (strcmp(arg, "--render") == 0)
+		{
+			m_render = true;
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	if (m_filePath.empty())
+	{
+		printf("--file is required\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+int SimPlayback::Run() const
+{
+	TrajectoryPlayback playback;
+	const double open_begin = FrameTimeStats::GetTimeSeconds();
+	if (!playback.Open(m_filePath))
+	{
+		printf("Could not open '%s' as a finished trajectory file\n", m_filePath.c_str());
+		return 1;
+	}
+	const double open_seconds = FrameTimeStats::GetTimeSeconds() - open_begin;
+	const uint num_agents = playback.GetNumAgents();
+	const uint first_tick = playback.GetFirstTick();
+	const uint last_tick = playback.GetLastTick();
+
+	// start to end, the cost of watching it
+	uint64_t agent_records = num_agents;
+	const double play_begin = FrameTimeStats::GetTimeSeconds();
+	while (playback.Step())
+	{
+		agent_records += playback.GetNumAgents();
+	}
+	const double play_seconds = FrameTimeStats::GetTimeSeconds() - play_begin;
+
+	SimRandom random(m_seed);
+	std::vector<uint> seek_ticks(m_numSeeks);
+	std::vector<double> seek_seconds(m_numSeeks);
+	for (uint seek_idx = 0; seek_idx < m_numSeeks; ++seek_idx)
+	{
+		seek_ticks[seek_idx] = first_tick + random.GetRandomUint32() % (last_tick - first_tick + 1);
+		const double seek_begin = FrameTimeStats::GetTimeSeconds();
+		playback.Seek(seek_ticks[seek_idx]);
+		seek_seconds[seek_idx] = FrameTimeStats::GetTimeSeconds() - seek_begin;
+	}
+
+	// the last tick of a block decodes all of it; come from another block so nothing carries over
+	const uint num_blocks = playback.GetNumBlocks();
+	double worst_seek_seconds = 0.0;
+	for (uint seek_idx = 0; seek_idx < std::min(m_numSeeks, num_blocks); ++seek_idx)
+	{
+		const uint block_idx = random.GetRandomUint32() % num_blocks;
+		playback.Seek(block_idx == 0 ? last_tick : first_tick);
+		const double seek_begin = FrameTimeStats::GetTimeSeconds();
+		playback.Seek(playback.GetBlock(block_idx).m_lastTick);
+		worst_seek_seconds = std::max(worst_seek_seconds, FrameTimeStats::GetTimeSeconds() - seek_begin);
+	}
+
+	std::vector<double> sorted_seconds = seek_seconds;
+	std::sort(sorted_seconds.begin(), sorted_seconds.end());
+	double total_seek_seconds = 0.0;
+	for (const double seconds : seek_seconds)
+	{
+		total_seek_seconds += seconds;
+	}
+
+	const double num_frames = static_cast<double>(std::max(playback.GetNumFrames(), 1u));
+	const double num_seeks = static_cast<double>(std::max(m_numSeeks, 1u));
+	printf("file              %s\n", m_filePath.c_str());
+	printf("recording         %u agents, ticks %u-%u, %u frames in %u blocks of %u, %llu dropped\n",
+		num_agents, first_tick, last_tick, playback.GetNumFrames(), num_blocks, playback.GetHeader().m_blockFrames,
+		static_cast<unsigned long long>(playback.GetDroppedFrames()));
+	printf("open              %.3f ms\n", open_seconds * 1000.0);
+	printf("playback          %.3f ms/frame, %.1f ns/agent\n", play_seconds * 1000.0 / num_frames,
+		play_seconds * 1.0e9 / static_cast<double>(std::max<uint64_t>(agent_records, 1)));
+	if (m_numSeeks > 0)
+	{
+		printf("seek              %.3f ms mean, %.3f ms p99, %.3f ms max over %u random ticks\n",
+			total_seek_seconds * 1000.0 / num_seeks,
+			sorted_seconds[std::min(m_numSeeks - 1, m_numSeeks * 99 / 100)] * 1000.0,
+			sorted_seconds.back() * 1000.0, m_numSeeks);
+		printf("seek block end    %.3f ms, the bound for any seek\n", worst_seek_seconds * 1000.0);
+	}
+
+	if (m_render)
+	{
+		printf("render            %.3f ms/frame, Game::Update and Render of every frame\n", TimeRendering() * 1000.0);
+	}
+
+	if (m_verify)
+	{
+		const bool matches = Verify(playback, seek_ticks);
+		printf("verify            %s, %u seeks against sequential playback\n", matches ? "PASS" : "FAIL", m_numSeeks);
+		return matches ? 0 : 1;
+	}
+	return 0;
+}
+
+
+bool SimPlayback::Verify(TrajectoryPlayback& playback, std::vector<uint> ticks) const
+{
+	// what sequential playback shows at each tick: the last frame at or before it
+	std::vector<uint> order(ticks.size());
+	for (uint seek_idx = 0; seek_idx < order.size(); ++seek_idx)
+	{
+		order[seek_idx] = seek_idx;
+	}
+	std::sort(order.begin(), order.end(), [&ticks](const uint lhs, const uint rhs) { return ticks[lhs] < ticks[rhs]; });
+
+	TrajectoryPlayback sequential;
+	if (!sequential.Open(m_filePath))
+	{
+		return false;
+	}
+
+	std::vector<uint64_t> expected(ticks.size());
+	uint64_t landing_hash = HashFrame(sequential);
+	bool has_more = true;
+	for (const uint seek_idx : order)
+	{
+		while (has_more && sequential.GetTick() <= ticks[seek_idx])
+		{
+			landing_hash = HashFrame(sequential);
+			has_more = sequential.Step();
+		}
+		expected[seek_idx] = landing_hash;
+	}
+
+	// the same ticks again in random order, each a seek from wherever the previous one left off
+	uint num_mismatches = 0;
+	for (uint seek_idx = 0; seek_idx < ticks.size(); ++seek_idx)
+	{
+		if (!playback.Seek(ticks[seek_idx]) || HashFrame(playback) != expected[seek_idx])
+		{
+			if (num_mismatches == 0)
+			{
+				printf("seek to tick %u landed on tick %u, not the frame playback shows there\n",
+					ticks[seek_idx], playback.GetTick());
+			}
+			++num_mismatches;
+		}
+	}
+	return num_mismatches == 0;
+}
+
+
+double SimPlayback::TimeRendering() const
+{
+	Game* game = new Game();
+	game->Startup();
+	double render_seconds = 0.0;
+	uint num_frames = 0;
+	if (game->StartTrajectoryPlayback(m_filePath))
+	{
+		const double render_begin = FrameTimeStats::GetTimeSeconds();
+		do
+		{
+			g_theRenderer->BeginFrame();
+			game->Render();
+			g_theRenderer->EndFrame();
+			game->Update(PLAYBACK_RENDER_DELTA_SECONDS);
+			++num_frames;
+		} while (game->IsPlayingBack() && !game->IsPlaybackPaused());
+		render_seconds = FrameTimeStats::GetTimeSeconds() - render_begin;
+	}
+
+	game->Shutdown();
+	delete game;
+	return render_seconds / static_cast<double>(std::max(num_frames, 1u));
+}
+
+
+STATIC void SimPlayback::PrintUsage()
+{
+	printf(
+		"usage: Headless playback --file FILE [options]\n"
+		"  --file FILE       trajectory file, e.g. from 'Headless --record FILE'\n"
+		"  --seeks N         random seeks to time (default 200)\n"
+		"  --seed N          seed of the seek targets (default 0x5EED5EED5EED5EED)\n"
+		"  --verify          require every seek to land on the frame sequential playback shows\n"
+		"  --render          also play it through Game::Update and Render against the null renderer\n"
+	);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/SimRandom.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class TrajectoryPlayback;
+
+//-----------------------------------------------------------------------------------------------
+// SimPlayback
+//
+// Cost of reading a trajectory file back (record one with "Headless --record FILE"): opening it,
+// playing it from start to end, random seeks, and seeks to the end of a block, which decode the most
+// frames and bound every other seek. With --verify every random seek has to land on exactly the frame
+// sequential playback reaches; with --render the recording drives a Game through Update and Render
+// against the null renderer, the path the viewer uses.
+//
+
+class SimPlayback
+{
+public:
+	std::string	m_filePath;
+	uint		m_numSeeks = 200;
+	uint64_t	m_seed = SimRandom::DEFAULT_SEED;	// of the seek targets
+	bool		m_verify = false;
+	bool		m_render = false;
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	int		Run() const;
+
+	static void	PrintUsage();
+
+private:
+	bool	Verify(TrajectoryPlayback& playback, std::vector<uint> ticks) const;
+	double	TimeRendering() const;
+};
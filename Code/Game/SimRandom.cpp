@@ -0,0 +1,51 @@
+#include "Game/SimRandom.hpp"
+
+// splitmix64 increment, the fractional part of the golden ratio
+constexpr uint64_t SIM_RANDOM_GAMMA = 0x9E3779B97F4A7C15ull;
+
+
+static uint64_t MixBits(uint64_t bits)
+{
+	bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ull;
+	bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBull;
+	return bits ^ (bits >> 31);
+}
+
+
+SimRandom::SimRandom(const uint64_t seed)
+{
+	Seed(seed);
+}
+
+
+void SimRandom::Seed(const uint64_t seed)
+{
+	m_seed = seed;
+	m_state = seed;
+}
+
+
+uint32_t SimRandom::GetRandomUint32()
+{
+	m_state += SIM_RANDOM_GAMMA;
+	return static_cast<uint32_t>(MixBits(m_state) >> 32);
+}
+
+
+float SimRandom::GetRandomFloatZeroToOne()
+{
+	// 24 bits fill a float mantissa exactly, so both ends are reachable
+	return static_cast<float>(GetRandomUint32() >> 8) * (1.0f / 16'777'215.0f);
+}
+
+
+float SimRandom::GetRandomFloatInRange(const float min_inclusive, const float max_inclusive)
+{
+	return min_inclusive + (max_inclusive - min_inclusive) * GetRandomFloatZeroToOne();
+}
+
+
+STATIC uint64_t SimRandom::CombineSeeds(const uint64_t seed, const uint64_t stream)
+{
+	return MixBits(seed ^ MixBits(stream + SIM_RANDOM_GAMMA));
+}
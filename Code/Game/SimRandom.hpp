@@ -0,0 +1,39 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include <cstdint>
+
+//-----------------------------------------------------------------------------------------------
+// SimRandom
+//
+// Small seedable generator (splitmix64) for simulation state, so each world and each vehicle draws
+// from its own stream instead of the engine's shared g_randomNumberGenerator. The same seed always
+// gives the same sequence on every platform; streams derived with CombineSeeds() do not overlap in
+// practice, which keeps a vehicle's draws independent of how many others exist or update first.
+//
+
+class SimRandom
+{
+public:
+	static constexpr uint64_t DEFAULT_SEED = 0x5EED5EED5EED5EEDull;
+
+public:
+	explicit SimRandom(uint64_t seed = DEFAULT_SEED);
+
+	void		Seed(uint64_t seed);
+	uint64_t	GetSeed() const { return m_seed; }
+
+	// the position in the stream, enough to carry it over to another process and continue there
+	uint64_t	GetState() const { return m_state; }
+	void		SetState(uint64_t state) { m_state = state; }
+
+	uint32_t	GetRandomUint32();
+	float		GetRandomFloatZeroToOne();
+	float		GetRandomFloatInRange(float min_inclusive, float max_inclusive);
+
+	// seed for a sub-stream, e.g. CombineSeeds(world_seed, vehicle_idx)
+	static uint64_t	CombineSeeds(uint64_t seed, uint64_t stream);
+
+private:
+	uint64_t	m_seed = DEFAULT_SEED;
+	uint64_t	m_state = DEFAULT_SEED;
+};
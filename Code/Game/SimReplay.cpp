@@ -0,0 +1,245 @@
+#include "Game/SimReplay.hpp"
+#include "Game/Game.hpp"
+#include "Game/GameJobs.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+//-----------------------------------------------------------------------------------------------
+bool SimReplay::ParseCommandLine(const int argc, char** argv)
+{
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--file") == 0 && has_value)
+		{
+			m_filePath = argv[++arg_idx];
+		}
+		else if (strcmp(arg, "--dt") == 0 && has_value)
+		{
+			m_fixedDeltaSeconds = strtod(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--threads") == 0 && has_value)
+		{
+			m_numThreads = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--slowest") == 0 && has_value)
+		{
+			m_numSlowest = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--frame-times") == 0 && has_value)
+		{
+			m_frameTimesPath = argv[++arg_idx];
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	if (m_filePath.empty() || m_fixedDeltaSeconds < 0.0)
+	{
+		printf("--file must be non-empty and --dt positive\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+int SimReplay::Run() const
+{
+	InputReplay replay;
+	if (!replay.Open(m_filePath))
+	{
+		printf("Could not open '%s' as an input recording\n", m_filePath.c_str());
+		return 1;
+	}
+
+	if (m_numThreads > 0)
+	{
+		GameJobs::SetNumWorkers(m_numThreads - 1);
+	}
+
+	const InputFileHeader& header = replay.GetHeader();
+	Game* game = CreateWorld(header);
+	const bool verify = m_fixedDeltaSeconds == 0.0;
+
+	std::vector<ReplayTick> ticks;
+	uint num_keys = 0;
+	uint num_settings = 0;
+	uint num_checkpoints = 0;
+	uint first_divergence = 0;
+	bool diverged = false;
+	uint last_key_frame = 0;
+	uint8_t last_key_code = 0;
+	double sim_seconds = 0.0;
+	double game_seconds = 0.0;
+
+	InputEvent event;
+	while (replay.Next(event))
+	{
+		switch (event.m_type)
+		{
+		case INPUT_EVENT_FRAME:
+		case INPUT_EVENT_FRAME_SAME_DT:
+		{
+			const double delta_seconds = verify ? event.m_deltaSeconds : m_fixedDeltaSeconds;
+			const double update_begin = FrameTimeStats::GetTimeSeconds();
+			game->Update(delta_seconds);
+			const double update_seconds = FrameTimeStats::GetTimeSeconds() - update_begin;
+			sim_seconds += update_seconds;
+			game_seconds += delta_seconds;
+
+			ReplayTick tick;
+			tick.m_frame = static_cast<uint>(ticks.size()) + 1;
+			tick.m_milliseconds = static_cast<float>(update_seconds * 1000.0);
+			tick.m_numVehicles = game->GetNumVehicles();
+			tick.m_lastKeyFrame = last_key_frame;
+			tick.m_lastKeyCode = last_key_code;
+			ticks.push_back(tick);
+			break;
+		}
+
+		case INPUT_EVENT_KEY_PRESSED:
+			game->HandleKeyPressed(event.m_keyCode);
+			last_key_frame = static_cast<uint>(ticks.size());
+			last_key_code = event.m_keyCode;
+			++num_keys;
+			break;
+
+		case INPUT_EVENT_KEY_RELEASED:
+			game->HandleKeyReleased(event.m_keyCode);
+			break;
+
+		case INPUT_EVENT_SETTINGS:
+			game->SetSteeringCombine(static_cast<SteeringCombine>(event.m_steeringCombine));
+			game->ApplyInputSettings(event.m_settings);
+			++num_settings;
+			break;
+
+		case INPUT_EVENT_CHECKPOINT:
+		case INPUT_EVENT_END:
+			// after the first difference every later one follows from it
+			if (verify && !diverged)
+			{
+				++num_checkpoints;
+				if (event.m_frame != ticks.size() || game->ComputeStateHash() != event.m_stateHash)
+				{
+					diverged = true;
+					first_divergence = event.m_frame;
+				}
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	const FrameTimeHistogram& tick_times = game->GetTickTimes().GetHistogram(FRAME_TIME_SPAN_ALL);
+	const uint num_frames = static_cast<uint>(ticks.size());
+	printf("file              %s, %u frames, %s\n", m_filePath.c_str(), num_frames,
+		replay.IsComplete() ? "complete" : "cut short, replayed up to its last whole event");
+	printf("recorded          seed 0x%016llX, %u agents at start, %u key presses, %u toggle changes\n",
+		static_cast<unsigned long long>(header.m_seed), header.m_numVehicles, num_keys, num_settings);
+	if (verify)
+	{
+		printf("dt                as recorded, %.3f s of game time\n", game_seconds);
+	}
+	else
+	{
+		printf("dt                fixed %.6f s instead of the recorded ones\n", m_fixedDeltaSeconds);
+	}
+	printf("agents            %u at the end, %u thread(s)\n", game->GetNumVehicles(), GameJobs::GetNumThreads());
+	printf("simulation        %.3f ms, %.3f ms/tick\n", sim_seconds * 1000.0,
+		sim_seconds * 1000.0 / static_cast<double>(std::max(num_frames, 1u)));
+	printf("tick p50/p99      %.3f / %.3f ms\n", static_cast<double>(tick_times.GetValueAtPercentile(50.0)) * 1.0e-3,
+		static_cast<double>(tick_times.GetValueAtPercentile(99.0)) * 1.0e-3);
+	printf("tick p99.9/max    %.3f / %.3f ms\n", static_cast<double>(tick_times.GetValueAtPercentile(99.9)) * 1.0e-3,
+		static_cast<double>(tick_times.GetMax()) * 1.0e-3);
+	PrintSlowest(ticks);
+
+	if (!m_frameTimesPath.empty() && !game->DumpFrameTimes(m_frameTimesPath))
+	{
+		printf("Could not write '%s'\n", m_frameTimesPath.c_str());
+	}
+	game->Shutdown();
+	delete game;
+
+	if (!verify)
+	{
+		printf("verify            skipped, --dt makes it a different run\n");
+		return 0;
+	}
+	if (diverged)
+	{
+		printf("verify            FAIL, state differs by the checkpoint after frame %u\n", first_divergence);
+		return 1;
+	}
+	printf("verify            %s, %u checkpoints match\n", num_checkpoints > 0 ? "PASS" : "nothing to check",
+		num_checkpoints);
+	return 0;
+}
+
+
+Game* SimReplay::CreateWorld(const InputFileHeader& header) const
+{
+	// what App::Startup builds, less the visuals, which the simulation never reads
+	Game* game = new Game();
+	game->SetSeed(header.m_seed);
+	game->SetVisualsEnabled(false);
+	game->Startup();
+	game->SetNumVehicles(header.m_numVehicles);
+	game->SetSteeringCombine(static_cast<SteeringCombine>(header.m_steeringCombine));
+	game->ApplyInputSettings(header.m_settings);
+	return game;
+}
+
+
+void SimReplay::PrintSlowest(std::vector<ReplayTick>& ticks) const
+{
+	const size_t num_slowest = std::min(static_cast<size_t>(m_numSlowest), ticks.size());
+	std::partial_sort(ticks.begin(), ticks.begin() + num_slowest, ticks.end(),
+		[](const ReplayTick& lhs, const ReplayTick& rhs) { return lhs.m_milliseconds > rhs.m_milliseconds; });
+
+	for (size_t tick_idx = 0; tick_idx < num_slowest; ++tick_idx)
+	{
+		const ReplayTick& tick = ticks[tick_idx];
+		printf("%-17s frame %u, %.3f ms, %u agents", tick_idx == 0 ? "slowest ticks" : "", tick.m_frame,
+			static_cast<double>(tick.m_milliseconds), tick.m_numVehicles);
+		if (tick.m_lastKeyCode == 0)
+		{
+			printf(", no key yet\n");
+		}
+		else if (isprint(tick.m_lastKeyCode))
+		{
+			printf(", %u frames after key '%c'\n", tick.m_frame - tick.m_lastKeyFrame, tick.m_lastKeyCode);
+		}
+		else
+		{
+			printf(", %u frames after key 0x%02X\n", tick.m_frame - tick.m_lastKeyFrame, tick.m_lastKeyCode);
+		}
+	}
+}
+
+
+STATIC void SimReplay::PrintUsage()
+{
+	printf(
+		"usage: Headless replay [options]\n"
+		"  --file FILE       input recording of a session (default Session.input)\n"
+		"  --dt S            fixed dt for every frame instead of the recorded ones, skips verification\n"
+		"  --threads N       total simulation threads (default: one per core)\n"
+		"  --slowest N       slowest ticks to list with what preceded them (default 5)\n"
+		"  --frame-times F   also write the replay's tick times, .csv or .json\n"
+	);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/InputRecording.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Game;
+
+//-----------------------------------------------------------------------------------------------
+// SimReplay
+//
+// Runs an input recording of an interactive session (inputRecordFile in GameConfig.xml) again
+// without a window: the same seed and starting population, then every recorded key, toggle and dt,
+// each Update timed. A session that was slow becomes a benchmark that runs the same way every time.
+//
+// The recorded dts reproduce the session exactly, and every checkpoint in the file is checked
+// against the replayed world's state hash; the first that differs says from which frame on the
+// replay is no longer the same run. --dt replaces every recorded dt with a fixed one instead, which
+// still applies the inputs at the same frames but is a different run, so nothing is verified.
+//
+// The report has the tick time percentiles and the slowest ticks, each with the population and the
+// last key before it, which is usually what caused it.
+//
+
+struct ReplayTick
+{
+	uint	m_frame = 0;
+	float	m_milliseconds = 0.0f;
+	uint	m_numVehicles = 0;
+	uint	m_lastKeyFrame = 0;		// frame the last key before this tick came in on
+	uint8_t	m_lastKeyCode = 0;		// 0 while no key has been pressed yet
+};
+
+
+class SimReplay
+{
+public:
+	std::string	m_filePath = InputRecorder::DEFAULT_PATH;
+	std::string	m_frameTimesPath;			// Game::DumpFrameTimes of the replay, skipped when empty
+	double		m_fixedDeltaSeconds = 0.0;	// 0 replays the recorded dts
+	uint		m_numThreads = 0;			// 0 keeps the GameJobs default, one per core
+	uint		m_numSlowest = 5;
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	int		Run() const;
+
+	static void	PrintUsage();
+
+private:
+	Game*	CreateWorld(const InputFileHeader& header) const;
+	void	PrintSlowest(std::vector<ReplayTick>& ticks) const;
+};
@@ -0,0 +1,515 @@
+#include "Game/SimScenario.hpp"
+#include "Game/Game.hpp"
+#include "Game/RenderBackend.hpp"
+#include "Game/TraceRecorder.hpp"
+#include "Game/AllocationCounter.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+static const char* s_behaviorNames[NUM_STEER_BEHAVIORS] = {
+	"none", "seek", "flee", "arrive", "pursuit", "evade", "wander", "obstacle", "wall", "agents"
+};
+
+
+bool SimScenario::ParseCommandLine(const int argc, char** argv)
+{
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--agents") == 0 && has_value)
+		{
+			m_numAgents = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--ticks") == 0 && has_value)
+		{
+			m_numTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--dt") == 0 && has_value)
+		{
+			m_deltaSeconds = strtod(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--mix") == 0 && has_value)
+		{
+			if (!ParseBehaviorMix(argv[++arg_idx], m_mix, m_modifiers))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--script") == 0 && has_value)
+		{
+			if (!LoadScript(argv[++arg_idx]))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--frame-times") == 0 && has_value)
+		{
+			m_frameTimesPath = argv[++arg_idx];
+		}
+		else if (strcmp(arg, "--trace") == 0 && has_value)
+		{
+			m_tracePath = argv[++arg_idx];
+		}
+		else if (strcmp(arg, "--record") == 0 && has_value)
+		{
+			m_trajectoryPath = argv[++arg_idx];
+		}
+		else if (strcmp(arg, "--record-ring") == 0 && has_value)
+		{
+			m_trajectorySettings.m_ringFrames = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--record-block") == 0 && has_value)
+		{
+			m_trajectorySettings.m_blockFrames = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--record-step") == 0 && has_value)
+		{
+			m_trajectorySettings.m_positionStep = static_cast<float>(strtod(argv[++arg_idx], nullptr));
+		}
+		else if (strcmp(arg, "--record-block-on-full") == 0)
+		{
+			m_trajectorySettings.m_overflow = TRAJECTORY_OVERFLOW_BLOCK;
+		}
+		else if (strcmp(arg, "--seed") == 0 && has_value)
+		{
+			m_seed = strtoull(argv[++arg_idx], nullptr, 0);
+		}
+		else if (strcmp(arg, "--no-cull") == 0)
+		{
+			m_cullAvoidance = false;
+		}
+		else if (strcmp(arg, "--flow") == 0)
+		{
+			m_flowFields = true;
+		}
+		else if (strcmp(arg, "--no-snapshots") == 0)
+		{
+			m_targetSnapshots = false;
+		}
+		else if (strcmp(arg, "--prioritized") == 0)
+		{
+			m_prioritized = true;
+		}
+		else if (strcmp(arg, "--lod") == 0)
+		{
+			m_lodTiers = true;
+		}
+		else if (strcmp(arg, "--render") == 0)
+		{
+			m_render = true;
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	if (m_deltaSeconds <= 0.0)
+	{
+		printf("--dt must be positive\n");
+		return false;
+	}
+
+	if (m_trajectorySettings.m_ringFrames == 0 || m_trajectorySettings.m_blockFrames == 0 ||
+		!(m_trajectorySettings.m_positionStep > 0.0f))
+	{
+		printf("--record-ring, --record-block and --record-step must be positive\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+bool SimScenario::LoadScript(const std::string& file_path)
+{
+	std::ifstream script(file_path);
+	if (!script.is_open())
+	{
+		printf("Could not open scenario script '%s'\n", file_path.c_str());
+		return false;
+	}
+
+	std::string line;
+	int line_number = 0;
+	while (std::getline(script, line))
+	{
+		++line_number;
+		if (line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+
+		std::istringstream line_stream(line);
+		ScenarioEvent scenario_event;
+		if (!(line_stream >> scenario_event.m_tick >> scenario_event.m_command))
+		{
+			printf("%s(%d): expected '<tick> <command> [argument]'\n", file_path.c_str(), line_number);
+			return false;
+		}
+
+		line_stream >> scenario_event.m_argument;
+		m_events.push_back(scenario_event);
+	}
+
+	std::stable_sort(m_events.begin(), m_events.end(),
+		[](const ScenarioEvent& lhs, const ScenarioEvent& rhs) { return lhs.m_tick < rhs.m_tick; });
+	return true;
+}
+
+
+int SimScenario::Run()
+{
+	Game* game = new Game();
+
+	const double startup_begin = GetTimeSeconds();
+	game->SetSeed(m_seed);
+	game->Startup();
+	game->SetFrameTimesPath(m_frameTimesPath);
+	const double startup_seconds = GetTimeSeconds() - startup_begin;
+
+	ScenarioResult result = Execute(game);
+	result.m_startupSeconds = startup_seconds;
+
+	if (!m_tracePath.empty())
+	{
+		TraceRecorder::Dump(m_tracePath, 0.0);
+	}
+
+	game->Shutdown();
+	delete game;
+
+	PrintResult(result);
+	return 0;
+}
+
+
+ScenarioResult SimScenario::Execute(Game* game) const
+{
+	ScenarioResult result;
+	result.m_numTicks = m_numTicks;
+
+	const double populate_begin = GetTimeSeconds();
+	game->SetNumVehicles(m_numAgents);
+	result.m_populateSeconds = GetTimeSeconds() - populate_begin;
+	result.m_numAgents = game->GetNumVehicles();
+	result.m_meshesCreated = g_theRenderer->GetTotalStats().m_meshesCreated;
+	result.m_residentMeshBytes = g_theRenderer->GetResidentMeshBytes();
+
+	game->SetAvoidanceCulling(m_cullAvoidance);
+	game->SetLodEnabled(m_lodTiers);
+	game->SetTargetSnapshots(m_targetSnapshots);
+	game->SetFlowFields(m_flowFields);
+	game->SetSteeringCombine(m_prioritized ? STEER_COMBINE_PRIORITIZED : STEER_COMBINE_AVERAGE);
+	ApplyBehaviorMix(game, m_mix, m_modifiers);
+
+	if (!m_trajectoryPath.empty())
+	{
+		result.m_recordedTrajectories = game->StartTrajectoryRecording(m_trajectoryPath, m_trajectorySettings);
+		if (!result.m_recordedTrajectories)
+		{
+			printf("Could not record trajectories to '%s'\n", m_trajectoryPath.c_str());
+		}
+	}
+
+	size_t next_event = 0;
+	for (uint tick_idx = 0; tick_idx < m_numTicks; ++tick_idx)
+	{
+		while (next_event < m_events.size() && m_events[next_event].m_tick <= tick_idx)
+		{
+			ApplyEvent(game, m_events[next_event]);
+			++next_event;
+		}
+
+		const double update_begin = GetTimeSeconds();
+		game->Update(m_deltaSeconds);
+		const double update_end = GetTimeSeconds();
+		result.m_simSeconds += update_end - update_begin;
+		result.m_agentUpdates += game->GetNumUpdatedLastTick();
+		result.m_allocations += game->GetAllocationsLastTick();
+
+		if (m_render)
+		{
+			g_theRenderer->BeginFrame();
+			game->Render();
+			g_theRenderer->EndFrame();
+			result.m_renderSeconds += GetTimeSeconds() - update_end;
+		}
+	}
+
+	if (result.m_recordedTrajectories)
+	{
+		result.m_trajectoriesComplete = game->StopTrajectoryRecording();
+		result.m_trajectoryStats = game->GetTrajectoryRecorder()->GetStats();
+	}
+
+	const FrameTimeHistogram& tick_times = game->GetTickTimes().GetHistogram(FRAME_TIME_SPAN_ALL);
+	result.m_tickP50Ms = static_cast<double>(tick_times.GetValueAtPercentile(50.0)) * 1.0e-3;
+	result.m_tickP99Ms = static_cast<double>(tick_times.GetValueAtPercentile(99.0)) * 1.0e-3;
+	result.m_tickP999Ms = static_cast<double>(tick_times.GetValueAtPercentile(99.9)) * 1.0e-3;
+	result.m_tickMaxMs = static_cast<double>(tick_times.GetMax()) * 1.0e-3;
+
+	for (int tier_idx = 0; tier_idx < NUM_LOD_TIERS; ++tier_idx)
+	{
+		result.m_lodTierPopulations[tier_idx] = game->GetLodScheduler().GetTierPopulation(tier_idx);
+	}
+
+	return result;
+}
+
+
+void SimScenario::PrintResult(const ScenarioResult& result) const
+{
+	const double ticks_per_second = result.m_simSeconds > 0.0 ?
+		static_cast<double>(result.m_numTicks) / result.m_simSeconds : 0.0;
+	const double updates_per_second = result.m_simSeconds > 0.0 ?
+		static_cast<double>(result.m_agentUpdates) / result.m_simSeconds : 0.0;
+
+	if (result.m_numAgents == m_numAgents)
+	{
+		printf("agents            %u\n", result.m_numAgents);
+	}
+	else
+	{
+		printf("agents            %u (%u requested)\n", result.m_numAgents, m_numAgents);
+	}
+	printf("ticks             %u (dt %.6f s)\n", result.m_numTicks, m_deltaSeconds);
+	printf("startup           %.3f ms\n", result.m_startupSeconds * 1000.0);
+	printf("populate          %.3f ms\n", result.m_populateSeconds * 1000.0);
+	printf("gpu meshes        %llu created, %llu bytes resident\n",
+		static_cast<unsigned long long>(result.m_meshesCreated),
+		static_cast<unsigned long long>(result.m_residentMeshBytes));
+	printf("simulation        %.3f ms\n", result.m_simSeconds * 1000.0);
+	printf("ticks/s           %.1f\n", ticks_per_second);
+	printf("agent-updates/s   %.1f\n", updates_per_second);
+	printf("allocations       %llu during Game::Update, process-wide%s\n", static_cast<unsigned long long>(result.m_allocations),
+		AllocationCounter::CountsEveryAllocation() ? "" : ", net of frees");
+	if (m_lodTiers)
+	{
+		printf("lod tiers 1/2/4   %u / %u / %u agents\n", result.m_lodTierPopulations[LOD_TIER_FULL],
+			result.m_lodTierPopulations[LOD_TIER_HALF], result.m_lodTierPopulations[LOD_TIER_QUARTER]);
+	}
+	printf("tick p50/p99      %.3f / %.3f ms\n", result.m_tickP50Ms, result.m_tickP99Ms);
+	printf("tick p99.9/max    %.3f / %.3f ms\n", result.m_tickP999Ms, result.m_tickMaxMs);
+
+	if (result.m_recordedTrajectories)
+	{
+		// raw is what the frames hold before encoding, three floats per agent
+		const TrajectoryStats& stats = result.m_trajectoryStats;
+		const double agent_records = static_cast<double>(std::max<uint64_t>(stats.m_encodedAgents, 1));
+		const double capture_share = result.m_simSeconds > 0.0 ? stats.m_captureSeconds / result.m_simSeconds : 0.0;
+		printf("trajectories      %llu frames written, %llu dropped%s\n",
+			static_cast<unsigned long long>(stats.m_writtenFrames),
+			static_cast<unsigned long long>(stats.m_droppedFrames),
+			result.m_trajectoriesComplete ? "" : ", WRITE FAILED");
+		printf("trajectory file   %.2f MB, %.2f bytes/agent/frame (raw %u)\n",
+			static_cast<double>(stats.m_writtenBytes) / (1024.0 * 1024.0),
+			static_cast<double>(stats.m_writtenBytes) / agent_records, static_cast<uint>(3 * sizeof(float)));
+		printf("capture           %.3f ms/tick, %.2f%% of simulation, %.3f ms blocked\n",
+			stats.m_captureSeconds * 1000.0 / static_cast<double>(std::max(result.m_numTicks, 1u)),
+			capture_share * 100.0, stats.m_blockedSeconds * 1000.0);
+	}
+
+	if (m_render)
+	{
+		const RenderStats stats = g_theRenderer->GetTotalStats();
+		printf("render            %.3f ms\n", result.m_renderSeconds * 1000.0);
+		printf("draw calls        %llu\n", static_cast<unsigned long long>(stats.m_drawCalls));
+		printf("state changes     %llu\n", static_cast<unsigned long long>(stats.m_stateChanges));
+		printf("bytes uploaded    %llu\n", static_cast<unsigned long long>(stats.m_bytesUploaded));
+		printf("resident meshes   %llu bytes\n", static_cast<unsigned long long>(g_theRenderer->GetResidentMeshBytes()));
+	}
+}
+
+
+STATIC void SimScenario::PrintUsage()
+{
+	printf(
+		"usage: Headless [options]\n"
+		"  --agents N        number of simulated vehicles (default 4)\n"
+		"  --ticks N         fixed-dt ticks to run (default 1000)\n"
+		"  --dt SECONDS      tick length (default 1/60)\n"
+		"  --mix SPEC        behavior mix, e.g. seek:1,pursuit:2,wander:1,+obstacle,+wall\n"
+		"                    names: none seek flee arrive pursuit evade wander obstacle wall agents\n"
+		"                    a leading '+' layers the behavior on every agent\n"
+		"  --script FILE     timed commands: '<tick> agents|mix|key <argument>'\n"
+		"  --seed N          world seed for spawning and wander (default 0x5EED5EED5EED5EED)\n"
+		"  --render          also run Game::Render against the null renderer\n"
+		"  --no-cull         run every avoidance query instead of culling by clearance\n"
+		"  --flow            seek/arrive follow shared flow fields around obstacles and walls\n"
+		"  --no-snapshots    pursuers read their target live instead of the per-tick snapshot\n"
+		"  --prioritized     combine behaviors as a truncated sum in priority order,\n"
+		"                    capped at each vehicle's max force (default averages)\n"
+		"  --lod             tick distant agents every 2nd/4th tick (LOD tiers)\n"
+		"  --frame-times FILE\n"
+		"                    write tick time percentiles at shutdown (.csv or .json)\n"
+		"  --trace FILE      write the run's Game::Update/Render timeline as Chrome trace JSON\n"
+		"  --record FILE     write every tick's positions and headings as a trajectory file\n"
+		"  --record-ring N   frames in flight to the writer thread (default 8)\n"
+		"  --record-block N  frames per block, each starting with a keyframe (default 20)\n"
+		"  --record-step D   position quantization step in world units (default 1/256)\n"
+		"  --record-block-on-full\n"
+		"                    wait for the writer when the ring is full (default drops the frame)\n"
+	);
+}
+
+
+STATIC bool SimScenario::ParseBehaviorMix(const std::string& mix_text, std::vector<BehaviorWeight>& out_mix,
+	std::vector<int>& out_modifiers)
+{
+	out_mix.clear();
+	out_modifiers.clear();
+
+	std::istringstream mix_stream(mix_text);
+	std::string entry;
+	while (std::getline(mix_stream, entry, ','))
+	{
+		if (entry.empty())
+		{
+			continue;
+		}
+
+		const bool is_modifier = entry[0] == '+';
+		if (is_modifier)
+		{
+			entry.erase(0, 1);
+		}
+
+		float weight = 1.0f;
+		const size_t colon = entry.find(':');
+		if (colon != std::string::npos)
+		{
+			weight = static_cast<float>(atof(entry.c_str() + colon + 1));
+			entry.erase(colon);
+		}
+
+		const int behavior = ParseBehaviorName(entry);
+		if (behavior < 0)
+		{
+			printf("Unknown behavior '%s' in mix '%s'\n", entry.c_str(), mix_text.c_str());
+			return false;
+		}
+
+		if (is_modifier)
+		{
+			out_modifiers.push_back(behavior);
+		}
+		else if (weight > 0.0f)
+		{
+			BehaviorWeight behavior_weight;
+			behavior_weight.m_behavior = behavior;
+			behavior_weight.m_weight = weight;
+			out_mix.push_back(behavior_weight);
+		}
+	}
+
+	return true;
+}
+
+
+STATIC void SimScenario::ApplyBehaviorMix(Game* game, const std::vector<BehaviorWeight>& mix,
+	const std::vector<int>& modifiers)
+{
+	float total_weight = 0.0f;
+	for (size_t mix_idx = 0; mix_idx < mix.size(); ++mix_idx)
+	{
+		total_weight += mix[mix_idx].m_weight;
+	}
+
+	// vehicle 0 is the wandering leader everybody else pursues or evades, leave it alone
+	const uint num_vehicles = game->GetNumVehicles();
+	for (uint veh_idx = 1; veh_idx < num_vehicles; ++veh_idx)
+	{
+		int behavior = CONSTANT_DIR;
+		if (total_weight > 0.0f)
+		{
+			// hand out behaviors in contiguous blocks proportional to their weight
+			const float slot = total_weight * static_cast<float>(veh_idx - 1) / static_cast<float>(num_vehicles - 1);
+			float cumulative = 0.0f;
+			for (size_t mix_idx = 0; mix_idx < mix.size(); ++mix_idx)
+			{
+				behavior = mix[mix_idx].m_behavior;
+				cumulative += mix[mix_idx].m_weight;
+				if (slot < cumulative)
+				{
+					break;
+				}
+			}
+		}
+
+		game->SetVehicleBehavior(veh_idx, behavior);
+		for (size_t mod_idx = 0; mod_idx < modifiers.size(); ++mod_idx)
+		{
+			game->AddVehicleBehavior(veh_idx, modifiers[mod_idx]);
+		}
+	}
+}
+
+
+STATIC int SimScenario::ParseBehaviorName(const std::string& name)
+{
+	for (int beh_idx = 0; beh_idx < NUM_STEER_BEHAVIORS; ++beh_idx)
+	{
+		if (name == s_behaviorNames[beh_idx])
+		{
+			return beh_idx;
+		}
+	}
+
+	return -1;
+}
+
+
+STATIC const char* SimScenario::GetBehaviorName(const int behavior)
+{
+	return behavior >= 0 && behavior < NUM_STEER_BEHAVIORS ? s_behaviorNames[behavior] : "unknown";
+}
+
+
+STATIC double SimScenario::GetTimeSeconds()
+{
+	const std::chrono::steady_clock::duration now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration<double>(now).count();
+}
+
+
+void SimScenario::ApplyEvent(Game* game, const ScenarioEvent& scenario_event) const
+{
+	if (scenario_event.m_command == "agents")
+	{
+		game->SetNumVehicles(static_cast<uint>(strtoul(scenario_event.m_argument.c_str(), nullptr, 10)));
+	}
+	else if (scenario_event.m_command == "mix")
+	{
+		std::vector<BehaviorWeight> mix;
+		std::vector<int> modifiers;
+		if (ParseBehaviorMix(scenario_event.m_argument, mix, modifiers))
+		{
+			ApplyBehaviorMix(game, mix, modifiers);
+		}
+	}
+	else if (scenario_event.m_command == "key")
+	{
+		// single characters are the key itself ('W', '5'), anything longer is a raw key code
+		const std::string& key = scenario_event.m_argument;
+		const unsigned char key_code = key.size() == 1 ?
+			static_cast<unsigned char>(toupper(key[0])) :
+			static_cast<unsigned char>(strtoul(key.c_str(), nullptr, 10));
+		game->HandleKeyPressed(key_code);
+		game->HandleKeyReleased(key_code);
+	}
+	else
+	{
+		printf("tick %u: unknown scenario command '%s'\n", scenario_event.m_tick, scenario_event.m_command.c_str());
+	}
+}
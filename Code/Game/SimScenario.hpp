@@ -0,0 +1,104 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/LodScheduler.hpp"
+#include "Game/SimRandom.hpp"
+#include "Game/TrajectoryRecorder.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Game;
+
+//-----------------------------------------------------------------------------------------------
+// SimScenario
+//
+// Describes a headless batch run: how many agents, which behaviors they get, how many fixed-dt
+// ticks to step and an optional script of timed commands. Run() drives a Game as fast as it can
+// without presenting and prints throughput.
+//
+// Script files hold one command per line, "<tick> <command> [argument]", e.g.
+//		0	agents	2048
+//		120	mix		pursuit:3,wander:1,+wall
+//		600	key		Q
+//
+
+struct BehaviorWeight
+{
+	int		m_behavior = CONSTANT_DIR;
+	float	m_weight = 1.0f;
+};
+
+
+struct ScenarioEvent
+{
+	uint		m_tick = 0;
+	std::string	m_command;
+	std::string	m_argument;
+};
+
+
+struct ScenarioResult
+{
+	uint		m_numAgents = 0;		// after SetNumVehicles, which clamps the requested count
+	uint		m_numTicks = 0;
+	uint64_t	m_agentUpdates = 0;
+	uint64_t	m_allocations = 0;
+	double		m_startupSeconds = 0.0;
+	double		m_populateSeconds = 0.0;	// SetNumVehicles, which creates whatever Startup did not
+	uint64_t	m_meshesCreated = 0;
+	size_t		m_residentMeshBytes = 0;
+	double		m_simSeconds = 0.0;
+	double		m_renderSeconds = 0.0;
+	double		m_tickP50Ms = 0.0;
+	double		m_tickP99Ms = 0.0;
+	double		m_tickP999Ms = 0.0;
+	double		m_tickMaxMs = 0.0;
+	uint		m_lodTierPopulations[NUM_LOD_TIERS] = { 0 };
+	bool		m_recordedTrajectories = false;
+	bool		m_trajectoriesComplete = false;		// every write succeeded
+	TrajectoryStats	m_trajectoryStats;
+};
+
+
+class SimScenario
+{
+public:
+	uint	m_numAgents = 4;
+	uint	m_numTicks = 1'000;
+	double	m_deltaSeconds = 1.0 / 60.0;
+	uint64_t	m_seed = SimRandom::DEFAULT_SEED;
+	bool	m_render = false;
+	bool	m_cullAvoidance = true;
+	bool	m_lodTiers = false;
+	bool	m_prioritized = false;
+	bool	m_targetSnapshots = true;
+	bool	m_flowFields = false;
+	std::string	m_frameTimesPath;	// written by Game::Shutdown when set
+	std::string	m_tracePath;		// Chrome trace of the whole run when set
+	std::string	m_trajectoryPath;	// every tick's positions and headings when set
+	TrajectorySettings	m_trajectorySettings;
+
+	std::vector<BehaviorWeight>	m_mix;
+	std::vector<int>			m_modifiers;	// behaviors layered on top of the mix (avoidance)
+	std::vector<ScenarioEvent>	m_events;
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	bool	LoadScript(const std::string& file_path);
+
+	int				Run();
+	ScenarioResult	Execute(Game* game) const;
+	void			PrintResult(const ScenarioResult& result) const;
+
+	static void		PrintUsage();
+	static bool		ParseBehaviorMix(const std::string& mix_text, std::vector<BehaviorWeight>& out_mix,
+		std::vector<int>& out_modifiers);
+	static void		ApplyBehaviorMix(Game* game, const std::vector<BehaviorWeight>& mix,
+		const std::vector<int>& modifiers);
+	static int		ParseBehaviorName(const std::string& name);
+	static const char*	GetBehaviorName(int behavior);
+	static double	GetTimeSeconds();
+
+private:
+	void	ApplyEvent(Game* game, const ScenarioEvent& scenario_event) const;
+};
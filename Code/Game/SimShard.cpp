@@ -0,0 +1,695 @@
+#include "Game/SimShard.hpp"
+#include "Game/Game.hpp"
+#include "Game/Vehicle.hpp"
+#include "Game/GameJobs.hpp"
+#include "Game/OrcaSolver.hpp"
+#include "Game/VehicleState.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// vehicle 0 is the leader every pursuer reads, each shard needs it wherever it is
+constexpr uint SHARD_LEADER_IDX = 0;
+
+constexpr size_t SHARD_EXCHANGE_ALIGNMENT = 64;
+
+
+//-----------------------------------------------------------------------------------------------
+void ShardGrid::Init(const uint num_shards, const WrapDomain& domain)
+{
+	m_domain = domain;
+
+	// of every columns x rows split, the one whose cells are closest to square
+	const Vec2 size = domain.GetSize();
+	float best_score = 0.0f;
+	for (uint num_rows = 1; num_rows <= num_shards; ++num_rows)
+	{
+		if (num_shards % num_rows != 0)
+		{
+			continue;
+		}
+
+		const uint num_columns = num_shards / num_rows;
+		const float cell_aspect = (size.x / static_cast<float>(num_columns)) / (size.y / static_cast<float>(num_rows));
+		const float score = std::fabs(std::log(cell_aspect));
+		if (num_rows == 1 || score < best_score)
+		{
+			best_score = score;
+			m_numColumns = num_columns;
+			m_numRows = num_rows;
+		}
+	}
+}
+
+
+uint ShardGrid::GetNumShards() const
+{
+	return m_numColumns * m_numRows;
+}
+
+
+uint ShardGrid::GetShardAt(const Vec2& position) const
+{
+	const Vec2 local = m_domain.Wrap(position) - m_domain.m_mins;
+	const Vec2 size = m_domain.GetSize();
+	const float column = local.x / size.x * static_cast<float>(m_numColumns);
+	const float row = local.y / size.y * static_cast<float>(m_numRows);
+
+	// clamped only against rounding at the max edge
+	const uint column_idx = std::min(static_cast<uint>(column), m_numColumns - 1);
+	const uint row_idx = std::min(static_cast<uint>(row), m_numRows - 1);
+	return row_idx * m_numColumns + column_idx;
+}
+
+
+void ShardGrid::GetShardBounds(const uint shard_idx, Vec2& out_mins, Vec2& out_maxs) const
+{
+	const Vec2 size = m_domain.GetSize();
+	const float cell_width = size.x / static_cast<float>(m_numColumns);
+	const float cell_height = size.y / static_cast<float>(m_numRows);
+	const uint column_idx = shard_idx % m_numColumns;
+	const uint row_idx = shard_idx / m_numColumns;
+
+	out_mins = Vec2(m_domain.m_mins.x + cell_width * static_cast<float>(column_idx),
+		m_domain.m_mins.y + cell_height * static_cast<float>(row_idx));
+	out_maxs = Vec2(out_mins.x + cell_width, out_mins.y + cell_height);
+}
+
+
+bool ShardGrid::IsNearShard(const uint shard_idx, const Vec2& position, const float margin) const
+{
+	// per axis, the periodic distance from the region's center against its half extent
+	Vec2 mins;
+	Vec2 maxs;
+	GetShardBounds(shard_idx, mins, maxs);
+	const Vec2 half_extent = (maxs - mins) * 0.5f;
+	const Vec2 offset = m_domain.GetDisplacement((mins + maxs) * 0.5f, position);
+	return std::fabs(offset.x) <= half_extent.x + margin && std::fabs(offset.y) <= half_extent.y + margin;
+}
+
+
+bool ShardGrid::IsNearBorder(const uint shard_idx, const Vec2& position, const float margin) const
+{
+	// anything within margin of another region is within margin of this one's border first; an axis
+	// with a single region wraps onto itself and has no border along it
+	Vec2 mins;
+	Vec2 maxs;
+	GetShardBounds(shard_idx, mins, maxs);
+	const Vec2 half_extent = (maxs - mins) * 0.5f;
+	const Vec2 offset = m_domain.GetDisplacement((mins + maxs) * 0.5f, position);
+	return (m_numColumns > 1 && std::fabs(offset.x) > half_extent.x - margin) ||
+		(m_numRows > 1 && std::fabs(offset.y) > half_extent.y - margin);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// What each shard reports back to the parent through the shared mapping
+struct ShardReport
+{
+	WorldMetrics	m_metrics;
+	uint64_t		m_handoffs = 0;			// vehicles this shard took over from another
+	uint64_t		m_ghostUpdates = 0;		// ghost states applied
+	uint64_t		m_published = 0;		// states written to this shard's outbox
+	uint			m_maxOwned = 0;
+	double			m_updateSeconds = 0.0;
+	double			m_exchangeSeconds = 0.0;	// publish, barrier wait and apply
+	int				m_completed = 0;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// ShardExchange
+//
+// Layout of the one MAP_SHARED mapping every shard inherits across fork, each array aligned to a
+// cache line:
+//		barrier | reports[shards] | outbox counts[shards][2] | outboxes[shards][2][vehicles] |
+//		final states[vehicles] | final owners[vehicles]
+//
+struct ShardExchange
+{
+	void*				m_memory = nullptr;
+	size_t				m_numBytes = 0;
+	uint				m_numShards = 0;
+	uint				m_numVehicles = 0;
+
+	pthread_barrier_t*	m_tickBarrier = nullptr;
+	ShardReport*		m_reports = nullptr;
+	uint*				m_outboxCounts = nullptr;
+	VehicleState*		m_outboxes = nullptr;
+	VehicleState*		m_finalStates = nullptr;
+	uint*				m_finalOwners = nullptr;	// shard index + 1 of whoever owned the vehicle at the end
+
+	bool	Create(uint num_shards, uint num_vehicles);
+	void	Destroy();
+
+	uint&			GetOutboxCount(uint shard_idx, uint parity) const	{ return m_outboxCounts[shard_idx * 2 + parity]; }
+	VehicleState*	GetOutbox(uint shard_idx, uint parity) const
+	{
+		return m_outboxes + (static_cast<size_t>(shard_idx) * 2 + parity) * m_numVehicles;
+	}
+};
+
+
+static size_t AlignExchangeOffset(const size_t offset)
+{
+	return (offset + SHARD_EXCHANGE_ALIGNMENT - 1) & ~(SHARD_EXCHANGE_ALIGNMENT - 1);
+}
+
+
+bool ShardExchange::Create(const uint num_shards, const uint num_vehicles)
+{
+	m_numShards = num_shards;
+	m_numVehicles = num_vehicles;
+
+	const size_t barrier_offset = 0;
+	const size_t reports_offset = AlignExchangeOffset(barrier_offset + sizeof(pthread_barrier_t));
+	const size_t counts_offset = AlignExchangeOffset(reports_offset + sizeof(ShardReport) * num_shards);
+	const size_t outboxes_offset = AlignExchangeOffset(counts_offset + sizeof(uint) * num_shards * 2);
+	const size_t finals_offset = AlignExchangeOffset(outboxes_offset +
+		sizeof(VehicleState) * num_vehicles * num_shards * 2);
+	const size_t owners_offset = AlignExchangeOffset(finals_offset + sizeof(VehicleState) * num_vehicles);
+	m_numBytes = AlignExchangeOffset(owners_offset + sizeof(uint) * num_vehicles);
+
+	// anonymous and shared, zero filled; only the barrier and reports need constructing
+	m_memory = mmap(nullptr, m_numBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (m_memory == MAP_FAILED)
+	{
+		m_memory = nullptr;
+		return false;
+	}
+
+	unsigned char* bytes = static_cast<unsigned char*>(m_memory);
+	m_tickBarrier = reinterpret_cast<pthread_barrier_t*>(bytes + barrier_offset);
+	m_reports = reinterpret_cast<ShardReport*>(bytes + reports_offset);
+	m_outboxCounts = reinterpret_cast<uint*>(bytes + counts_offset);
+	m_outboxes = reinterpret_cast<VehicleState*>(bytes + outboxes_offset);
+	m_finalStates = reinterpret_cast<VehicleState*>(bytes + finals_offset);
+	m_finalOwners = reinterpret_cast<uint*>(bytes + owners_offset);
+
+	for (uint shard_idx = 0; shard_idx < num_shards; ++shard_idx)
+	{
+		new (&m_reports[shard_idx]) ShardReport();
+	}
+
+	pthread_barrierattr_t barrier_attributes;
+	pthread_barrierattr_init(&barrier_attributes);
+	pthread_barrierattr_setpshared(&barrier_attributes, PTHREAD_PROCESS_SHARED);
+	const int barrier_result = pthread_barrier_init(m_tickBarrier, &barrier_attributes, num_shards);
+	pthread_barrierattr_destroy(&barrier_attributes);
+	if (barrier_result != 0)
+	{
+		munmap(m_memory, m_numBytes);
+		m_memory = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+
+void ShardExchange::Destroy()
+{
+	if (m_memory == nullptr)
+	{
+		return;
+	}
+
+	pthread_barrier_destroy(m_tickBarrier);
+	munmap(m_memory, m_numBytes);
+	m_memory = nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool SimShard::ParseCommandLine(const int argc, char** argv)
+{
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--shards") == 0 && has_value)
+		{
+			m_numShards = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--agents") == 0 && has_value)
+		{
+			m_numAgents = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--ticks") == 0 && has_value)
+		{
+			m_numTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--obstacles") == 0 && has_value)
+		{
+			m_numObstacles = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--walls") == 0 && has_value)
+		{
+			m_numWalls = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--threads") == 0 && has_value)
+		{
+			m_numThreads = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--margin") == 0 && has_value)
+		{
+			m_ghostMargin = static_cast<float>(strtod(argv[++arg_idx], nullptr));
+		}
+		else if (strcmp(arg, "--seed") == 0 && has_value)
+		{
+			m_seed = strtoull(argv[++arg_idx], nullptr, 0);
+		}
+		else if (strcmp(arg, "--dt") == 0 && has_value)
+		{
+			m_deltaSeconds = strtod(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--mix") == 0 && has_value)
+		{
+			if (!SimScenario::ParseBehaviorMix(argv[++arg_idx], m_mix, m_modifiers))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--verify") == 0)
+		{
+			m_verify = true;
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	if (m_numShards == 0 || m_numAgents == 0 || m_numThreads == 0 || m_deltaSeconds <= 0.0)
+	{
+		printf("--shards, --agents, --threads and --dt must be positive\n");
+		return false;
+	}
+
+	if (m_ghostMargin < OrcaSolver::DEFAULT_NEIGHBOR_DISTANCE)
+	{
+		printf("warning: a ghost margin under %.1f hides avoidance neighbors, shards will diverge\n",
+			static_cast<double>(OrcaSolver::DEFAULT_NEIGHBOR_DISTANCE));
+	}
+
+	return true;
+}
+
+
+int SimShard::Run() const
+{
+	ShardGrid grid;
+	grid.Init(m_numShards, WORLD_WRAP);
+
+	// the population SetNumVehicles will settle on, a throwaway world would cost a whole setup
+	const uint num_vehicles = std::max(m_numAgents, 1u);
+	ShardExchange exchange;
+	if (!exchange.Create(m_numShards, num_vehicles))
+	{
+		printf("Could not create the shared exchange for %u shards\n", m_numShards);
+		return 1;
+	}
+
+	// the children must not inherit buffered output, nor a running job pool (threads do not survive fork)
+	fflush(stdout);
+	const double run_begin = FrameTimeStats::GetTimeSeconds();
+	std::vector<pid_t> children(m_numShards, -1);
+	for (uint shard_idx = 0; shard_idx < m_numShards; ++shard_idx)
+	{
+		const pid_t child = fork();
+		if (child == 0)
+		{
+			const int shard_result = RunShard(shard_idx, grid, exchange);
+			fflush(stdout);
+			_exit(shard_result);
+		}
+
+		if (child < 0)
+		{
+			printf("fork failed for shard %u\n", shard_idx);
+			break;
+		}
+		children[shard_idx] = child;
+	}
+
+	// a shard that dies (or never started) leaves the rest waiting at the barrier forever, take them down too
+	uint num_running = static_cast<uint>(std::count_if(children.begin(), children.end(),
+		[](const pid_t child) { return child > 0; }));
+	bool all_succeeded = num_running == m_numShards;
+	if (!all_succeeded)
+	{
+		for (const pid_t child : children)
+		{
+			if (child > 0)
+			{
+				kill(child, SIGKILL);
+			}
+		}
+	}
+	while (num_running > 0)
+	{
+		int status = 0;
+		const pid_t finished = waitpid(-1, &status, 0);
+		if (finished < 0)
+		{
+			break;
+		}
+
+		--num_running;
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		{
+			all_succeeded = false;
+		}
+		if (!all_succeeded)
+		{
+			for (const pid_t child : children)
+			{
+				if (child > 0 && child != finished)
+				{
+					kill(child, SIGKILL);
+				}
+			}
+		}
+	}
+	const double run_seconds = FrameTimeStats::GetTimeSeconds() - run_begin;
+
+	if (!all_succeeded)
+	{
+		printf("A shard failed, the run is incomplete\n");
+		exchange.Destroy();
+		return 1;
+	}
+
+	WorldMetrics metrics;
+	uint64_t handoffs = 0;
+	uint64_t ghost_updates = 0;
+	uint64_t published = 0;
+	uint max_owned = 0;
+	double max_update_seconds = 0.0;
+	double max_exchange_seconds = 0.0;
+	for (uint shard_idx = 0; shard_idx < m_numShards; ++shard_idx)
+	{
+		const ShardReport& report = exchange.m_reports[shard_idx];
+		metrics.m_numTicks = report.m_metrics.m_numTicks;
+		metrics.m_agentUpdates += report.m_metrics.m_agentUpdates;
+		metrics.m_obstacleCollisions += report.m_metrics.m_obstacleCollisions;
+		metrics.m_distanceTraveled += report.m_metrics.m_distanceTraveled;
+		handoffs += report.m_handoffs;
+		ghost_updates += report.m_ghostUpdates;
+		published += report.m_published;
+		max_owned = std::max(max_owned, report.m_maxOwned);
+		max_update_seconds = std::max(max_update_seconds, report.m_updateSeconds);
+		max_exchange_seconds = std::max(max_exchange_seconds, report.m_exchangeSeconds);
+	}
+
+	const double num_ticks = static_cast<double>(std::max(m_numTicks, 1u));
+	printf("shards            %u (%u x %u regions), ghost margin %.1f\n",
+		m_numShards, grid.m_numColumns, grid.m_numRows, static_cast<double>(m_ghostMargin));
+	printf("agents            %u, %u ticks, %u thread(s) per shard\n", num_vehicles, m_numTicks, m_numThreads);
+	printf("wall              %.3f s, setup included\n", run_seconds);
+	printf("update            %.3f ms/tick on the slowest shard\n", max_update_seconds * 1000.0 / num_ticks);
+	printf("exchange          %.3f ms/tick on the slowest shard, barrier wait included\n",
+		max_exchange_seconds * 1000.0 / num_ticks);
+	printf("owned             %u at most on one shard (%.1f%% of the population)\n",
+		max_owned, 100.0 * static_cast<double>(max_owned) / static_cast<double>(num_vehicles));
+	printf("published         %.1f states/tick, %.1f ghost updates/tick\n",
+		static_cast<double>(published) / num_ticks, static_cast<double>(ghost_updates) / num_ticks);
+	printf("handoffs          %llu\n", static_cast<unsigned long long>(handoffs));
+	printf("agent-updates     %llu\n", static_cast<unsigned long long>(metrics.m_agentUpdates));
+	printf("collisions        %llu\n", static_cast<unsigned long long>(metrics.m_obstacleCollisions));
+	printf("distance          %.1f\n", metrics.m_distanceTraveled);
+
+	const int result = m_verify ? Verify(exchange) : 0;
+	exchange.Destroy();
+	return result;
+}
+
+
+Game* SimShard::CreateWorld() const
+{
+	// the same calls in the same order everywhere, so every shard and the reference start identical
+	Game* game = new Game();
+	game->SetSeed(m_seed);
+	game->SetVisualsEnabled(false);
+	game->Startup();
+	game->SpawnObstacles(m_numObstacles);
+	game->SpawnWalls(m_numWalls);
+	game->SetNumVehicles(m_numAgents);
+	SimScenario::ApplyBehaviorMix(game, m_mix, m_modifiers);
+	game->SetMetricsEnabled(true);
+	return game;
+}
+
+
+int SimShard::RunShard(const uint shard_idx, const ShardGrid& grid, ShardExchange& exchange) const
+{
+	GameJobs::SetNumWorkers(m_numThreads - 1);
+	Game* game = CreateWorld();
+	const uint num_vehicles = std::min(game->GetNumVehicles(), exchange.m_numVehicles);
+	ShardReport& report = exchange.m_reports[shard_idx];
+
+	// everybody starts with the whole population, exact; keep what is here or within reach
+	std::vector<uint> ghosts;
+	std::vector<uint> handed_over;
+	ghosts.reserve(num_vehicles);
+	handed_over.reserve(num_vehicles);
+	for (uint veh_idx = 0; veh_idx < num_vehicles; ++veh_idx)
+	{
+		const Vec2 position = game->GetVehicle(veh_idx)->GetPosition();
+		if (grid.GetShardAt(position) == shard_idx)
+		{
+			game->SetVehicleOwnership(veh_idx, VEHICLE_OWNED);
+		}
+		else if (veh_idx == SHARD_LEADER_IDX || grid.IsNearShard(shard_idx, position, m_ghostMargin))
+		{
+			game->SetVehicleOwnership(veh_idx, VEHICLE_GHOST);
+			ghosts.push_back(veh_idx);
+		}
+		else
+		{
+			game->SetVehicleOwnership(veh_idx, VEHICLE_REMOTE);
+		}
+	}
+
+	for (uint tick_idx = 0; tick_idx < m_numTicks; ++tick_idx)
+	{
+		const double update_begin = FrameTimeStats::GetTimeSeconds();
+		game->Update(m_deltaSeconds);
+		const double exchange_begin = FrameTimeStats::GetTimeSeconds();
+		report.m_updateSeconds += exchange_begin - update_begin;
+
+		// publish whatever another shard may need, and let go of whatever left the region
+		const uint parity = tick_idx & 1;
+		VehicleState* outbox = exchange.GetOutbox(shard_idx, parity);
+		uint num_published = 0;
+		uint num_owned = 0;
+		handed_over.clear();
+		for (uint veh_idx = 0; veh_idx < num_vehicles; ++veh_idx)
+		{
+			if (game->GetVehicleOwnership(veh_idx) != VEHICLE_OWNED)
+			{
+				continue;
+			}
+
+			const Vec2 position = game->GetVehicle(veh_idx)->GetPosition();
+			if (veh_idx == SHARD_LEADER_IDX || grid.IsNearBorder(shard_idx, position, m_ghostMargin))
+			{
+				game->WriteVehicleState(veh_idx, outbox[num_published++]);
+			}
+
+			if (grid.GetShardAt(position) != shard_idx)
+			{
+				handed_over.push_back(veh_idx);
+			}
+			else
+			{
+				++num_owned;
+			}
+		}
+		exchange.GetOutboxCount(shard_idx, parity) = num_published;
+		report.m_published += num_published;
+		report.m_maxOwned = std::max(report.m_maxOwned, num_owned);
+
+		pthread_barrier_wait(exchange.m_tickBarrier);
+
+		// last tick's ghosts are only current again if somebody publishes them below
+		for (const uint veh_idx : ghosts)
+		{
+			game->SetVehicleOwnership(veh_idx, VEHICLE_REMOTE);
+		}
+		ghosts.clear();
+
+		// what just left is exact here until the end of the tick, its new owner publishes it from then on
+		for (const uint veh_idx : handed_over)
+		{
+			const Vec2 position = game->GetVehicle(veh_idx)->GetPosition();
+			if (veh_idx == SHARD_LEADER_IDX || grid.IsNearShard(shard_idx, position, m_ghostMargin))
+			{
+				game->SetVehicleOwnership(veh_idx, VEHICLE_GHOST);
+				ghosts.push_back(veh_idx);
+			}
+			else
+			{
+				game->SetVehicleOwnership(veh_idx, VEHICLE_REMOTE);
+			}
+		}
+
+		for (uint other_idx = 0; other_idx < m_numShards; ++other_idx)
+		{
+			if (other_idx == shard_idx)
+			{
+				continue;
+			}
+
+			const VehicleState* other_outbox = exchange.GetOutbox(other_idx, parity);
+			const uint num_states = exchange.GetOutboxCount(other_idx, parity);
+			for (uint state_idx = 0; state_idx < num_states; ++state_idx)
+			{
+				const VehicleState& state = other_outbox[state_idx];
+				if (grid.GetShardAt(state.m_position) == shard_idx)
+				{
+					game->ReadVehicleState(state);
+					game->SetVehicleOwnership(state.m_index, VEHICLE_OWNED);
+					++report.m_handoffs;
+				}
+				else if (state.m_index == SHARD_LEADER_IDX || grid.IsNearShard(shard_idx, state.m_position, m_ghostMargin))
+				{
+					game->ReadVehicleState(state);
+					game->SetVehicleOwnership(state.m_index, VEHICLE_GHOST);
+					ghosts.push_back(state.m_index);
+					++report.m_ghostUpdates;
+				}
+			}
+		}
+		report.m_exchangeSeconds += FrameTimeStats::GetTimeSeconds() - exchange_begin;
+	}
+
+	// every vehicle is owned by exactly one shard, which reports where it ended up
+	for (uint veh_idx = 0; veh_idx < num_vehicles; ++veh_idx)
+	{
+		if (game->GetVehicleOwnership(veh_idx) == VEHICLE_OWNED)
+		{
+			game->WriteVehicleState(veh_idx, exchange.m_finalStates[veh_idx]);
+			exchange.m_finalOwners[veh_idx] = shard_idx + 1;
+		}
+	}
+	report.m_metrics = game->GetMetrics();
+	report.m_completed = 1;
+
+	game->Shutdown();
+	delete game;
+	GameJobs::Shutdown();
+	return 0;
+}
+
+
+int SimShard::Verify(const ShardExchange& exchange) const
+{
+	GameJobs::SetNumWorkers(m_numThreads - 1);
+	Game* game = CreateWorld();
+	const double reference_begin = FrameTimeStats::GetTimeSeconds();
+	for (uint tick_idx = 0; tick_idx < m_numTicks; ++tick_idx)
+	{
+		game->Update(m_deltaSeconds);
+	}
+	const double reference_seconds = FrameTimeStats::GetTimeSeconds() - reference_begin;
+
+	// states are plain data without padding, equal bytes means the runs agree exactly
+	const uint num_vehicles = std::min(game->GetNumVehicles(), exchange.m_numVehicles);
+	uint num_mismatches = 0;
+	uint num_unowned = 0;
+	uint first_mismatch = num_vehicles;
+	float max_position_error = 0.0f;
+	for (uint veh_idx = 0; veh_idx < num_vehicles; ++veh_idx)
+	{
+		if (exchange.m_finalOwners[veh_idx] == 0)
+		{
+			++num_unowned;
+			continue;
+		}
+
+		VehicleState expected;
+		game->WriteVehicleState(veh_idx, expected);
+		const VehicleState& actual = exchange.m_finalStates[veh_idx];
+		if (memcmp(&expected, &actual, sizeof(VehicleState)) != 0)
+		{
+			first_mismatch = std::min(first_mismatch, veh_idx);
+			++num_mismatches;
+			max_position_error = std::max(max_position_error, (expected.m_position - actual.m_position).GetLength());
+		}
+	}
+
+	// summation order differs between one world and several, distance only agrees to rounding
+	WorldMetrics sharded_metrics;
+	for (uint shard_idx = 0; shard_idx < exchange.m_numShards; ++shard_idx)
+	{
+		sharded_metrics.m_agentUpdates += exchange.m_reports[shard_idx].m_metrics.m_agentUpdates;
+		sharded_metrics.m_obstacleCollisions += exchange.m_reports[shard_idx].m_metrics.m_obstacleCollisions;
+		sharded_metrics.m_distanceTraveled += exchange.m_reports[shard_idx].m_metrics.m_distanceTraveled;
+	}
+	const WorldMetrics& reference_metrics = game->GetMetrics();
+	const double distance_error = std::fabs(sharded_metrics.m_distanceTraveled - reference_metrics.m_distanceTraveled) /
+		std::max(reference_metrics.m_distanceTraveled, 1.0);
+	const bool metrics_match = sharded_metrics.m_agentUpdates == reference_metrics.m_agentUpdates &&
+		sharded_metrics.m_obstacleCollisions == reference_metrics.m_obstacleCollisions && distance_error < 1.0e-9;
+
+	game->Shutdown();
+	delete game;
+
+	printf("reference         %.3f s unsharded\n", reference_seconds);
+	if (num_mismatches == 0 && num_unowned == 0 && metrics_match)
+	{
+		printf("equivalence       PASS, %u vehicles bit-identical after %u ticks\n", num_vehicles, m_numTicks);
+		return 0;
+	}
+
+	printf("equivalence       FAIL, %u of %u vehicles differ, %u without an owner\n",
+		num_mismatches, num_vehicles, num_unowned);
+	if (num_mismatches > 0)
+	{
+		const VehicleState& actual = exchange.m_finalStates[first_mismatch];
+		printf("                  first is vehicle %u at (%.4f, %.4f), max position error %.6f\n",
+			first_mismatch, static_cast<double>(actual.m_position.x), static_cast<double>(actual.m_position.y),
+			static_cast<double>(max_position_error));
+	}
+	if (!metrics_match)
+	{
+		printf("                  metrics differ: %llu vs %llu updates, %llu vs %llu collisions\n",
+			static_cast<unsigned long long>(sharded_metrics.m_agentUpdates),
+			static_cast<unsigned long long>(reference_metrics.m_agentUpdates),
+			static_cast<unsigned long long>(sharded_metrics.m_obstacleCollisions),
+			static_cast<unsigned long long>(reference_metrics.m_obstacleCollisions));
+	}
+	return 1;
+}
+
+
+STATIC void SimShard::PrintUsage()
+{
+	printf(
+		"usage: Headless shard [options]\n"
+		"  --shards N        processes, each owning one region of the world (default 4)\n"
+		"  --agents N        number of simulated vehicles (default 4096)\n"
+		"  --ticks N         fixed-dt ticks to run (default 600)\n"
+		"  --obstacles N     extra obstacles (default 8)\n"
+		"  --walls N         extra walls (default 4)\n"
+		"  --mix SPEC        behavior mix as for run (default wander:3,pursuit:1,+obstacle,+wall,+agents)\n"
+		"  --margin DIST     ghost zone width around each region (default 20)\n"
+		"  --threads N       GameJobs threads per shard (default 1)\n"
+		"  --seed N          world seed (default 0x5EED5EED5EED5EED)\n"
+		"  --verify          also run one unsharded world and require identical final states\n"
+		"  --dt SECONDS      tick length (default 1/60)\n"
+	);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/SimScenario.hpp"
+#include "Game/SimRandom.hpp"
+#include "Game/WrapDomain.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+#include <vector>
+
+class Game;
+struct ShardExchange;
+
+//-----------------------------------------------------------------------------------------------
+// ShardGrid
+//
+// The world cut into columns x rows rectangles of equal size, one per shard. Ownership is a pure
+// function of position, so every process that knows where a vehicle is agrees on who owns it. The
+// world is a torus and so is the grid: positions outside the domain wrap into it, and regions on
+// opposite edges are neighbors across the seam, with margins measured the periodic way.
+//
+
+struct ShardGrid
+{
+	WrapDomain	m_domain;
+	uint		m_numColumns = 1;
+	uint		m_numRows = 1;
+
+	void	Init(uint num_shards, const WrapDomain& domain);				// picks the most square cells
+	uint	GetNumShards() const;
+	uint	GetShardAt(const Vec2& position) const;							// of the wrapped position
+	void	GetShardBounds(uint shard_idx, Vec2& out_mins, Vec2& out_maxs) const;
+	bool	IsNearShard(uint shard_idx, const Vec2& position, float margin) const;	// inside the region grown by margin
+	bool	IsNearBorder(uint shard_idx, const Vec2& position, float margin) const;	// not inside it shrunk by margin
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// SimShard
+//
+// One world split across processes by region. Every shard forks from the same setup, so all of them
+// start with the whole population in the same state; from then on each one only updates the vehicles
+// inside its region and mirrors nearby ones as read-only ghosts:
+//
+//		tick		Game::Update, owned vehicles only
+//		publish		owned vehicles within the ghost margin of the region border (and the leader,
+//					everybody's pursuit target) go to this shard's outbox as VehicleState
+//		barrier		process-shared, once per tick; outboxes alternate by tick parity so nobody
+//					overwrites one that is still being read
+//		apply		other outboxes: states inside this region are handed over and owned from now on,
+//					states within the margin become ghosts, everything else stays remote
+//
+// Outboxes, the barrier and the final states live in one anonymous shared mapping created before
+// fork. With a margin of at least the agent avoidance neighbor distance every input to an owned
+// vehicle's tick is exact, so --verify expects the sharded run to match a single unsharded world bit
+// for bit.
+//
+
+class SimShard
+{
+public:
+	uint		m_numShards = 4;
+	uint		m_numAgents = 4'096;
+	uint		m_numTicks = 600;
+	uint		m_numObstacles = 8;
+	uint		m_numWalls = 4;
+	uint		m_numThreads = 1;		// GameJobs threads per shard, including its main thread
+	float		m_ghostMargin = 20.0f;
+	uint64_t	m_seed = SimRandom::DEFAULT_SEED;
+	double		m_deltaSeconds = 1.0 / 60.0;
+	bool		m_verify = false;
+
+	std::vector<BehaviorWeight>	m_mix = { { STEER_WANDER, 3.0f }, { STEER_PURSUIT, 1.0f } };
+	std::vector<int>			m_modifiers = { STEER_OBSTACLE_AVOIDANCE, STEER_WALL_AVOIDANCE, STEER_AGENT_AVOIDANCE };
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	int		Run() const;
+
+	static void	PrintUsage();
+
+private:
+	Game*	CreateWorld() const;
+	int		RunShard(uint shard_idx, const ShardGrid& grid, ShardExchange& exchange) const;
+	int		Verify(const ShardExchange& exchange) const;
+};
@@ -0,0 +1,290 @@
+#include "Game/SimSnapshot.hpp"
+#include "Game/Game.hpp"
+#include "Game/GameJobs.hpp"
+#include "Game/VehicleState.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// the fresh world starts small and different, the restore has to bring everything else
+constexpr uint SNAPSHOT_FRESH_VEHICLES = 4;
+constexpr uint64_t SNAPSHOT_FRESH_SEED_XOR = 0x9E3779B97F4A7C15ull;
+
+
+//-----------------------------------------------------------------------------------------------
+bool SimSnapshot::ParseCommandLine(const int argc, char** argv)
+{
+	for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+	{
+		const char* arg = argv[arg_idx];
+		const bool has_value = arg_idx + 1 < argc;
+
+		if (strcmp(arg, "--agents") == 0 && has_value)
+		{
+			m_numAgents = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--ticks") == 0 && has_value)
+		{
+			m_numTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--verify-ticks") == 0 && has_value)
+		{
+			m_numVerifyTicks = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--obstacles") == 0 && has_value)
+		{
+			m_numObstacles = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--walls") == 0 && has_value)
+		{
+			m_numWalls = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--threads") == 0 && has_value)
+		{
+			m_numThreads = static_cast<uint>(strtoul(argv[++arg_idx], nullptr, 10));
+		}
+		else if (strcmp(arg, "--seed") == 0 && has_value)
+		{
+			m_seed = strtoull(argv[++arg_idx], nullptr, 0);
+		}
+		else if (strcmp(arg, "--dt") == 0 && has_value)
+		{
+			m_deltaSeconds = strtod(argv[++arg_idx], nullptr);
+		}
+		else if (strcmp(arg, "--mix") == 0 && has_value)
+		{
+			if (!SimScenario::ParseBehaviorMix(argv[++arg_idx], m_mix, m_modifiers))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--file") == 0 && has_value)
+		{
+			m_filePath = argv[++arg_idx];
+		}
+		else if (strcmp(arg, "--keep") == 0)
+		{
+			m_keepFile = true;
+		}
+		else if (strcmp(arg, "--verify") == 0)
+		{
+			m_verify = true;
+		}
+		else
+		{
+			printf("Unknown or incomplete argument '%s'\n", arg);
+			return false;
+		}
+	}
+
+	if (m_numAgents == 0 || m_deltaSeconds <= 0.0 || m_filePath.empty())
+	{
+		printf("--agents, --dt and --file must be positive or non-empty\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+int SimSnapshot::Run() const
+{
+	if (m_numThreads > 0)
+	{
+		GameJobs::SetNumWorkers(m_numThreads - 1);
+	}
+
+	const double setup_begin = FrameTimeStats::GetTimeSeconds();
+	Game* game = CreateWorld();
+	const double setup_seconds = FrameTimeStats::GetTimeSeconds() - setup_begin;
+	Step(game, m_numTicks);
+
+	const double save_begin = FrameTimeStats::GetTimeSeconds();
+	const bool saved = game->SaveSnapshot(m_filePath);
+	const double save_seconds = FrameTimeStats::GetTimeSeconds() - save_begin;
+	if (!saved)
+	{
+		printf("Could not write '%s'\n", m_filePath.c_str());
+		game->Shutdown();
+		delete game;
+		return 1;
+	}
+
+	// the reference: the saved world simply carrying on
+	std::vector<VehicleState> expected_states;
+	WorldMetrics expected_metrics;
+	if (m_verify)
+	{
+		Step(game, m_numVerifyTicks);
+		expected_states.resize(game->GetNumCreatedVehicles());
+		for (uint veh_idx = 0; veh_idx < game->GetNumCreatedVehicles(); ++veh_idx)
+		{
+			game->WriteVehicleState(veh_idx, expected_states[veh_idx]);
+		}
+		expected_metrics = game->GetMetrics();
+	}
+
+	const double map_begin = FrameTimeStats::GetTimeSeconds();
+	WorldSnapshot snapshot;
+	const bool mapped = snapshot.Map(m_filePath);
+	const double map_seconds = FrameTimeStats::GetTimeSeconds() - map_begin;
+	if (!mapped)
+	{
+		printf("Could not map '%s' back\n", m_filePath.c_str());
+		game->Shutdown();
+		delete game;
+		return 1;
+	}
+
+	// F7: back into the world that saved it, which has moved on since (or not, without --verify)
+	const double in_place_begin = FrameTimeStats::GetTimeSeconds();
+	bool restored = game->RestoreSnapshot(snapshot);
+	const double in_place_seconds = FrameTimeStats::GetTimeSeconds() - in_place_begin;
+
+	bool all_match = true;
+	if (m_verify && restored)
+	{
+		Step(game, m_numVerifyTicks);
+		all_match = Matches(game, expected_states, expected_metrics, "in place") && all_match;
+	}
+	game->Shutdown();
+	delete game;
+
+	// a world that never saw the saved one, with another seed and almost no vehicles
+	Game* fresh_game = new Game();
+	fresh_game->SetSeed(m_seed ^ SNAPSHOT_FRESH_SEED_XOR);
+	fresh_game->SetVisualsEnabled(false);
+	fresh_game->Startup();
+	fresh_game->SetNumVehicles(SNAPSHOT_FRESH_VEHICLES);
+
+	const double fresh_begin = FrameTimeStats::GetTimeSeconds();
+	restored = fresh_game->RestoreSnapshot(snapshot) && restored;
+	const double fresh_seconds = FrameTimeStats::GetTimeSeconds() - fresh_begin;
+
+	if (m_verify && restored)
+	{
+		Step(fresh_game, m_numVerifyTicks);
+		all_match = Matches(fresh_game, expected_states, expected_metrics, "fresh") && all_match;
+	}
+	fresh_game->Shutdown();
+	delete fresh_game;
+
+	const WorldSnapshotHeader& header = snapshot.GetHeader();
+	const double file_megabytes = static_cast<double>(header.m_fileSize) / (1024.0 * 1024.0);
+	printf("agents            %u (%u created), %u ticks before the save, %u thread(s)\n",
+		header.m_populationSize, header.m_numVehicles, m_numTicks, GameJobs::GetNumThreads());
+	printf("setup             %.3f s\n", setup_seconds);
+	printf("file              %.1f MB, %u bytes/vehicle, version %u\n",
+		file_megabytes, header.m_vehicleSize, header.m_version);
+	printf("save              %.3f ms, one write\n", save_seconds * 1000.0);
+	printf("map               %.3f ms\n", map_seconds * 1000.0);
+	printf("restore in place  %.3f ms\n", in_place_seconds * 1000.0);
+	printf("restore fresh     %.3f ms, vehicles created included\n", fresh_seconds * 1000.0);
+
+	snapshot.Unmap();
+	if (!m_keepFile)
+	{
+		remove(m_filePath.c_str());
+	}
+
+	if (!restored)
+	{
+		printf("RestoreSnapshot refused the file\n");
+		return 1;
+	}
+
+	if (m_verify)
+	{
+		printf("verify            %s after %u ticks past the save\n", all_match ? "PASS" : "FAIL", m_numVerifyTicks);
+		return all_match ? 0 : 1;
+	}
+	return 0;
+}
+
+
+Game* SimSnapshot::CreateWorld() const
+{
+	Game* game = new Game();
+	game->SetSeed(m_seed);
+	game->SetVisualsEnabled(false);
+	game->Startup();
+	game->SpawnObstacles(m_numObstacles);
+	game->SpawnWalls(m_numWalls);
+	game->SetNumVehicles(m_numAgents);
+	SimScenario::ApplyBehaviorMix(game, m_mix, m_modifiers);
+	game->SetMetricsEnabled(true);
+	return game;
+}
+
+
+void SimSnapshot::Step(Game* game, const uint num_ticks) const
+{
+	for (uint tick_idx = 0; tick_idx < num_ticks; ++tick_idx)
+	{
+		game->Update(m_deltaSeconds);
+	}
+}
+
+
+bool SimSnapshot::Matches(const Game* game, const std::vector<VehicleState>& expected_states,
+	const WorldMetrics& expected_metrics, const char* label) const
+{
+	// states are plain data without padding, equal bytes means the runs agree exactly
+	const uint num_vehicles = game->GetNumCreatedVehicles();
+	uint num_mismatches = 0;
+	uint first_mismatch = num_vehicles;
+	for (uint veh_idx = 0; veh_idx < std::min(num_vehicles, static_cast<uint>(expected_states.size())); ++veh_idx)
+	{
+		VehicleState actual;
+		game->WriteVehicleState(veh_idx, actual);
+		if (memcmp(&expected_states[veh_idx], &actual, sizeof(VehicleState)) != 0)
+		{
+			first_mismatch = std::min(first_mismatch, veh_idx);
+			++num_mismatches;
+		}
+	}
+
+	const WorldMetrics& metrics = game->GetMetrics();
+	const bool metrics_match = metrics.m_numTicks == expected_metrics.m_numTicks &&
+		metrics.m_agentUpdates == expected_metrics.m_agentUpdates &&
+		metrics.m_obstacleCollisions == expected_metrics.m_obstacleCollisions &&
+		metrics.m_distanceTraveled == expected_metrics.m_distanceTraveled;
+	const bool count_matches = num_vehicles == expected_states.size();
+
+	if (num_mismatches > 0)
+	{
+		printf("%-17s %u of %u vehicle states differ, first %u\n", label, num_mismatches, num_vehicles, first_mismatch);
+	}
+	if (!count_matches)
+	{
+		printf("%-17s %u vehicles created, expected %u\n", label, num_vehicles, static_cast<uint>(expected_states.size()));
+	}
+	if (!metrics_match)
+	{
+		printf("%-17s metrics differ\n", label);
+	}
+	return num_mismatches == 0 && count_matches && metrics_match;
+}
+
+
+STATIC void SimSnapshot::PrintUsage()
+{
+	printf(
+		"usage: Headless snapshot [options]\n"
+		"  --agents N        number of simulated vehicles (default 1000000)\n"
+		"  --ticks N         fixed-dt ticks before the save (default 10)\n"
+		"  --verify-ticks N  ticks past the save compared with --verify (default 10)\n"
+		"  --obstacles N     extra obstacles (default 8)\n"
+		"  --walls N         extra walls (default 4)\n"
+		"  --mix SPEC        behavior mix as for run (default wander:3,pursuit:1,+obstacle,+wall)\n"
+		"  --threads N       worker threads including the caller (default one per core)\n"
+		"  --seed N          world seed (default 0x5EED5EED5EED5EED)\n"
+		"  --file PATH       snapshot file (default World.snapshot)\n"
+		"  --keep            leave the file behind\n"
+		"  --verify          require both restored worlds to carry on exactly like the saved one\n"
+		"  --dt SECONDS      tick length (default 1/60)\n"
+	);
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/SimScenario.hpp"
+#include "Game/SimRandom.hpp"
+#include "Game/WorldSnapshot.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Game;
+
+//-----------------------------------------------------------------------------------------------
+// SimSnapshot
+//
+// Cost and exactness of WorldSnapshot at full population. One world is built and stepped, saved,
+// then the file is mapped and restored twice: in place into the same world after it has moved on
+// (what F7 does), and into a fresh world started with another seed and a handful of vehicles, so
+// every vehicle has to be created. Reports save, map and restore times and the file size.
+//
+// With --verify the original world first continues past the save as the reference, and both
+// restored worlds must then reach the same vehicle states, bit for bit, and the same metrics.
+//
+
+class SimSnapshot
+{
+public:
+	uint		m_numAgents = 1'000'000;
+	uint		m_numTicks = 10;			// before the save
+	uint		m_numVerifyTicks = 10;		// after it, reference and restored worlds alike
+	uint		m_numObstacles = 8;
+	uint		m_numWalls = 4;
+	uint		m_numThreads = 0;			// 0 keeps the GameJobs default, one per core
+	uint64_t	m_seed = SimRandom::DEFAULT_SEED;
+	double		m_deltaSeconds = 1.0 / 60.0;
+	std::string	m_filePath = WorldSnapshot::DEFAULT_PATH;
+	bool		m_verify = false;
+	bool		m_keepFile = false;
+
+	std::vector<BehaviorWeight>	m_mix = { { STEER_WANDER, 3.0f }, { STEER_PURSUIT, 1.0f } };
+	std::vector<int>			m_modifiers = { STEER_OBSTACLE_AVOIDANCE, STEER_WALL_AVOIDANCE };
+
+public:
+	bool	ParseCommandLine(int argc, char** argv);
+	int		Run() const;
+
+	static void	PrintUsage();
+
+private:
+	Game*	CreateWorld() const;
+	void	Step(Game* game, uint num_ticks) const;
+	bool	Matches(const Game* game, const std::vector<VehicleState>& expected_states,
+				const WorldMetrics& expected_metrics, const char* label) const;
+};
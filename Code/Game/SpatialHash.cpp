@@ -0,0 +1,308 @@
+#include "Game/SpatialHash.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+void SpatialHash::Build(const Vec2* positions, const uint num_positions, const float cell_size)
+{
+	m_positions = positions;
+	m_numItems = num_positions;
+	m_cellSize = cell_size;
+	m_inverseCellSize = 1.0f / cell_size;
+	m_isPeriodic = false;
+
+	BuildBuckets();
+}
+
+
+void SpatialHash::Build(const Vec2* positions, const uint num_positions, const float cell_size,
+	const WrapDomain& wrap_domain)
+{
+	m_positions = positions;
+	m_numItems = num_positions;
+	m_cellSize = cell_size;
+	m_inverseCellSize = 1.0f / cell_size;
+	m_isPeriodic = true;
+	m_wrapDomain = wrap_domain;
+
+	// round the cell count down so no cell is narrower than asked, a radius of cell_size still spans
+	// at most three cells per axis
+	const Vec2 size = wrap_domain.GetSize();
+	m_numCellsX = std::max(1, static_cast<int>(std::floor(size.x * m_inverseCellSize)));
+	m_numCellsY = std::max(1, static_cast<int>(std::floor(size.y * m_inverseCellSize)));
+	m_inverseCellSizes = Vec2(static_cast<float>(m_numCellsX) / size.x, static_cast<float>(m_numCellsY) / size.y);
+
+	// queries measure against these, so no candidate pays for wrapping
+	m_wrappedPositions.resize(num_positions);
+	for (uint item_idx = 0; item_idx < num_positions; ++item_idx)
+	{
+		m_wrappedPositions[item_idx] = wrap_domain.Wrap(positions[item_idx]);
+	}
+
+	BuildBuckets();
+}
+
+
+template <typename CandidateVisitor>
+void SpatialHash::VisitCell(const int cell_x, const int cell_y, const Vec2* positions, const Vec2& query,
+	const float radius_sq, const uint skip_index, CandidateVisitor& visitor) const
+{
+	const uint bucket = GetBucket(cell_x, cell_y);
+	const uint64_t cell_key = PackCell(cell_x, cell_y);
+
+	for (uint slot = m_bucketStarts[bucket]; slot < m_bucketStarts[bucket + 1]; ++slot)
+	{
+		const uint item_idx = m_entries[slot];
+		if (m_entryCells[slot] != cell_key || item_idx == skip_index)
+		{
+			continue;
+		}
+
+		const Vec2 displacement = positions[item_idx] - query;
+		const float distance_sq = displacement.x * displacement.x + displacement.y * displacement.y;
+		if (distance_sq > radius_sq)
+		{
+			continue;
+		}
+
+		visitor.Visit(item_idx, displacement, distance_sq);
+	}
+}
+
+
+template <typename CandidateVisitor>
+void SpatialHash::VisitCandidates(const Vec2& position, const float radius, const uint skip_index,
+	CandidateVisitor& visitor) const
+{
+	const float radius_sq = radius * radius;
+	if (!m_isPeriodic)
+	{
+		const int min_x = static_cast<int>(std::floor((position.x - radius) * m_inverseCellSize));
+		const int max_x = static_cast<int>(std::floor((position.x + radius) * m_inverseCellSize));
+		const int min_y = static_cast<int>(std::floor((position.y - radius) * m_inverseCellSize));
+		const int max_y = static_cast<int>(std::floor((position.y + radius) * m_inverseCellSize));
+
+		for (int cell_y = min_y; cell_y <= max_y; ++cell_y)
+		{
+			for (int cell_x = min_x; cell_x <= max_x; ++cell_x)
+			{
+				VisitCell(cell_x, cell_y, m_positions, position, radius_sq, skip_index, visitor);
+			}
+		}
+		return;
+	}
+
+	// the cells covering [query - radius, query + radius] along each axis, in unwrapped coordinates, so
+	// every cell knows which image of its items lies on the query's side of the seam and the distance
+	// test costs what it does on the plane
+	const Vec2 query = m_wrapDomain.Wrap(position);
+	const Vec2 local = query - m_wrapDomain.m_mins;
+	const int min_x = static_cast<int>(std::floor((local.x - radius) * m_inverseCellSizes.x));
+	const int max_x = static_cast<int>(std::floor((local.x + radius) * m_inverseCellSizes.x));
+	const int min_y = static_cast<int>(std::floor((local.y - radius) * m_inverseCellSizes.y));
+	const int max_y = static_cast<int>(std::floor((local.y + radius) * m_inverseCellSizes.y));
+
+	// a span as wide as the period would meet cells twice, visit each once and take the minimum image
+	if (max_x - min_x + 1 >= m_numCellsX || max_y - min_y + 1 >= m_numCellsY)
+	{
+		for (uint item_idx = 0; item_idx < m_numItems; ++item_idx)
+		{
+			if (item_idx == skip_index)
+			{
+				continue;
+			}
+
+			const Vec2 displacement = m_wrapDomain.GetDisplacement(query, m_wrappedPositions[item_idx]);
+			const float distance_sq = displacement.x * displacement.x + displacement.y * displacement.y;
+			if (distance_sq <= radius_sq)
+			{
+				visitor.Visit(item_idx, displacement, distance_sq);
+			}
+		}
+		return;
+	}
+
+	const Vec2 size = m_wrapDomain.GetSize();
+	for (int unwrapped_y = min_y; unwrapped_y <= max_y; ++unwrapped_y)
+	{
+		const int period_y = unwrapped_y < 0 ? -1 : (unwrapped_y >= m_numCellsY ? 1 : 0);
+		const int cell_y = unwrapped_y - period_y * m_numCellsY;
+
+		for (int unwrapped_x = min_x; unwrapped_x <= max_x; ++unwrapped_x)
+		{
+			const int period_x = unwrapped_x < 0 ? -1 : (unwrapped_x >= m_numCellsX ? 1 : 0);
+			const int cell_x = unwrapped_x - period_x * m_numCellsX;
+
+			// measuring from the query moved by one period is measuring to the item's image
+			const Vec2 image_query(query.x - static_cast<float>(period_x) * size.x,
+				query.y - static_cast<float>(period_y) * size.y);
+			VisitCell(cell_x, cell_y, m_wrappedPositions.data(), image_query, radius_sq, skip_index, visitor);
+		}
+	}
+}
+
+
+uint SpatialHash::QueryNearest(const Vec2& position, const float radius, const uint skip_index,
+	const uint max_results, SpatialNeighbor* out_neighbors) const
+{
+	if (max_results == 0 || m_numItems == 0)
+	{
+		return 0;
+	}
+
+	// insertion into the sorted, bounded result list; (distance, index) is a strict order
+	struct NearestVisitor
+	{
+		SpatialNeighbor*	m_neighbors;
+		uint				m_maxResults;
+		uint				m_numFound;
+
+		void Visit(const uint item_idx, const Vec2& displacement, const float distance_sq)
+		{
+			if (m_numFound == m_maxResults)
+			{
+				const SpatialNeighbor& worst = m_neighbors[m_numFound - 1];
+				if (distance_sq > worst.m_distanceSq ||
+					(distance_sq == worst.m_distanceSq && item_idx > worst.m_index))
+				{
+					return;
+				}
+			}
+			else
+			{
+				++m_numFound;
+			}
+
+			uint insert_idx = m_numFound - 1;
+			while (insert_idx > 0)
+			{
+				const SpatialNeighbor& previous = m_neighbors[insert_idx - 1];
+				if (previous.m_distanceSq < distance_sq ||
+					(previous.m_distanceSq == distance_sq && previous.m_index < item_idx))
+				{
+					break;
+				}
+
+				m_neighbors[insert_idx] = previous;
+				--insert_idx;
+			}
+
+			m_neighbors[insert_idx].m_distanceSq = distance_sq;
+			m_neighbors[insert_idx].m_index = item_idx;
+			m_neighbors[insert_idx].m_displacement = displacement;
+		}
+	};
+
+	NearestVisitor visitor = { out_neighbors, max_results, 0 };
+	VisitCandidates(position, radius, skip_index, visitor);
+	return visitor.m_numFound;
+}
+
+
+uint SpatialHash::QueryRange(const Vec2& position, const float radius, const uint skip_index,
+	std::vector<SpatialNeighbor>& out_neighbors) const
+{
+	out_neighbors.clear();
+	if (m_numItems == 0)
+	{
+		return 0;
+	}
+
+	struct RangeVisitor
+	{
+		std::vector<SpatialNeighbor>&	m_neighbors;
+
+		void Visit(const uint item_idx, const Vec2& displacement, const float distance_sq)
+		{
+			SpatialNeighbor neighbor;
+			neighbor.m_distanceSq = distance_sq;
+			neighbor.m_index = item_idx;
+			neighbor.m_displacement = displacement;
+			m_neighbors.push_back(neighbor);
+		}
+	};
+
+	RangeVisitor visitor = { out_neighbors };
+	VisitCandidates(position, radius, skip_index, visitor);
+	return static_cast<uint>(out_neighbors.size());
+}
+
+
+void SpatialHash::BuildBuckets()
+{
+	// about two buckets per item keeps collisions rare without a sparse table
+	uint num_buckets = 64;
+	while (num_buckets < m_numItems * 2)
+	{
+		num_buckets <<= 1;
+	}
+	m_bucketMask = num_buckets - 1;
+
+	m_bucketStarts.assign(static_cast<size_t>(num_buckets) + 1, 0);
+	m_itemBuckets.resize(m_numItems);
+	m_itemCells.resize(m_numItems);
+	m_entries.resize(m_numItems);
+	m_entryCells.resize(m_numItems);
+
+	for (uint item_idx = 0; item_idx < m_numItems; ++item_idx)
+	{
+		int cell_x;
+		int cell_y;
+		GetCell(item_idx, cell_x, cell_y);
+		const uint bucket = GetBucket(cell_x, cell_y);
+		m_itemBuckets[item_idx] = bucket;
+		m_itemCells[item_idx] = PackCell(cell_x, cell_y);
+		++m_bucketStarts[bucket + 1];
+	}
+
+	for (uint bucket = 0; bucket < num_buckets; ++bucket)
+	{
+		m_bucketStarts[bucket + 1] += m_bucketStarts[bucket];
+	}
+
+	// scatter in item order, so every bucket lists its items ascending
+	for (uint item_idx = 0; item_idx < m_numItems; ++item_idx)
+	{
+		const uint bucket = m_itemBuckets[item_idx];
+		const uint slot = m_bucketStarts[bucket]++;
+		m_entries[slot] = item_idx;
+		m_entryCells[slot] = m_itemCells[item_idx];
+	}
+
+	// the scatter advanced every start to the next bucket's, shift them back
+	for (uint bucket = num_buckets; bucket > 0; --bucket)
+	{
+		m_bucketStarts[bucket] = m_bucketStarts[bucket - 1];
+	}
+	m_bucketStarts[0] = 0;
+}
+
+
+void SpatialHash::GetCell(const uint item_idx, int& out_cell_x, int& out_cell_y) const
+{
+	if (!m_isPeriodic)
+	{
+		out_cell_x = static_cast<int>(std::floor(m_positions[item_idx].x * m_inverseCellSize));
+		out_cell_y = static_cast<int>(std::floor(m_positions[item_idx].y * m_inverseCellSize));
+		return;
+	}
+
+	const Vec2 local = m_wrappedPositions[item_idx] - m_wrapDomain.m_mins;
+	out_cell_x = std::min(static_cast<int>(local.x * m_inverseCellSizes.x), m_numCellsX - 1);
+	out_cell_y = std::min(static_cast<int>(local.y * m_inverseCellSizes.y), m_numCellsY - 1);
+}
+
+
+uint SpatialHash::GetBucket(const int cell_x, const int cell_y) const
+{
+	// large primes spread neighboring cells over the table
+	const uint hash = static_cast<uint>(cell_x) * 73856093u ^ static_cast<uint>(cell_y) * 19349663u;
+	return hash & m_bucketMask;
+}
+
+
+STATIC uint64_t SpatialHash::PackCell(const int cell_x, const int cell_y)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(cell_x)) << 32) | static_cast<uint32_t>(cell_y);
+}
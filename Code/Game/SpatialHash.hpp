@@ -0,0 +1,83 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/WrapDomain.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// SpatialHash
+//
+// Uniform grid over an unbounded plane, hashed into a power of two bucket table and rebuilt from
+// scratch every tick with a counting sort, so items of one bucket are contiguous and the build is
+// two linear passes with no allocation once the arrays have grown. Each entry remembers its cell, so
+// cells that collide in the table never leak into each other's queries.
+//
+// Built with a WrapDomain the grid tiles one period instead, each axis cut into a whole number of
+// cells at least cell_size wide, and cell coordinates wrap. A query visits every cell of its span at
+// most once, however large the radius, so nobody is found twice, and distances are measured to the
+// nearest periodic image. Each visited cell knows which period it was reached through, so candidates
+// are tested exactly as on the plane; only a radius spanning the whole period falls back to a scan.
+//
+// QueryNearest returns up to max_results items within a radius, closest first, with equal distances
+// ordered by item index so results do not depend on bucket order. QueryRange returns all of them in
+// bucket order. Either way each neighbor carries its displacement from the query position, which
+// on a torus is the minimum image and not simply the difference of the two positions.
+//
+
+struct SpatialNeighbor
+{
+	float	m_distanceSq = 0.0f;
+	uint	m_index = 0;
+	Vec2	m_displacement = Vec2::ZERO;	// neighbor position minus query position
+};
+
+
+class SpatialHash
+{
+public:
+	void	Build(const Vec2* positions, uint num_positions, float cell_size);
+	void	Build(const Vec2* positions, uint num_positions, float cell_size, const WrapDomain& wrap_domain);
+
+	uint	QueryNearest(const Vec2& position, float radius, uint skip_index, uint max_results,
+		SpatialNeighbor* out_neighbors) const;
+	uint	QueryRange(const Vec2& position, float radius, uint skip_index,
+		std::vector<SpatialNeighbor>& out_neighbors) const;		// clears out_neighbors first
+
+	uint	GetNumItems() const { return m_numItems; }
+	bool	IsPeriodic() const { return m_isPeriodic; }
+
+private:
+	void	BuildBuckets();
+	void	GetCell(uint item_idx, int& out_cell_x, int& out_cell_y) const;
+	uint	GetBucket(int cell_x, int cell_y) const;
+
+	template <typename CandidateVisitor>
+	void	VisitCandidates(const Vec2& position, float radius, uint skip_index, CandidateVisitor& visitor) const;
+	template <typename CandidateVisitor>
+	void	VisitCell(int cell_x, int cell_y, const Vec2* positions, const Vec2& query, float radius_sq,
+		uint skip_index, CandidateVisitor& visitor) const;
+
+	static uint64_t	PackCell(int cell_x, int cell_y);
+
+private:
+	const Vec2*				m_positions = nullptr;	// borrowed from the caller, valid until the next Build
+	uint					m_numItems = 0;
+	float					m_cellSize = 1.0f;
+	float					m_inverseCellSize = 1.0f;
+	uint					m_bucketMask = 0;
+
+	//periodic mode, cells tile the domain exactly
+	bool					m_isPeriodic = false;
+	WrapDomain				m_wrapDomain;
+	int						m_numCellsX = 1;
+	int						m_numCellsY = 1;
+	Vec2					m_inverseCellSizes = Vec2(1.0f, 1.0f);
+	std::vector<Vec2>		m_wrappedPositions;	// every item moved into the domain
+
+	std::vector<uint>		m_bucketStarts;		// prefix sums, bucket b holds [starts[b], starts[b + 1])
+	std::vector<uint>		m_entries;			// item indices sorted by bucket
+	std::vector<uint64_t>	m_entryCells;		// packed cell of each entry, parallel to m_entries
+	std::vector<uint>		m_itemBuckets;		// scratch, bucket of every item
+	std::vector<uint64_t>	m_itemCells;		// scratch, packed cell of every item
+};
@@ -2,10 +2,18 @@
 #include "Game/Vehicle.hpp"
 #include "Game/WallEntity.hpp"
 #include "Game/Game.hpp"
+#include "Game/GameProfiler.hpp"
+#include "Game/WhiskerFan.hpp"
+#include "Game/WrapDomain.hpp"
+#include "Game/WorldSnapshot.hpp"
 
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/Ray2.hpp"
 
+// slack on the culling bounds so float rounding in the field can never cull a real hit
+constexpr float AVOIDANCE_CULL_MARGIN = 0.01f;
+
+
 SteeringBehavior::SteeringBehavior(Vehicle* agent) : m_vehicle(agent), m_wanderTarget(agent->GetPosition())
 {
 }
@@ -13,120 +21,102 @@ SteeringBehavior::SteeringBehavior(Vehicle* agent) : m_vehicle(agent), m_wanderT
 
 SteeringBehavior::~SteeringBehavior()
 {
+	m_vehicle->GetTheGame()->GetTargetSnapshots().Release(m_targetSnapshot);
+	m_vehicle->GetTheGame()->GetFlowFields().Release(m_flowField);
 }
 
 
 Vec2 SteeringBehavior::Calculate(const std::bitset<NUM_STEER_BEHAVIORS>& behavior)
 {
+	if(behavior.none() || behavior.test(CONSTANT_DIR))
+	{
+		return Vec2::ZERO;
+	}
+
+	if (m_vehicle->GetTheGame()->GetSteeringCombine() == STEER_COMBINE_PRIORITIZED)
+	{
+		return CalculatePrioritized(behavior);
+	}
+
 	Vec2 resulting_vector = Vec2::ZERO;
 	float num_vectors = 0.0f;
+	for(int beh_idx = 0; beh_idx < NUM_STEER_BEHAVIORS; ++beh_idx)
+	{
+		if(!behavior.test(beh_idx) || IsAvoidanceBehavior(beh_idx))
+		{
+			continue;
+		}
 
-	if(behavior.none())
+		Vec2 force = Vec2::ZERO;
+		if (CalculateBehavior(beh_idx, force))
+		{
+			resulting_vector += force;
+			num_vectors += 1.0f;
+		}
+	}
+
+	// an avoidance hit replaces the goals, the highest in PRIORITY_ORDER wins like in the prioritized combine
+	for (const int beh_idx : PRIORITY_ORDER)
 	{
-		return Vec2::ZERO;
+		Vec2 force = Vec2::ZERO;
+		if (IsAvoidanceBehavior(beh_idx) && behavior.test(beh_idx) && CalculateBehavior(beh_idx, force))
+		{
+			resulting_vector = force;
+			break;
+		}
 	}
-	
-	for(int beh_idx = 0; beh_idx < NUM_STEER_BEHAVIORS; ++beh_idx)
+
+	// avoidance alone does not count as a vector, dividing by zero would turn the vehicle into NaNs
+	if (num_vectors > 0.0f)
 	{
-		if(!behavior.test(beh_idx))
+		resulting_vector /= num_vectors;
+	}
+	return resulting_vector;
+}
+
+
+Vec2 SteeringBehavior::CalculatePrioritized(const std::bitset<NUM_STEER_BEHAVIORS>& behavior)
+{
+	const float max_force = m_vehicle->GetMaxForce();
+	Vec2 resulting_vector = Vec2::ZERO;
+	float magnitude_so_far = 0.0f;
+
+	for (const int beh_idx : PRIORITY_ORDER)
+	{
+		if (!behavior.test(beh_idx))
 		{
 			continue;
 		}
 
-		switch(beh_idx)
+		const float remaining = max_force - magnitude_so_far;
+		if (remaining <= 0.0f)
 		{
-			case CONSTANT_DIR:
-			{
-				return Vec2::ZERO;
-				break;
-			}
-			case STEER_SEEK:
-			{
-				if(m_movingTarget != nullptr)
-				{
-					resulting_vector += Seek(m_movingTarget->GetPosition());
-				}
-				else
-				{
-					resulting_vector += Seek(m_target);
-				}
-				num_vectors += 1.0f;
-				break;
-			}
-			case STEER_FLEE:
-			{
-				if (m_movingTarget != nullptr)
-				{
-					resulting_vector += Flee(m_movingTarget->GetPosition());
-				}
-				else
-				{
-					resulting_vector += Flee(m_target);
-				}
-					
-				num_vectors += 1.0f;
-				break;
-			}
-			case STEER_ARRIVE:
-			{
-				if (m_movingTarget != nullptr)
-				{
-					resulting_vector += Arrive(m_movingTarget->GetPosition());
-				}
-				else
-				{
-					resulting_vector += Arrive(m_target);
-				}
-					
-				num_vectors += 1.0f;
-				break;
-			}
-			case STEER_PURSUIT:
-			{
-				resulting_vector += Pursuit(m_movingTarget);
-				num_vectors += 1.0f;
-				break;
-			}
-			case STEER_EVADE:
-			{
-				resulting_vector += Evade(m_movingTarget);
-				num_vectors += 1.0f;
-				break;
-			}
-			case STEER_WANDER:
-			{
-				resulting_vector += Wander();
-				num_vectors += 1.0f;
-				break;
-			}
-			case STEER_OBSTACLE_AVOIDANCE:
-			{
-				Vec2 result = Vec2::ZERO;
-				const bool avoid = ObstacleAvoidance(result);
+			break;
+		}
 
-				if(avoid)
-				{
-					resulting_vector = result;
-				}
-				break;
-			}
-			case STEER_WALL_AVOIDANCE:
-			{
-				Vec2 result = Vec2::ZERO;
-				const bool avoid = WallAvoidance(result);
+		Vec2 force = Vec2::ZERO;
+		if (!CalculateBehavior(beh_idx, force))
+		{
+			continue;
+		}
 
-				if (avoid)
-				{
-					resulting_vector = result;
-				}
-				break;
-			}
-			
-		
+		// each behavior gets what the ones above it left over, clipped if it asks for more
+		const float force_length = force.GetLength();
+		if (force_length < remaining)
+		{
+			resulting_vector += force;
+			magnitude_so_far = resulting_vector.GetLength();
+			continue;
+		}
+
+		// budget used up, nothing below this priority can change the result
+		if (force_length > 0.0f)
+		{
+			resulting_vector += force * (remaining / force_length);
 		}
+		break;
 	}
 
-	resulting_vector /= num_vectors;
 	return resulting_vector;
 }
 
@@ -177,43 +167,75 @@ Vec2 SteeringBehavior::Arrive(const Vec2& target_pos)
 }
 
 
-Vec2 SteeringBehavior::Pursuit(const Vehicle* evader)
+Vec2 SteeringBehavior::FlowSeek(const Vec2& target_pos)
+{
+	Vec2 direction;
+	float distance;
+	if (!SampleFlowField(direction, distance))
+	{
+		return Seek(target_pos);
+	}
+
+	const Vec2 desired_velocity = direction * m_vehicle->GetMaxSpeed();
+	return desired_velocity - m_vehicle->GetVelocity();
+}
+
+
+Vec2 SteeringBehavior::FlowArrive(const Vec2& target_pos)
+{
+	Vec2 direction;
+	float distance;
+	if (!SampleFlowField(direction, distance))
+	{
+		return Arrive(target_pos);
+	}
+
+	// path length instead of straight distance, so agents do not brake behind an obstacle
+	const float speed = Min(distance * m_scalarModifier, m_vehicle->GetMaxSpeed());
+	const Vec2 desired_velocity = direction * speed;
+	return desired_velocity - m_vehicle->GetVelocity();
+}
+
+
+Vec2 SteeringBehavior::Pursuit(const TargetSnapshot& evader)
 {
 	// if we are in front of the evader and heading towards them, then just seek
-	const Vec2 to_evader = evader->GetPosition() - m_vehicle->GetPosition();
-	const float relative_heading_v_2_e = DotProduct(m_vehicle->GetForward(), evader->GetForward());
+	const Vec2 to_evader = evader.m_position - m_vehicle->GetPosition();
+	const float relative_heading_v_2_e = DotProduct(m_vehicle->GetForward(), evader.m_forward);
 	const float relative_direction = DotProduct(to_evader, m_vehicle->GetForward());
 
 	if(relative_direction > 0 && relative_heading_v_2_e < -1.0f * m_headingTowardsTolerance)
 	{
-		return Seek(evader->GetPosition());
+		return Seek(evader.m_position);
 	}
 	
-	const float sum_of_vehicles_velocity = m_vehicle->GetMaxSpeed() + evader->GetSpeed();
+	const float sum_of_vehicles_velocity = m_vehicle->GetMaxSpeed() + evader.m_speed;
 	float look_ahead_time = to_evader.GetLength() / sum_of_vehicles_velocity;
-	look_ahead_time += TurnaroundTime(m_vehicle, evader->GetPosition(), m_turnaroundCoefficient);
+	look_ahead_time += TurnaroundTime(m_vehicle, evader.m_position, m_turnaroundCoefficient);
 	
-	const Vec2 predicted_position = evader->GetPosition() + evader->GetVelocity() * look_ahead_time;
+	const Vec2 predicted_position = evader.m_position + evader.m_velocity * look_ahead_time;
 	return Seek(predicted_position);
 }
 
 
-Vec2 SteeringBehavior::Evade(const Vehicle* pursuer)
+Vec2 SteeringBehavior::Evade(const TargetSnapshot& pursuer)
 {
-	const Vec2 to_pursuer = pursuer->GetPosition() - m_vehicle->GetPosition();
+	const Vec2 to_pursuer = pursuer.m_position - m_vehicle->GetPosition();
 
-	const float sum_of_vehicles_velocity = m_vehicle->GetMaxSpeed() + pursuer->GetSpeed();
+	const float sum_of_vehicles_velocity = m_vehicle->GetMaxSpeed() + pursuer.m_speed;
 	float look_ahead_time = to_pursuer.GetLength() / sum_of_vehicles_velocity;
 
-	const Vec2 predicted_position = pursuer->GetPosition() + pursuer->GetVelocity() * look_ahead_time;
+	const Vec2 predicted_position = pursuer.m_position + pursuer.m_velocity * look_ahead_time;
 	return Flee(predicted_position);
 }
 
 
 Vec2 SteeringBehavior::Wander()
 {
-	float random_x = g_randomNumberGenerator.GetRandomFloatInRange(-1.0f, 1.0f);
-	float random_y = g_randomNumberGenerator.GetRandomFloatInRange(-1.0f, 1.0f);
+	// the vehicle's own stream, so the draws do not depend on who else wanders or in which world
+	SimRandom& random = m_vehicle->GetRandom();
+	float random_x = random.GetRandomFloatInRange(-1.0f, 1.0f);
+	float random_y = random.GetRandomFloatInRange(-1.0f, 1.0f);
 	m_wanderTarget += Vec2(random_x * m_wanderJitter, random_y * m_wanderJitter);
 
 	m_wanderTarget.Normalize();
@@ -233,8 +255,15 @@ bool SteeringBehavior::ObstacleAvoidance(Vec2& out_vec)
 	const float frac_of_speed = m_vehicle->GetSpeed() / m_vehicle->GetMaxSpeed();
 	const float detection_box_length = m_minLookAhead + m_minLookAhead * frac_of_speed;
 
-	// Loop through all of the obstacles and tag those that are within the objects bounding radius
+	// Nothing gets tagged unless an obstacle surface is within the detection box length
 	Game* the_game = m_vehicle->GetTheGame();
+	if (the_game->IsAvoidanceCullingEnabled() &&
+		the_game->GetClearanceField().GetObstacleClearance(m_vehicle->GetPosition()) > detection_box_length + AVOIDANCE_CULL_MARGIN)
+	{
+		return false;
+	}
+
+	// Loop through all of the obstacles and tag those that are within the objects bounding radius
 	the_game->TagObstaclesWithinDisc(m_vehicle, detection_box_length);
 	const std::vector<BaseEntity*>& obstacles = the_game->GetObstacles();
 
@@ -247,8 +276,10 @@ bool SteeringBehavior::ObstacleAvoidance(Vec2& out_vec)
 	{
 		if(obstacles[ob_idx]->IsTagged())
 		{
-			//Transform the tagged obstacle into the vehicle's local space.
-			const Vec2 local_pos = PointToLocalSpace(obstacles[ob_idx]->GetPosition(), m_vehicle->GetForward(),
+			//Transform the tagged obstacle into the vehicle's local space, using its image nearest to us
+			const Vec2 image_pos = m_vehicle->GetPosition() +
+				WORLD_WRAP.GetDisplacement(m_vehicle->GetPosition(), obstacles[ob_idx]->GetPosition());
+			const Vec2 local_pos = PointToLocalSpace(image_pos, m_vehicle->GetForward(),
 				m_vehicle->GetTangent(), m_vehicle->GetPosition());
 
 			//Early out if the local_pos.x is negative. This means the obstacle is behind us
@@ -333,11 +364,35 @@ bool SteeringBehavior::ObstacleAvoidance(Vec2& out_vec)
 
 bool SteeringBehavior::WallAvoidance(Vec2& out_vec)
 {
-	std::vector<Vec2> whiskers = CreateWhiskers(m_numWhiskers, m_whiskerLength, m_fieldOfViewDegrees,
-		m_vehicle->GetForward(), m_vehicle->GetPosition());
+	if (m_whiskerFan == nullptr)
+	{
+		return false;
+	}
 
-	// Loop through all of the obstacles and tag those that are within the objects bounding radius
+	// A hit is a point on a wall segment closer than the whisker length (Raycast only reports hits
+	// in front of the ray), so with every segment further away than that there is nothing to find
 	Game* the_game = m_vehicle->GetTheGame();
+	if (the_game->IsAvoidanceCullingEnabled() &&
+		the_game->GetClearanceField().GetWallClearance(m_vehicle->GetPosition()) > m_whiskerLength + AVOIDANCE_CULL_MARGIN)
+	{
+		return false;
+	}
+
+	// rotate the shared local fan by this vehicle's heading
+	const uint num_whiskers = m_whiskerFan->m_numWhiskers;
+	const Vec2 position = m_vehicle->GetPosition();
+	const Vec2 forward = m_vehicle->GetForward();
+	const Vec2 tangent = m_vehicle->GetTangent();
+
+	Vec2 whisker_dirs[WhiskerFan::MAX_WHISKERS];
+	Vec2 whiskers[WhiskerFan::MAX_WHISKERS];
+	for (uint whisk_idx = 0; whisk_idx < num_whiskers; ++whisk_idx)
+	{
+		whisker_dirs[whisk_idx] = m_whiskerFan->GetWorldDirection(whisk_idx, forward, tangent);
+		whiskers[whisk_idx] = position + whisker_dirs[whisk_idx] * m_whiskerLength;
+	}
+
+	// Loop through all of the obstacles and tag those that are within the objects bounding radius
 	const std::vector<WallEntity*>& walls = the_game->GetWalls();
 
 	float dist_to_closest_intersection = INFINITY;
@@ -347,15 +402,12 @@ bool SteeringBehavior::WallAvoidance(Vec2& out_vec)
 	Vec2 steering_force = Vec2::ZERO;
 	Vec2 closest_point = Vec2::ZERO;
 
-	for(int whisk_idx = 0; whisk_idx < m_numWhiskers; ++whisk_idx)
+	for(uint whisk_idx = 0; whisk_idx < num_whiskers; ++whisk_idx)
 	{
 		const int num_walls = static_cast<int>(walls.size());
 		for(int wall_idx = 0; wall_idx < num_walls; ++wall_idx)
 		{
-			Vec2 whisker_dir = whiskers[whisk_idx] - m_vehicle->GetPosition();
-			whisker_dir.Normalize();
-			
-			Ray2 whisker_ray(m_vehicle->GetPosition(), whisker_dir);
+			Ray2 whisker_ray(position, whisker_dirs[whisk_idx]);
 			float out_t[2] = { INFINITY, INFINITY };
 			const uint impact = Raycast(out_t, whisker_ray, walls[wall_idx]->GetPlane());
 
@@ -392,6 +444,87 @@ bool SteeringBehavior::WallAvoidance(Vec2& out_vec)
 }
 
 
+bool SteeringBehavior::SampleFlowField(Vec2& out_direction, float& out_distance) const
+{
+	const Game* the_game = m_vehicle->GetTheGame();
+	if (m_flowField == FlowFieldCache::INVALID_FLOW_FIELD || !the_game->AreFlowFieldsEnabled())
+	{
+		return false;
+	}
+
+	return the_game->GetFlowFields().Sample(m_flowField, m_vehicle->GetPosition(), out_direction, out_distance);
+}
+
+
+bool SteeringBehavior::CalculateBehavior(const int beh_idx, Vec2& out_force)
+{
+	switch (beh_idx)
+	{
+		case STEER_SEEK:
+		{
+			GAME_PROFILE_SCOPE(PROFILE_STEER_SEEK);
+			out_force = FlowSeek(m_movingTarget != nullptr ? GetMovingTargetSnapshot().m_position : m_target);
+			return true;
+		}
+		case STEER_FLEE:
+		{
+			GAME_PROFILE_SCOPE(PROFILE_STEER_FLEE);
+			out_force = Flee(m_movingTarget != nullptr ? GetMovingTargetSnapshot().m_position : m_target);
+			return true;
+		}
+		case STEER_ARRIVE:
+		{
+			GAME_PROFILE_SCOPE(PROFILE_STEER_ARRIVE);
+			out_force = FlowArrive(m_movingTarget != nullptr ? GetMovingTargetSnapshot().m_position : m_target);
+			return true;
+		}
+		case STEER_PURSUIT:
+		{
+			GAME_PROFILE_SCOPE(PROFILE_STEER_PURSUIT);
+			out_force = Pursuit(GetMovingTargetSnapshot());
+			return true;
+		}
+		case STEER_EVADE:
+		{
+			GAME_PROFILE_SCOPE(PROFILE_STEER_EVADE);
+			out_force = Evade(GetMovingTargetSnapshot());
+			return true;
+		}
+		case STEER_WANDER:
+		{
+			GAME_PROFILE_SCOPE(PROFILE_STEER_WANDER);
+			out_force = Wander();
+			return true;
+		}
+		case STEER_OBSTACLE_AVOIDANCE:
+		{
+			GAME_PROFILE_SCOPE(PROFILE_STEER_OBSTACLE_AVOIDANCE);
+			return ObstacleAvoidance(out_force);
+		}
+		case STEER_WALL_AVOIDANCE:
+		{
+			GAME_PROFILE_SCOPE(PROFILE_STEER_WALL_AVOIDANCE);
+			return WallAvoidance(out_force);
+		}
+		case STEER_AGENT_AVOIDANCE:
+		{
+			// not a force, Vehicle::Update takes the solved velocity, see Game::SolveAgentAvoidance
+			return false;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+
+STATIC bool SteeringBehavior::IsAvoidanceBehavior(const int beh_idx)
+{
+	return beh_idx == STEER_OBSTACLE_AVOIDANCE || beh_idx == STEER_WALL_AVOIDANCE || beh_idx == STEER_AGENT_AVOIDANCE;
+}
+
+
 float SteeringBehavior::TurnaroundTime(const Vehicle* agent, const Vec2& target_pos, const float coefficient) const
 {
 	Vec2 to_target = target_pos - m_vehicle->GetPosition();
@@ -407,6 +540,10 @@ float SteeringBehavior::TurnaroundTime(const Vehicle* agent, const Vec2& target_
 void SteeringBehavior::SetTarget(const Vec2& target_pos)
 {
 	m_target = target_pos;
+
+	// a fixed target drops the moving one's snapshot, the cache would otherwise keep capturing it
+	m_vehicle->GetTheGame()->GetTargetSnapshots().Release(m_targetSnapshot);
+	m_targetSnapshot = TargetSnapshotCache::INVALID_SNAPSHOT;
 	m_movingTarget = nullptr;
 }
 
@@ -426,9 +563,54 @@ void SteeringBehavior::SetPursuitTurnaround(const float coefficient)
 }
 
 
-void SteeringBehavior::SetMovingTarget(const Vehicle* target_pos)
+void SteeringBehavior::SetMovingTarget(const Vehicle* moving_target)
 {
-	m_movingTarget = target_pos;
+	if (moving_target == m_movingTarget)
+	{
+		return;
+	}
+
+	TargetSnapshotCache& target_snapshots = m_vehicle->GetTheGame()->GetTargetSnapshots();
+	target_snapshots.Release(m_targetSnapshot);
+	m_targetSnapshot = target_snapshots.Retain(moving_target);
+	m_movingTarget = moving_target;
+}
+
+
+void SteeringBehavior::SetFlowGoal(const Vec2& goal)
+{
+	FlowFieldCache& flow_fields = m_vehicle->GetTheGame()->GetFlowFields();
+	flow_fields.Release(m_flowField);
+	m_flowField = flow_fields.Retain(goal);
+}
+
+
+void SteeringBehavior::SetFlowGoal(const Vehicle* moving_goal)
+{
+	FlowFieldCache& flow_fields = m_vehicle->GetTheGame()->GetFlowFields();
+	flow_fields.Release(m_flowField);
+	m_flowField = flow_fields.Retain(moving_goal);
+}
+
+
+void SteeringBehavior::ClearFlowGoal()
+{
+	m_vehicle->GetTheGame()->GetFlowFields().Release(m_flowField);
+	m_flowField = FlowFieldCache::INVALID_FLOW_FIELD;
+}
+
+
+const TargetSnapshot& SteeringBehavior::GetMovingTargetSnapshot() const
+{
+	const Game* the_game = m_vehicle->GetTheGame();
+	if (m_targetSnapshot != TargetSnapshotCache::INVALID_SNAPSHOT && the_game->AreTargetSnapshotsEnabled())
+	{
+		return the_game->GetTargetSnapshots().Get(m_targetSnapshot);
+	}
+
+	// cache switched off, read the target as it is right now
+	m_liveTargetSnapshot.CaptureFrom(*m_movingTarget);
+	return m_liveTargetSnapshot;
 }
 
 void SteeringBehavior::SetRandomWalk(const float radius, const float distance, const float jitter)
@@ -439,6 +621,18 @@ void SteeringBehavior::SetRandomWalk(const float radius, const float distance, c
 }
 
 
+Vec2 SteeringBehavior::GetWanderTarget() const
+{
+	return m_wanderTarget;
+}
+
+
+void SteeringBehavior::SetWanderTarget(const Vec2& wander_target)
+{
+	m_wanderTarget = wander_target;
+}
+
+
 void SteeringBehavior::SetObstaclesAvoidance(const float min_look_ahead, const float avoidance_mul, 
 	const float breaking_weight)
 {
@@ -452,8 +646,110 @@ void SteeringBehavior::SetWallAvoidance(const uint num_whiskers, const float whi
 	const float avoidance_mul,
 	const float field_of_view_degrees)
 {
-	m_numWhiskers = num_whiskers;
+	m_whiskerFan = WhiskerFan::CreateOrGet(num_whiskers, field_of_view_degrees);
 	m_whiskerLength = whisker_length;
 	m_avoidanceMultiplier = avoidance_mul;
-	m_fieldOfViewDegrees = field_of_view_degrees;
+}
+
+
+void SteeringBehavior::WriteSnapshot(SteeringSnapshot& out_snapshot) const
+{
+	out_snapshot.m_target = m_target;
+	out_snapshot.m_movingTarget = m_movingTarget != nullptr ? m_movingTarget->GetPopulationIndex() : INVALID_SNAPSHOT_INDEX;
+
+	out_snapshot.m_flowGoalKind = FLOW_GOAL_NONE;
+	out_snapshot.m_flowGoal = Vec2::ZERO;
+	out_snapshot.m_flowMovingGoal = INVALID_SNAPSHOT_INDEX;
+	if (m_flowField != FlowFieldCache::INVALID_FLOW_FIELD)
+	{
+		const Vehicle* moving_goal = nullptr;
+		m_vehicle->GetTheGame()->GetFlowFields().GetGoal(m_flowField, out_snapshot.m_flowGoal, moving_goal);
+		out_snapshot.m_flowGoalKind = moving_goal != nullptr ? FLOW_GOAL_VEHICLE : FLOW_GOAL_POINT;
+		out_snapshot.m_flowMovingGoal = moving_goal != nullptr ? moving_goal->GetPopulationIndex() : INVALID_SNAPSHOT_INDEX;
+	}
+
+	out_snapshot.m_arriveModifier = m_scalarModifier;
+	out_snapshot.m_pursuitTolerance = m_headingTowardsTolerance;
+	out_snapshot.m_turnaroundCoefficient = m_turnaroundCoefficient;
+	out_snapshot.m_wanderRadius = m_wanderRadius;
+	out_snapshot.m_wanderDistance = m_wanderDistance;
+	out_snapshot.m_wanderJitter = m_wanderJitter;
+	out_snapshot.m_minLookAhead = m_minLookAhead;
+	out_snapshot.m_avoidanceMultiplier = m_avoidanceMultiplier;
+	out_snapshot.m_breakingWeight = m_breakingWeight;
+	out_snapshot.m_numWhiskers = m_whiskerFan != nullptr ? m_whiskerFan->m_numWhiskers : 0;
+	out_snapshot.m_whiskerFieldOfViewDegrees = m_whiskerFan != nullptr ? m_whiskerFan->m_fieldOfViewDegrees : 0.0f;
+	out_snapshot.m_whiskerLength = m_whiskerLength;
+}
+
+
+void SteeringBehavior::ReadSnapshot(const SteeringSnapshot& snapshot)
+{
+	m_scalarModifier = snapshot.m_arriveModifier;
+	m_headingTowardsTolerance = snapshot.m_pursuitTolerance;
+	m_turnaroundCoefficient = snapshot.m_turnaroundCoefficient;
+	m_wanderRadius = snapshot.m_wanderRadius;
+	m_wanderDistance = snapshot.m_wanderDistance;
+	m_wanderJitter = snapshot.m_wanderJitter;
+	m_minLookAhead = snapshot.m_minLookAhead;
+	m_avoidanceMultiplier = snapshot.m_avoidanceMultiplier;
+	m_breakingWeight = snapshot.m_breakingWeight;
+	m_whiskerLength = snapshot.m_whiskerLength;
+
+	// a fan without whiskers finds nothing, exactly like no fan; the fan lookup takes a lock, skip it
+	// when the vehicle already has the right one
+	if (snapshot.m_numWhiskers == 0)
+	{
+		m_whiskerFan = nullptr;
+	}
+	else if (m_whiskerFan == nullptr || m_whiskerFan->m_numWhiskers != snapshot.m_numWhiskers ||
+		m_whiskerFan->m_fieldOfViewDegrees != snapshot.m_whiskerFieldOfViewDegrees)
+	{
+		m_whiskerFan = WhiskerFan::CreateOrGet(snapshot.m_numWhiskers, snapshot.m_whiskerFieldOfViewDegrees);
+	}
+
+	// goals hold references in Game's caches, only touch them when they change
+	const Game* the_game = m_vehicle->GetTheGame();
+	const uint num_vehicles = the_game->GetNumCreatedVehicles();
+	const Vehicle* moving_target = snapshot.m_movingTarget < num_vehicles ? the_game->GetVehicle(snapshot.m_movingTarget) : nullptr;
+	SetMovingTarget(moving_target);
+	m_target = snapshot.m_target;
+
+	const Vehicle* flow_moving_goal = snapshot.m_flowMovingGoal < num_vehicles ? the_game->GetVehicle(snapshot.m_flowMovingGoal) : nullptr;
+	Vec2 current_goal = Vec2::ZERO;
+	const Vehicle* current_moving_goal = nullptr;
+	if (m_flowField != FlowFieldCache::INVALID_FLOW_FIELD)
+	{
+		the_game->GetFlowFields().GetGoal(m_flowField, current_goal, current_moving_goal);
+	}
+
+	switch (snapshot.m_flowGoalKind)
+	{
+		case FLOW_GOAL_POINT:
+		{
+			if (m_flowField == FlowFieldCache::INVALID_FLOW_FIELD || current_moving_goal != nullptr ||
+				current_goal.x != snapshot.m_flowGoal.x || current_goal.y != snapshot.m_flowGoal.y)
+			{
+				SetFlowGoal(snapshot.m_flowGoal);
+			}
+			break;
+		}
+		case FLOW_GOAL_VEHICLE:
+		{
+			if (flow_moving_goal == nullptr)
+			{
+				ClearFlowGoal();
+			}
+			else if (current_moving_goal != flow_moving_goal)
+			{
+				SetFlowGoal(flow_moving_goal);
+			}
+			break;
+		}
+		default:
+		{
+			ClearFlowGoal();
+			break;
+		}
+	}
 }
@@ -1,9 +1,13 @@
 #pragma once
 #include "Game/GameCommon.hpp"
+#include "Game/TargetSnapshotCache.hpp"
+#include "Game/FlowField.hpp"
 #include "Engine/Math/Vec2.hpp"
 #include <bitset>
 
 class Vehicle;
+class WhiskerFan;
+struct SteeringSnapshot;
 
 class SteeringBehavior
 {
@@ -20,6 +24,9 @@ private:
 	//Targeting
 	Vec2			m_target = Vec2::ZERO;
 	const Vehicle*	m_movingTarget = nullptr;
+	int				m_targetSnapshot = TargetSnapshotCache::INVALID_SNAPSHOT;	// m_movingTarget in Game's cache
+	int				m_flowField = FlowFieldCache::INVALID_FLOW_FIELD;			// seek/arrive goal in Game's cache
+	mutable TargetSnapshot	m_liveTargetSnapshot;	// GetMovingTargetSnapshot with the cache switched off
 
 	//Wandering
 	float	m_wanderRadius = 1.0f;
@@ -33,29 +40,53 @@ private:
 	float m_breakingWeight = 0.2f;
 
 	//WallAvoidance
-	uint				m_numWhiskers;
-	float				m_whiskerLength;
-	float				m_fieldOfViewDegrees;
+	const WhiskerFan*	m_whiskerFan = nullptr;		// shared, see WhiskerFan::CreateOrGet
+	float				m_whiskerLength = 0.0f;
 	
 public:
-	
+	// highest priority first. The prioritized combine spends the force budget in this order, and in
+	// the averaged combine the first avoidance here that finds something overrides the goals. Agent
+	// avoidance is not in it, it replaces the velocity the combined force gives, see Vehicle::Update.
+	// Prioritized caps the sum at the vehicle's m_maxForce, which is small next to its top speed
+	// (4 against 50-75 for the default vehicles), so it turns and brakes far more gently than averaged
+	static constexpr int PRIORITY_ORDER[] = {
+		STEER_WALL_AVOIDANCE,
+		STEER_OBSTACLE_AVOIDANCE,
+		STEER_EVADE,
+		STEER_FLEE,
+		STEER_PURSUIT,
+		STEER_SEEK,
+		STEER_ARRIVE,
+		STEER_WANDER
+	};
+
+public:
 	explicit SteeringBehavior(Vehicle* agent);
 	~SteeringBehavior();
 
 	Vec2 Calculate(const std::bitset<NUM_STEER_BEHAVIORS>& behavior);
+	Vec2 CalculatePrioritized(const std::bitset<NUM_STEER_BEHAVIORS>& behavior);
 
 	Vec2 Seek(const Vec2& target_pos);
 	Vec2 Flee(const Vec2& target_pos);
 	Vec2 Arrive(const Vec2& target_pos);
-	Vec2 Pursuit(const Vehicle* evader);
-	Vec2 Evade(const Vehicle* pursuer);
+	Vec2 FlowSeek(const Vec2& target_pos);
+	Vec2 FlowArrive(const Vec2& target_pos);
+	Vec2 Pursuit(const TargetSnapshot& evader);
+	Vec2 Evade(const TargetSnapshot& pursuer);
 	Vec2 Wander();
 	bool ObstacleAvoidance(Vec2& out_vec);
 	bool WallAvoidance(Vec2& out_vec);
 
 	// Target Setting
 	void	SetTarget(const Vec2& target_pos);
-	void	SetMovingTarget(const Vehicle* target_pos);
+	void	SetMovingTarget(const Vehicle* moving_target);
+	const TargetSnapshot&	GetMovingTargetSnapshot() const;	// valid until the next call
+
+	// Flow field goal, shared with every other agent heading to the same place
+	void	SetFlowGoal(const Vec2& goal);
+	void	SetFlowGoal(const Vehicle* moving_goal);
+	void	ClearFlowGoal();
 
 	// Arriving Settings
 	void	SetArriveModifier(float scalar_modifier);
@@ -66,6 +97,8 @@ public:
 
 	// Random Walk Setting
 	void	SetRandomWalk(float radius, float distance, float jitter);
+	Vec2	GetWanderTarget() const;
+	void	SetWanderTarget(const Vec2& wander_target);
 
 	// Obstacle Avoidance
 	void	SetObstaclesAvoidance(float min_look_ahead, float avoidance_mul, float breaking_weight);
@@ -73,7 +106,14 @@ public:
 	// Wall Avoidance
 	void	SetWallAvoidance(uint num_whiskers, float avoidance_mul, float whisker_length, 
 		float field_of_view_degrees);
+
+	// Every parameter and goal, targets by population index, see WorldSnapshot
+	void	WriteSnapshot(SteeringSnapshot& out_snapshot) const;
+	void	ReadSnapshot(const SteeringSnapshot& snapshot);
 	
 private:
+	bool SampleFlowField(Vec2& out_direction, float& out_distance) const;
+	bool CalculateBehavior(int beh_idx, Vec2& out_force);
+	static bool IsAvoidanceBehavior(int beh_idx);
 	float TurnaroundTime(const Vehicle* agent, const Vec2& target_pos, float coefficient) const;
 };
@@ -0,0 +1,82 @@
+#include "Game/TargetSnapshotCache.hpp"
+#include "Game/Vehicle.hpp"
+
+
+void TargetSnapshot::CaptureFrom(const Vehicle& target)
+{
+	m_position = target.GetPosition();
+	m_velocity = target.GetVelocity();
+	m_forward = target.GetForward();
+	m_speed = target.GetSpeed();
+}
+
+
+int TargetSnapshotCache::Retain(const Vehicle* target)
+{
+	if (target == nullptr)
+	{
+		return INVALID_SNAPSHOT;
+	}
+
+	const std::unordered_map<const Vehicle*, int>::iterator found = m_handles.find(target);
+	if (found != m_handles.end())
+	{
+		++m_snapshots[found->second].m_refCount;
+		return found->second;
+	}
+
+	int snapshot_handle;
+	if (!m_freeSlots.empty())
+	{
+		snapshot_handle = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		snapshot_handle = static_cast<int>(m_snapshots.size());
+		m_snapshots.emplace_back();
+	}
+
+	// filled straight away, a target picked up between ticks is readable before the next Capture
+	TargetSnapshot& snapshot = m_snapshots[snapshot_handle];
+	snapshot.m_target = target;
+	snapshot.m_refCount = 1;
+	snapshot.CaptureFrom(*target);
+
+	m_handles[target] = snapshot_handle;
+	return snapshot_handle;
+}
+
+
+void TargetSnapshotCache::Release(const int snapshot_handle)
+{
+	if (snapshot_handle == INVALID_SNAPSHOT)
+	{
+		return;
+	}
+
+	TargetSnapshot& snapshot = m_snapshots[snapshot_handle];
+	if (--snapshot.m_refCount > 0)
+	{
+		return;
+	}
+
+	// the target may already be gone (shutdown order), only its address is used as the key
+	m_handles.erase(snapshot.m_target);
+	snapshot.m_target = nullptr;
+	m_freeSlots.push_back(snapshot_handle);
+}
+
+
+void TargetSnapshotCache::Capture()
+{
+	const size_t num_snapshots = m_snapshots.size();
+	for (size_t snapshot_idx = 0; snapshot_idx < num_snapshots; ++snapshot_idx)
+	{
+		TargetSnapshot& snapshot = m_snapshots[snapshot_idx];
+		if (snapshot.m_target != nullptr)
+		{
+			snapshot.CaptureFrom(*snapshot.m_target);
+		}
+	}
+}
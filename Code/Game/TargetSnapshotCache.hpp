@@ -0,0 +1,51 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <unordered_map>
+#include <vector>
+
+class Vehicle;
+
+//-----------------------------------------------------------------------------------------------
+// TargetSnapshotCache
+//
+// Kinematic state of every vehicle that something is chasing or running from, copied once at the
+// start of a tick. Pursuit, evade and the moving-target seek/flee/arrive read the copy through a handle
+// instead of walking the target's getters, so thousands of pursuers of the leader share one cache
+// line and all of them see the target where it was when the tick began, whatever the update order.
+//
+// Entries are reference counted by the steering behaviors that target them (SetMovingTarget) and the
+// slot is recycled once nobody refers to it. Handles stay valid while referenced.
+//
+
+struct alignas(64) TargetSnapshot
+{
+	Vec2			m_position = Vec2::ZERO;
+	Vec2			m_velocity = Vec2::ZERO;
+	Vec2			m_forward = Vec2::ZERO;
+	float			m_speed = 0.0f;
+	uint			m_refCount = 0;
+	const Vehicle*	m_target = nullptr;
+
+	void	CaptureFrom(const Vehicle& target);
+};
+
+
+class TargetSnapshotCache
+{
+public:
+	static constexpr int INVALID_SNAPSHOT = -1;
+
+public:
+	int		Retain(const Vehicle* target);
+	void	Release(int snapshot_handle);
+	void	Capture();
+
+	const TargetSnapshot&	Get(int snapshot_handle) const { return m_snapshots[snapshot_handle]; }
+	uint					GetNumTargets() const { return static_cast<uint>(m_handles.size()); }
+
+private:
+	std::vector<TargetSnapshot>					m_snapshots;
+	std::vector<int>							m_freeSlots;
+	std::unordered_map<const Vehicle*, int>		m_handles;
+};
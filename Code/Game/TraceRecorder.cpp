@@ -0,0 +1,170 @@
+#include "Game/TraceRecorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+STATIC std::atomic<bool> TraceRecorder::s_enabled(true);
+
+// rings are created on a thread's first event and live until exit, a dump may read them any time
+static std::atomic<TraceThreadBuffer*>	s_threadBuffers[TraceRecorder::MAX_TRACE_THREADS];
+static std::atomic<int>					s_numThreadBuffers(0);
+static thread_local TraceThreadBuffer*	t_threadBuffer = nullptr;
+static thread_local bool				t_threadBufferDenied = false;
+
+// timestamps are raw ticks, converted at dump time against the steady clock since startup
+static const uint64_t	s_originTicks = GameProfiler::GetTicks();
+static const auto		s_originTime = std::chrono::steady_clock::now();
+
+// events the owning thread may overwrite while a dump copies its ring
+constexpr uint64_t TRACE_DUMP_HEADROOM = 1024;
+
+
+STATIC void TraceRecorder::Record(const char* name, const uint64_t begin_ticks, const uint64_t end_ticks)
+{
+	TraceThreadBuffer* buffer = t_threadBuffer;
+	if (buffer == nullptr)
+	{
+		buffer = AcquireThreadBuffer();
+		if (buffer == nullptr)
+		{
+			return;
+		}
+	}
+
+	// single writer per ring: plain stores for the event, release on the index so dumps see it whole
+	const uint64_t write_index = buffer->m_writeIndex.load(std::memory_order_relaxed);
+	TraceEvent& trace_event = buffer->m_events[write_index & (TraceThreadBuffer::CAPACITY - 1)];
+	trace_event.m_name = name;
+	trace_event.m_beginTicks = begin_ticks;
+	trace_event.m_endTicks = end_ticks;
+	buffer->m_writeIndex.store(write_index + 1, std::memory_order_release);
+}
+
+
+STATIC void TraceRecorder::SetThreadName(const char* thread_name)
+{
+	TraceThreadBuffer* buffer = t_threadBuffer != nullptr ? t_threadBuffer : AcquireThreadBuffer();
+	if (buffer != nullptr)
+	{
+		buffer->m_threadName = thread_name;
+	}
+}
+
+
+STATIC void TraceRecorder::SetEnabled(const bool enabled)
+{
+	s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+STATIC bool TraceRecorder::Dump(const std::string& file_path, const double last_seconds)
+{
+	const double nanoseconds_per_tick = CalibrateNanosecondsPerTick();
+	const uint64_t now_ticks = GameProfiler::GetTicks();
+	const double window_ticks = last_seconds * 1.0e9 / nanoseconds_per_tick;
+	const uint64_t cutoff_ticks = last_seconds > 0.0 && window_ticks < static_cast<double>(now_ticks) ?
+		now_ticks - static_cast<uint64_t>(window_ticks) : 0;
+
+	FILE* file = fopen(file_path.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"LD46\"}}");
+
+	std::vector<TraceEvent> events;
+	const int num_buffers = std::min(s_numThreadBuffers.load(std::memory_order_acquire), MAX_TRACE_THREADS);
+	for (int buffer_idx = 0; buffer_idx < num_buffers; ++buffer_idx)
+	{
+		const TraceThreadBuffer* buffer = s_threadBuffers[buffer_idx].load(std::memory_order_acquire);
+		if (buffer == nullptr)
+		{
+			continue;
+		}
+
+		if (buffer->m_threadName != nullptr)
+		{
+			fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+				buffer->m_threadId, buffer->m_threadName);
+		}
+
+		// copy first, then drop whatever the owner lapped while we were copying
+		const uint64_t end_index = buffer->m_writeIndex.load(std::memory_order_acquire);
+		uint64_t begin_index = end_index > TraceThreadBuffer::CAPACITY ?
+			end_index - TraceThreadBuffer::CAPACITY + TRACE_DUMP_HEADROOM : 0;
+
+		events.clear();
+		for (uint64_t event_idx = begin_index; event_idx < end_index; ++event_idx)
+		{
+			events.push_back(buffer->m_events[event_idx & (TraceThreadBuffer::CAPACITY - 1)]);
+		}
+
+		const uint64_t latest_index = buffer->m_writeIndex.load(std::memory_order_acquire);
+		const uint64_t first_valid = latest_index > TraceThreadBuffer::CAPACITY ?
+			latest_index - TraceThreadBuffer::CAPACITY : 0;
+		const size_t skip = first_valid > begin_index ? static_cast<size_t>(first_valid - begin_index) : 0;
+
+		for (size_t event_idx = skip; event_idx < events.size(); ++event_idx)
+		{
+			const TraceEvent& trace_event = events[event_idx];
+			if (trace_event.m_name == nullptr || trace_event.m_endTicks < cutoff_ticks ||
+				trace_event.m_beginTicks < s_originTicks)
+			{
+				continue;
+			}
+
+			const double begin_us = static_cast<double>(trace_event.m_beginTicks - s_originTicks) *
+				nanoseconds_per_tick * 1.0e-3;
+			const double duration_us = static_cast<double>(trace_event.m_endTicks - trace_event.m_beginTicks) *
+				nanoseconds_per_tick * 1.0e-3;
+			fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+				trace_event.m_name, buffer->m_threadId, begin_us, duration_us);
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	return true;
+}
+
+
+STATIC TraceThreadBuffer* TraceRecorder::AcquireThreadBuffer()
+{
+	if (t_threadBufferDenied)
+	{
+		return nullptr;
+	}
+
+	const int buffer_idx = s_numThreadBuffers.fetch_add(1, std::memory_order_acq_rel);
+	if (buffer_idx >= MAX_TRACE_THREADS)
+	{
+		// out of rings, this thread's events are dropped rather than shared behind a lock
+		t_threadBufferDenied = true;
+		return nullptr;
+	}
+
+	TraceThreadBuffer* buffer = new TraceThreadBuffer();
+	buffer->m_threadId = buffer_idx;
+	s_threadBuffers[buffer_idx].store(buffer, std::memory_order_release);
+
+	t_threadBuffer = buffer;
+	return buffer;
+}
+
+
+STATIC double TraceRecorder::CalibrateNanosecondsPerTick()
+{
+	// need a measurable span between the origin and now, wait it out right after startup
+	const std::chrono::steady_clock::time_point min_time = s_originTime + std::chrono::milliseconds(50);
+	while (std::chrono::steady_clock::now() < min_time)
+	{
+	}
+
+	const uint64_t now_ticks = GameProfiler::GetTicks();
+	const double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - s_originTime).count();
+	return elapsed_ns / static_cast<double>(now_ticks - s_originTicks);
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/GameProfiler.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+//-----------------------------------------------------------------------------------------------
+// TraceRecorder
+//
+// Always-on timeline of frame phases and worker jobs. Every thread appends complete events (name,
+// begin, end in TSC ticks) to its own fixed ring, so recording is two timestamp reads and a store,
+// with no locks and no allocation once the thread's ring exists. Dump() writes the last N seconds of
+// every ring as Chrome trace-event JSON, which chrome://tracing and ui.perfetto.dev open directly.
+//
+// Names must be string literals (or otherwise outlive the recorder), only the pointer is stored.
+// Define GAME_DISABLE_TRACE_EVENTS (see GameCommon.hpp) to compile every scope out.
+//
+
+#if !defined(GAME_DISABLE_TRACE_EVENTS)
+#define GAME_TRACE_EVENTS_ENABLED
+#endif
+
+struct TraceEvent
+{
+	const char*	m_name = nullptr;
+	uint64_t	m_beginTicks = 0;
+	uint64_t	m_endTicks = 0;
+};
+
+
+struct TraceThreadBuffer
+{
+	static constexpr uint64_t CAPACITY = 1 << 16;	// power of two, ~1.5MB per thread, ~55 s of main thread at ~20 scopes/frame and 60 fps
+
+	TraceEvent				m_events[CAPACITY];
+	std::atomic<uint64_t>	m_writeIndex{ 0 };
+	const char*				m_threadName = nullptr;
+	int						m_threadId = 0;
+};
+
+
+class TraceRecorder
+{
+public:
+	static constexpr int	MAX_TRACE_THREADS = 64;
+	static constexpr double	DEFAULT_DUMP_SECONDS = 5.0;
+
+public:
+	static void		Record(const char* name, uint64_t begin_ticks, uint64_t end_ticks);
+	static void		SetThreadName(const char* thread_name);
+
+	static void		SetEnabled(bool enabled);
+	static bool		IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+	// last_seconds <= 0 writes everything still held in the rings
+	static bool		Dump(const std::string& file_path, double last_seconds = DEFAULT_DUMP_SECONDS);
+
+private:
+	static TraceThreadBuffer*	AcquireThreadBuffer();
+	static double				CalibrateNanosecondsPerTick();
+
+private:
+	static std::atomic<bool>	s_enabled;
+};
+
+
+class GameTraceScope
+{
+private:
+	const char*	m_name;
+	uint64_t	m_beginTicks;
+
+public:
+	explicit GameTraceScope(const char* name)
+		: m_name(TraceRecorder::IsEnabled() ? name : nullptr),
+		m_beginTicks(m_name != nullptr ? GameProfiler::GetTicks() : 0)
+	{
+	}
+
+	~GameTraceScope()
+	{
+		if (m_name != nullptr)
+		{
+			TraceRecorder::Record(m_name, m_beginTicks, GameProfiler::GetTicks());
+		}
+	}
+};
+
+
+#if defined(GAME_TRACE_EVENTS_ENABLED)
+#define GAME_TRACE_SCOPE(name) GameTraceScope GAME_PROFILE_COMBINE(trace_scope_, __LINE__)(name)
+#else
+#define GAME_TRACE_SCOPE(name)
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include <cstddef>
+#include <cstdint>
+
+//-----------------------------------------------------------------------------------------------
+// Trajectory files
+//
+// Per tick positions and headings of the whole population, written by TrajectoryRecorder:
+//
+//		header		TrajectoryFileHeader
+//		blocks		m_blockFrames frames each (the last one may be short)
+//		index		TrajectoryBlockEntry per block
+//		footer		TrajectoryFooter, at the very end of the file
+//
+// Positions are quantized to multiples of m_positionStep and headings to 1/65536 of a turn. A block
+// starts with a keyframe and every later frame in it holds differences to the frame before, so any
+// block decodes on its own. A frame is
+//
+//		varint tick, float game time, varint agent count, then per agent zigzag varints of x, y, heading
+//
+// where the keyframe's values are differences to zero and an agent the previous frame did not have
+// is encoded against zero as well. Heading differences wrap at 16 bits. Ticks need not be
+// consecutive: frames the recorder dropped are simply missing.
+//
+
+constexpr uint32_t TRAJECTORY_MAGIC = 0x4A52544E;			// "NTRJ"
+constexpr uint32_t TRAJECTORY_FOOTER_MAGIC = 0x5846524A;	// "JRFX"
+constexpr uint32_t TRAJECTORY_VERSION = 1;
+constexpr uint32_t TRAJECTORY_HEADING_STEPS = 65'536;		// per full turn
+
+
+struct TrajectoryFileHeader
+{
+	uint32_t	m_magic = TRAJECTORY_MAGIC;
+	uint32_t	m_version = TRAJECTORY_VERSION;
+	uint32_t	m_headerSize = sizeof(TrajectoryFileHeader);
+	uint32_t	m_blockFrames = 0;
+	float		m_positionStep = 0.0f;
+	uint32_t	m_headingSteps = TRAJECTORY_HEADING_STEPS;
+	uint64_t	m_seed = 0;
+};
+
+
+struct TrajectoryBlockEntry
+{
+	uint64_t	m_offset = 0;			// of the block's first byte in the file
+	uint32_t	m_size = 0;				// bytes
+	uint32_t	m_firstTick = 0;
+	uint32_t	m_lastTick = 0;
+	uint32_t	m_numFrames = 0;
+	uint32_t	m_maxAgents = 0;		// most agents in any of its frames
+	uint32_t	m_reserved = 0;
+};
+
+
+struct TrajectoryFooter
+{
+	uint64_t	m_indexOffset = 0;
+	uint64_t	m_droppedFrames = 0;
+	uint32_t	m_numBlocks = 0;
+	uint32_t	m_numFrames = 0;
+	uint32_t	m_magic = TRAJECTORY_FOOTER_MAGIC;
+	uint32_t	m_version = TRAJECTORY_VERSION;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Zigzag maps small signed values to small unsigned ones (0, -1, 1, -2 ... to 0, 1, 2, 3 ...), and a
+// varint stores 7 bits per byte with the high bit set on all but the last byte.
+inline uint32_t ZigzagEncode(const int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+
+inline int32_t ZigzagDecode(const uint32_t value)
+{
+	return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+
+// writes at most 5 bytes, returns past the last one
+inline uint8_t* WriteVarint(uint8_t* out, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		*out++ = static_cast<uint8_t>(value | 0x80);
+		value >>= 7;
+	}
+	*out++ = static_cast<uint8_t>(value);
+	return out;
+}
+
+
+// nullptr if the varint runs past end or over 5 bytes
+inline const uint8_t* ReadVarint(const uint8_t* in, const uint8_t* end, uint32_t& out_value)
+{
+	uint32_t value = 0;
+	for (uint shift = 0; shift < 35 && in < end; shift += 7)
+	{
+		const uint8_t byte = *in++;
+		value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			out_value = value;
+			return in;
+		}
+	}
+	return nullptr;
+}
@@ -0,0 +1,281 @@
+#include "Game/TrajectoryPlayback.hpp"
+#include "Game/TraceRecorder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// the on-disk layout, a change to any of these is a new TRAJECTORY_VERSION
+static_assert(sizeof(TrajectoryFileHeader) == 32, "TrajectoryFileHeader layout changed");
+static_assert(sizeof(TrajectoryBlockEntry) == 32, "TrajectoryBlockEntry layout changed");
+static_assert(sizeof(TrajectoryFooter) == 32, "TrajectoryFooter layout changed");
+
+constexpr float TRAJECTORY_HEADING_TO_RADIANS = 6.28318530718f / static_cast<float>(TRAJECTORY_HEADING_STEPS);
+
+
+//-----------------------------------------------------------------------------------------------
+bool TrajectoryPlayback::Open(const std::string& file_path)
+{
+	Close();
+	if (!m_file.Map(file_path) || !ReadIndex())
+	{
+		Close();
+		return false;
+	}
+
+	// on the first frame, so Step() plays from the start
+	if (!BeginBlock(0) || !DecodeFrame())
+	{
+		Close();
+		return false;
+	}
+	Dequantize();
+	return true;
+}
+
+
+void TrajectoryPlayback::Close()
+{
+	m_file.Unmap();
+	m_index.clear();
+	m_header = TrajectoryFileHeader();
+	m_footer = TrajectoryFooter();
+	m_blockIdx = 0;
+	m_frameInBlock = 0;
+	m_cursor = nullptr;
+	m_blockEnd = nullptr;
+	m_tick = 0;
+	m_time = 0.0f;
+	m_numAgents = 0;
+}
+
+
+bool TrajectoryPlayback::Seek(const uint tick)
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	GAME_TRACE_SCOPE("TrajectoryPlayback::Seek");
+
+	// the last block starting at or before tick; later in the current block just decodes on from here
+	const std::vector<TrajectoryBlockEntry>::const_iterator after = std::upper_bound(m_index.begin(), m_index.end(),
+		tick, [](const uint lhs, const TrajectoryBlockEntry& rhs) { return lhs < rhs.m_firstTick; });
+	const uint block_idx = after == m_index.begin() ? 0 : static_cast<uint>(after - m_index.begin()) - 1;
+	const bool continues = block_idx == m_blockIdx && m_frameInBlock > 0 && tick >= m_tick;
+	if (!continues && (!BeginBlock(block_idx) || !DecodeFrame()))
+	{
+		return false;
+	}
+
+	uint next_tick = 0;
+	while (m_frameInBlock < m_index[m_blockIdx].m_numFrames && PeekTick(next_tick) && next_tick <= tick)
+	{
+		if (!DecodeFrame())
+		{
+			return false;
+		}
+	}
+
+	Dequantize();
+	return true;
+}
+
+
+bool TrajectoryPlayback::Step()
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	if (m_frameInBlock == m_index[m_blockIdx].m_numFrames)
+	{
+		if (m_blockIdx + 1 >= m_index.size() || !BeginBlock(m_blockIdx + 1))
+		{
+			return false;
+		}
+	}
+
+	if (!DecodeFrame())
+	{
+		return false;
+	}
+
+	Dequantize();
+	return true;
+}
+
+
+uint TrajectoryPlayback::GetFirstTick() const
+{
+	return m_index.empty() ? 0 : m_index.front().m_firstTick;
+}
+
+
+uint TrajectoryPlayback::GetLastTick() const
+{
+	return m_index.empty() ? 0 : m_index.back().m_lastTick;
+}
+
+
+bool TrajectoryPlayback::ReadIndex()
+{
+	const uint8_t* data = m_file.GetData();
+	const size_t size = m_file.GetSize();
+	if (size < sizeof(TrajectoryFileHeader) + sizeof(TrajectoryFooter))
+	{
+		return false;
+	}
+
+	memcpy(&m_header, data, sizeof(TrajectoryFileHeader));
+	memcpy(&m_footer, data + size - sizeof(TrajectoryFooter), sizeof(TrajectoryFooter));
+	const bool header_valid = m_header.m_magic == TRAJECTORY_MAGIC && m_header.m_version == TRAJECTORY_VERSION &&
+		m_header.m_headerSize == sizeof(TrajectoryFileHeader) && m_header.m_blockFrames > 0 &&
+		m_header.m_positionStep > 0.0f && std::isfinite(m_header.m_positionStep) &&
+		m_header.m_headingSteps == TRAJECTORY_HEADING_STEPS;
+
+	// a file without a footer was never finished, the recorder only writes it when it stops
+	const uint64_t index_bytes = static_cast<uint64_t>(m_footer.m_numBlocks) * sizeof(TrajectoryBlockEntry);
+	const bool footer_valid = m_footer.m_magic == TRAJECTORY_FOOTER_MAGIC && m_footer.m_version == TRAJECTORY_VERSION &&
+		m_footer.m_numBlocks > 0 && m_footer.m_indexOffset >= sizeof(TrajectoryFileHeader) &&
+		m_footer.m_indexOffset + index_bytes + sizeof(TrajectoryFooter) == size;
+	if (!header_valid || !footer_valid)
+	{
+		return false;
+	}
+
+	m_index.resize(m_footer.m_numBlocks);
+	memcpy(m_index.data(), data + m_footer.m_indexOffset, static_cast<size_t>(index_bytes));
+
+	// blocks inside the frame data, in tick order, and together holding every frame the footer counts
+	uint64_t num_frames = 0;
+	for (size_t block_idx = 0; block_idx < m_index.size(); ++block_idx)
+	{
+		const TrajectoryBlockEntry& entry = m_index[block_idx];
+		const bool in_order = block_idx == 0 || entry.m_firstTick > m_index[block_idx - 1].m_lastTick;
+		if (entry.m_offset < sizeof(TrajectoryFileHeader) || entry.m_offset + entry.m_size > m_footer.m_indexOffset ||
+			entry.m_numFrames == 0 || entry.m_numFrames > m_header.m_blockFrames ||
+			entry.m_firstTick > entry.m_lastTick || !in_order)
+		{
+			return false;
+		}
+		num_frames += entry.m_numFrames;
+	}
+
+	return num_frames == m_footer.m_numFrames;
+}
+
+
+bool TrajectoryPlayback::BeginBlock(const uint block_idx)
+{
+	if (block_idx >= m_index.size())
+	{
+		return false;
+	}
+
+	const TrajectoryBlockEntry& entry = m_index[block_idx];
+	m_blockIdx = block_idx;
+	m_frameInBlock = 0;
+	m_cursor = m_file.GetData() + entry.m_offset;
+	m_blockEnd = m_cursor + entry.m_size;
+	return true;
+}
+
+
+bool TrajectoryPlayback::PeekTick(uint& out_tick) const
+{
+	uint32_t tick = 0;
+	if (ReadVarint(m_cursor, m_blockEnd, tick) == nullptr)
+	{
+		return false;
+	}
+
+	out_tick = tick;
+	return true;
+}
+
+
+bool TrajectoryPlayback::DecodeFrame()
+{
+	const TrajectoryBlockEntry& entry = m_index[m_blockIdx];
+	if (m_frameInBlock >= entry.m_numFrames)
+	{
+		return false;
+	}
+
+	uint32_t tick = 0;
+	uint32_t num_agents = 0;
+	const uint8_t* in = ReadVarint(m_cursor, m_blockEnd, tick);
+	if (in == nullptr || m_blockEnd - in < static_cast<ptrdiff_t>(sizeof(float)))
+	{
+		return false;
+	}
+	memcpy(&m_time, in, sizeof(float));
+	in = ReadVarint(in + sizeof(float), m_blockEnd, num_agents);
+	if (in == nullptr || num_agents > entry.m_maxAgents)
+	{
+		return false;
+	}
+
+	// a keyframe, and any agent the previous frame did not have, is against zero
+	const uint num_continued = m_frameInBlock == 0 ? 0 : std::min(num_agents, m_numAgents);
+	if (m_quantized.size() < 3 * static_cast<size_t>(num_agents))
+	{
+		m_quantized.resize(3 * static_cast<size_t>(num_agents));
+	}
+	std::fill(m_quantized.begin() + 3 * static_cast<size_t>(num_continued),
+		m_quantized.begin() + 3 * static_cast<size_t>(num_agents), 0);
+
+	// most deltas between ticks fit one byte, those skip the general varint loop
+	int32_t* values = m_quantized.data();
+	int32_t* values_end = values + 3 * static_cast<size_t>(num_agents);
+	const uint8_t* const block_end = m_blockEnd;
+	for (; values != values_end; values += 3)
+	{
+		uint32_t deltas[3];
+		for (uint32_t& delta : deltas)
+		{
+			if (in < block_end && *in < 0x80)
+			{
+				delta = *in++;
+			}
+			else if ((in = ReadVarint(in, block_end, delta)) == nullptr)
+			{
+				m_numAgents = 0;
+				return false;
+			}
+		}
+
+		values[0] += ZigzagDecode(deltas[0]);
+		values[1] += ZigzagDecode(deltas[1]);
+		values[2] = (values[2] + ZigzagDecode(deltas[2])) & 0xFFFF;
+	}
+
+	m_cursor = in;
+	m_tick = tick;
+	m_numAgents = num_agents;
+	++m_frameInBlock;
+	return true;
+}
+
+
+void TrajectoryPlayback::Dequantize()
+{
+	if (m_positions.size() < m_numAgents)
+	{
+		m_positions.resize(m_numAgents);
+		m_forwards.resize(m_numAgents);
+	}
+
+	const float position_step = m_header.m_positionStep;
+	for (uint agent_idx = 0; agent_idx < m_numAgents; ++agent_idx)
+	{
+		const int32_t* values = &m_quantized[3 * static_cast<size_t>(agent_idx)];
+		const float heading = static_cast<float>(values[2]) * TRAJECTORY_HEADING_TO_RADIANS;
+		m_positions[agent_idx] = Vec2(static_cast<float>(values[0]) * position_step,
+			static_cast<float>(values[1]) * position_step);
+		m_forwards[agent_idx] = Vec2(cosf(heading), sinf(heading));
+	}
+}
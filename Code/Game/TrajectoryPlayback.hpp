@@ -0,0 +1,78 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/TrajectoryFormat.hpp"
+#include "Game/MappedFile.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// TrajectoryPlayback
+//
+// Reads a trajectory file (see TrajectoryFormat.hpp) in place from a read-only mapping. Open() only
+// checks the header, footer and block index; frames are decoded on demand into one current frame.
+//
+// Seek() finds the block holding a tick by binary search over the index and decodes forward from its
+// keyframe, so any tick costs at most one block of frames however long the recording is. Step()
+// decodes the next frame, crossing into the next block as needed, which is all sequential playback
+// costs. Only the frame that lands is turned back into positions and forward vectors.
+//
+
+class TrajectoryPlayback
+{
+public:
+	TrajectoryPlayback() = default;
+
+	TrajectoryPlayback(const TrajectoryPlayback&) = delete;
+	TrajectoryPlayback& operator=(const TrajectoryPlayback&) = delete;
+
+	bool	Open(const std::string& file_path);		// on the first frame; false if missing, unfinished or malformed
+	void	Close();
+	bool	IsOpen() const { return m_file.IsMapped(); }
+
+	bool	Seek(uint tick);		// the last frame at or before tick, the first frame before that
+	bool	Step();					// the next frame, false at the end of the recording
+
+	const TrajectoryFileHeader&	GetHeader() const { return m_header; }
+	uint		GetNumBlocks() const { return m_footer.m_numBlocks; }
+	const TrajectoryBlockEntry&	GetBlock(uint block_idx) const { return m_index[block_idx]; }
+	uint		GetNumFrames() const { return m_footer.m_numFrames; }
+	uint64_t	GetDroppedFrames() const { return m_footer.m_droppedFrames; }
+	uint		GetFirstTick() const;
+	uint		GetLastTick() const;
+
+	// the current frame, valid after a successful Seek or Step
+	uint						GetTick() const { return m_tick; }
+	float						GetTime() const { return m_time; }
+	uint						GetNumAgents() const { return m_numAgents; }
+	const std::vector<Vec2>&	GetPositions() const { return m_positions; }
+	const std::vector<Vec2>&	GetForwards() const { return m_forwards; }
+
+private:
+	bool	ReadIndex();		// header, footer and index, checked against each other and the file size
+	bool	BeginBlock(uint block_idx);
+	bool	PeekTick(uint& out_tick) const;		// of the frame at the cursor, without decoding it
+	bool	DecodeFrame();
+	void	Dequantize();
+
+private:
+	MappedFile							m_file;
+	TrajectoryFileHeader				m_header;
+	TrajectoryFooter					m_footer;
+	std::vector<TrajectoryBlockEntry>	m_index;	// copied out, entries in the file are unaligned
+
+	//Decoding position
+	uint			m_blockIdx = 0;
+	uint			m_frameInBlock = 0;		// frames of the current block decoded so far
+	const uint8_t*	m_cursor = nullptr;
+	const uint8_t*	m_blockEnd = nullptr;
+
+	//Current frame
+	uint					m_tick = 0;
+	float					m_time = 0.0f;
+	uint					m_numAgents = 0;
+	std::vector<int32_t>	m_quantized;	// x, y, heading per agent
+	std::vector<Vec2>		m_positions;
+	std::vector<Vec2>		m_forwards;
+};
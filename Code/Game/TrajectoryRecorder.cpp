@@ -0,0 +1,334 @@
+#include "Game/TrajectoryRecorder.hpp"
+#include "Game/Vehicle.hpp"
+#include "Game/GameJobs.hpp"
+#include "Game/FrameTimeHistogram.hpp"
+#include "Game/TraceRecorder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// tick, time and agent count ahead of the agents, and x, y, heading per agent, all at their longest
+constexpr size_t TRAJECTORY_MAX_FRAME_HEADER_BYTES = 5 + sizeof(float) + 5;
+constexpr size_t TRAJECTORY_MAX_AGENT_BYTES = 3 * 5;
+
+constexpr float TRAJECTORY_PI = 3.14159265359f;
+constexpr float TRAJECTORY_RADIANS_TO_HEADING = static_cast<float>(TRAJECTORY_HEADING_STEPS) / (2.0f * TRAJECTORY_PI);
+
+
+//-----------------------------------------------------------------------------------------------
+// Rounds half away from zero without a library call
+static int32_t RoundToInt(const float value)
+{
+	return static_cast<int32_t>(value >= 0.0f ? value + 0.5f : value - 0.5f);
+}
+
+
+// atan2 from a polynomial on one octant, within 2e-6 radians: 25 times finer than a heading step, and
+// several times cheaper than atan2f, which dominated the encoding
+static float ApproximateAtan2(const float y, const float x)
+{
+	const float abs_x = std::fabs(x);
+	const float abs_y = std::fabs(y);
+	const float max_abs = std::max(abs_x, abs_y);
+	if (max_abs == 0.0f)
+	{
+		return 0.0f;
+	}
+
+	const float ratio = std::min(abs_x, abs_y) / max_abs;
+	const float ratio_squared = ratio * ratio;
+	float angle = ratio * (0.99997726f + ratio_squared * (-0.33262347f + ratio_squared * (0.19354346f +
+		ratio_squared * (-0.11643287f + ratio_squared * (0.05265332f + ratio_squared * -0.01172120f)))));
+	if (abs_y > abs_x)
+	{
+		angle = 0.5f * TRAJECTORY_PI - angle;
+	}
+	if (x < 0.0f)
+	{
+		angle = TRAJECTORY_PI - angle;
+	}
+	return y < 0.0f ? -angle : angle;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+	Stop();
+}
+
+
+bool TrajectoryRecorder::Start(const std::string& file_path, const TrajectorySettings& settings,
+	const uint num_agents, const uint64_t seed)
+{
+	if (IsRecording() || settings.m_ringFrames == 0 || settings.m_blockFrames == 0 || !(settings.m_positionStep > 0.0f))
+	{
+		return false;
+	}
+
+	m_file = fopen(file_path.c_str(), "wb");
+	if (m_file == nullptr)
+	{
+		return false;
+	}
+
+	m_settings = settings;
+	m_numQueued = 0;
+	m_numWritten = 0;
+	m_stopping = false;
+	m_stats = TrajectoryStats();
+	m_index.clear();
+	m_currentBlock = TrajectoryBlockEntry();
+	m_previousAgents = 0;
+	m_writeFailed = false;
+
+	// everything the steady state touches exists before the first frame
+	m_frames.resize(settings.m_ringFrames);
+	for (TrajectoryFrame& frame : m_frames)
+	{
+		frame.m_positions.resize(num_agents);
+		frame.m_forwards.resize(num_agents);
+	}
+	m_previous.assign(3 * static_cast<size_t>(num_agents), 0);
+	m_encoded.resize(TRAJECTORY_MAX_FRAME_HEADER_BYTES + TRAJECTORY_MAX_AGENT_BYTES * num_agents);
+
+	TrajectoryFileHeader header;
+	header.m_blockFrames = settings.m_blockFrames;
+	header.m_positionStep = settings.m_positionStep;
+	header.m_seed = seed;
+	m_fileOffset = 0;
+	WriteBytes(&header, sizeof(header));
+	m_stats.m_writtenBytes = m_fileOffset;
+
+	m_writer = std::thread(&TrajectoryRecorder::RunWriter, this);
+	return true;
+}
+
+
+void TrajectoryRecorder::Capture(const std::vector<Vehicle*>& vehicles, const uint num_agents, const uint tick,
+	const float time)
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	GAME_TRACE_SCOPE("TrajectoryRecorder::Capture");
+	const double capture_begin = FrameTimeStats::GetTimeSeconds();
+	const uint64_t num_slots = m_frames.size();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_numQueued - m_numWritten == num_slots)
+	{
+		if (m_settings.m_overflow == TRAJECTORY_OVERFLOW_DROP)
+		{
+			lock.unlock();
+			++m_stats.m_droppedFrames;
+			m_stats.m_captureSeconds += FrameTimeStats::GetTimeSeconds() - capture_begin;
+			return;
+		}
+
+		m_frameWritten.wait(lock, [this, num_slots]() { return m_numQueued - m_numWritten < num_slots; });
+		m_stats.m_blockedSeconds += FrameTimeStats::GetTimeSeconds() - capture_begin;
+	}
+	TrajectoryFrame& frame = m_frames[m_numQueued % num_slots];
+	lock.unlock();
+
+	// the slot is ours until it is queued, only a population larger than at Start allocates
+	const uint num_captured = std::min(num_agents, static_cast<uint>(vehicles.size()));
+	if (frame.m_positions.size() < num_captured)
+	{
+		frame.m_positions.resize(num_captured);
+		frame.m_forwards.resize(num_captured);
+	}
+	frame.m_tick = tick;
+	frame.m_time = time;
+	frame.m_numAgents = num_captured;
+
+	auto copy_range = [&vehicles, &frame](const uint begin, const uint end)
+	{
+		for (uint veh_idx = begin; veh_idx < end; ++veh_idx)
+		{
+			const Vehicle* vehicle = vehicles[veh_idx];
+			frame.m_positions[veh_idx] = vehicle->GetPosition();
+			frame.m_forwards[veh_idx] = vehicle->GetForward();
+		}
+	};
+	GameJobs::ParallelFor(num_captured, CAPTURE_GRAIN, copy_range);
+
+	lock.lock();
+	++m_numQueued;
+	lock.unlock();
+	m_frameQueued.notify_one();
+
+	++m_stats.m_capturedFrames;
+	m_stats.m_captureSeconds += FrameTimeStats::GetTimeSeconds() - capture_begin;
+}
+
+
+bool TrajectoryRecorder::Stop()
+{
+	if (!IsRecording())
+	{
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_frameQueued.notify_one();
+	m_writer.join();
+
+	// the writer is gone, its counters are ours now
+	const bool closed = fclose(m_file) == 0;
+	m_file = nullptr;
+	return closed && !m_writeFailed;
+}
+
+
+TrajectoryStats TrajectoryRecorder::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+
+void TrajectoryRecorder::RunWriter()
+{
+	TraceRecorder::SetThreadName("Trajectory writer");
+	const uint64_t num_slots = m_frames.size();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_frameQueued.wait(lock, [this]() { return m_numWritten < m_numQueued || m_stopping; });
+		if (m_numWritten == m_numQueued)
+		{
+			break;
+		}
+
+		const TrajectoryFrame& frame = m_frames[m_numWritten % num_slots];
+		lock.unlock();
+		EncodeFrame(frame);
+		lock.lock();
+
+		++m_numWritten;
+		++m_stats.m_writtenFrames;
+		m_stats.m_encodedAgents += frame.m_numAgents;
+		m_stats.m_writtenBytes = m_fileOffset;
+		m_stats.m_writeFailed = m_writeFailed;
+		m_frameWritten.notify_one();
+	}
+	lock.unlock();
+
+	// the index and footer close the file, a reader finds both from its end
+	FinishBlock();
+	TrajectoryFooter footer;
+	footer.m_indexOffset = m_fileOffset;
+	footer.m_numBlocks = static_cast<uint32_t>(m_index.size());
+	for (const TrajectoryBlockEntry& entry : m_index)
+	{
+		footer.m_numFrames += entry.m_numFrames;
+	}
+	if (!m_index.empty())
+	{
+		WriteBytes(m_index.data(), m_index.size() * sizeof(TrajectoryBlockEntry));
+	}
+
+	lock.lock();
+	footer.m_droppedFrames = m_stats.m_droppedFrames;
+	lock.unlock();
+	WriteBytes(&footer, sizeof(footer));
+
+	lock.lock();
+	m_stats.m_writtenBytes = m_fileOffset;
+	m_stats.m_writeFailed = m_writeFailed;
+}
+
+
+void TrajectoryRecorder::EncodeFrame(const TrajectoryFrame& frame)
+{
+	// a block starts with a keyframe, every agent against zero
+	if (m_currentBlock.m_numFrames == 0)
+	{
+		m_currentBlock.m_offset = m_fileOffset;
+		m_currentBlock.m_firstTick = frame.m_tick;
+		m_previousAgents = 0;
+	}
+
+	const uint num_agents = frame.m_numAgents;
+	if (m_previous.size() < 3 * static_cast<size_t>(num_agents))
+	{
+		m_previous.resize(3 * static_cast<size_t>(num_agents), 0);
+		m_encoded.resize(TRAJECTORY_MAX_FRAME_HEADER_BYTES + TRAJECTORY_MAX_AGENT_BYTES * num_agents);
+	}
+
+	uint8_t* out = m_encoded.data();
+	out = WriteVarint(out, frame.m_tick);
+	memcpy(out, &frame.m_time, sizeof(float));
+	out += sizeof(float);
+	out = WriteVarint(out, num_agents);
+
+	const float positions_per_unit = 1.0f / m_settings.m_positionStep;
+	const uint num_continued = std::min(num_agents, m_previousAgents);
+	for (uint agent_idx = 0; agent_idx < num_agents; ++agent_idx)
+	{
+		const Vec2& position = frame.m_positions[agent_idx];
+		const Vec2& forward = frame.m_forwards[agent_idx];
+		const int32_t x = RoundToInt(position.x * positions_per_unit);
+		const int32_t y = RoundToInt(position.y * positions_per_unit);
+		const int32_t heading = static_cast<uint16_t>(
+			RoundToInt(ApproximateAtan2(forward.y, forward.x) * TRAJECTORY_RADIANS_TO_HEADING));
+
+		int32_t* previous = &m_previous[3 * static_cast<size_t>(agent_idx)];
+		if (agent_idx >= num_continued)
+		{
+			previous[0] = 0;
+			previous[1] = 0;
+			previous[2] = 0;
+		}
+
+		// differences of quantized values, so rounding never accumulates
+		const int32_t heading_delta = static_cast<int16_t>(static_cast<uint16_t>(heading - previous[2]));
+		out = WriteVarint(out, ZigzagEncode(x - previous[0]));
+		out = WriteVarint(out, ZigzagEncode(y - previous[1]));
+		out = WriteVarint(out, ZigzagEncode(heading_delta));
+		previous[0] = x;
+		previous[1] = y;
+		previous[2] = heading;
+	}
+	m_previousAgents = num_agents;
+
+	const size_t num_bytes = static_cast<size_t>(out - m_encoded.data());
+	WriteBytes(m_encoded.data(), num_bytes);
+	m_currentBlock.m_size += static_cast<uint32_t>(num_bytes);
+	m_currentBlock.m_lastTick = frame.m_tick;
+	m_currentBlock.m_maxAgents = std::max(m_currentBlock.m_maxAgents, num_agents);
+	if (++m_currentBlock.m_numFrames == m_settings.m_blockFrames)
+	{
+		FinishBlock();
+	}
+}
+
+
+void TrajectoryRecorder::FinishBlock()
+{
+	if (m_currentBlock.m_numFrames > 0)
+	{
+		m_index.push_back(m_currentBlock);
+	}
+	m_currentBlock = TrajectoryBlockEntry();
+}
+
+
+void TrajectoryRecorder::WriteBytes(const void* data, const size_t size)
+{
+	// after a failed write the file is useless, keep counting but stop writing
+	if (!m_writeFailed && fwrite(data, 1, size, m_file) != size)
+	{
+		m_writeFailed = true;
+	}
+	m_fileOffset += size;
+}
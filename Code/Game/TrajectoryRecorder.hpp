@@ -0,0 +1,121 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/TrajectoryFormat.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Vehicle;
+
+//-----------------------------------------------------------------------------------------------
+// TrajectoryRecorder
+//
+// Records every tick's positions and headings to a trajectory file (see TrajectoryFormat.hpp) without
+// writing anything on the simulation thread. Capture() copies the population into the next free slot
+// of a ring of preallocated frames and returns; a writer thread quantizes, delta encodes and writes
+// the frames in blocks behind it.
+//
+// When the writer falls behind and the ring is full, the overflow policy decides: DROP skips the
+// frame (the file then has a gap in its ticks) and the tick goes on, BLOCK waits for the writer to
+// free a slot, so the file is complete but the tick pays for it. Both are counted.
+//
+
+enum TrajectoryOverflow
+{
+	TRAJECTORY_OVERFLOW_DROP = 0,
+	TRAJECTORY_OVERFLOW_BLOCK,
+
+	NUM_TRAJECTORY_OVERFLOWS
+};
+
+
+struct TrajectorySettings
+{
+	uint				m_ringFrames = 8;				// frames in flight between Capture and the writer
+	uint				m_blockFrames = 20;				// frames per block, each block starts with a keyframe and bounds a seek (~20 ms at 100k agents)
+	float				m_positionStep = 1.0f / 256.0f;	// world units per quantization step
+	TrajectoryOverflow	m_overflow = TRAJECTORY_OVERFLOW_DROP;
+};
+
+
+struct TrajectoryStats
+{
+	uint64_t	m_capturedFrames = 0;
+	uint64_t	m_droppedFrames = 0;
+	uint64_t	m_writtenFrames = 0;
+	uint64_t	m_writtenBytes = 0;
+	uint64_t	m_encodedAgents = 0;		// agent records in every written frame
+	double		m_captureSeconds = 0.0;		// on the simulation thread, blocking included
+	double		m_blockedSeconds = 0.0;		// of that, waiting for a free slot
+	bool		m_writeFailed = false;
+};
+
+
+struct TrajectoryFrame
+{
+	uint				m_tick = 0;
+	float				m_time = 0.0f;
+	uint				m_numAgents = 0;
+	std::vector<Vec2>	m_positions;
+	std::vector<Vec2>	m_forwards;
+};
+
+
+class TrajectoryRecorder
+{
+public:
+	static constexpr const char*	DEFAULT_PATH = "Trajectories.traj";
+	static constexpr uint			CAPTURE_GRAIN = 8'192;		// vehicles per job when copying a frame
+
+public:
+	TrajectoryRecorder() = default;
+	~TrajectoryRecorder();
+
+	TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+	TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+	// opens the file, writes the header and starts the writer; frames are sized for num_agents up front
+	bool	Start(const std::string& file_path, const TrajectorySettings& settings, uint num_agents, uint64_t seed);
+	void	Capture(const std::vector<Vehicle*>& vehicles, uint num_agents, uint tick, float time);
+	bool	Stop();		// drains the ring, writes the index and footer; false if any write failed
+	bool	IsRecording() const { return m_file != nullptr; }
+
+	TrajectoryStats				GetStats() const;
+	const TrajectorySettings&	GetSettings() const { return m_settings; }
+
+private:
+	void	RunWriter();
+	void	EncodeFrame(const TrajectoryFrame& frame);
+	void	FinishBlock();
+	void	WriteBytes(const void* data, size_t size);
+
+private:
+	TrajectorySettings				m_settings;
+	FILE*							m_file = nullptr;
+	std::thread						m_writer;
+
+	//Ring, guarded by m_mutex: slots [m_numWritten, m_numQueued) belong to the writer, the rest to Capture
+	std::vector<TrajectoryFrame>	m_frames;
+	mutable std::mutex				m_mutex;
+	std::condition_variable			m_frameQueued;
+	std::condition_variable			m_frameWritten;
+	uint64_t						m_numQueued = 0;
+	uint64_t						m_numWritten = 0;
+	bool							m_stopping = false;
+
+	//Writer thread only
+	std::vector<int32_t>				m_previous;		// x, y, heading per agent, as last encoded
+	std::vector<uint8_t>				m_encoded;		// one frame, sized for the worst case
+	std::vector<TrajectoryBlockEntry>	m_index;
+	TrajectoryBlockEntry				m_currentBlock;
+	uint64_t							m_fileOffset = 0;
+	uint								m_previousAgents = 0;
+	bool								m_writeFailed = false;
+
+	TrajectoryStats	m_stats;	// capture counters by Capture, writer counters under m_mutex
+};
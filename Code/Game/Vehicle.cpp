@@ -1,11 +1,12 @@
 #include "Game/Vehicle.hpp"
 #include "Game/SteeringBehavior.hpp"
 #include "Game/Game.hpp"
+#include "Game/GameProfiler.hpp"
+#include "Game/SharedVisuals.hpp"
+#include "Game/WorldSnapshot.hpp"
 
 #include "Engine/Math/MathUtils.hpp"
-#include "Engine/Renderer/GPUMesh.hpp"
-#include "Engine/Renderer/Material.hpp"
-#include "Engine/Renderer/Shader.hpp"
+#include "Game/RenderBackend.hpp"
 
 Vehicle::Vehicle(Game* game, const Vec2& pos, const float rotation_degrees, const Vec2& velocity,
 	const float mass, const float max_force, const float max_speed, const float max_turn_speed_deg,
@@ -22,19 +23,7 @@ Vehicle::Vehicle(Game* game, const Vec2& pos, const float rotation_degrees, cons
 
 Vehicle::~Vehicle()
 {
-	if (m_steeringMesh != nullptr)
-	{
-		delete m_steeringMesh;
-		m_steeringMesh = nullptr;
-	}
-
-	
-	if(m_forwardMesh != nullptr)
-	{
-		delete m_forwardMesh;
-		m_forwardMesh = nullptr;
-	}
-
+	// the meshes belong to SharedVisuals
 	delete m_steering;
 	m_steering = nullptr;
 }
@@ -47,13 +36,34 @@ void Vehicle::Init()
 
 void Vehicle::Update(const double delta_seconds)
 {
-	const Vec2 steering_force = m_steering->Calculate(m_behaviors);
+	GAME_PROFILE_SCOPE(PROFILE_VEHICLE_UPDATE);
+
+	// presolved means it was in this tick's agent avoidance solve
+	const bool presolved = m_hasPresolvedSteering;
+	m_hasPresolvedSteering = false;
+
+	Vec2 steering_force = m_presolvedSteering;
+	if (!presolved)
+	{
+		GAME_PROFILE_SCOPE(PROFILE_STEER_CALCULATE);
+		steering_force = m_steering->Calculate(m_behaviors);
+	}
+
+	GAME_PROFILE_SCOPE(PROFILE_INTEGRATION);
 
 	// Acceleration = force/mass
 	const Vec2 acceleration = steering_force * m_inverseMass;
 
 	// Velocity = v_0 + a*t
 	m_velocity += acceleration * static_cast<float>(delta_seconds);
+
+	// the solve's preferred velocity was this one, see PresolveSteering; its answer is the closest
+	// velocity to it that stays clear of the neighbors, so take the answer in place of it
+	Vec2 avoiding_velocity = Vec2::ZERO;
+	if (presolved && m_theGame->GetAgentAvoidanceVelocity(m_populationIdx, avoiding_velocity))
+	{
+		m_velocity = avoiding_velocity;
+	}
 	const float vel_length_sqrd = m_velocity.GetLengthSquared();
 
 	// if 0.0f then we divide by zero
@@ -90,6 +100,24 @@ void Vehicle::Update(const double delta_seconds)
 }
 
 
+Vec2 Vehicle::PresolveSteering(const double delta_seconds)
+{
+	{
+		GAME_PROFILE_SCOPE(PROFILE_STEER_CALCULATE);
+		m_presolvedSteering = m_steering->Calculate(m_behaviors);
+	}
+	m_hasPresolvedSteering = true;
+
+	// what Update will integrate, truncated the same way
+	Vec2 velocity = m_velocity + m_presolvedSteering * m_inverseMass * static_cast<float>(delta_seconds);
+	if (velocity.GetLengthSquared() > m_maxSpeed * m_maxSpeed)
+	{
+		velocity = velocity.GetNormalized() * m_maxSpeed;
+	}
+	return velocity;
+}
+
+
 void Vehicle::Render() const
 {
 	Matrix44 model_matrix(m_modelMatrix);
@@ -108,6 +136,7 @@ void Vehicle::TurnOffSteering()
 {
 	m_behaviors.reset();
 	m_steering->SetMovingTarget(nullptr);
+	m_steering->ClearFlowGoal();
 	m_steering->SetTarget(Vec2::ZERO);
 }
 
@@ -115,14 +144,18 @@ void Vehicle::TurnOffSteering()
 void Vehicle::SeekTarget(const Vec2& target_pos)
 {
 	m_steering->SetTarget(target_pos);
+	m_steering->SetFlowGoal(target_pos);
 	m_behaviors[STEER_SEEK] = true;
+	Wake();
 }
 
 
 void Vehicle::SeekTarget(const Vehicle* moving_target)
 {
 	m_steering->SetMovingTarget(moving_target);
+	m_steering->SetFlowGoal(moving_target);
 	m_behaviors[STEER_SEEK] = true;
+	Wake();
 }
 
 
@@ -130,6 +163,7 @@ void Vehicle::FleeTarget(const Vec2& target_pos)
 {
 	m_steering->SetTarget(target_pos);
 	m_behaviors[STEER_FLEE] = true;
+	Wake();
 }
 
 
@@ -137,7 +171,9 @@ void Vehicle::ArriveAt(const Vec2& target_pos, const float scalar_modifier)
 {
 	m_steering->SetTarget(target_pos);
 	m_steering->SetArriveModifier(scalar_modifier);
+	m_steering->SetFlowGoal(target_pos);
 	m_behaviors[STEER_ARRIVE] = true;
+	Wake();
 }
 
 
@@ -148,6 +184,7 @@ void Vehicle::PursuitOn(const Vehicle* moving_target, const float head_on_tolera
 	m_steering->SetPursuitHeadTowardsTolerance(head_on_tolerance_frac);
 	m_steering->SetPursuitTurnaround(turn_around_modifier);
 	m_behaviors[STEER_PURSUIT] = true;
+	Wake();
 }
 
 
@@ -155,6 +192,7 @@ void Vehicle::EvadeFrom(const Vehicle* moving_target)
 {
 	m_steering->SetMovingTarget(moving_target);
 	m_behaviors[STEER_EVADE] = true;
+	Wake();
 }
 
 
@@ -162,6 +200,7 @@ void Vehicle::WanderAround(const float radius, const float distance, const float
 {
 	m_steering->SetRandomWalk(radius, distance, jitter);
 	m_behaviors[STEER_WANDER] = true;
+	Wake();
 }
 
 
@@ -170,6 +209,7 @@ void Vehicle::AvoidObstacles(const float min_look_ahead, const float avoidance_m
 {
 	m_steering->SetObstaclesAvoidance(min_look_ahead, avoidance_mul, breaking_weight);
 	m_behaviors[STEER_OBSTACLE_AVOIDANCE] = true;
+	Wake();
 }
 
 
@@ -178,98 +218,222 @@ void Vehicle::AvoidWalls(const uint num_whiskers, const float whisker_length, co
 {
 	m_steering->SetWallAvoidance(num_whiskers, whisker_length, avoidance_mul, field_of_view_degrees);
 	m_behaviors[STEER_WALL_AVOIDANCE] = true;
+	Wake();
 }
 
 
-Game* Vehicle::GetTheGame() const
+void Vehicle::AvoidAgents()
 {
-	return m_theGame;
+	// neighbors, horizon and the solve itself are shared, see Game::SolveAgentAvoidance
+	m_behaviors[STEER_AGENT_AVOIDANCE] = true;
+	Wake();
 }
 
 
-void Vehicle::InitVisuals()
+bool Vehicle::HasBehavior(const int behavior) const
 {
-	// Get Everything to draw the triangle
-	m_material = g_theRenderer->CreateOrGetMaterial("white", false);
-	m_material->SetShader("default_unlit.hlsl");
-	m_material->m_shader->SetDepth(COMPARE_LESS_EQUAL, true);
-	TextureView* white_texture(reinterpret_cast<TextureView*>(g_theRenderer->CreateOrGetTextureView2D("0xFFFFFFFF")));
-	m_material->SetDiffuseMap(white_texture);
+	return m_behaviors.test(behavior);
+}
+
 
-	CPUMesh triangle_mesh;
-	CpuMeshAddTriangle(&triangle_mesh, GetBoundingRadius(), m_color);
-	m_mesh = new GPUMesh(g_theRenderer);
-	m_mesh->CreateFromCPUMesh<Vertex_Lit>(triangle_mesh);
+void Vehicle::SetVelocity(const Vec2& new_vel)
+{
+	MovingEntity::SetVelocity(new_vel);
+	Wake();
 }
 
 
-void Vehicle::InitDebugVisuals()
+void Vehicle::SetPopulationIndex(const uint population_idx)
 {
-	// Get Everything to forward Debug
-	m_forwardMaterial = g_theRenderer->CreateOrGetMaterial("black", false);
-	m_forwardMaterial->SetShader("default_lit.hlsl");
-	m_forwardMaterial->m_shader->SetDepth(COMPARE_LESS_EQUAL, true);
-	TextureView* black_texture(reinterpret_cast<TextureView*>(g_theRenderer->CreateOrGetTextureView2D("0x000000FF")));
-	m_forwardMaterial->SetDiffuseMap(black_texture);
+	m_populationIdx = population_idx;
+}
 
-	CPUMesh forward_line_mesh;
-	CpuMeshAddLine(&forward_line_mesh, Vec2::ZERO, Vec2(1.0f, 0.0f), 1.0f, Rgba::BLACK);
-	m_forwardMesh = new GPUMesh(g_theRenderer);
-	m_forwardMesh->CreateFromCPUMesh<Vertex_Lit>(forward_line_mesh);
 
+uint Vehicle::GetPopulationIndex() const
+{
+	return m_populationIdx;
+}
 
-	// Get Everything to steering Debug
-	m_steeringMaterial = g_theRenderer->CreateOrGetMaterial("red", false);
-	m_steeringMaterial->SetShader("default_lit.hlsl");
-	m_steeringMaterial->m_shader->SetDepth(COMPARE_LESS_EQUAL, true);
-	TextureView* red_texture(reinterpret_cast<TextureView*>(g_theRenderer->CreateOrGetTextureView2D("0xFF0000FF")));
-	m_steeringMaterial->SetDiffuseMap(red_texture);
 
-	CPUMesh steering_line_mesh;
-	CpuMeshAddLine(&steering_line_mesh, Vec2::ZERO, Vec2(1.0f, 0.0f), 1.0f, Rgba::BLACK);
-	m_steeringMesh = new GPUMesh(g_theRenderer);
-	m_steeringMesh->CreateFromCPUMesh<Vertex_Lit>(steering_line_mesh);
+bool Vehicle::IsAwake() const
+{
+	return m_isAwake;
 }
 
 
-void Vehicle::UpdateDebugArrows(const Vec2& steering_force)
+bool Vehicle::CanSleep() const
 {
-	//  Update Debug drawing for arrows
-	if (m_forwardMesh != nullptr)
+	// nothing steers it and it has (all but) stopped, another Update would not change anything
+	return m_behaviors.none() && m_velocity.GetLengthSquared() < 0.000001f;
+}
+
+
+void Vehicle::Sleep()
+{
+	m_velocity = Vec2::ZERO;
+	m_steeringLength = 0.0f;
+	m_isAwake = false;
+}
+
+
+void Vehicle::Wake()
+{
+	if (!m_isAwake)
 	{
-		delete m_forwardMesh;
-		m_forwardMesh = nullptr;
+		m_isAwake = true;
+		m_theGame->WakeVehicle(m_populationIdx);
 	}
+}
+
+
+void Vehicle::SetLodPriority(const int lod_priority)
+{
+	m_lodPriority = lod_priority;
+}
+
+
+int Vehicle::GetLodPriority() const
+{
+	return m_lodPriority;
+}
+
+
+void Vehicle::SetLodTier(const int lod_tier)
+{
+	m_lodTier = lod_tier;
+}
 
-	CPUMesh forward_line_mesh;
-	CpuMeshAddLine(
-		&forward_line_mesh, 
-		Vec2::ZERO, 
-		Vec2(1.0f, 0.0f), 
-		1.0f, 
-		Rgba::BLACK
-	);
-	
-	m_forwardMesh = new GPUMesh(g_theRenderer);
-	m_forwardMesh->CreateFromCPUMesh<Vertex_Lit>(forward_line_mesh);
 
-	if (m_steeringMesh != nullptr)
+int Vehicle::GetLodTier() const
+{
+	return m_lodTier;
+}
+
+
+void Vehicle::AccumulateLodSeconds(const double delta_seconds)
+{
+	m_lodPendingSeconds += delta_seconds;
+}
+
+
+double Vehicle::PeekLodSeconds() const
+{
+	return m_lodPendingSeconds;
+}
+
+
+double Vehicle::ConsumeLodSeconds()
+{
+	const double pending_seconds = m_lodPendingSeconds;
+	m_lodPendingSeconds = 0.0;
+	return pending_seconds;
+}
+
+
+Game* Vehicle::GetTheGame() const
+{
+	return m_theGame;
+}
+
+
+SimRandom& Vehicle::GetRandom()
+{
+	return m_random;
+}
+
+
+void Vehicle::WriteState(VehicleState& out_state) const
+{
+	out_state.m_index = m_populationIdx;
+	out_state.m_position = GetPosition();
+	out_state.m_velocity = m_velocity;
+	out_state.m_forward = GetForward();
+	out_state.m_wanderTarget = m_steering->GetWanderTarget();
+	out_state.m_randomState = m_random.GetState();
+	out_state.m_lodPendingSeconds = m_lodPendingSeconds;
+}
+
+
+void Vehicle::ReadState(const VehicleState& state)
+{
+	// a straight copy, not SetVelocity, whether it is awake is up to whoever owns the vehicle
+	SetPos(state.m_position);
+	m_velocity = state.m_velocity;
+	SetForward(state.m_forward);
+	m_steering->SetWanderTarget(state.m_wanderTarget);
+	m_random.SetState(state.m_randomState);
+	m_lodPendingSeconds = state.m_lodPendingSeconds;
+}
+
+
+void Vehicle::WriteSnapshot(VehicleSnapshot& out_snapshot) const
+{
+	WriteState(out_snapshot.m_state);
+	m_steering->WriteSnapshot(out_snapshot.m_steering);
+
+	out_snapshot.m_boundingRadius = GetBoundingRadius();
+	out_snapshot.m_mass = m_mass;
+	out_snapshot.m_maxSpeed = m_maxSpeed;
+	out_snapshot.m_maxForce = m_maxForce;
+	out_snapshot.m_maxTurnSpeedDeg = m_maxTurnSpeedDeg;
+	out_snapshot.m_behaviors = static_cast<uint32_t>(m_behaviors.to_ulong());
+	out_snapshot.m_flags = m_isAwake ? VEHICLE_SNAPSHOT_AWAKE : 0u;
+	out_snapshot.m_lodPriority = m_lodPriority;
+	out_snapshot.m_lodTier = m_lodTier;
+}
+
+
+void Vehicle::ReadSnapshot(const VehicleSnapshot& snapshot)
+{
+	// the mesh follows the radius, Game re-inits visuals of vehicles whose radius changed
+	if (snapshot.m_boundingRadius != GetBoundingRadius())
 	{
-		delete m_steeringMesh;
-		m_steeringMesh = nullptr;
+		SetBoundingRadius(snapshot.m_boundingRadius);
+		SetScale(snapshot.m_boundingRadius);
 	}
 
-	CPUMesh steering_line_mesh;
-	CpuMeshAddLine(
-		&steering_line_mesh, 
-		Vec2::ZERO, 
-		Vec2(steering_force.GetLength(), 0.0f),
-		1.0f, 
-		Rgba::RED
-	);
-	
-	m_steeringMesh = new GPUMesh(g_theRenderer);
-	m_steeringMesh->CreateFromCPUMesh<Vertex_Lit>(steering_line_mesh);
+	m_mass = snapshot.m_mass;
+	m_inverseMass = 1.0f / snapshot.m_mass;
+	m_maxSpeed = snapshot.m_maxSpeed;
+	m_maxForce = snapshot.m_maxForce;
+	m_maxTurnSpeedDeg = snapshot.m_maxTurnSpeedDeg;
+	m_behaviors = std::bitset<NUM_STEER_BEHAVIORS>(snapshot.m_behaviors);
+	m_lodPriority = snapshot.m_lodPriority;
+	m_lodTier = snapshot.m_lodTier >= 0 && snapshot.m_lodTier < NUM_LOD_TIERS ? snapshot.m_lodTier : LOD_TIER_FULL;
+
+	// straight assignments, Game rebuilds its active set from the awake flags afterwards
+	m_isAwake = (snapshot.m_flags & VEHICLE_SNAPSHOT_AWAKE) != 0;
+	m_steeringLength = 0.0f;
+
+	ReadState(snapshot.m_state);
+	m_steering->ReadSnapshot(snapshot.m_steering);
+}
+
+
+void Vehicle::InitVisuals()
+{
+	// every vehicle of the same size and color shares one triangle
+	m_material = SharedVisuals::GetMaterial(SHARED_MATERIAL_VEHICLE);
+	m_mesh = SharedVisuals::CreateOrGetMesh(SHARED_MESH_TRIANGLE, GetBoundingRadius(), m_color);
+	m_ownsMesh = false;
+}
+
+
+void Vehicle::InitDebugVisuals()
+{
+	// unit lines, the model matrix scales them to the forward and steering lengths
+	m_forwardMaterial = SharedVisuals::GetMaterial(SHARED_MATERIAL_FORWARD);
+	m_forwardMesh = SharedVisuals::CreateOrGetMesh(SHARED_MESH_LINE, 1.0f, Rgba::BLACK);
+
+	m_steeringMaterial = SharedVisuals::GetMaterial(SHARED_MATERIAL_STEERING);
+	m_steeringMesh = SharedVisuals::CreateOrGetMesh(SHARED_MESH_LINE, 1.0f, Rgba::RED);
+}
+
+
+void Vehicle::UpdateDebugArrows(const Vec2& steering_force)
+{
+	// both arrow meshes are built once in InitDebugVisuals, only the steering length changes
+	m_steeringLength = steering_force.GetLength();
 }
 
 
@@ -279,6 +443,12 @@ void Vehicle::RenderDebugArrows() const
 	g_theRenderer->BindMaterial(*m_forwardMaterial);
 	g_theRenderer->DrawMesh(*m_forwardMesh);
 
+	// stretch the unit steering line along the vehicle's forward axis
+	Matrix33 steering_matrix(m_modelMatrix);
+	steering_matrix.SetIvec(m_modelMatrix.GetIvec2() * m_steeringLength);
+	const Matrix44 steering_model(steering_matrix);
+	g_theRenderer->BindModelMatrix(steering_model);
+
 	g_theRenderer->BindMaterial(*m_steeringMaterial);
 	g_theRenderer->DrawMesh(*m_steeringMesh);
 }
@@ -1,9 +1,13 @@
 #pragma once
 #include "Game/MovingEntity.hpp"
+#include "Game/LodScheduler.hpp"
+#include "Game/SimRandom.hpp"
+#include "Game/VehicleState.hpp"
 #include <bitset>
 
 class Game;
 class SteeringBehavior;
+struct VehicleSnapshot;
 
 
 class Vehicle : public MovingEntity
@@ -14,6 +18,22 @@ private:
 	
 	//bit field
 	std::bitset<NUM_STEER_BEHAVIORS> m_behaviors;
+
+	//active set, see Game::WakeVehicle
+	uint	m_populationIdx = 0;
+	bool	m_isAwake = true;
+
+	//wander draws, seeded from the world seed and the population index
+	SimRandom	m_random;
+
+	//agent avoidance, this tick's steering worked out ahead of the solve, see Game::SolveAgentAvoidance
+	Vec2	m_presolvedSteering = Vec2::ZERO;
+	bool	m_hasPresolvedSteering = false;
+
+	//multi-rate ticking, see LodScheduler
+	int		m_lodPriority = LOD_PRIORITY_BY_DISTANCE;
+	int		m_lodTier = LOD_TIER_FULL;
+	double	m_lodPendingSeconds = 0.0;
 	
 	//debugging
 	Rgba m_color = Rgba::WHITE;
@@ -21,7 +41,8 @@ private:
 	GPUMesh*	m_forwardMesh = nullptr;
 
 	Material*	m_steeringMaterial = nullptr;
-	GPUMesh*	m_steeringMesh = nullptr;
+	GPUMesh*	m_steeringMesh = nullptr;		// unit length, scaled by m_steeringLength when drawn
+	float		m_steeringLength = 0.0f;
 
 public:
 	Vehicle(Game* game, const Vec2& pos, float rotation_degrees, const Vec2& velocity, float mass,
@@ -34,6 +55,27 @@ public:
 	void	Update(double delta_seconds) override;
 	void	Render() const override;
 
+	//Sleeping
+	void	SetVelocity(const Vec2& new_vel) override;
+	void	SetPopulationIndex(uint population_idx);
+	uint	GetPopulationIndex() const;
+	bool	IsAwake() const;
+	bool	CanSleep() const;
+	void	Sleep();
+	void	Wake();
+
+	//Agent avoidance
+	Vec2	PresolveSteering(double delta_seconds);	// the velocity this tick's steering alone would give
+
+	//Level of detail
+	void	SetLodPriority(int lod_priority);	// a LodTier to pin, or LOD_PRIORITY_BY_DISTANCE
+	int		GetLodPriority() const;
+	void	SetLodTier(int lod_tier);
+	int		GetLodTier() const;
+	void	AccumulateLodSeconds(double delta_seconds);
+	double	ConsumeLodSeconds();
+	double	PeekLodSeconds() const;
+
 	//Steering behaviors
 	void	TurnOffSteering();
 	void	SeekTarget(const Vec2& target_pos);
@@ -45,9 +87,20 @@ public:
 	void	WanderAround(float radius, float distance, float jitter);
 	void	AvoidObstacles(float min_look_ahead, float avoidance_mul, float breaking_weight);
 	void	AvoidWalls(uint num_whiskers, float whisker_length, float avoidance_mul, float field_of_view_degrees);
+	void	AvoidAgents();
+	bool	HasBehavior(int behavior) const;
 	
 	//Helppers
-	Game*	GetTheGame() const;
+	Game*		GetTheGame() const;
+	SimRandom&	GetRandom();
+
+	//What Update evolves, enough to continue the vehicle in another process
+	void	WriteState(VehicleState& out_state) const;
+	void	ReadState(const VehicleState& state);
+
+	//Everything, setup included, see WorldSnapshot
+	void	WriteSnapshot(VehicleSnapshot& out_snapshot) const;
+	void	ReadSnapshot(const VehicleSnapshot& snapshot);
 
 private:
 	void InitVisuals() override;
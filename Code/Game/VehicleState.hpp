@@ -0,0 +1,26 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+
+//-----------------------------------------------------------------------------------------------
+// VehicleState
+//
+// The part of a vehicle that changes while it simulates, as plain data. Behaviors, targets and
+// tuning are set up identically wherever the vehicle lives and are not part of it; restoring this on
+// a vehicle with the same setup continues it exactly where it left off, bit for bit.
+//
+// Trivially copyable, so it can be written to shared memory or a file as is.
+//
+
+struct VehicleState
+{
+	uint		m_index = 0;				// population index
+	uint		m_obstacleContact = 0;		// Game's metrics, non-zero while overlapping an obstacle
+	Vec2		m_position;
+	Vec2		m_velocity;
+	Vec2		m_forward = Vec2(1.0f, 0.0f);
+	Vec2		m_wanderTarget;
+	uint64_t	m_randomState = 0;
+	double		m_lodPendingSeconds = 0.0;
+};
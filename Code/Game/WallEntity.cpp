@@ -1,9 +1,7 @@
 #include "Game/WallEntity.hpp"
 
 #include "Engine/Math/MathUtils.hpp"
-#include "Engine/Renderer/GPUMesh.hpp"
-#include "Engine/Renderer/Material.hpp"
-#include "Engine/Renderer/Shader.hpp"
+#include "Game/RenderBackend.hpp"
 
 #include "Engine/Math/MathUtils.hpp"
 
@@ -11,6 +9,13 @@ WallEntity::WallEntity(Game* game, const float wall_length, const Vec2& forward,
 	BaseEntity(ENTITY_WALL), m_theGame(game), m_plane(forward, signed_distance),
 	m_wallHalfLength(wall_length*0.5f)
 {
+	// the transform is simulation state, set up here so worlds without visuals never need Init
+	Vec2 center = m_plane.PointOnPlane();
+	m_modelMatrix.SetTvec(center);
+	
+	const Vec2 direction = m_plane.GetDirection();
+	m_modelMatrix.SetIvec(direction);
+	m_modelMatrix.SetJvec(direction.GetRotated90Degrees());
 }
 
 WallEntity::~WallEntity()
@@ -19,13 +24,6 @@ WallEntity::~WallEntity()
 
 void WallEntity::Init()
 {
-	Vec2 center = m_plane.PointOnPlane();
-	m_modelMatrix.SetTvec(center);
-	
-	const Vec2 forward = m_plane.GetDirection();
-	m_modelMatrix.SetIvec(forward);
-	m_modelMatrix.SetJvec(forward.GetRotated90Degrees());
-
 	InitVisuals();
 }
 
@@ -0,0 +1,48 @@
+#include "Game/WhiskerFan.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+#include <deque>
+#include <mutex>
+
+// deque so handed out pointers survive later insertions; fans live until exit
+static std::deque<WhiskerFan>	s_whiskerFans;
+static std::mutex				s_whiskerFansLock;
+
+
+STATIC const WhiskerFan* WhiskerFan::CreateOrGet(const uint num_whiskers, const float field_of_view_degrees)
+{
+	const uint clamped_whiskers = num_whiskers < MAX_WHISKERS ? num_whiskers : MAX_WHISKERS;
+
+	std::lock_guard<std::mutex> lock(s_whiskerFansLock);
+	for (const WhiskerFan& fan : s_whiskerFans)
+	{
+		if (fan.m_numWhiskers == clamped_whiskers && fan.m_fieldOfViewDegrees == field_of_view_degrees)
+		{
+			return &fan;
+		}
+	}
+
+	s_whiskerFans.emplace_back();
+	WhiskerFan& fan = s_whiskerFans.back();
+	fan.m_numWhiskers = clamped_whiskers;
+	fan.m_fieldOfViewDegrees = field_of_view_degrees;
+
+	const float sector_degrees = clamped_whiskers > 1 ?
+		field_of_view_degrees / static_cast<float>(clamped_whiskers - 1) : 0.0f;
+
+	float angle_degrees = -0.5f * field_of_view_degrees;
+	for (uint whisk_idx = 0; whisk_idx < clamped_whiskers; ++whisk_idx)
+	{
+		fan.m_localDirections[whisk_idx] = Vec2(CosDegrees(angle_degrees), SinDegrees(angle_degrees));
+		angle_degrees += sector_degrees;
+	}
+
+	return &fan;
+}
+
+
+STATIC uint WhiskerFan::GetNumFans()
+{
+	std::lock_guard<std::mutex> lock(s_whiskerFansLock);
+	return static_cast<uint>(s_whiskerFans.size());
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+
+//-----------------------------------------------------------------------------------------------
+// WhiskerFan
+//
+// Unit whisker directions for wall avoidance, in the vehicle's local space (x forward, y tangent),
+// spread evenly from -fov/2 to +fov/2 like CreateWhiskers. The trigonometry is done once per
+// (count, field of view) pair: CreateOrGet() hands every vehicle with the same settings the same fan,
+// and a tick only rotates the directions by the vehicle's heading.
+//
+
+class WhiskerFan
+{
+public:
+	static constexpr uint MAX_WHISKERS = 16;
+
+public:
+	uint	m_numWhiskers = 0;
+	float	m_fieldOfViewDegrees = 0.0f;
+	Vec2	m_localDirections[MAX_WHISKERS];
+
+public:
+	Vec2	GetWorldDirection(uint whisk_idx, const Vec2& forward, const Vec2& tangent) const;
+
+	static const WhiskerFan*	CreateOrGet(uint num_whiskers, float field_of_view_degrees);
+	static uint					GetNumFans();
+};
+
+
+inline Vec2 WhiskerFan::GetWorldDirection(const uint whisk_idx, const Vec2& forward, const Vec2& tangent) const
+{
+	const Vec2& local = m_localDirections[whisk_idx];
+	return forward * local.x + tangent * local.y;
+}
@@ -0,0 +1,119 @@
+#include "Game/WorldSnapshot.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+// the on-disk layout, a change to any of these is a new WORLD_SNAPSHOT_VERSION
+static_assert(sizeof(WorldSnapshotHeader) == 192, "WorldSnapshotHeader layout changed");
+static_assert(sizeof(VehicleSnapshot) == 168, "VehicleSnapshot layout changed");
+static_assert(sizeof(ObstacleSnapshot) == 12, "ObstacleSnapshot layout changed");
+static_assert(sizeof(WallSnapshot) == 16, "WallSnapshot layout changed");
+
+
+static uint64_t AlignSection(const uint64_t offset)
+{
+	return (offset + WorldSnapshot::SECTION_ALIGNMENT - 1) & ~(WorldSnapshot::SECTION_ALIGNMENT - 1);
+}
+
+
+bool WorldSnapshot::Map(const std::string& file_path)
+{
+	if (m_file.Map(file_path) && !IsValid())
+	{
+		m_file.Unmap();
+	}
+
+	return m_file.IsMapped();
+}
+
+
+void WorldSnapshot::Unmap()
+{
+	m_file.Unmap();
+}
+
+
+const WorldSnapshotHeader& WorldSnapshot::GetHeader() const
+{
+	return *reinterpret_cast<const WorldSnapshotHeader*>(m_file.GetData());
+}
+
+
+const VehicleSnapshot* WorldSnapshot::GetVehicles() const
+{
+	return reinterpret_cast<const VehicleSnapshot*>(m_file.GetData() + GetHeader().m_vehiclesOffset);
+}
+
+
+const ObstacleSnapshot* WorldSnapshot::GetObstacles() const
+{
+	return reinterpret_cast<const ObstacleSnapshot*>(m_file.GetData() + GetHeader().m_obstaclesOffset);
+}
+
+
+const WallSnapshot* WorldSnapshot::GetWalls() const
+{
+	return reinterpret_cast<const WallSnapshot*>(m_file.GetData() + GetHeader().m_wallsOffset);
+}
+
+
+STATIC void WorldSnapshot::LayOut(WorldSnapshotHeader& header)
+{
+	header.m_magic = WORLD_SNAPSHOT_MAGIC;
+	header.m_version = WORLD_SNAPSHOT_VERSION;
+	header.m_headerSize = sizeof(WorldSnapshotHeader);
+	header.m_vehicleSize = sizeof(VehicleSnapshot);
+	header.m_obstacleSize = sizeof(ObstacleSnapshot);
+	header.m_wallSize = sizeof(WallSnapshot);
+
+	header.m_vehiclesOffset = AlignSection(sizeof(WorldSnapshotHeader));
+	header.m_obstaclesOffset = AlignSection(header.m_vehiclesOffset + static_cast<uint64_t>(header.m_numVehicles) * sizeof(VehicleSnapshot));
+	header.m_wallsOffset = AlignSection(header.m_obstaclesOffset + static_cast<uint64_t>(header.m_numObstacles) * sizeof(ObstacleSnapshot));
+	header.m_fileSize = header.m_wallsOffset + static_cast<uint64_t>(header.m_numWalls) * sizeof(WallSnapshot);
+}
+
+
+STATIC bool WorldSnapshot::WriteFile(const std::string& file_path, const std::vector<uint8_t>& buffer)
+{
+	FILE* file = fopen(file_path.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	const size_t num_written = fwrite(buffer.data(), 1, buffer.size(), file);
+	const bool closed = fclose(file) == 0;
+	return num_written == buffer.size() && closed;
+}
+
+
+bool WorldSnapshot::IsValid() const
+{
+	if (m_file.GetSize() < sizeof(WorldSnapshotHeader))
+	{
+		return false;
+	}
+
+	// a file laid out by this build has exactly the offsets LayOut gives its counts
+	const WorldSnapshotHeader& header = GetHeader();
+	WorldSnapshotHeader expected;
+	expected.m_numVehicles = header.m_numVehicles;
+	expected.m_numObstacles = header.m_numObstacles;
+	expected.m_numWalls = header.m_numWalls;
+	LayOut(expected);
+
+	return header.m_magic == expected.m_magic &&
+		header.m_version == expected.m_version &&
+		header.m_headerSize == expected.m_headerSize &&
+		header.m_vehicleSize == expected.m_vehicleSize &&
+		header.m_obstacleSize == expected.m_obstacleSize &&
+		header.m_wallSize == expected.m_wallSize &&
+		header.m_vehiclesOffset == expected.m_vehiclesOffset &&
+		header.m_obstaclesOffset == expected.m_obstaclesOffset &&
+		header.m_wallsOffset == expected.m_wallsOffset &&
+		header.m_fileSize == expected.m_fileSize &&
+		header.m_fileSize == m_file.GetSize() &&
+		header.m_numVehicles > 0 &&
+		header.m_populationSize <= header.m_numVehicles &&
+		header.m_steeringCombine < NUM_STEER_COMBINES;
+}
@@ -0,0 +1,173 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/Game.hpp"
+#include "Game/VehicleState.hpp"
+#include "Game/MappedFile.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// WorldSnapshot
+//
+// The whole simulation state of a Game as one versioned binary file: a fixed header followed by flat
+// arrays of plain records, vehicles, obstacles and walls, each starting on a 64 byte boundary.
+//
+//		header		counts, offsets, world random state, seed, settings and metrics
+//		vehicles	VehicleSnapshot, kinematics, random state, behavior mask, steering parameters
+//		obstacles	ObstacleSnapshot
+//		walls		WallSnapshot
+//
+// Game::SaveSnapshot lays the records out in one buffer and writes it with a single write. Map()
+// maps the file read-only and only checks the header, after which the records are used in place;
+// nothing is parsed or copied until Game::RestoreSnapshot reads them straight into the vehicles.
+//
+// Targets are stored as population indices, so a snapshot restores into any world. Records are
+// native endian with no padding; the header records every record size, and any mismatch with this
+// build (or another version) makes Map() refuse the file.
+//
+
+constexpr uint32_t WORLD_SNAPSHOT_MAGIC = 0x4E535357;	// "WSSN"
+constexpr uint32_t WORLD_SNAPSHOT_VERSION = 1;
+constexpr uint32_t INVALID_SNAPSHOT_INDEX = 0xFFFFFFFFu;
+
+
+// WorldSnapshotHeader::m_worldFlags
+constexpr uint32_t WORLD_SNAPSHOT_CULL_AVOIDANCE = 1u << 0;
+constexpr uint32_t WORLD_SNAPSHOT_TARGET_SNAPSHOTS = 1u << 1;
+constexpr uint32_t WORLD_SNAPSHOT_FLOW_FIELDS = 1u << 2;
+constexpr uint32_t WORLD_SNAPSHOT_LOD = 1u << 3;
+constexpr uint32_t WORLD_SNAPSHOT_METRICS = 1u << 4;
+
+// VehicleSnapshot::m_flags
+constexpr uint32_t VEHICLE_SNAPSHOT_AWAKE = 1u << 0;
+constexpr uint32_t VEHICLE_SNAPSHOT_OBSTACLE_CONTACT = 1u << 1;
+
+
+enum FlowGoalKind : uint32_t
+{
+	FLOW_GOAL_NONE = 0,
+	FLOW_GOAL_POINT,
+	FLOW_GOAL_VEHICLE
+};
+
+
+struct WorldSnapshotHeader
+{
+	uint32_t	m_magic = WORLD_SNAPSHOT_MAGIC;
+	uint32_t	m_version = WORLD_SNAPSHOT_VERSION;
+	uint32_t	m_headerSize = 0;
+	uint32_t	m_vehicleSize = 0;
+	uint32_t	m_obstacleSize = 0;
+	uint32_t	m_wallSize = 0;
+	uint32_t	m_numVehicles = 0;			// every vehicle created, the population and the spares past it
+	uint32_t	m_populationSize = 0;
+	uint32_t	m_numObstacles = 0;
+	uint32_t	m_numWalls = 0;
+	uint32_t	m_steeringCombine = 0;
+	uint32_t	m_worldFlags = 0;
+	int32_t		m_currentFrame = 0;
+	float		m_time = 0.0f;
+	uint32_t	m_metricTicks = 0;
+	uint32_t	m_reserved = 0;
+
+	uint64_t	m_seed = 0;
+	uint64_t	m_randomState = 0;
+	uint64_t	m_vehiclesOffset = 0;
+	uint64_t	m_obstaclesOffset = 0;
+	uint64_t	m_wallsOffset = 0;
+	uint64_t	m_fileSize = 0;
+	uint64_t	m_metricAgentUpdates = 0;
+	uint64_t	m_metricObstacleCollisions = 0;
+	double		m_metricDistanceTraveled = 0.0;
+
+	SteeringTuning	m_steeringTuning;
+	uint32_t		m_tuningPadding = 0;
+};
+
+
+// SteeringBehavior's parameters and goals
+struct SteeringSnapshot
+{
+	Vec2		m_target;
+	Vec2		m_flowGoal;
+	uint32_t	m_movingTarget = INVALID_SNAPSHOT_INDEX;
+	uint32_t	m_flowGoalKind = FLOW_GOAL_NONE;
+	uint32_t	m_flowMovingGoal = INVALID_SNAPSHOT_INDEX;
+	float		m_arriveModifier = 1.0f;
+	float		m_pursuitTolerance = 0.97f;
+	float		m_turnaroundCoefficient = 0.25f;
+	float		m_wanderRadius = 1.0f;
+	float		m_wanderDistance = 0.0f;
+	float		m_wanderJitter = 0.0f;
+	float		m_minLookAhead = 10.0f;
+	float		m_avoidanceMultiplier = 1.0f;
+	float		m_breakingWeight = 0.2f;
+	uint32_t	m_numWhiskers = 0;			// 0 when no whisker fan was ever set up
+	float		m_whiskerFieldOfViewDegrees = 0.0f;
+	float		m_whiskerLength = 0.0f;
+};
+
+
+struct VehicleSnapshot
+{
+	VehicleState		m_state;
+	SteeringSnapshot	m_steering;
+	float				m_boundingRadius = 1.0f;
+	float				m_mass = 1.0f;
+	float				m_maxSpeed = 1.0f;
+	float				m_maxForce = 1.0f;
+	float				m_maxTurnSpeedDeg = 1.0f;
+	uint32_t			m_behaviors = 0;		// bit b set while Behavior b is on
+	uint32_t			m_flags = 0;
+	int32_t				m_lodPriority = LOD_PRIORITY_BY_DISTANCE;
+	int32_t				m_lodTier = LOD_TIER_FULL;
+};
+
+
+struct ObstacleSnapshot
+{
+	Vec2	m_position;
+	float	m_radius = 0.0f;
+};
+
+
+struct WallSnapshot
+{
+	Vec2	m_normal;
+	float	m_signedDistance = 0.0f;
+	float	m_length = 0.0f;
+};
+
+
+class WorldSnapshot
+{
+public:
+	static constexpr const char*	DEFAULT_PATH = "World.snapshot";
+	static constexpr uint64_t		SECTION_ALIGNMENT = 64;
+
+public:
+	WorldSnapshot() = default;
+
+	WorldSnapshot(const WorldSnapshot&) = delete;
+	WorldSnapshot& operator=(const WorldSnapshot&) = delete;
+
+	bool	Map(const std::string& file_path);		// false if missing, truncated or written by another version
+	void	Unmap();
+	bool	IsMapped() const { return m_file.IsMapped(); }
+
+	const WorldSnapshotHeader&	GetHeader() const;
+	const VehicleSnapshot*		GetVehicles() const;
+	const ObstacleSnapshot*		GetObstacles() const;
+	const WallSnapshot*			GetWalls() const;
+
+	static void	LayOut(WorldSnapshotHeader& header);	// sizes, offsets and file size from the counts
+	static bool	WriteFile(const std::string& file_path, const std::vector<uint8_t>& buffer);
+
+private:
+	bool	IsValid() const;
+
+private:
+	MappedFile	m_file;
+};
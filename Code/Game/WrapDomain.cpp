@@ -0,0 +1,57 @@
+#include "Game/WrapDomain.hpp"
+
+#include <cmath>
+
+const WrapDomain WORLD_WRAP = {
+	Vec2(-WORLD_HEIGHT * WORLD_ASPECT, -WORLD_HEIGHT),
+	Vec2(WORLD_HEIGHT * WORLD_ASPECT, WORLD_HEIGHT_ADJUST)
+};
+
+
+static float WrapOffset(const float offset, const float period)
+{
+	// offset minus the nearest whole number of periods, at most half a period either way
+	return offset - period * std::floor(offset / period + 0.5f);
+}
+
+
+Vec2 WrapDomain::GetSize() const
+{
+	return m_maxs - m_mins;
+}
+
+
+static float WrapCoordinate(const float coordinate, const float min, const float max)
+{
+	// inside stays bit for bit, positions the world already wrapped never move
+	if (coordinate >= min && coordinate < max)
+	{
+		return coordinate;
+	}
+
+	const float period = max - min;
+	const float wrapped = coordinate - period * std::floor((coordinate - min) / period);
+
+	// rounding can land a hair below the max edge onto it
+	return wrapped < max ? wrapped : min;
+}
+
+
+Vec2 WrapDomain::Wrap(const Vec2& position) const
+{
+	return Vec2(WrapCoordinate(position.x, m_mins.x, m_maxs.x), WrapCoordinate(position.y, m_mins.y, m_maxs.y));
+}
+
+
+Vec2 WrapDomain::GetDisplacement(const Vec2& from, const Vec2& to) const
+{
+	const Vec2 size = GetSize();
+	return Vec2(WrapOffset(to.x - from.x, size.x), WrapOffset(to.y - from.y, size.y));
+}
+
+
+float WrapDomain::GetDistanceSquared(const Vec2& position_a, const Vec2& position_b) const
+{
+	const Vec2 displacement = GetDisplacement(position_a, position_b);
+	return displacement.x * displacement.x + displacement.y * displacement.y;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+
+//-----------------------------------------------------------------------------------------------
+// WrapDomain
+//
+// A rectangle with periodic edges: whatever leaves one side comes back on the other, so the shortest
+// way between two points may cross the seam. GetDisplacement returns that minimum-image vector, at
+// most half the period along either axis, for points anywhere (not just inside the rectangle).
+//
+// WORLD_WRAP is the rectangle Vehicle::Update wraps positions into; it is asymmetric vertically,
+// bottom at -WORLD_HEIGHT and top at WORLD_HEIGHT_ADJUST.
+//
+
+struct WrapDomain
+{
+	Vec2	m_mins;
+	Vec2	m_maxs;
+
+	Vec2	GetSize() const;
+	Vec2	Wrap(const Vec2& position) const;							// into [mins, maxs)
+	Vec2	GetDisplacement(const Vec2& from, const Vec2& to) const;	// minimum image of to - from
+	float	GetDistanceSquared(const Vec2& position_a, const Vec2& position_b) const;
+};
+
+
+extern const WrapDomain WORLD_WRAP;